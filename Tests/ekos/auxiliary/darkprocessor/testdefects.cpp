@@ -11,10 +11,15 @@
 #include <QTest>
 #endif
 
+#include <algorithm>
+#include <array>
 #include <memory>
+#include <random>
+#include <vector>
 
 #include <QObject>
 #include "fitsviewer/fitsdata.h"
+#include "ekos/auxiliary/darkcalibration.h"
 #include "ekos/auxiliary/darkprocessor.h"
 #include "ekos/auxiliary/defectmap.h"
 
@@ -33,10 +38,41 @@ class TestDefects : public QObject
 
     private slots:
         void basicTest();
+        void indexesTest();
+        void correctionTest();
 };
 
 #include "testdefects.moc"
 
+namespace
+{
+
+struct Geometry
+{
+    uint32_t width, height;
+    uint16_t offsetX, offsetY;
+};
+
+// The enabled defects with all their neighbors in the frame, as sample indexes of the frame.
+std::vector<uint32_t> expectedIndexes(const DefectMap &map, const Geometry &geometry)
+{
+    std::vector<uint32_t> expected;
+    auto add = [&](const BadPixel & onePixel)
+    {
+        const int x = static_cast<int>(onePixel.x) - geometry.offsetX;
+        const int y = static_cast<int>(onePixel.y) - geometry.offsetY;
+        if (x >= 1 && y >= 1 && x < static_cast<int>(geometry.width) - 1 && y < static_cast<int>(geometry.height) - 1)
+            expected.push_back(x + y * geometry.width);
+    };
+    std::for_each(map.hotThreshold(), map.hotPixels().cend(), add);
+    std::for_each(map.coldPixels().cbegin(), map.coldThreshold(), add);
+    std::sort(expected.begin(), expected.end());
+    expected.erase(std::unique(expected.begin(), expected.end()), expected.end());
+    return expected;
+}
+
+}
+
 TestDefects::TestDefects() : QObject()
 {
 }
@@ -101,4 +137,73 @@ void TestDefects::basicTest()
     }
 }
 
+void TestDefects::indexesTest()
+{
+    const QString filename = "../Tests/ekos/auxiliary/darkprocessor/hotpixels.fits";
+    if (!QFileInfo::exists(filename))
+        QSKIP(QString("Failed to locate file %1, skipping test.").arg(filename).toLatin1());
+
+    QSharedPointer<FITSData> darkData;
+    darkData.reset(new FITSData());
+    QFuture<bool> result = darkData->loadFromFile(filename);
+    result.waitForFinished();
+
+    if (result.result() == false)
+        QSKIP("Failed to load image, skipping test.");
+
+    QSharedPointer<DefectMap> map;
+    map.reset(new DefectMap());
+    map->setDarkData(darkData);
+    QVERIFY(map->hotCount() > 0);
+
+    // The full frame, and a subframe whose borders cut through the defects.
+    for (const Geometry &geometry : std::vector<Geometry> {{darkData->width(), darkData->height(), 0, 0}, {50, 40, 20, 30}})
+    {
+        auto indexes = map->defectIndexes(geometry.width, geometry.height, geometry.offsetX, geometry.offsetY);
+        QVERIFY(indexes);
+        QVERIFY(*indexes == expectedIndexes(*map, geometry));
+        // The list is kept for the next frame of the same geometry.
+        QVERIFY(map->defectIndexes(geometry.width, geometry.height, geometry.offsetX, geometry.offsetY) == indexes);
+    }
+
+    // Disabling the hot pixels rebuilds the list.
+    map->setHotEnabled(false);
+    const Geometry subframe {50, 40, 20, 30};
+    QVERIFY(*map->defectIndexes(subframe.width, subframe.height, subframe.offsetX, subframe.offsetY) ==
+            expectedIndexes(*map, subframe));
+}
+
+void TestDefects::correctionTest()
+{
+    const uint32_t width = 13, height = 11;
+    std::mt19937 generator(11);
+    std::vector<uint16_t> light(width * height);
+    for (auto &sample : light)
+        sample = generator() % 1000;
+
+    // Adjacent defects, whose medians would depend on the order if corrected ones were read back,
+    // and defects next to each border.
+    const std::vector<uint32_t> indexes
+    {
+        1 + 1 * width, 5 + 5 * width, 6 + 5 * width, 6 + 6 * width, 11 + 4 * width, 3 + 9 * width, 11 + 9 * width
+    };
+    for (auto index : indexes)
+        light[index] = 65535;
+
+    std::vector<uint16_t> expected = light;
+    for (auto index : indexes)
+    {
+        std::array<uint16_t, 8> neighbors;
+        const int64_t w = width;
+        size_t i = 0;
+        for (int64_t offset : { -w - 1, -w, -w + 1, int64_t(-1), int64_t(1), w - 1, w, w + 1 })
+            neighbors[i++] = light[index + offset];
+        std::sort(neighbors.begin(), neighbors.end());
+        expected[index] = (neighbors[3] + neighbors[4]) / 2;
+    }
+
+    Ekos::DarkCalibration::correctDefects(light.data(), width, indexes);
+    QVERIFY(light == expected);
+}
+
 QTEST_GUILESS_MAIN(TestDefects)
@@ -11,10 +11,15 @@
 #include <QTest>
 #endif
 
+#include <cmath>
+#include <limits>
 #include <memory>
+#include <random>
+#include <vector>
 
 #include <QObject>
 #include "fitsviewer/fitsdata.h"
+#include "ekos/auxiliary/darkcalibration.h"
 #include "ekos/auxiliary/darkprocessor.h"
 
 class TestSubtraction : public QObject
@@ -27,8 +32,92 @@ class TestSubtraction : public QObject
 
     private slots:
         void basicTest();
+        void kernelTest();
+        void benchmarkSubtract_data();
+        void benchmarkSubtract();
 };
 
+namespace
+{
+
+// Scalar subtraction with the documented results: below zero is set to zero, and the types smaller than int
+// saturate at their largest value. The loop used before the vectorized kernels wrapped around for signed 16 bit
+// samples instead.
+template <typename T>
+void referenceSubtract(T *light, uint32_t width, uint32_t height, T const *dark, uint32_t darkStride)
+{
+    for (uint32_t y = 0; y < height; y++)
+    {
+        for (uint32_t x = 0; x < width; x++)
+        {
+            if constexpr (std::is_integral<T>::value && sizeof(T) <= 2)
+            {
+                const int32_t value = static_cast<int32_t>(light[x]) - dark[x];
+                light[x] = value > 0 ? static_cast<T>(std::min<int32_t>(value, std::numeric_limits<T>::max())) : 0;
+            }
+            else
+                light[x] = (light[x] > dark[x]) ? (light[x] - dark[x]) : 0;
+        }
+        light += width;
+        dark += darkStride;
+    }
+}
+
+template <typename T>
+std::vector<T> randomSamples(size_t count, std::mt19937 &generator)
+{
+    std::vector<T> samples(count);
+    for (auto &sample : samples)
+    {
+        if constexpr (std::is_floating_point<T>::value)
+            sample = std::uniform_real_distribution<T>(-100, 1000)(generator);
+        else
+            sample = static_cast<T>(generator());
+    }
+    return samples;
+}
+
+template <typename T>
+void checkKernels()
+{
+    // Odd width for the leftover samples, and a subframe of a wider dark.
+    const uint32_t width = 1037, height = 67, darkStride = 1100, offset = 3 * darkStride + 50;
+    std::mt19937 generator(5);
+    const auto light = randomSamples<T>(width * height, generator);
+    auto dark = randomSamples<T>(darkStride * (height + 3), generator);
+    if constexpr (std::is_floating_point<T>::value)
+    {
+        dark[offset + 1] = std::numeric_limits<T>::quiet_NaN();
+        dark[offset + 2] = std::numeric_limits<T>::infinity();
+    }
+
+    auto expected = light;
+    referenceSubtract(expected.data(), width, height, dark.data() + offset, darkStride);
+
+    Ekos::DarkCalibration::Scaling scaling;
+    scaling.scale = 0.37;
+    scaling.bias = 12.5;
+    auto expectedScaled = light;
+    Ekos::DarkCalibration::subtract(expectedScaled.data(), width, height, dark.data() + offset, darkStride, scaling,
+                                    FITSSweep::KERNEL_SCALAR);
+
+    for (auto kernel : {FITSSweep::KERNEL_SCALAR, FITSSweep::KERNEL_SSE2, FITSSweep::KERNEL_AVX2, FITSSweep::KERNEL_NEON})
+    {
+        auto result = light;
+        Ekos::DarkCalibration::subtract(result.data(), width, height, dark.data() + offset, darkStride,
+                                        Ekos::DarkCalibration::Scaling(), kernel);
+        QVERIFY(result == expected);
+
+        // The scalar code may fuse the multiply and add where the vectorized kernels don't.
+        result = light;
+        Ekos::DarkCalibration::subtract(result.data(), width, height, dark.data() + offset, darkStride, scaling, kernel);
+        for (size_t i = 0; i < result.size(); i++)
+            QVERIFY(std::abs(static_cast<double>(result[i]) - expectedScaled[i]) <= 1e-4 * std::abs(static_cast<double>(expectedScaled[i])) + 1);
+    }
+}
+
+}
+
 #include "testsubtraction.moc"
 
 TestSubtraction::TestSubtraction() : QObject()
@@ -63,4 +152,49 @@ void TestSubtraction::basicTest()
 }
 
 
+void TestSubtraction::kernelTest()
+{
+    checkKernels<uint8_t>();
+    checkKernels<int16_t>();
+    checkKernels<uint16_t>();
+    checkKernels<int32_t>();
+    checkKernels<uint32_t>();
+    checkKernels<float>();
+    checkKernels<int64_t>();
+    checkKernels<double>();
+}
+
+void TestSubtraction::benchmarkSubtract_data()
+{
+    QTest::addColumn<int>("METHOD");
+    QTest::newRow("reference") << -1;
+    QTest::newRow("scalar") << static_cast<int>(FITSSweep::KERNEL_SCALAR);
+    QTest::newRow("selected") << static_cast<int>(FITSSweep::kernel());
+}
+
+void TestSubtraction::benchmarkSubtract()
+{
+    QFETCH(int, METHOD);
+
+    // A 16 bit 60 MP frame, with a light well above the dark so that it isn't clipped to 0 over the iterations.
+    const uint32_t width = 9576, height = 6388;
+    std::mt19937 generator(7);
+    std::vector<uint16_t> light(static_cast<size_t>(width) * height), dark(light.size());
+    for (size_t i = 0; i < light.size(); i++)
+    {
+        light[i] = 30000 + generator() % 30000;
+        dark[i] = generator() % 256;
+    }
+
+    QBENCHMARK
+    {
+        if (METHOD < 0)
+            referenceSubtract(light.data(), width, height, dark.data(), width);
+        else
+            Ekos::DarkCalibration::subtract(light.data(), width, height, dark.data(), width, Ekos::DarkCalibration::Scaling(),
+                                            static_cast<FITSSweep::Kernel>(METHOD));
+    }
+}
+
+
 QTEST_GUILESS_MAIN(TestSubtraction)
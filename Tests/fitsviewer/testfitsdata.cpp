@@ -10,11 +10,20 @@
 #include <QTest>
 #endif
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <memory>
+#include <numeric>
+#include <QTemporaryDir>
 #include "testfitsdata.h"
 #include "Options.h"
 #include "ekos/auxiliary/solverutils.h"
 #include "ekos/auxiliary/stellarsolverprofile.h"
+#include "fitsviewer/fitsmedian.h"
+#include "fitsviewer/fitssweep.h"
+#include "fitsviewer/fitsbayer.h"
+#include "fitsviewer/fitssepdetector.h"
 
 Q_DECLARE_METATYPE(FITSMode);
 
@@ -693,4 +702,313 @@ void TestFitsData::testParallelSolvers()
 #endif
 }
 
+namespace
+{
+// Median and MAD the slow way, by sorting.
+template <typename T>
+QPair<double, double> sortedMedianAndMAD(const std::vector<T> &values)
+{
+    std::vector<double> sorted(values.begin(), values.end());
+    std::sort(sorted.begin(), sorted.end());
+    const size_t n = sorted.size();
+    const double median = (sorted[(n - 1) / 2] + sorted[n / 2]) / 2;
+    for (auto &value : sorted)
+        value = std::fabs(value - median);
+    std::sort(sorted.begin(), sorted.end());
+    return qMakePair(median, (sorted[(n - 1) / 2] + sorted[n / 2]) / 2);
+}
+
+template <typename T>
+void checkMedianAndMAD(const std::vector<T> &values)
+{
+    const auto expected = sortedMedianAndMAD(values);
+    const auto result = FITSMedian::compute(values.data(), values.size());
+    QVERIFY2(std::fabs(result.median - expected.first) <= 1e-6 * std::max(1.0, std::fabs(expected.first)),
+             qPrintable(QString("median expected(computed): %1(%2)").arg(expected.first).arg(result.median)));
+    QVERIFY2(std::fabs(result.mad - expected.second) <= 1e-6 * std::max(1.0, expected.second),
+             qPrintable(QString("MAD expected(computed): %1(%2)").arg(expected.second).arg(result.mad)));
+}
+}
+
+void TestFitsData::testMedianAndMAD()
+{
+    QRandomGenerator generator(42);
+    // Odd and even sizes, small enough for a single thread and large enough for several.
+    for (const int size : {1, 2, 7, 1000, 300001})
+    {
+        std::vector<uint8_t> bytes(size);
+        std::vector<uint16_t> shorts(size);
+        std::vector<int16_t> signedShorts(size);
+        std::vector<int32_t> longs(size);
+        std::vector<float> floats(size);
+        for (int i = 0; i < size; i++)
+        {
+            bytes[i] = generator.bounded(256);
+            shorts[i] = 1000 + generator.bounded(500);
+            signedShorts[i] = generator.bounded(-30000, 30000);
+            longs[i] = generator.bounded(-2000000000, 2000000000);
+            floats[i] = 0.1 + 0.01 * generator.generateDouble();
+        }
+        checkMedianAndMAD(bytes);
+        checkMedianAndMAD(shorts);
+        checkMedianAndMAD(signedShorts);
+        checkMedianAndMAD(longs);
+        // A hot pixel should not degrade the precision of the quantized bins.
+        if (size > 2)
+            floats[0] = 65535;
+        checkMedianAndMAD(floats);
+    }
+}
+
+namespace
+{
+// Compares every kernel available on this CPU with a plain loop.
+template <typename T>
+void checkSweep(const std::vector<T> &values)
+{
+    double min = values[0], max = values[0], sum = 0, squaredSum = 0;
+    for (const auto value : values)
+    {
+        min = std::min<double>(min, value);
+        max = std::max<double>(max, value);
+        sum += value;
+        squaredSum += static_cast<double>(value) * value;
+    }
+
+    const auto reference = FITSSweep::sweep(values.data(), values.size(), true, FITSSweep::KERNEL_SCALAR);
+    for (const auto kernel : {FITSSweep::KERNEL_SCALAR, FITSSweep::KERNEL_SSE2, FITSSweep::KERNEL_AVX2, FITSSweep::KERNEL_NEON})
+    {
+        const auto result = FITSSweep::sweep(values.data(), values.size(), true, kernel);
+        QCOMPARE(result.count, static_cast<uint32_t>(values.size()));
+        QCOMPARE(result.min, min);
+        QCOMPARE(result.max, max);
+        QVERIFY(std::fabs(result.sum - sum) <= 1e-9 * std::fabs(sum));
+        QVERIFY(std::fabs(result.squaredSum - squaredSum) <= 1e-9 * squaredSum);
+        QVERIFY(result.histogram == reference.histogram);
+        if (FITSSweep::hasHistogram<T>())
+            QCOMPARE(std::accumulate(result.histogram.begin(), result.histogram.end(), 0u), result.count);
+    }
+}
+}
+
+void TestFitsData::testSweepKernels()
+{
+    QRandomGenerator generator(7);
+    // Sizes chosen to exercise the vector loops and the scalar tails.
+    for (const int size : {1, 15, 33, 1001, 300007})
+    {
+        std::vector<uint8_t> bytes(size);
+        std::vector<uint16_t> shorts(size);
+        std::vector<int16_t> signedShorts(size);
+        std::vector<float> floats(size);
+        for (int i = 0; i < size; i++)
+        {
+            bytes[i] = generator.bounded(256);
+            shorts[i] = generator.bounded(65536);
+            signedShorts[i] = generator.bounded(-32768, 32768);
+            floats[i] = generator.bounded(-1000.0) + 500;
+        }
+        checkSweep(bytes);
+        checkSweep(shorts);
+        checkSweep(signedShorts);
+        checkSweep(floats);
+    }
+}
+
+namespace
+{
+// Writes the values to a FITS file with cfitsio, loads it back and compares the pixels.
+template <typename T>
+void checkLoad(const QString &filename, int bitpix, int datatype, std::vector<T> values, FITSMode mode = FITS_CALIBRATE)
+{
+    const long width = 301, height = 203;
+    values.resize(width * height);
+
+    fitsfile *fptr = nullptr;
+    int status = 0;
+    long naxes[2] = {width, height};
+    fits_create_file(&fptr, filename.toLocal8Bit().data(), &status);
+    fits_create_img(fptr, bitpix, 2, naxes, &status);
+    fits_write_img(fptr, datatype, 1, values.size(), values.data(), &status);
+    fits_close_file(fptr, &status);
+    QCOMPARE(status, 0);
+
+    std::unique_ptr<FITSData> data(new FITSData(mode));
+    QFuture<bool> worker = data->loadFromFile(filename);
+    worker.waitForFinished();
+    QVERIFY(worker.result());
+    QCOMPARE(data->getStatistics().samples_per_channel, static_cast<uint32_t>(values.size()));
+    QVERIFY(std::memcmp(data->getImageBuffer(), values.data(), values.size() * sizeof(T)) == 0);
+}
+}
+
+void TestFitsData::testMappedLoad()
+{
+    QTemporaryDir dir;
+    QVERIFY(dir.isValid());
+    QRandomGenerator generator(3);
+
+    std::vector<uint8_t> bytes(64 * 1024);
+    std::vector<uint16_t> shorts(64 * 1024);
+    std::vector<uint16_t> positiveShorts(64 * 1024);
+    std::vector<float> floats(64 * 1024);
+    std::vector<double> doubles(64 * 1024);
+    for (size_t i = 0; i < bytes.size(); i++)
+    {
+        bytes[i] = generator.bounded(256);
+        shorts[i] = generator.bounded(65536);
+        positiveShorts[i] = generator.bounded(32768);
+        floats[i] = generator.bounded(1000.0);
+        doubles[i] = generator.generateDouble();
+    }
+
+    // Kept mapped as they are stored.
+    checkLoad(dir.filePath("bytes.fits"), BYTE_IMG, TBYTE, bytes);
+    // Converted from the mapping.
+    checkLoad(dir.filePath("shorts.fits"), USHORT_IMG, TUSHORT, shorts);
+    checkLoad(dir.filePath("floats.fits"), FLOAT_IMG, TFLOAT, floats);
+    checkLoad(dir.filePath("doubles.fits"), DOUBLE_IMG, TDOUBLE, doubles);
+    checkLoad(dir.filePath("normal-bytes.fits"), BYTE_IMG, TBYTE, bytes, FITS_NORMAL);
+    checkLoad(dir.filePath("normal-shorts.fits"), USHORT_IMG, TUSHORT, shorts, FITS_NORMAL);
+    checkLoad(dir.filePath("focus.fits"), USHORT_IMG, TUSHORT, shorts, FITS_FOCUS);
+    // Signed shorts and compressed files are read through cfitsio.
+    checkLoad(dir.filePath("signed.fits"), SHORT_IMG, TUSHORT, positiveShorts);
+    checkLoad(dir.filePath("shorts.fits.gz"), USHORT_IMG, TUSHORT, shorts);
+    checkLoad(dir.filePath("floats.fits.gz"), FLOAT_IMG, TFLOAT, floats);
+}
+
+namespace
+{
+// Compares the banded, planar debayering with one pass of the dc1394 method over the whole frame.
+template <typename T>
+void checkDebayer(const std::vector<T> &bayer, uint32_t width, uint32_t height, const BayerParams &params)
+{
+    std::vector<T> planar(bayer.size() * 3);
+    QCOMPARE(FITSBayer::debayer(bayer.data(), planar.data(), width, height, params), DC1394_SUCCESS);
+
+    // Edge sense and downsample work on pairs of rows.
+    const T *source = bayer.data() + params.offsetY * width;
+    uint32_t rows = height - params.offsetY;
+    if (params.method == DC1394_BAYER_METHOD_EDGESENSE || params.method == DC1394_BAYER_METHOD_DOWNSAMPLE)
+        rows &= ~1u;
+
+    std::vector<T> rgb(bayer.size() * 3);
+    if (sizeof(T) == 1)
+        dc1394_bayer_decoding_8bit(reinterpret_cast<const uint8_t *>(source), reinterpret_cast<uint8_t *>(rgb.data()), width,
+                                   rows, params.filter, params.method);
+    else
+        dc1394_bayer_decoding_16bit(reinterpret_cast<const uint16_t *>(source), reinterpret_cast<uint16_t *>(rgb.data()),
+                                    width, rows, params.filter, params.method, 16);
+
+    const size_t count = params.method == DC1394_BAYER_METHOD_DOWNSAMPLE ? rows / 2 * (width / 2) : rows * width;
+    for (size_t i = 0; i < count; i++)
+    {
+        for (size_t channel = 0; channel < 3; channel++)
+        {
+            if (planar[channel * bayer.size() + i] != rgb[i * 3 + channel])
+                QFAIL(qPrintable(QString("Method %1 pattern %2 offset %3 differs at pixel %4").arg(params.method)
+                                 .arg(params.filter).arg(params.offsetY).arg(i)));
+        }
+    }
+}
+}
+
+void TestFitsData::testTiledDebayer()
+{
+    // Tall enough for several bands, with an odd height and an image row offset.
+    const uint32_t width = 302, height = 611;
+    QRandomGenerator generator(11);
+    std::vector<uint8_t> bytes(width * height);
+    std::vector<uint16_t> shorts(width * height);
+    for (size_t i = 0; i < bytes.size(); i++)
+    {
+        bytes[i] = generator.bounded(256);
+        shorts[i] = generator.bounded(65536);
+    }
+
+    // AHD is left out, it reads outside of the frame at its borders.
+    for (int method = DC1394_BAYER_METHOD_NEAREST; method < DC1394_BAYER_METHOD_AHD; method++)
+    {
+        for (int filter = DC1394_COLOR_FILTER_MIN; filter <= DC1394_COLOR_FILTER_MAX; filter++)
+        {
+            for (int offsetY = 0; offsetY <= 1; offsetY++)
+            {
+                BayerParams params;
+                params.method = static_cast<dc1394bayer_method_t>(method);
+                params.filter = static_cast<dc1394color_filter_t>(filter);
+                params.offsetX = 0;
+                params.offsetY = offsetY;
+                checkDebayer(bytes, width, height, params);
+                checkDebayer(shorts, width, height, params);
+            }
+        }
+    }
+}
+
+void TestFitsData::testSEPRegions()
+{
+    // Overlapping windows are merged, also when a merged window reaches another one, and clipped to the frame.
+    const QRect frame(0, 0, 100, 100);
+    const auto merged = FITSSEPDetector::mergeRegions({QRect(0, 0, 10, 10), QRect(30, 0, 10, 10), QRect(8, 0, 24, 5),
+                                                          QRect(90, 90, 20, 20), QRect(200, 200, 5, 5)}, frame);
+    QCOMPARE(static_cast<int>(merged.size()), 2);
+    QCOMPARE(merged[0], QRect(0, 0, 40, 10));
+    QCOMPARE(merged[1], QRect(90, 90, 10, 10));
+    QVERIFY(FITSSEPDetector::mergeRegions({QRect(-20, -20, 10, 10)}, frame).isEmpty());
+
+#if QT_VERSION < 0x050900
+    QSKIP("Skipping fixture-based test on old QT version.");
+#else
+    const QString name = "m47_sim_stars.fits";
+    if(!QFile::exists(name))
+        QSKIP("Skipping load test because of missing fixture");
+
+    std::unique_ptr<FITSData> d(new FITSData());
+    QFuture<bool> worker = d->loadFromFile(name);
+    QTRY_VERIFY_WITH_TIMEOUT(worker.isFinished(), 10000);
+    QVERIFY(worker.result());
+
+    QVERIFY(d->findStars(ALGORITHM_SEP).result());
+    QList<Edge> fullFrame;
+    for (const Edge *star : d->getStarCenters())
+        fullFrame.append(*star);
+    QVERIFY(fullFrame.size() > 10);
+
+    // Windows around a few stars, well away from the others, find these stars at the same positions.
+    QVariantList regions;
+    QList<Edge> expected;
+    for (const Edge &star : fullFrame)
+    {
+        const QRect region(static_cast<int>(star.x) - 32, static_cast<int>(star.y) - 32, 65, 65);
+        const bool isolated = std::none_of(fullFrame.begin(), fullFrame.end(), [&](const Edge & other)
+        {
+            return &other != &star && region.adjusted(-16, -16, 16, 16).contains(QPointF(other.x, other.y).toPoint());
+        });
+        if (isolated && region.intersected(QRect(0, 0, d->width(), d->height())) == region)
+        {
+            regions.append(region);
+            expected.append(star);
+        }
+        if (expected.size() == 5)
+            break;
+    }
+    QVERIFY(!expected.isEmpty());
+
+    QVariantMap settings;
+    settings["regions"] = regions;
+    d->setSourceExtractorSettings(settings);
+    QVERIFY(d->findStars(ALGORITHM_SEP).result());
+    const QList<Edge *> found = d->getStarCenters();
+    QVERIFY(found.size() >= expected.size());
+    for (const Edge &star : expected)
+    {
+        QVERIFY(std::any_of(found.begin(), found.end(), [&](const Edge * other)
+        {
+            return std::hypot(other->x - star.x, other->y - star.y) < 0.5;
+        }));
+    }
+    QVERIFY(d->getSkyBackground().mean > 0);
+#endif
+}
+
 QTEST_GUILESS_MAIN(TestFitsData)
@@ -53,6 +53,12 @@ class TestFitsData : public QObject
         void testBahtinovFocusHFR();
 
         void testParallelSolvers();
+
+        void testMedianAndMAD();
+        void testSweepKernels();
+        void testMappedLoad();
+        void testTiledDebayer();
+        void testSEPRegions();
     private:
         void startGuideDetect(const QString &filename);
         void guideLoadFinished();
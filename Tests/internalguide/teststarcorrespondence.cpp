@@ -14,8 +14,13 @@
 #endif
 
 #include <QObject>
+#include <QPointF>
 #include "Options.h"
 
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
 
 class TestStarCorrespondence : public QObject
 {
@@ -30,6 +35,10 @@ class TestStarCorrespondence : public QObject
 
     private slots:
         void basicTest();
+        void starIndexTest();
+        void benchmarkClosestStar_data();
+        void benchmarkClosestStar();
+        void benchmarkFind();
 };
 
 #include "teststarcorrespondence.moc"
@@ -245,4 +254,176 @@ void TestStarCorrespondence::basicTest()
     runNoCorrespondenceTest();
 }
 
+// Closest star by scanning the stars sorted by x, as StarCorrespondence did before StarPositionIndex.
+int linearClosestStar(double x, double y, const QList<Edge> &sortedStars, double maxDistance, double *distance)
+{
+    const int size = sortedStars.size();
+    int startPoint = 0;
+    const int coarseIncrement = size / 10;
+    if (coarseIncrement > 1)
+    {
+        for (int i = 0; i < size; i += coarseIncrement)
+        {
+            if (sortedStars[i].x < x - maxDistance)
+                startPoint = i;
+            else
+                break;
+        }
+    }
+
+    int bestIndex = -1;
+    double bestSquaredDistance = maxDistance * maxDistance;
+    for (int i = startPoint; i < size; ++i)
+    {
+        auto &star = sortedStars[i];
+        if (star.x < x - maxDistance) continue;
+        if (star.x > x + maxDistance) break;
+        const double xDiff = star.x - x;
+        const double yDiff = star.y - y;
+        const double squaredDistance = xDiff * xDiff + yDiff * yDiff;
+        if (squaredDistance <= bestSquaredDistance)
+        {
+            bestIndex = i;
+            bestSquaredDistance = squaredDistance;
+        }
+    }
+    if (distance != nullptr) *distance = sqrt(bestSquaredDistance);
+    return bestIndex;
+}
+
+// A wide field guide camera frame, stars sorted by x.
+QList<Edge> makeStarField(int numStars, unsigned int seed)
+{
+    srand(seed);
+    QList<Edge> stars;
+    for (int i = 0; i < numStars; ++i)
+        stars.append(makeEdge((rand() % 300000) / 100.0, (rand() % 200000) / 100.0));
+    std::sort(stars.begin(), stars.end(), [](const Edge & a, const Edge & b)
+    {
+        return a.x < b.x;
+    });
+    return stars;
+}
+
+void TestStarCorrespondence::starIndexTest()
+{
+    // Empty index
+    StarPositionIndex empty(QList<Edge>(), 5.0);
+    QCOMPARE(empty.findClosest(10, 10, 5.0), -1);
+    QVERIFY(empty.findWithin(10, 10, 5.0).isEmpty());
+
+    // Same answers as the linear scan, including ties and stars exactly at the maximum distance.
+    QList<Edge> stars = makeStarField(500, 7);
+    stars.append(makeEdge(1000, 1000));
+    stars.append(makeEdge(1004, 1000));
+    stars.append(makeEdge(1000, 1005));
+    std::sort(stars.begin(), stars.end(), [](const Edge & a, const Edge & b)
+    {
+        return a.x < b.x;
+    });
+
+    for (double maxDistance : {1.0, 5.0, 20.0})
+    {
+        StarPositionIndex index(stars, maxDistance);
+        QCOMPARE(index.size(), static_cast<int>(stars.size()));
+
+        srand(11);
+        for (int i = 0; i < 5000; ++i)
+        {
+            const double x = (rand() % 310000) / 100.0 - 50;
+            const double y = (rand() % 210000) / 100.0 - 50;
+            double linearDistance, indexDistance;
+            const int linear = linearClosestStar(x, y, stars, maxDistance, &linearDistance);
+            QCOMPARE(index.findClosest(x, y, maxDistance, &indexDistance), linear);
+            QCOMPARE(indexDistance, linearDistance);
+        }
+
+        // Tied at 2 pixels, and a star exactly at 5 pixels.
+        QCOMPARE(index.findClosest(1002, 1000, maxDistance), linearClosestStar(1002, 1000, stars, maxDistance, nullptr));
+        QCOMPARE(index.findClosest(1000, 1000, 5.0), linearClosestStar(1000, 1000, stars, 5.0, nullptr));
+        QCOMPARE(index.findClosest(1000, 995, 5.0), linearClosestStar(1000, 995, stars, 5.0, nullptr));
+
+        const QVector<int> within = index.findWithin(1000, 1000, 5.0);
+        for (int i = 0; i < stars.size(); ++i)
+        {
+            const double d = hypot(stars[i].x - 1000.0, stars[i].y - 1000.0);
+            QCOMPARE(within.contains(i), d <= 5.0);
+        }
+    }
+}
+
+void TestStarCorrespondence::benchmarkClosestStar_data()
+{
+    QTest::addColumn<int>("numStars");
+    QTest::addColumn<bool>("indexed");
+
+    for (int numStars : {50, 500, 2000})
+    {
+        QTest::addRow("linear %d", numStars) << numStars << false;
+        QTest::addRow("indexed %d", numStars) << numStars << true;
+    }
+}
+
+// The queries of one findInternal() candidate loop: every star as the guide star, 30 reference offsets.
+void TestStarCorrespondence::benchmarkClosestStar()
+{
+    QFETCH(int, numStars);
+    QFETCH(bool, indexed);
+    constexpr double maxDistance = 5.0;
+
+    const QList<Edge> stars = makeStarField(numStars, 3);
+    QVector<QPointF> offsets;
+    for (int i = 0; i < 30; ++i)
+        offsets.append(QPointF(stars[(i * 7) % numStars].x - stars[0].x, stars[(i * 7) % numStars].y - stars[0].y));
+
+    int found = 0;
+    if (indexed)
+    {
+        QBENCHMARK
+        {
+            const StarPositionIndex index(stars, maxDistance);
+            for (const auto &star : stars)
+                for (const auto &offset : offsets)
+                    found += index.findClosest(star.x + offset.x(), star.y + offset.y(), maxDistance, nullptr) >= 0;
+        }
+    }
+    else
+    {
+        QBENCHMARK
+        {
+            for (const auto &star : stars)
+                for (const auto &offset : offsets)
+                    found += linearClosestStar(star.x + offset.x(), star.y + offset.y(), stars, maxDistance, nullptr) >= 0;
+        }
+    }
+    QVERIFY(found > 0);
+}
+
+void TestStarCorrespondence::benchmarkFind()
+{
+    Options::setAlwaysInventGuideStar(false);
+
+    // 500 stars, 30 of them references, moved by a couple of pixels.
+    QList<Edge> stars = makeStarField(500, 5);
+    QList<Edge> references;
+    for (int i = 0; i < 30; ++i)
+        references.append(stars[i * 16]);
+    for (auto &star : stars)
+    {
+        star.x += 1.5;
+        star.y -= 0.5;
+    }
+
+    StarCorrespondence c(references, 0);
+    c.setImageSize(3000, 2000);
+    QVector<int> output;
+    Edge gStar;
+    QBENCHMARK
+    {
+        gStar = c.find(stars, 5.0, &output, false);
+    }
+    QCOMPARE(gStar.x, stars[0].x);
+    QCOMPARE(gStar.y, stars[0].y);
+}
+
 QTEST_GUILESS_MAIN(TestStarCorrespondence)
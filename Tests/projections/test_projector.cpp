@@ -0,0 +1,206 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "test_projector.h"
+
+#include "projections/azimuthalequidistantprojector.h"
+#include "projections/equirectangularprojector.h"
+#include "projections/gnomonicprojector.h"
+#include "projections/lambertprojector.h"
+#include "projections/orthographicprojector.h"
+#include "projections/stereographicprojector.h"
+
+#include <QRandomGenerator>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+constexpr int POINT_COUNT = 100000;
+}
+
+TestProjector::TestProjector() : QObject()
+{
+    m_focus.setRA(5.5);
+    m_focus.setDec(20.0);
+    m_focus.setAz(120.0);
+    m_focus.setAlt(40.0);
+
+    // The points are spread over the whole sphere, most of them are off the visible hemisphere
+    QRandomGenerator generator(42);
+    m_points.resize(POINT_COUNT);
+    for (auto &point : m_points)
+    {
+        point.setRA(generator.bounded(24.0));
+        point.setDec(asin(generator.bounded(2.0) - 1) / dms::DegToRad);
+        point.setAz(generator.bounded(360.0));
+        point.setAlt(asin(generator.bounded(2.0) - 1) / dms::DegToRad);
+    }
+}
+
+void TestProjector::addProjections()
+{
+    QTest::addColumn<Projector::Projection>("type");
+    QTest::addColumn<bool>("useAltAz");
+
+    const QList<QPair<const char *, Projector::Projection>> projections =
+    {
+        { "Lambert", Projector::Lambert },
+        { "AzimuthalEquidistant", Projector::AzimuthalEquidistant },
+        { "Orthographic", Projector::Orthographic },
+        { "Equirectangular", Projector::Equirectangular },
+        { "Stereographic", Projector::Stereographic },
+        { "Gnomonic", Projector::Gnomonic },
+    };
+
+    for (const auto &projection : projections)
+    {
+        QTest::newRow(qPrintable(QString("%1 equatorial").arg(projection.first))) << projection.second << false;
+        QTest::newRow(qPrintable(QString("%1 horizontal").arg(projection.first))) << projection.second << true;
+    }
+}
+
+std::unique_ptr<Projector> TestProjector::createProjector(Projector::Projection type, bool useAltAz) const
+{
+    ViewParams p;
+    p.width         = 1920;
+    p.height        = 1080;
+    p.zoomFactor    = 500;
+    p.rotationAngle = CachingDms(15.0);
+    p.useRefraction = true;
+    p.useAltAz      = useAltAz;
+    p.fillGround    = false;
+    p.mirror        = false;
+    p.focus         = const_cast<SkyPoint *>(&m_focus);
+
+    switch (type)
+    {
+        case Projector::Lambert:
+            return std::make_unique<LambertProjector>(p);
+        case Projector::AzimuthalEquidistant:
+            return std::make_unique<AzimuthalEquidistantProjector>(p);
+        case Projector::Orthographic:
+            return std::make_unique<OrthographicProjector>(p);
+        case Projector::Equirectangular:
+            return std::make_unique<EquirectangularProjector>(p);
+        case Projector::Stereographic:
+            return std::make_unique<StereographicProjector>(p);
+        case Projector::Gnomonic:
+        default:
+            return std::make_unique<GnomonicProjector>(p);
+    }
+}
+
+void TestProjector::testToScreenBatch_data()
+{
+    addProjections();
+}
+
+void TestProjector::testToScreenBatch()
+{
+    QFETCH(Projector::Projection, type);
+    QFETCH(bool, useAltAz);
+
+    auto projector = createProjector(type, useAltAz);
+
+    std::vector<double> lon, lat;
+    for (const auto &point : m_points)
+    {
+        lon.push_back(useAltAz ? point.az().radians() : point.ra().radians());
+        lat.push_back(useAltAz ? point.alt().radians() : point.dec().radians());
+    }
+
+    std::vector<float> x(m_points.size()), y(m_points.size());
+    std::vector<uint8_t> visible(m_points.size());
+    projector->toScreenBatch(lon.data(), lat.data(), static_cast<int>(m_points.size()), x.data(), y.data(),
+                             visible.data());
+
+    int visibleCount = 0;
+    for (size_t i = 0; i < m_points.size(); ++i)
+    {
+        bool scalarVisible = false;
+        Eigen::Vector2f p = projector->toScreenVec(&m_points[i], true, &scalarVisible);
+
+        QCOMPARE(static_cast<bool>(visible[i]), scalarVisible);
+        if (!scalarVisible)
+            continue;
+
+        // Both round to float at the end, the gnomonic projection goes far off screen
+        const float tolerance = 1e-3f * std::max(1.0f, std::max(std::fabs(p.x()), std::fabs(p.y())));
+        QVERIFY2(std::fabs(x[i] - p.x()) <= tolerance && std::fabs(y[i] - p.y()) <= tolerance,
+                 qPrintable(QString("Point %1: batch (%2, %3) scalar (%4, %5)")
+                            .arg(i).arg(x[i]).arg(y[i]).arg(p.x()).arg(p.y())));
+        visibleCount++;
+    }
+
+    QVERIFY(visibleCount > 0);
+}
+
+void TestProjector::benchmarkToScreenVec_data()
+{
+    addProjections();
+}
+
+void TestProjector::benchmarkToScreenVec()
+{
+    QFETCH(Projector::Projection, type);
+    QFETCH(bool, useAltAz);
+
+    auto projector = createProjector(type, useAltAz);
+
+    int visibleCount = 0;
+    QBENCHMARK
+    {
+        visibleCount = 0;
+        for (const auto &point : m_points)
+        {
+            bool visible = false;
+            Eigen::Vector2f p = projector->toScreenVec(&point, true, &visible);
+            if (visible && projector->onScreen(p))
+                visibleCount++;
+        }
+    }
+    QVERIFY(visibleCount > 0);
+}
+
+void TestProjector::benchmarkToScreenBatch_data()
+{
+    addProjections();
+}
+
+void TestProjector::benchmarkToScreenBatch()
+{
+    QFETCH(Projector::Projection, type);
+    QFETCH(bool, useAltAz);
+
+    auto projector = createProjector(type, useAltAz);
+
+    std::vector<double> lon(m_points.size()), lat(m_points.size());
+    std::vector<float> x(m_points.size()), y(m_points.size());
+    std::vector<uint8_t> visible(m_points.size());
+    const int count = static_cast<int>(m_points.size());
+
+    int visibleCount = 0;
+    QBENCHMARK
+    {
+        // Gathering the coordinates is part of the cost, as in SkyQPainter::drawPointSources()
+        for (int i = 0; i < count; ++i)
+        {
+            lon[i] = useAltAz ? m_points[i].az().radians() : m_points[i].ra().radians();
+            lat[i] = useAltAz ? m_points[i].alt().radians() : m_points[i].dec().radians();
+        }
+        projector->toScreenBatch(lon.data(), lat.data(), count, x.data(), y.data(), visible.data());
+
+        visibleCount = 0;
+        for (int i = 0; i < count; ++i)
+        {
+            if (visible[i] && projector->onScreen(QPointF(x[i], y[i])))
+                visibleCount++;
+        }
+    }
+    QVERIFY(visibleCount > 0);
+}
+
+QTEST_GUILESS_MAIN(TestProjector)
@@ -0,0 +1,45 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include "projections/projector.h"
+
+#include <memory>
+#include <vector>
+
+/**
+ * @class TestProjector
+ * @short Compares the batch projection of the projectors with toScreenVec(), and benchmarks both.
+ */
+class TestProjector : public QObject
+{
+        Q_OBJECT
+
+    public:
+        TestProjector();
+
+    private slots:
+        void testToScreenBatch_data();
+        void testToScreenBatch();
+
+        void benchmarkToScreenVec_data();
+        void benchmarkToScreenVec();
+        void benchmarkToScreenBatch_data();
+        void benchmarkToScreenBatch();
+
+    private:
+        void addProjections();
+        std::unique_ptr<Projector> createProjector(Projector::Projection type, bool useAltAz) const;
+
+        SkyPoint m_focus;
+        std::vector<SkyPoint> m_points;
+};
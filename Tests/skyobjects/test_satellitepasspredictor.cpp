@@ -0,0 +1,153 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * This file contains unit tests for the SatellitePassPredictor class.
+ */
+
+#include <QObject>
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <cmath>
+#include <memory>
+
+#include "geolocation.h"
+#include "skyobjects/satellite.h"
+#include "skyobjects/satellitepasspredictor.h"
+
+class TestSatellitePassPredictor : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestSatellitePassPredictor();
+
+        /** @short Destructor */
+        ~TestSatellitePassPredictor() override = default;
+
+    private slots:
+        void positionTest();
+        void predictTest();
+};
+
+// This include must go after the class declaration.
+#include "test_satellitepasspredictor.moc"
+
+TestSatellitePassPredictor::TestSatellitePassPredictor() : QObject()
+{
+}
+
+namespace
+{
+
+constexpr double MIN_ALTITUDE = 10;
+
+// Silicon Valley
+const GeoLocation &siliconValley()
+{
+    static const GeoLocation geo(dms(-122, 10), dms(37, 26, 30));
+    return geo;
+}
+
+KStarsDateTime startTime()
+{
+    return KStarsDateTime(2454730.0);
+}
+
+Satellite *iss()
+{
+    return new Satellite("ISS (ZARYA)",
+                         "1 25544U 98067A   08264.51782528 -.00002182  00000-0 -11606-4 0  2927",
+                         "2 25544  51.6416 247.4627 0006703 130.5360 325.0288 15.72125391563537");
+}
+
+}  // namespace
+
+void TestSatellitePassPredictor::positionTest()
+{
+    std::unique_ptr<Satellite> satellite(iss());
+    const Satellite::Frame frame(startTime(), &siliconValley());
+
+    // Computing the position does not move the satellite, and matches the updated position.
+    Satellite::Position position;
+    QCOMPARE(satellite->position(frame, &position), 0);
+    QCOMPARE(satellite->updatePos(frame), 0);
+    QVERIFY(std::fabs(satellite->az().Degrees() - position.az) < 1e-9);
+    QVERIFY(std::fabs(satellite->alt().Degrees() - position.alt) < 1e-9);
+    QVERIFY(std::fabs(satellite->range() - position.range) < 1e-9);
+
+    // A frame moved by the rotation of the Earth only is close to an exact frame for a minute.
+    for (int seconds : { 10, 30, 60 })
+    {
+        Satellite::Position exact, moved;
+        QCOMPARE(satellite->position(Satellite::Frame(startTime().addSecs(seconds), &siliconValley()), &exact), 0);
+        QCOMPARE(satellite->position(frame.after(seconds), &moved), 0);
+        QVERIFY2(std::fabs(exact.alt - moved.alt) < 0.001,
+                 qPrintable(QString("%1 s: alt %2 vs %3").arg(seconds).arg(exact.alt).arg(moved.alt)));
+    }
+}
+
+void TestSatellitePassPredictor::predictTest()
+{
+    std::unique_ptr<Satellite> satellite(iss());
+    constexpr int duration = 18 * 3600;
+
+    SatellitePassPredictor predictor(&siliconValley(), startTime(), startTime().addSecs(duration));
+    predictor.setMinAltitude(MIN_ALTITUDE);
+    const QVector<SatellitePassPredictor::Pass> passes = predictor.predict(QList<Satellite *>() << satellite.get());
+
+    // Brute force, every second.
+    struct Expected
+    {
+        int rise;
+        int set;
+        double culminationAlt;
+    };
+    QVector<Expected> expected;
+    bool above = false;
+    for (int seconds = 0; seconds <= duration; seconds++)
+    {
+        Satellite::Position p;
+        QCOMPARE(satellite->position(Satellite::Frame(startTime().addSecs(seconds), &siliconValley()), &p), 0);
+        if (p.alt >= MIN_ALTITUDE && !above)
+            expected.append({ seconds, -1, p.alt });
+        else if (p.alt < MIN_ALTITUDE && above)
+            expected.last().set = seconds;
+        if (p.alt >= MIN_ALTITUDE)
+            expected.last().culminationAlt = std::max(expected.last().culminationAlt, p.alt);
+        above = p.alt >= MIN_ALTITUDE;
+    }
+
+    QVERIFY(!expected.isEmpty());
+    QCOMPARE(passes.size(), expected.size());
+    for (int i = 0; i < passes.size(); i++)
+    {
+        const auto &pass = passes[i];
+        QVERIFY(pass.satellite == satellite.get());
+        if (expected[i].rise > 0)
+        {
+            const double rise = static_cast<double>(pass.rise.djd() - startTime().djd()) * 86400;
+            QVERIFY2(std::fabs(rise - expected[i].rise) < 2,
+                     qPrintable(QString("pass %1: rise %2 vs %3").arg(i).arg(rise).arg(expected[i].rise)));
+        }
+        if (expected[i].set > 0)
+        {
+            const double set = static_cast<double>(pass.set.djd() - startTime().djd()) * 86400;
+            QVERIFY2(std::fabs(set - expected[i].set) < 2,
+                     qPrintable(QString("pass %1: set %2 vs %3").arg(i).arg(set).arg(expected[i].set)));
+        }
+        QVERIFY2(std::fabs(pass.culminationAlt - expected[i].culminationAlt) < 0.01,
+                 qPrintable(QString("pass %1: culmination %2 vs %3").arg(i).arg(pass.culminationAlt)
+                            .arg(expected[i].culminationAlt)));
+    }
+}
+
+QTEST_GUILESS_MAIN(TestSatellitePassPredictor)
@@ -292,6 +292,69 @@ void TestStarObject::testUpdateCoords()
 
 }
 
+void TestStarObject::testJITupdateBatch()
+{
+    /*
+     * The batched update uses a combined precession-nutation matrix and
+     * an aberration vector, which must agree with the step-by-step
+     * computation of StarObject::updateCoords() over the whole sky
+     */
+    Options::setUseRelativistic(false);
+
+    KStarsDateTime dt = KStarsDateTime::fromString("2028-11-13T04:33");
+    const KSNumbers num(dt.djd());
+    const CachingDms LST(dms::fromString("03:20:00", false));
+    const CachingDms lat(dms::fromString("+48:10:00", true));
+
+    QVector<StarObject> stars;
+    for (int ra = 0; ra < 360; ra += 15)
+    {
+        for (int dec = -88; dec <= 88; dec += 8)
+        {
+            double pmRa = (ra - 180) * 5.0, pmDec = dec * 10.0;
+            stars.append(StarObject(dms(ra + 0.5), dms(dec + 0.25), 0.0, "", "", "K0", pmRa, pmDec, 0.0, false, false, 0));
+        }
+    }
+
+    // Some more stars than the batch processes at once
+    QVERIFY(stars.size() > 128);
+
+    QVector<StarObject> references = stars;
+    StarObject::JITupdate(stars.data(), stars.size(), &num, &LST, &lat, 1, 1);
+
+    // Small differences are expected, from the first order formulas of
+    // nutation and aberration in SkyPoint. This is the documented bound of 50 mas.
+    constexpr double tolerance = 0.05 / 3600.0;
+
+    for (int i = 0; i < stars.size(); ++i)
+    {
+        StarObject &star = stars[i], &reference = references[i];
+        reference.updateCoordsNow(&num);
+        reference.EquatorialToHorizontal(&LST, &lat);
+
+        QCOMPARE(star.updateID, quint64(1));
+        QCOMPARE(star.updateNumID, quint64(1));
+
+        dms dRA(star.ra().Degrees() - reference.ra().Degrees());
+        dRA.reduceToRange(dms::MINUSPI_TO_PI);
+        QVERIFY2(fabs(dRA.Degrees() * reference.dec().cos()) < tolerance && fabs(star.dec().Degrees() - reference.dec().Degrees()) < tolerance,
+                 qPrintable(QString("Star %1 at %2, %3 differs by %4, %5 arcsec").arg(i)
+                            .arg(reference.ra().Degrees()).arg(reference.dec().Degrees())
+                            .arg(dRA.Degrees() * 3600.0).arg((star.dec().Degrees() - reference.dec().Degrees()) * 3600.0)));
+
+        dms dAz(star.az().Degrees() - reference.az().Degrees());
+        dAz.reduceToRange(dms::MINUSPI_TO_PI);
+        QVERIFY(fabs(dAz.Degrees() * cos(reference.alt().radians())) < tolerance);
+        QVERIFY(fabs(star.alt().Degrees() - reference.alt().Degrees()) < tolerance);
+    }
+
+    // Already up to date stars are left alone
+    StarObject moved = stars.first();
+    moved.setRA(CachingDms(0.0));
+    StarObject::JITupdate(&moved, 1, &num, &LST, &lat, 1, 1);
+    QCOMPARE(moved.ra().Degrees(), 0.0);
+}
+
 #ifdef HAVE_LIBERFA
 void TestStarObject::compareProperMotionAgainstErfa_data()
 {
@@ -42,6 +42,7 @@ class TestStarObject : public QObject
     private slots:
         void testUpdateCoordsStepByStep();
         void testUpdateCoords();
+        void testJITupdateBatch();
 #ifdef HAVE_LIBERFA
         void compareProperMotionAgainstErfa_data();
         void compareProperMotionAgainstErfa();
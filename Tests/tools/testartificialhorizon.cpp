@@ -17,6 +17,8 @@
 #include <QTest>
 #endif
 
+#include <QRandomGenerator>
+
 #include <memory>
 
 #include "artificialhorizoncomponent.h"
@@ -37,6 +39,7 @@ class TestArtificialHorizon : public QObject
     private slots:
         void artificialHorizonTest();
         void artificialCeilingTest();
+        void compiledConstraintsTest();
 
     private:
 };
@@ -258,4 +261,71 @@ void TestArtificialHorizon::artificialCeilingTest()
     QVERIFY(checkHorizon(horizon, 351, 3, false, polygons));
 }
 
+// Checks that the compiled constraints answer like the horizon lines.
+void TestArtificialHorizon::compiledConstraintsTest()
+{
+    ArtificialHorizon horizon;
+    horizon.setTesting();
+
+    // A horizon all around, crossing 0 degrees, with a ceiling, another horizon line
+    // above part of the ceiling, and a short horizon line crossing the first one.
+    QList<double> az1  = {259.0, 260.0, 299.0, 300.0, 330.0,   0.0,  30.0,  60.0,  61.0,  90.0, 120.0, 150.0, 180.0, 210.0, 240.0, 259.99};
+    QList<double> alt1 = { 90.0,  26.0,  28.0,  26.0,  31.0,  22.0,  26.0,  18.0,  90.0,  85.0,  40.0,  12.0,  15.0,  33.0,  40.0,  90.0};
+    horizon.addRegion("horizon", true, setupHorizonEntities(az1, alt1), false);
+    QList<double> az2  = {262.0, 300.0, 330.0,  0.0,  30.0,  58.0};
+    QList<double> alt2 = { 66.0,  70.0,  62.0, 66.0,  75.0,  66.0};
+    horizon.addRegion("ceiling", true, setupHorizonEntities(az2, alt2), true);
+    QList<double> az3  = {340.0, 355.0, 10.0};
+    QList<double> alt3 = { 72.0,  80.0, 71.0};
+    horizon.addRegion("above", true, setupHorizonEntities(az3, alt3), false);
+    QList<double> az4  = {130.0, 150.0, 170.0};
+    QList<double> alt4 = { 10.0,  45.0, 20.0};
+    horizon.addRegion("tree", true, setupHorizonEntities(az4, alt4), false);
+
+    // At the azimuths of the table, the answers are the same.
+    for (int i = 0; i < 360 * 20; i += 3)
+    {
+        const double az = i / 20.0;
+        QVERIFY(fabs(horizon.altitudeConstraint(az) - horizon.altitudeConstraintInternal(az)) < 1e-6);
+        for (double alt = -10.25; alt < 90; alt += 0.5)
+        {
+            QString reason, expectedReason;
+            double margin, expectedMargin;
+            const bool visible = horizon.isVisible(az, alt, &reason, &margin);
+            const bool expected = horizon.isVisibleInternal(az, alt, &expectedReason, &expectedMargin);
+            QVERIFY2(visible == expected, qPrintable(QString("az %1 alt %2").arg(az).arg(alt)));
+            QCOMPARE(reason, expectedReason);
+            QVERIFY(fabs(margin - expectedMargin) < 1e-6);
+        }
+    }
+
+    // In between, they can only differ within a table step, or .1 degrees in altitude, of a limit.
+    QRandomGenerator random(7);
+    int differences = 0;
+    for (int i = 0; i < 20000; ++i)
+    {
+        const double az = random.bounded(360.0);
+        const double alt = random.bounded(100.0) - 10;
+        const bool visible = horizon.isVisible(az, alt);
+        if (visible == horizon.isVisibleInternal(az, alt))
+            continue;
+        differences++;
+        bool nearLimit = false;
+        for (double dAz = -0.05; dAz <= 0.05 && !nearLimit; dAz += 0.05)
+            for (double dAlt = -0.1; dAlt <= 0.1 && !nearLimit; dAlt += 0.1)
+                nearLimit = horizon.isVisibleInternal(az + dAz, alt + dAlt) == visible;
+        QVERIFY2(nearLimit, qPrintable(QString("az %1 alt %2").arg(az).arg(alt)));
+    }
+    QVERIFY(differences < 20);
+
+    // Changing an entity recompiles the constraints.
+    QVERIFY(!horizon.isVisible(140, 25));
+    horizon.findRegion("tree")->setEnabled(false);
+    QVERIFY(horizon.isVisible(140, 25));
+    QVERIFY(horizon.isVisibleInternal(140, 25));
+    horizon.removeRegion("horizon");
+    QCOMPARE(horizon.altitudeConstraint(200), -90.0);
+    QCOMPARE(horizon.altitudeConstraintInternal(200), -90.0);
+}
+
 QTEST_GUILESS_MAIN(TestArtificialHorizon)
@@ -0,0 +1,200 @@
+/*
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+/*
+ * This file contains unit tests for the VisibilityEngine class.
+ */
+
+#include <QObject>
+
+#include <QtGlobal>
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+#include <QtTest/QTest>
+#else
+#include <QTest>
+#endif
+
+#include <QRandomGenerator>
+
+#include <cmath>
+#include <memory>
+
+#include "artificialhorizoncomponent.h"
+#include "geolocation.h"
+#include "ksnumbers.h"
+#include "linelist.h"
+#include "skypoint.h"
+#include "visibilityengine.h"
+
+class TestVisibilityEngine : public QObject
+{
+        Q_OBJECT
+
+    public:
+        /** @short Constructor */
+        TestVisibilityEngine();
+
+        /** @short Destructor */
+        ~TestVisibilityEngine() override = default;
+
+    private slots:
+        void altitudesTest();
+        void evaluateTest();
+        void evaluateBenchmark();
+};
+
+// This include must go after the class declaration.
+#include "testvisibilityengine.moc"
+
+TestVisibilityEngine::TestVisibilityEngine() : QObject()
+{
+}
+
+namespace
+{
+
+// Silicon Valley
+const GeoLocation &siliconValley()
+{
+    static const GeoLocation geo(dms(-122, 10), dms(37, 26, 30));
+    return geo;
+}
+
+KStarsDateTime startTime()
+{
+    KStarsDateTime time;
+    time.setDate(QDate(2024, 3, 10));
+    time.setTime(QTime(3, 0, 0));
+    time.setTimeSpec(Qt::UTC);
+    return time;
+}
+
+// Altitude and azimuth the way the rest of KStars computes them.
+void horizontal(const VisibilityEngine &engine, int sample, SkyPoint &point, double *alt, double *az)
+{
+    CachingDms LST = siliconValley().GSTtoLST(engine.sampleTime(sample).gst());
+    point.EquatorialToHorizontal(&LST, siliconValley().lat());
+    *alt = point.alt().Degrees();
+    *az = point.az().Degrees();
+}
+
+}  // namespace
+
+void TestVisibilityEngine::altitudesTest()
+{
+    const VisibilityEngine engine(&siliconValley(), startTime(), 600, 144);
+    QCOMPARE(engine.sampleCount(), 144);
+
+    const QList<QPair<double, double>> coordinates = { {0, 0}, {83.8, -5.4}, {201.4, 47.2}, {10.7, 41.3}, {279.2, 38.8}, {37.9, 89.3}, {266.4, -29.0} };
+    for (const auto &c : coordinates)
+    {
+        SkyPoint point;
+        point.setRA(dms(c.first));
+        point.setDec(dms(c.second));
+        const QVector<double> altitudes = engine.altitudes(point.ra(), point.dec());
+        QCOMPARE(altitudes.size(), engine.sampleCount());
+        for (int i = 0; i < engine.sampleCount(); i++)
+        {
+            double alt, az;
+            horizontal(engine, i, point, &alt, &az);
+            QVERIFY2(std::fabs(altitudes[i] - alt) < 0.001,
+                     qPrintable(QString("ra %1 dec %2 sample %3: %4 vs %5").arg(c.first).arg(c.second).arg(i)
+                                .arg(altitudes[i]).arg(alt)));
+        }
+    }
+}
+
+void TestVisibilityEngine::evaluateTest()
+{
+    constexpr int step = 600;
+    VisibilityEngine engine(&siliconValley(), startTime(), step, 144);
+    // Dark from 2 to 20 hours after the start.
+    engine.setNight(startTime().addSecs(2 * 3600), startTime().addSecs(20 * 3600));
+
+    // Blocks the east below 40 degrees.
+    ArtificialHorizon horizon;
+    std::shared_ptr<LineList> line(new LineList());
+    for (double az = 60; az <= 130; az += 10)
+    {
+        std::shared_ptr<SkyPoint> p(new SkyPoint());
+        p->setAz(dms(az));
+        p->setAlt(dms(40));
+        line->append(p);
+    }
+    horizon.addRegion("East", true, line, false);
+
+    VisibilityEngine::Constraints constraints;
+    constraints.minAltitude = 30;
+    constraints.maxAltitude = 75;
+    constraints.preDawnMinutes = 30;
+    constraints.horizon = &horizon;
+
+    QVector<SkyPoint> targets;
+    QRandomGenerator random(42);
+    for (int i = 0; i < 200; i++)
+    {
+        SkyPoint point;
+        point.setRA0(dms(random.bounded(360.0)));
+        point.setDec0(dms(random.bounded(180.0) - 90));
+        targets.append(point);
+    }
+
+    const QVector<VisibilityEngine::Visibility> visibility = engine.evaluate(targets, constraints);
+    QCOMPARE(visibility.size(), targets.size());
+
+    const KSNumbers numbers(engine.sampleTime(engine.sampleCount() / 2).djd());
+    for (int t = 0; t < targets.size(); t++)
+    {
+        SkyPoint point = targets[t];
+        point.updateCoordsNow(&numbers);
+
+        int count = 0;
+        double maxAltitude = -90;
+        for (int i = 0; i < engine.sampleCount(); i++)
+        {
+            const int seconds = i * step;
+            if (seconds < 2 * 3600 || seconds >= 20 * 3600)
+                continue;
+            double alt, az;
+            horizontal(engine, i, point, &alt, &az);
+            maxAltitude = std::max(maxAltitude, alt);
+            if (seconds < 20 * 3600 - 30 * 60 && alt >= 30 && alt <= 75 && horizon.isAltitudeOK(az, alt, nullptr))
+                count++;
+        }
+
+        QVERIFY(std::fabs(visibility[t].maxAltitude - maxAltitude) < 0.02);
+        // A sample right at a limit may go either way with float sines.
+        QVERIFY2(std::fabs(visibility[t].runHours - count * step / 3600.0) <= step / 3600.0 + 1e-9,
+                 qPrintable(QString("target %1: %2 vs %3 hours").arg(t).arg(visibility[t].runHours)
+                            .arg(count * step / 3600.0)));
+    }
+}
+
+void TestVisibilityEngine::evaluateBenchmark()
+{
+    VisibilityEngine engine(&siliconValley(), startTime(), 600, 144);
+    engine.setNight(startTime().addSecs(2 * 3600), startTime().addSecs(20 * 3600));
+
+    VisibilityEngine::Constraints constraints;
+    constraints.minAltitude = 30;
+
+    QVector<SkyPoint> targets;
+    QRandomGenerator random(42);
+    for (int i = 0; i < 10000; i++)
+    {
+        SkyPoint point;
+        point.setRA0(dms(random.bounded(360.0)));
+        point.setDec0(dms(random.bounded(180.0) - 90));
+        targets.append(point);
+    }
+
+    QVector<VisibilityEngine::Visibility> visibility;
+    QBENCHMARK
+    {
+        visibility = engine.evaluate(targets, constraints);
+    }
+    QCOMPARE(visibility.size(), targets.size());
+}
+
+QTEST_GUILESS_MAIN(TestVisibilityEngine)
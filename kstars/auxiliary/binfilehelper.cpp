@@ -28,6 +28,7 @@ BinFileHelper::~BinFileHelper()
 
 void BinFileHelper::init()
 {
+    unmapFile();
     if (fileHandle)
         fclose(fileHandle);
 
@@ -73,6 +74,7 @@ FILE *BinFileHelper::openFile(const QString &fileName)
 {
     QString FilePath = KSPaths::locate(QStandardPaths::AppLocalDataLocation, fileName);
     init();
+    filePath             = FilePath;
     QByteArray b         = FilePath.toLatin1();
     const char *filepath = b.data();
 
@@ -275,10 +277,57 @@ bool BinFileHelper::readHeader()
 
 void BinFileHelper::closeFile()
 {
+    unmapFile();
     fclose(fileHandle);
     fileHandle = nullptr;
 }
 
+bool BinFileHelper::mapFile()
+{
+    if (mappedData)
+        return true;
+    if (!fileHandle)
+        return false;
+
+    mappedFile.setFileName(filePath);
+    if (!mappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    mappedSize = mappedFile.size();
+    mappedData = mappedSize > 0 ? mappedFile.map(0, mappedSize) : nullptr;
+    if (!mappedData)
+    {
+        mappedFile.close();
+        mappedSize = 0;
+        return false;
+    }
+    return true;
+}
+
+void BinFileHelper::unmapFile()
+{
+    if (!mappedData)
+        return;
+
+    mappedFile.unmap(const_cast<uchar *>(mappedData));
+    mappedFile.close();
+    mappedData = nullptr;
+    mappedSize = 0;
+}
+
+void BinFileHelper::readAhead(quint32 offset, quint32 size) const
+{
+    if (!mappedData || offset >= mappedSize)
+        return;
+
+    constexpr quint32 pageSize = 4096;
+    const quint64 end = qMin<quint64>(quint64(offset) + size, mappedSize);
+    // volatile, so the reads are not optimized away
+    volatile uchar sink = 0;
+    for (quint64 i = offset; i < end; i += pageSize)
+        sink = sink + mappedData[i];
+}
+
 int BinFileHelper::getErrorNumber()
 {
     int err = errnum;
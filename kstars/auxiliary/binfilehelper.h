@@ -6,6 +6,7 @@
 
 #pragma once
 
+#include <QFile>
 #include <QString>
 #include <QVector>
 
@@ -197,6 +198,34 @@ class BinFileHelper
      */
     static int unsigned_KDE_fseek(FILE *stream, quint32 offset, int whence);
 
+    /**
+     * @short Maps the whole open file into memory, so that records can be accessed with getRecords()
+     * instead of being read through the file handle. The file handle remains usable.
+     * @return true if the file could be mapped
+     */
+    bool mapFile();
+
+    /** @return true if the file is mapped into memory */
+    inline bool isMapped() const { return mappedData != nullptr; }
+
+    /**
+     * @short Returns the mapped bytes of count records starting at offset
+     * @return pointer to the first record, or nullptr if the file isn't mapped or the records lie beyond its end
+     * @note The records are in the byte order of the file, see getByteSwap()
+     */
+    inline const uchar *getRecords(quint32 offset, quint32 count) const
+    {
+        if (!mappedData || quint64(offset) + quint64(count) * recordSize > quint64(mappedSize))
+            return nullptr;
+        return mappedData + offset;
+    }
+
+    /**
+     * @short Touches the mapped pages in [offset, offset + size), so that they are read from disk
+     * by the calling thread rather than by a later reader. Does nothing if the file isn't mapped.
+     */
+    void readAhead(quint32 offset, quint32 size) const;
+
     /*! @short An enum providing user-friendly names for errors encountered */
     enum Errors
     {
@@ -227,8 +256,16 @@ class BinFileHelper
      */
     void init();
 
+    void unmapFile();
+
     /// Handle to the file.
     FILE *fileHandle { nullptr};
+    /// Path of the open file
+    QString filePath;
+    /// The file mapped into memory, if mapFile() was called
+    QFile mappedFile;
+    const uchar *mappedData { nullptr };
+    qint64 mappedSize { 0 };
     /// Stores offsets corresponding to each index table entry
     QVector<unsigned long> indexOffset;
     /// Stores number of records under each index table entry
@@ -5,6 +5,7 @@
 */
 
 #include "analyze.h"
+#include "analyzeloader.h"
 
 #include <knotification.h>
 #include <QDateTime>
@@ -798,12 +799,12 @@ void Analyze::addGuideStats(double raDrift, double decDrift, int raPulse, int de
                 (time - lastCaptureRmsTime > MAX_GUIDE_STATS_GAP))
         {
             // this is the first sample in a series with a gap behind us.
-            statsPlot->graph(CAPTURE_RMS_GRAPH)->addData(lastCaptureRmsTime + .0001, qQNaN());
-            statsPlot->graph(CAPTURE_RMS_GRAPH)->addData(time - .0001, qQNaN());
+            addStatsData(CAPTURE_RMS_GRAPH, lastCaptureRmsTime + .0001, qQNaN());
+            addStatsData(CAPTURE_RMS_GRAPH, time - .0001, qQNaN());
             captureRms->resetFilter();
         }
         const double rmsC = captureRms->newSample(raDrift, decDrift);
-        statsPlot->graph(CAPTURE_RMS_GRAPH)->addData(time, rmsC);
+        addStatsData(CAPTURE_RMS_GRAPH, time, rmsC);
         lastCaptureRmsTime = time;
     }
 
@@ -815,12 +816,12 @@ void Analyze::addGuideStatsInternal(double raDrift, double decDrift, double raPu
                                     double numStars, double skyBackground,
                                     double drift, double rms, double time)
 {
-    statsPlot->graph(RA_GRAPH)->addData(time, raDrift);
-    statsPlot->graph(DEC_GRAPH)->addData(time, decDrift);
-    statsPlot->graph(RA_PULSE_GRAPH)->addData(time, raPulse);
-    statsPlot->graph(DEC_PULSE_GRAPH)->addData(time, decPulse);
-    statsPlot->graph(DRIFT_GRAPH)->addData(time, drift);
-    statsPlot->graph(RMS_GRAPH)->addData(time, rms);
+    addStatsData(RA_GRAPH, time, raDrift);
+    addStatsData(DEC_GRAPH, time, decDrift);
+    addStatsData(RA_PULSE_GRAPH, time, raPulse);
+    addStatsData(DEC_PULSE_GRAPH, time, decPulse);
+    addStatsData(DRIFT_GRAPH, time, drift);
+    addStatsData(RMS_GRAPH, time, rms);
 
     // Set the SNR axis' maximum to 95% of the way up from the middle to the top.
     if (!qIsNaN(snr))
@@ -830,9 +831,9 @@ void Analyze::addGuideStatsInternal(double raDrift, double decDrift, double raPu
     if (!qIsNaN(numStars))
         numStarsMax = std::max(numStars, static_cast<double>(numStarsMax));
 
-    statsPlot->graph(SNR_GRAPH)->addData(time, snr);
-    statsPlot->graph(NUMSTARS_GRAPH)->addData(time, numStars);
-    statsPlot->graph(SKYBG_GRAPH)->addData(time, skyBackground);
+    addStatsData(SNR_GRAPH, time, snr);
+    addStatsData(NUMSTARS_GRAPH, time, numStars);
+    addStatsData(SKYBG_GRAPH, time, skyBackground);
 }
 
 void Analyze::addTemperature(double temperature, double time)
@@ -840,12 +841,12 @@ void Analyze::addTemperature(double temperature, double time)
     // The HFR corresponds to the last capture
     // If there is no temperature sensor, focus sends a large negative value.
     if (temperature > -200)
-        statsPlot->graph(TEMPERATURE_GRAPH)->addData(time, temperature);
+        addStatsData(TEMPERATURE_GRAPH, time, temperature);
 }
 
 void Analyze::addFocusPosition(double focusPosition, double time)
 {
-    statsPlot->graph(FOCUS_POSITION_GRAPH)->addData(time, focusPosition);
+    addStatsData(FOCUS_POSITION_GRAPH, time, focusPosition);
 }
 
 void Analyze::addTargetDistance(double targetDistance, double time)
@@ -855,10 +856,10 @@ void Analyze::addTargetDistance(double targetDistance, double time)
             previousCaptureStartedTime < previousCaptureCompletedTime &&
             previousCaptureCompletedTime <= time)
     {
-        statsPlot->graph(TARGET_DISTANCE_GRAPH)->addData(previousCaptureStartedTime - .0001, qQNaN());
-        statsPlot->graph(TARGET_DISTANCE_GRAPH)->addData(previousCaptureStartedTime, targetDistance);
-        statsPlot->graph(TARGET_DISTANCE_GRAPH)->addData(previousCaptureCompletedTime, targetDistance);
-        statsPlot->graph(TARGET_DISTANCE_GRAPH)->addData(previousCaptureCompletedTime + .0001, qQNaN());
+        addStatsData(TARGET_DISTANCE_GRAPH, previousCaptureStartedTime - .0001, qQNaN());
+        addStatsData(TARGET_DISTANCE_GRAPH, previousCaptureStartedTime, targetDistance);
+        addStatsData(TARGET_DISTANCE_GRAPH, previousCaptureCompletedTime, targetDistance);
+        addStatsData(TARGET_DISTANCE_GRAPH, previousCaptureCompletedTime + .0001, qQNaN());
     }
 }
 
@@ -867,25 +868,25 @@ void Analyze::addHFR(double hfr, int numCaptureStars, int median, double eccentr
                      double time, double startTime)
 {
     // The HFR corresponds to the last capture
-    statsPlot->graph(HFR_GRAPH)->addData(startTime - .0001, qQNaN());
-    statsPlot->graph(HFR_GRAPH)->addData(startTime, hfr);
-    statsPlot->graph(HFR_GRAPH)->addData(time, hfr);
-    statsPlot->graph(HFR_GRAPH)->addData(time + .0001, qQNaN());
-
-    statsPlot->graph(NUM_CAPTURE_STARS_GRAPH)->addData(startTime - .0001, qQNaN());
-    statsPlot->graph(NUM_CAPTURE_STARS_GRAPH)->addData(startTime, numCaptureStars);
-    statsPlot->graph(NUM_CAPTURE_STARS_GRAPH)->addData(time, numCaptureStars);
-    statsPlot->graph(NUM_CAPTURE_STARS_GRAPH)->addData(time + .0001, qQNaN());
-
-    statsPlot->graph(MEDIAN_GRAPH)->addData(startTime - .0001, qQNaN());
-    statsPlot->graph(MEDIAN_GRAPH)->addData(startTime, median);
-    statsPlot->graph(MEDIAN_GRAPH)->addData(time, median);
-    statsPlot->graph(MEDIAN_GRAPH)->addData(time + .0001, qQNaN());
-
-    statsPlot->graph(ECCENTRICITY_GRAPH)->addData(startTime - .0001, qQNaN());
-    statsPlot->graph(ECCENTRICITY_GRAPH)->addData(startTime, eccentricity);
-    statsPlot->graph(ECCENTRICITY_GRAPH)->addData(time, eccentricity);
-    statsPlot->graph(ECCENTRICITY_GRAPH)->addData(time + .0001, qQNaN());
+    addStatsData(HFR_GRAPH, startTime - .0001, qQNaN());
+    addStatsData(HFR_GRAPH, startTime, hfr);
+    addStatsData(HFR_GRAPH, time, hfr);
+    addStatsData(HFR_GRAPH, time + .0001, qQNaN());
+
+    addStatsData(NUM_CAPTURE_STARS_GRAPH, startTime - .0001, qQNaN());
+    addStatsData(NUM_CAPTURE_STARS_GRAPH, startTime, numCaptureStars);
+    addStatsData(NUM_CAPTURE_STARS_GRAPH, time, numCaptureStars);
+    addStatsData(NUM_CAPTURE_STARS_GRAPH, time + .0001, qQNaN());
+
+    addStatsData(MEDIAN_GRAPH, startTime - .0001, qQNaN());
+    addStatsData(MEDIAN_GRAPH, startTime, median);
+    addStatsData(MEDIAN_GRAPH, time, median);
+    addStatsData(MEDIAN_GRAPH, time + .0001, qQNaN());
+
+    addStatsData(ECCENTRICITY_GRAPH, startTime - .0001, qQNaN());
+    addStatsData(ECCENTRICITY_GRAPH, startTime, eccentricity);
+    addStatsData(ECCENTRICITY_GRAPH, time, eccentricity);
+    addStatsData(ECCENTRICITY_GRAPH, time + .0001, qQNaN());
 
     medianMax = std::max(median, medianMax);
     numCaptureStarsMax = std::max(numCaptureStars, numCaptureStarsMax);
@@ -896,31 +897,74 @@ void Analyze::addHFR(double hfr, int numCaptureStars, int median, double eccentr
 void Analyze::addMountCoords(double ra, double dec, double az,
                              double alt, int pierSide, double ha, double time)
 {
-    statsPlot->graph(MOUNT_RA_GRAPH)->addData(time, ra);
-    statsPlot->graph(MOUNT_DEC_GRAPH)->addData(time, dec);
-    statsPlot->graph(MOUNT_HA_GRAPH)->addData(time, ha);
-    statsPlot->graph(AZ_GRAPH)->addData(time, az);
-    statsPlot->graph(ALT_GRAPH)->addData(time, alt);
-    statsPlot->graph(PIER_SIDE_GRAPH)->addData(time, double(pierSide));
+    addStatsData(MOUNT_RA_GRAPH, time, ra);
+    addStatsData(MOUNT_DEC_GRAPH, time, dec);
+    addStatsData(MOUNT_HA_GRAPH, time, ha);
+    addStatsData(AZ_GRAPH, time, az);
+    addStatsData(ALT_GRAPH, time, alt);
+    addStatsData(PIER_SIDE_GRAPH, time, double(pierSide));
+}
+
+// Add a point to one of the Stats graphs. While a file is read, the points are
+// collected per graph and added in bulk by flushStatsData().
+void Analyze::addStatsData(int graph, double time, double value)
+{
+    if (!readingFile)
+    {
+        statsPlot->graph(graph)->addData(time, value);
+        return;
+    }
+    auto &columns = pendingStats[graph];
+    columns.keys.append(time);
+    columns.values.append(value);
+}
+
+void Analyze::flushStatsData()
+{
+    for (auto it = pendingStats.cbegin(); it != pendingStats.cend(); ++it)
+    {
+        const auto &keys = it.value().keys;
+        statsPlot->graph(it.key())->addData(keys, it.value().values, std::is_sorted(keys.cbegin(), keys.cend()));
+    }
+    pendingStats.clear();
 }
 
 // Read a .analyze file, and setup all the graphics.
+// The file is parsed in parallel by AnalyzeLoader, then replayed in order, since
+// most events depend on the ones before them.
 double Analyze::readDataFromFile(const QString &filename)
 {
     double lastTime = 10;
-    QFile inputFile(filename);
-    if (inputFile.open(QIODevice::ReadOnly))
+    AnalyzeLoader loader;
+    if (!loader.load(filename))
+        return lastTime;
+
+    readingFile = true;
+    for (const auto &record : loader.records())
     {
-        QTextStream in(&inputFile);
-        while (!in.atEnd())
+        double time = 0;
+        const auto &v = record.values;
+        switch (record.type)
         {
-            QString line = in.readLine();
-            double time = processInputLine(line);
-            if (time > lastTime)
-                lastTime = time;
+            case AnalyzeLoader::Record::GUIDE_STATS:
+                processGuideStats(record.time, v[0], v[1], static_cast<int>(v[2]), static_cast<int>(v[3]), v[4], v[5],
+                                  static_cast<int>(v[6]), true);
+                time = record.time;
+                break;
+            case AnalyzeLoader::Record::MOUNT_COORDS:
+                processMountCoords(record.time, v[0], v[1], v[2], v[3], static_cast<int>(v[4]), v[5], true);
+                time = record.time;
+                break;
+            case AnalyzeLoader::Record::LINE:
+                time = processInputLine(record.line);
+                break;
         }
-        inputFile.close();
+        if (time > lastTime)
+            lastTime = time;
     }
+    readingFile = false;
+    flushStatsData();
+
     return lastTime;
 }
 
@@ -386,6 +386,9 @@ class Analyze : public QWidget, public Ui::Analyze
         void addTemperature(double temperature, const double time);
         void addFocusPosition(double focusPosition, double time);
         void addTargetDistance(double targetDistance, const double time);
+        // Adds a point to a statsPlot graph, or keeps it for flushStatsData() while a file is read.
+        void addStatsData(int graph, double time, double value);
+        void flushStatsData();
 
         // Initialize the graphs (axes, linestyle, pen, name, checkbox callbacks).
         // Returns the graph index.
@@ -442,6 +445,15 @@ class Analyze : public QWidget, public Ui::Analyze
         double readDataFromFile(const QString &filename);
         double processInputLine(const QString &line);
 
+        // Stats points read from a file, added to the graphs all at once.
+        struct StatsColumns
+        {
+            QVector<double> keys;
+            QVector<double> values;
+        };
+        QHash<int, StatsColumns> pendingStats;
+        bool readingFile { false };
+
         // Opens a FITS file for viewing.
         void displayFITS(const QString &filename);
 
@@ -0,0 +1,213 @@
+/*  Analyze Loader
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "analyzeloader.h"
+
+#include <QByteArray>
+#include <QFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+#include <vector>
+
+namespace Ekos
+{
+
+namespace
+{
+
+// Bytes per parsing job, cut at the next line end.
+constexpr qint64 CHUNK_SIZE = 4 * 1024 * 1024;
+
+// Enough for the longest numeric line, MountCoords with the hour angle.
+constexpr int MAX_FIELDS = 9;
+
+struct Field
+{
+    const char *data;
+    int size;
+
+    bool operator==(const char *text) const
+    {
+        return size == static_cast<int>(strlen(text)) && memcmp(data, text, size) == 0;
+    }
+
+    // Same conversions as QString::toDouble() and toInt(), without building strings.
+    double toDouble(bool *ok) const
+    {
+        return QByteArray::fromRawData(data, size).toDouble(ok);
+    }
+    int toInt(bool *ok) const
+    {
+        return QByteArray::fromRawData(data, size).toInt(ok);
+    }
+};
+
+// Splits a line on commas. Returns the number of fields, MAX_FIELDS + 1 if there are more.
+int split(const char *line, int size, Field *fields)
+{
+    int count = 0;
+    const char *start = line;
+    const char *end = line + size;
+    for (;;)
+    {
+        const char *comma = static_cast<const char *>(memchr(start, ',', end - start));
+        if (count == MAX_FIELDS)
+            return MAX_FIELDS + 1;
+        fields[count++] = { start, static_cast<int>((comma ? comma : end) - start) };
+        if (comma == nullptr)
+            return count;
+        start = comma + 1;
+    }
+}
+
+// Fills in the numbers of the frequent lines. Returns false if the line is to be dropped.
+bool parseNumbers(const Field *fields, int count, AnalyzeLoader::Record &record)
+{
+    bool ok = true;
+    auto number = [&](int i, bool integer)
+    {
+        if (!ok)
+            return 0.0;
+        return integer ? static_cast<double>(fields[i].toInt(&ok)) : fields[i].toDouble(&ok);
+    };
+
+    if (record.type == AnalyzeLoader::Record::GUIDE_STATS)
+    {
+        // ra, dec, raPulse, decPulse, snr, skyBg, numStars
+        static constexpr bool integers[7] = { false, false, true, true, false, false, true };
+        for (int i = 0; i < 7; i++)
+            record.values[i] = number(i + 2, integers[i]);
+    }
+    else
+    {
+        // ra, dec, az, alt, pierSide and the optional ha
+        static constexpr bool integers[6] = { false, false, false, false, true, false };
+        for (int i = 0; i < 6; i++)
+            record.values[i] = (i + 2 < count) ? number(i + 2, integers[i]) : 0;
+    }
+    return ok;
+}
+
+void parseLine(const char *line, int size, QVector<AnalyzeLoader::Record> &records)
+{
+    // QTextStream::readLine() drops the \r of \r\n line ends.
+    if (size > 0 && line[size - 1] == '\r')
+        size--;
+
+    Field fields[MAX_FIELDS];
+    const int count = split(line, size, fields);
+
+    // Comments and lines without a time are ignored by processInputLine() too.
+    if (count < 2 || (fields[0].size > 0 && fields[0].data[0] == '#'))
+        return;
+
+    AnalyzeLoader::Record record;
+    if (fields[0] == "GuideStats" && count == 9)
+        record.type = AnalyzeLoader::Record::GUIDE_STATS;
+    else if (fields[0] == "MountCoords" && (count == 7 || count == 8))
+        record.type = AnalyzeLoader::Record::MOUNT_COORDS;
+
+    if (record.type == AnalyzeLoader::Record::LINE)
+    {
+        record.line = QString::fromUtf8(line, size);
+        records.append(record);
+        return;
+    }
+
+    bool ok;
+    record.time = fields[1].toDouble(&ok);
+    if (!ok || record.time < 0 || record.time > 3600 * 24 * 10)
+        return;
+    if (parseNumbers(fields, count, record))
+        records.append(record);
+}
+
+}
+
+bool AnalyzeLoader::load(const QString &filename)
+{
+    m_Records.clear();
+
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const qint64 size = file.size();
+    if (size == 0)
+        return true;
+
+    uchar *data = file.map(0, size);
+    if (data)
+    {
+        m_Records = parse(reinterpret_cast<const char *>(data), size);
+        file.unmap(data);
+    }
+    else
+    {
+        // Some files, e.g. on special filesystems, cannot be mapped.
+        const QByteArray contents = file.readAll();
+        m_Records = parse(contents.constData(), contents.size());
+    }
+    return true;
+}
+
+QVector<AnalyzeLoader::Record> AnalyzeLoader::parse(const char *data, qint64 size)
+{
+    struct Chunk
+    {
+        const char *begin;
+        const char *end;
+        QVector<Record> records;
+    };
+
+    const char * const end = data + size;
+    std::vector<Chunk> chunks;
+    for (const char *begin = data; begin < end;)
+    {
+        const char *chunkEnd = begin + std::min(CHUNK_SIZE, static_cast<qint64>(end - begin));
+        if (chunkEnd < end)
+        {
+            const char *newline = static_cast<const char *>(memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = newline ? newline + 1 : end;
+        }
+        chunks.push_back({begin, chunkEnd, {}});
+        begin = chunkEnd;
+    }
+
+    auto parseChunk = [](Chunk & chunk)
+    {
+        // About one record per 60 bytes for guiding logs.
+        chunk.records.reserve(static_cast<int>((chunk.end - chunk.begin) / 60));
+        for (const char *line = chunk.begin; line < chunk.end;)
+        {
+            const char *newline = static_cast<const char *>(memchr(line, '\n', chunk.end - line));
+            const char *lineEnd = newline ? newline : chunk.end;
+            parseLine(line, static_cast<int>(lineEnd - line), chunk.records);
+            line = lineEnd + 1;
+        }
+    };
+
+    if (chunks.size() == 1)
+    {
+        parseChunk(chunks.front());
+        return chunks.front().records;
+    }
+
+    QtConcurrent::blockingMap(chunks, parseChunk);
+
+    int total = 0;
+    for (const auto &chunk : chunks)
+        total += chunk.records.size();
+
+    QVector<Record> records;
+    records.reserve(total);
+    for (const auto &chunk : chunks)
+        records.append(chunk.records);
+    return records;
+}
+
+}
@@ -0,0 +1,65 @@
+/*  Analyze Loader
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <array>
+
+namespace Ekos
+{
+
+/**
+ * @brief Reads a .analyze file into records, ready to be replayed in order.
+ *
+ * The file is memory-mapped and cut into chunks at line ends, and the chunks are parsed in
+ * parallel. The frequent lines, guide stats and mount coordinates, are parsed into numbers.
+ * All the other lines are kept as text for Analyze::processInputLine().
+ */
+class AnalyzeLoader
+{
+    public:
+        struct Record
+        {
+            enum Type : uint8_t
+            {
+                LINE,
+                GUIDE_STATS,
+                MOUNT_COORDS
+            };
+
+            Type type { LINE };
+            double time { 0 };
+            // GUIDE_STATS: ra, dec, raPulse, decPulse, snr, skyBg, numStars
+            // MOUNT_COORDS: ra, dec, az, alt, pierSide, ha
+            std::array<double, 7> values {};
+            // LINE only
+            QString line;
+        };
+
+        /**
+         * @brief load Reads and parses the file.
+         * @return false if the file could not be read.
+         */
+        bool load(const QString &filename);
+
+        const QVector<Record> &records() const
+        {
+            return m_Records;
+        }
+
+        /**
+         * @brief parse Parses the lines of a buffer, in order.
+         * Invalid guide stats and mount coordinates lines are dropped, the same as processInputLine() does.
+         */
+        static QVector<Record> parse(const char *data, qint64 size);
+
+    private:
+        QVector<Record> m_Records;
+};
+
+}
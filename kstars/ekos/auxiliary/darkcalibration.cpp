@@ -0,0 +1,546 @@
+/*  Dark Calibration
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "darkcalibration.h"
+#include "fitsviewer/fitsparallel.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define DARKCALIBRATION_SSE2
+#include <emmintrin.h>
+// AVX2 kernels are compiled with function level target attributes and only used if the CPU has AVX2.
+#if defined(__GNUC__) || defined(__clang__)
+#define DARKCALIBRATION_AVX2
+#define DARKCALIBRATION_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define DARKCALIBRATION_NEON
+#include <arm_neon.h>
+#endif
+
+namespace Ekos
+{
+
+namespace DarkCalibration
+{
+
+namespace
+{
+
+using FITSSweep::Kernel;
+
+// Scaled subtraction is done in float for float samples and integers of up to 16 bits, as in the
+// vectorized kernels, and in double for the others.
+template <typename T>
+using ScaledType = typename std::conditional<(sizeof(T) <= 2 || std::is_same<T, float>::value), float, double>::type;
+
+bool isSupported(Kernel requested)
+{
+    switch (requested)
+    {
+        case FITSSweep::KERNEL_SCALAR:
+            return true;
+        case FITSSweep::KERNEL_SSE2:
+            return FITSSweep::kernel() == FITSSweep::KERNEL_SSE2 || FITSSweep::kernel() == FITSSweep::KERNEL_AVX2;
+        default:
+            return FITSSweep::kernel() == requested;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// Scalar kernels, also used for the samples left over by the vectorized ones.
+////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+void subtractScalar(T *light, T const *dark, uint32_t count)
+{
+    for (uint32_t i = 0; i < count; i++)
+    {
+        if constexpr (std::is_integral<T>::value && sizeof(T) <= 2)
+        {
+            // Saturate like the vectorized kernels.
+            const int32_t value = static_cast<int32_t>(light[i]) - dark[i];
+            light[i] = value > 0 ? static_cast<T>(std::min<int32_t>(value, std::numeric_limits<T>::max())) : 0;
+        }
+        else
+            light[i] = (light[i] > dark[i]) ? (light[i] - dark[i]) : 0;
+    }
+}
+
+template <typename T>
+void subtractScaledScalar(T *light, T const *dark, uint32_t count, ScaledType<T> scale, ScaledType<T> offset)
+{
+    using S = ScaledType<T>;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const S value = static_cast<S>(light[i]) - (scale * static_cast<S>(dark[i]) + offset);
+        if constexpr (std::is_integral<T>::value)
+        {
+            // Clamp before rounding, as the vectorized kernels do.
+            const S clamped = value > 0 ? std::min<S>(value, static_cast<S>(std::numeric_limits<T>::max())) : 0;
+            light[i] = static_cast<T>(std::nearbyint(clamped));
+        }
+        else
+            light[i] = value > 0 ? value : 0;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// SSE2 kernels.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(DARKCALIBRATION_SSE2)
+
+void subtractSSE2(uint8_t *light, uint8_t const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<__m128i const *>(light + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dark + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(light + i), _mm_subs_epu8(l, d));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractSSE2(uint16_t *light, uint16_t const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<__m128i const *>(light + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dark + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(light + i), _mm_subs_epu16(l, d));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractSSE2(int16_t *light, int16_t const *dark, uint32_t count)
+{
+    const __m128i zero = _mm_setzero_si128();
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<__m128i const *>(light + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dark + i));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(light + i), _mm_max_epi16(_mm_subs_epi16(l, d), zero));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractSSE2(float *light, float const *dark, uint32_t count)
+{
+    const __m128 zero = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        // Max returns its second operand if either is NaN, so NaN becomes 0 like in the scalar code.
+        const __m128 difference = _mm_sub_ps(_mm_loadu_ps(light + i), _mm_loadu_ps(dark + i));
+        _mm_storeu_ps(light + i, _mm_max_ps(difference, zero));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractScaledSSE2(uint16_t *light, uint16_t const *dark, uint32_t count, float scale, float offset)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i bias = _mm_set1_epi32(0x8000);
+    const __m128i flip = _mm_set1_epi16(static_cast<int16_t>(0x8000));
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128 offsets = _mm_set1_ps(offset);
+    const __m128 minimum = _mm_setzero_ps();
+    const __m128 maximum = _mm_set1_ps(65535.0f);
+
+    auto scaled = [&](__m128i l, __m128i d)
+    {
+        const __m128 value = _mm_sub_ps(_mm_cvtepi32_ps(l), _mm_add_ps(_mm_mul_ps(scales, _mm_cvtepi32_ps(d)), offsets));
+        // SSE2 has no unsigned 32 to 16 bit pack, so pack signed values offset by 0x8000.
+        return _mm_sub_epi32(_mm_cvtps_epi32(_mm_min_ps(_mm_max_ps(value, minimum), maximum)), bias);
+    };
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i l = _mm_loadu_si128(reinterpret_cast<__m128i const *>(light + i));
+        const __m128i d = _mm_loadu_si128(reinterpret_cast<__m128i const *>(dark + i));
+        const __m128i low = scaled(_mm_unpacklo_epi16(l, zero), _mm_unpacklo_epi16(d, zero));
+        const __m128i high = scaled(_mm_unpackhi_epi16(l, zero), _mm_unpackhi_epi16(d, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(light + i), _mm_xor_si128(_mm_packs_epi32(low, high), flip));
+    }
+    subtractScaledScalar(light + i, dark + i, count - i, scale, offset);
+}
+
+void subtractScaledSSE2(float *light, float const *dark, uint32_t count, float scale, float offset)
+{
+    const __m128 scales = _mm_set1_ps(scale);
+    const __m128 offsets = _mm_set1_ps(offset);
+    const __m128 zero = _mm_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 value = _mm_sub_ps(_mm_loadu_ps(light + i), _mm_add_ps(_mm_mul_ps(scales, _mm_loadu_ps(dark + i)), offsets));
+        _mm_storeu_ps(light + i, _mm_max_ps(value, zero));
+    }
+    subtractScaledScalar(light + i, dark + i, count - i, scale, offset);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// AVX2 kernels.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(DARKCALIBRATION_AVX2)
+
+DARKCALIBRATION_TARGET_AVX2
+void subtractAVX2(uint8_t *light, uint8_t const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(light + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dark + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(light + i), _mm256_subs_epu8(l, d));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+DARKCALIBRATION_TARGET_AVX2
+void subtractAVX2(uint16_t *light, uint16_t const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(light + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dark + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(light + i), _mm256_subs_epu16(l, d));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+DARKCALIBRATION_TARGET_AVX2
+void subtractAVX2(int16_t *light, int16_t const *dark, uint32_t count)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(light + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dark + i));
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(light + i), _mm256_max_epi16(_mm256_subs_epi16(l, d), zero));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+DARKCALIBRATION_TARGET_AVX2
+void subtractAVX2(float *light, float const *dark, uint32_t count)
+{
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 difference = _mm256_sub_ps(_mm256_loadu_ps(light + i), _mm256_loadu_ps(dark + i));
+        _mm256_storeu_ps(light + i, _mm256_max_ps(difference, zero));
+    }
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+// Lambdas don't inherit the target attribute, so this is a function of its own.
+DARKCALIBRATION_TARGET_AVX2
+inline __m256i subtractScaledAVX2(__m128i l, __m128i d, __m256 scales, __m256 offsets)
+{
+    const __m256 lights = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(l));
+    const __m256 darks = _mm256_cvtepi32_ps(_mm256_cvtepu16_epi32(d));
+    // Separate multiply and add, as the other kernels, so that the results don't depend on the kernel.
+    const __m256 value = _mm256_sub_ps(lights, _mm256_add_ps(_mm256_mul_ps(scales, darks), offsets));
+    return _mm256_cvtps_epi32(_mm256_min_ps(_mm256_max_ps(value, _mm256_setzero_ps()), _mm256_set1_ps(65535.0f)));
+}
+
+DARKCALIBRATION_TARGET_AVX2
+void subtractScaledAVX2(uint16_t *light, uint16_t const *dark, uint32_t count, float scale, float offset)
+{
+    const __m256 scales = _mm256_set1_ps(scale);
+    const __m256 offsets = _mm256_set1_ps(offset);
+
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i l = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(light + i));
+        const __m256i d = _mm256_loadu_si256(reinterpret_cast<__m256i const *>(dark + i));
+        const __m256i low = subtractScaledAVX2(_mm256_castsi256_si128(l), _mm256_castsi256_si128(d), scales, offsets);
+        const __m256i high = subtractScaledAVX2(_mm256_extracti128_si256(l, 1), _mm256_extracti128_si256(d, 1), scales, offsets);
+        // The pack works within 128 bit lanes, put the quarters back in order.
+        const __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(low, high), 0xD8);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(light + i), packed);
+    }
+    subtractScaledScalar(light + i, dark + i, count - i, scale, offset);
+}
+
+DARKCALIBRATION_TARGET_AVX2
+void subtractScaledAVX2(float *light, float const *dark, uint32_t count, float scale, float offset)
+{
+    const __m256 scales = _mm256_set1_ps(scale);
+    const __m256 offsets = _mm256_set1_ps(offset);
+    const __m256 zero = _mm256_setzero_ps();
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 value = _mm256_sub_ps(_mm256_loadu_ps(light + i),
+                                           _mm256_add_ps(_mm256_mul_ps(scales, _mm256_loadu_ps(dark + i)), offsets));
+        _mm256_storeu_ps(light + i, _mm256_max_ps(value, zero));
+    }
+    subtractScaledScalar(light + i, dark + i, count - i, scale, offset);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// NEON kernels.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(DARKCALIBRATION_NEON)
+
+void subtractNEON(uint8_t *light, uint8_t const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+        vst1q_u8(light + i, vqsubq_u8(vld1q_u8(light + i), vld1q_u8(dark + i)));
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractNEON(uint16_t *light, uint16_t const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        vst1q_u16(light + i, vqsubq_u16(vld1q_u16(light + i), vld1q_u16(dark + i)));
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractNEON(int16_t *light, int16_t const *dark, uint32_t count)
+{
+    const int16x8_t zero = vdupq_n_s16(0);
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+        vst1q_s16(light + i, vmaxq_s16(vqsubq_s16(vld1q_s16(light + i), vld1q_s16(dark + i)), zero));
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+// NEON max propagates NaN, so keep the positive values with a mask instead, NaN compares false.
+inline float32x4_t positive(float32x4_t value)
+{
+    const uint32x4_t mask = vcgtq_f32(value, vdupq_n_f32(0));
+    return vreinterpretq_f32_u32(vandq_u32(mask, vreinterpretq_u32_f32(value)));
+}
+
+void subtractNEON(float *light, float const *dark, uint32_t count)
+{
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+        vst1q_f32(light + i, positive(vsubq_f32(vld1q_f32(light + i), vld1q_f32(dark + i))));
+    subtractScalar(light + i, dark + i, count - i);
+}
+
+void subtractScaledNEON(uint16_t *light, uint16_t const *dark, uint32_t count, float scale, float offset)
+{
+    const float32x4_t scales = vdupq_n_f32(scale);
+    const float32x4_t offsets = vdupq_n_f32(offset);
+    const float32x4_t minimum = vdupq_n_f32(0);
+    const float32x4_t maximum = vdupq_n_f32(65535.0f);
+
+    auto scaled = [&](uint16x4_t l, uint16x4_t d)
+    {
+        const float32x4_t lights = vcvtq_f32_u32(vmovl_u16(l));
+        const float32x4_t darks = vcvtq_f32_u32(vmovl_u16(d));
+        const float32x4_t value = vsubq_f32(lights, vaddq_f32(vmulq_f32(scales, darks), offsets));
+        // Round to nearest even, as the other kernels.
+        return vqmovn_u32(vcvtnq_u32_f32(vminq_f32(vmaxq_f32(value, minimum), maximum)));
+    };
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint16x8_t l = vld1q_u16(light + i);
+        const uint16x8_t d = vld1q_u16(dark + i);
+        vst1q_u16(light + i, vcombine_u16(scaled(vget_low_u16(l), vget_low_u16(d)), scaled(vget_high_u16(l), vget_high_u16(d))));
+    }
+    subtractScaledScalar(light + i, dark + i, count - i, scale, offset);
+}
+
+void subtractScaledNEON(float *light, float const *dark, uint32_t count, float scale, float offset)
+{
+    const float32x4_t scales = vdupq_n_f32(scale);
+    const float32x4_t offsets = vdupq_n_f32(offset);
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4_t value = vsubq_f32(vld1q_f32(light + i), vaddq_f32(vmulq_f32(scales, vld1q_f32(dark + i)), offsets));
+        vst1q_f32(light + i, positive(value));
+    }
+    subtractScaledScalar(light + i, dark + i, count - i, scale, offset);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// Dispatch.
+////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename T>
+constexpr bool hasKernel()
+{
+    return std::is_same<T, uint8_t>::value || std::is_same<T, int16_t>::value ||
+           std::is_same<T, uint16_t>::value || std::is_same<T, float>::value;
+}
+
+template <typename T>
+constexpr bool hasScaledKernel()
+{
+    return std::is_same<T, uint16_t>::value || std::is_same<T, float>::value;
+}
+
+template <typename T>
+void subtractRow(Kernel kernel, T *light, T const *dark, uint32_t count)
+{
+    if constexpr (hasKernel<T>())
+    {
+        switch (kernel)
+        {
+#if defined(DARKCALIBRATION_AVX2)
+            case FITSSweep::KERNEL_AVX2:
+                return subtractAVX2(light, dark, count);
+#endif
+#if defined(DARKCALIBRATION_SSE2)
+            case FITSSweep::KERNEL_SSE2:
+                return subtractSSE2(light, dark, count);
+#endif
+#if defined(DARKCALIBRATION_NEON)
+            case FITSSweep::KERNEL_NEON:
+                return subtractNEON(light, dark, count);
+#endif
+            default:
+                break;
+        }
+    }
+    subtractScalar(light, dark, count);
+}
+
+template <typename T>
+void subtractScaledRow(Kernel kernel, T *light, T const *dark, uint32_t count, ScaledType<T> scale, ScaledType<T> offset)
+{
+    if constexpr (hasScaledKernel<T>())
+    {
+        switch (kernel)
+        {
+#if defined(DARKCALIBRATION_AVX2)
+            case FITSSweep::KERNEL_AVX2:
+                return subtractScaledAVX2(light, dark, count, scale, offset);
+#endif
+#if defined(DARKCALIBRATION_SSE2)
+            case FITSSweep::KERNEL_SSE2:
+                return subtractScaledSSE2(light, dark, count, scale, offset);
+#endif
+#if defined(DARKCALIBRATION_NEON)
+            case FITSSweep::KERNEL_NEON:
+                return subtractScaledNEON(light, dark, count, scale, offset);
+#endif
+            default:
+                break;
+        }
+    }
+    subtractScaledScalar(light, dark, count, scale, offset);
+}
+
+template <typename T>
+T median8(T const *center, const std::array<int64_t, 8> &neighbors)
+{
+    std::array<T, 8> elements;
+    for (size_t i = 0; i < elements.size(); i++)
+        elements[i] = center[neighbors[i]];
+
+    // Same as sorting the neighbors and averaging the two middle ones, with fewer comparisons.
+    std::nth_element(elements.begin(), elements.begin() + 4, elements.end());
+    const T lower = *std::max_element(elements.begin(), elements.begin() + 4);
+    auto median = (lower + elements[4]) / 2;
+    return median;
+}
+
+}  // namespace
+
+template <typename T>
+void subtract(T *light, uint32_t width, uint32_t height, T const *dark, uint32_t darkStride,
+              const Scaling &scaling, Kernel forceKernel)
+{
+    if (light == nullptr || dark == nullptr || width == 0 || height == 0)
+        return;
+
+    const Kernel selected = isSupported(forceKernel) ? forceKernel : FITSSweep::kernel();
+    const ScaledType<T> scale = scaling.scale;
+    const ScaledType<T> offset = (1 - scaling.scale) * scaling.bias;
+
+    // Partitions are cut anywhere in the frame, and processed as row segments since the dark rows
+    // may be longer than the light ones.
+    FITSParallel::runPartitioned<bool>(width * height, [&](uint32_t start, uint32_t end)
+    {
+        for (uint32_t i = start; i < end;)
+        {
+            const uint32_t y = i / width;
+            const uint32_t x = i - y * width;
+            const uint32_t count = std::min(end - i, width - x);
+            T const *darkRow = dark + static_cast<size_t>(y) * darkStride + x;
+            if (scaling.isIdentity())
+                subtractRow(selected, light + i, darkRow, count);
+            else
+                subtractScaledRow(selected, light + i, darkRow, count, scale, offset);
+            i += count;
+        }
+        return true;
+    });
+}
+
+template <typename T>
+void correctDefects(T *light, uint32_t width, const std::vector<uint32_t> &indexes)
+{
+    if (light == nullptr || indexes.empty())
+        return;
+
+    const int64_t w = width;
+    const std::array<int64_t, 8> neighbors { -w - 1, -w, -w + 1, -1, 1, w - 1, w, w + 1 };
+
+    // All the medians are taken before any sample is replaced.
+    std::vector<T> medians(indexes.size());
+    FITSParallel::runPartitioned<bool>(static_cast<uint32_t>(indexes.size()), [&](uint32_t start, uint32_t end)
+    {
+        for (uint32_t i = start; i < end; i++)
+            medians[i] = median8(light + indexes[i], neighbors);
+        return true;
+    });
+
+    for (size_t i = 0; i < indexes.size(); i++)
+        light[indexes[i]] = medians[i];
+}
+
+#define DARKCALIBRATION_INSTANTIATE(T) \
+    template void subtract(T *light, uint32_t width, uint32_t height, T const *dark, uint32_t darkStride, \
+                           const Scaling &scaling, Kernel forceKernel); \
+    template void correctDefects(T *light, uint32_t width, const std::vector<uint32_t> &indexes);
+
+DARKCALIBRATION_INSTANTIATE(uint8_t)
+DARKCALIBRATION_INSTANTIATE(int16_t)
+DARKCALIBRATION_INSTANTIATE(uint16_t)
+DARKCALIBRATION_INSTANTIATE(int32_t)
+DARKCALIBRATION_INSTANTIATE(uint32_t)
+DARKCALIBRATION_INSTANTIATE(float)
+DARKCALIBRATION_INSTANTIATE(int64_t)
+DARKCALIBRATION_INSTANTIATE(double)
+
+}
+
+}
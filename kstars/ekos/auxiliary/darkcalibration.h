@@ -0,0 +1,64 @@
+/*  Dark Calibration
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "fitsviewer/fitssweep.h"
+
+#include <stdint.h>
+#include <vector>
+
+namespace Ekos
+{
+
+// Calibration kernels applied to light frames by the DarkProcessor.
+//
+// Dark subtraction is vectorized with SSE2 or AVX2 on x86 and NEON on ARM64 for 8 and 16 bit
+// integer and float samples, using the kernel FITSSweep selected for the CPU, with a scalar
+// fallback for the other types. The frame is split between several threads.
+namespace DarkCalibration
+{
+
+/**
+ * @brief Scaling of the dark frame, for a dark taken with another exposure than the light.
+ * The light becomes light - bias - scale * (dark - bias), where bias is the level of a bias frame.
+ * With the default scale of 1 the dark is subtracted as is and the bias does not matter.
+ */
+struct Scaling
+{
+    double scale { 1 };
+    double bias { 0 };
+
+    bool isIdentity() const
+    {
+        return scale == 1;
+    }
+};
+
+/**
+ * @brief subtract Subtracts the dark from the light, in place.
+ * Results below zero are set to zero, and integer results are clamped to the largest value of the type.
+ * @param light light frame samples, width x height.
+ * @param dark first dark sample matching the light, rows are darkStride samples apart.
+ * @param forceKernel kernel to use instead of the selected one, mainly for testing. Ignored if not
+ * supported by the CPU.
+ * @note Uses multiple threads, blocks until done.
+ */
+template <typename T>
+void subtract(T *light, uint32_t width, uint32_t height, T const *dark, uint32_t darkStride,
+              const Scaling &scaling = Scaling(), FITSSweep::Kernel forceKernel = FITSSweep::kernel());
+
+/**
+ * @brief correctDefects Replaces each defective sample with the median of its 8 neighbors.
+ * The neighbors are taken from the frame before correction, so the result does not depend on the order of the defects.
+ * @param light light frame samples, rows are width samples apart.
+ * @param indexes defective samples with all their neighbors in the frame, see DefectMap::defectIndexes().
+ */
+template <typename T>
+void correctDefects(T *light, uint32_t width, const std::vector<uint32_t> &indexes);
+
+}
+
+}
@@ -25,6 +25,8 @@
 #include <QStatusBar>
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <limits>
 
 namespace Ekos
 {
@@ -140,7 +142,11 @@ DarkLibrary::DarkLibrary(QWidget *parent) : QDialog(parent)
     connect(startB, &QPushButton::clicked, this, &DarkLibrary::start);
     connect(stopB, &QPushButton::clicked, this, &DarkLibrary::stop);
 
-    KStarsData::Instance()->userdb()->GetAllDarkFrames(m_DarkFramesDatabaseList);
+    {
+        QMutexLocker locker(&m_CacheMutex);
+        updateCacheBudget();
+    }
+    refreshFromDB();
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
     // Defect Map Connections
     ////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
@@ -205,7 +211,61 @@ DarkLibrary::~DarkLibrary()
 ///////////////////////////////////////////////////////////////////////////////////////
 void DarkLibrary::refreshFromDB()
 {
+    QMutexLocker locker(&m_CacheMutex);
     KStarsData::Instance()->userdb()->GetAllDarkFrames(m_DarkFramesDatabaseList);
+    rebuildLookupIndex();
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+QString DarkLibrary::lookupBucket(const QString &camera, int chip, int binX, int binY)
+{
+    return QString("%1|%2|%3x%4").arg(camera).arg(chip).arg(binX).arg(binY);
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+void DarkLibrary::rebuildLookupIndex()
+{
+    m_DarkFramesIndex.clear();
+    m_DarkFrameLookup.clear();
+    m_DefectMapLookup.clear();
+
+    for (int row = 0; row < m_DarkFramesDatabaseList.size(); row++)
+    {
+        const QVariantMap &map = m_DarkFramesDatabaseList[row];
+        m_DarkFramesIndex[lookupBucket(map["ccd"].toString(), map["chip"].toInt(), map["binX"].toInt(),
+                                       map["binY"].toInt())].append(row);
+    }
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+void DarkLibrary::updateCacheBudget()
+{
+    // The masters already cached count as available, as they would be freed to make room.
+    double budgetMB = CACHE_BUDGET_MB;
+    const double availableMB = KSUtils::getAvailableRAM() / 1e6;
+    if (availableMB > 0)
+        budgetMB = std::min(budgetMB, (availableMB + m_CachedDarkFrames.totalCost() / 1024.0) / 2);
+
+    m_CachedDarkFrames.setMaxCost(std::max(1, static_cast<int>(budgetMB * 1024)));
+    // Defect maps are much smaller than their darks.
+    m_CachedDefectMaps.setMaxCost(std::max(1, static_cast<int>(budgetMB * 1024 / 8)));
+}
+
+///////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////
+void DarkLibrary::evictMaster(const QString &filename)
+{
+    QMutexLocker locker(&m_CacheMutex);
+    m_CachedDarkFrames.remove(filename);
+    // Defect maps are cached under the filename of their dark.
+    m_CachedDefectMaps.remove(filename);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -213,93 +273,115 @@ void DarkLibrary::refreshFromDB()
 ///////////////////////////////////////////////////////////////////////////////////////
 bool DarkLibrary::findDarkFrame(ISD::CameraChip *m_TargetChip, double duration, QSharedPointer<FITSData> &darkData)
 {
+    int binX = 1, binY = 1;
+    m_TargetChip->getBinning(&binX, &binY);
+    const QString bucket = lookupBucket(m_TargetChip->getCCD()->getDeviceName(), static_cast<int>(m_TargetChip->getType()),
+                                        binX, binY);
+
+    const int gain = getGain();
+    QString isoValue;
+    const bool hasISO = m_TargetChip->getISOValue(isoValue);
+    const bool hasCoolerControl = m_TargetChip->getCCD()->hasCoolerControl();
+    const bool hasCooler = m_TargetChip->getCCD()->hasCooler();
+    const double maxTemperatureDiff = maxDarkTemperatureDiff->value();
+
+    // Settings are quantized so that repeated requests with the same camera settings share one lookup.
+    double temperature = 0;
+    if (hasCoolerControl || hasCooler)
+        m_TargetChip->getCCD()->getTemperature(&temperature);
+    temperature = std::round(temperature * 10) / 10;
+    const double lookupDuration = std::round(duration * 1000) / 1000;
+
+    const QString key = QStringList
+    {
+        bucket, QString::number(gain), hasISO ? "iso:" + isoValue : QString(), QString::number(lookupDuration),
+        QString::number(hasCoolerControl), QString::number(hasCooler), QString::number(temperature),
+        QString::number(maxTemperatureDiff)
+    }.join('|');
+
     QVariantMap bestCandidate;
-    for (auto &map : m_DarkFramesDatabaseList)
     {
-        // First check CCD name matches and check if we are on the correct chip
-        if (map["ccd"].toString() == m_TargetChip->getCCD()->getDeviceName() &&
-                map["chip"].toInt() == static_cast<int>(m_TargetChip->getType()))
+        QMutexLocker locker(&m_CacheMutex);
+        auto lookup = m_DarkFrameLookup.constFind(key);
+        if (lookup == m_DarkFrameLookup.constEnd())
         {
-            // Match Gain
-            int gain = getGain();
-            if (gain >= 0 && map["gain"].toInt() != gain)
-                continue;
-
-            // Match ISO
-            QString isoValue;
-            if (m_TargetChip->getISOValue(isoValue) && map["iso"].toString() != isoValue)
-                continue;
-
-            // Match binning
-            int binX = 1, binY = 1;
-            m_TargetChip->getBinning(&binX, &binY);
-
-            // Then check if binning is the same
-            if (map["binX"].toInt() != binX || map["binY"].toInt() != binY)
-                continue;
-
-            // If camera has an active cooler, then we check temperature against the absolute threshold.
-            if (m_TargetChip->getCCD()->hasCoolerControl())
+            int bestRow = -1;
+            for (int row : m_DarkFramesIndex.value(bucket))
             {
-                double temperature = 0;
-                m_TargetChip->getCCD()->getTemperature(&temperature);
-                double darkTemperature = map["temperature"].toDouble();
-                // If different is above threshold, it is completely rejected.
-                if (darkTemperature != INVALID_VALUE && fabs(darkTemperature - temperature) > maxDarkTemperatureDiff->value())
+                const QVariantMap &map = m_DarkFramesDatabaseList[row];
+
+                // Match Gain
+                if (gain >= 0 && map["gain"].toInt() != gain)
                     continue;
-            }
 
-            if (bestCandidate.isEmpty())
-            {
-                bestCandidate = map;
-                continue;
-            }
+                // Match ISO
+                if (hasISO && map["iso"].toString() != isoValue)
+                    continue;
 
-            // We try to find the best frame
-            // Frame closest in exposure duration wins
-            // Frame with temperature closest to stored temperature wins (if temperature is reported)
-            uint32_t thisMapScore = 0;
-            uint32_t bestCandidateScore = 0;
+                // If camera has an active cooler, then we check temperature against the absolute threshold.
+                if (hasCoolerControl)
+                {
+                    double darkTemperature = map["temperature"].toDouble();
+                    // If different is above threshold, it is completely rejected.
+                    if (darkTemperature != INVALID_VALUE && fabs(darkTemperature - temperature) > maxTemperatureDiff)
+                        continue;
+                }
 
-            // Else we check for the closest passive temperature
-            if (m_TargetChip->getCCD()->hasCooler())
-            {
-                double temperature = 0;
-                m_TargetChip->getCCD()->getTemperature(&temperature);
-                double diffMap = std::fabs(temperature - map["temperature"].toDouble());
-                double diffBest = std::fabs(temperature - bestCandidate["temperature"].toDouble());
-                // Prefer temperatures closest to target
-                if (diffMap < diffBest)
-                    thisMapScore++;
-                else if (diffBest < diffMap)
-                    bestCandidateScore++;
-            }
+                if (bestRow < 0)
+                {
+                    bestRow = row;
+                    continue;
+                }
 
-            // Duration has a higher score priority over temperature
-            {
-                double diffMap = std::fabs(map["duration"].toDouble() - duration);
-                double diffBest = std::fabs(bestCandidate["duration"].toDouble() - duration);
-                if (diffMap < diffBest)
-                    thisMapScore += 5;
-                else if (diffBest < diffMap)
-                    bestCandidateScore += 5;
-            }
+                const QVariantMap &best = m_DarkFramesDatabaseList[bestRow];
 
-            // More recent has a higher score than older.
-            {
-                const QDateTime now = QDateTime::currentDateTime();
-                int64_t diffMap  = map["timestamp"].toDateTime().secsTo(now);
-                int64_t diffBest = bestCandidate["timestamp"].toDateTime().secsTo(now);
-                if (diffMap < diffBest)
-                    thisMapScore++;
-                else if (diffBest < diffMap)
-                    bestCandidateScore++;
-            }
+                // We try to find the best frame
+                // Frame closest in exposure duration wins
+                // Frame with temperature closest to stored temperature wins (if temperature is reported)
+                uint32_t thisMapScore = 0;
+                uint32_t bestCandidateScore = 0;
 
-            // Find candidate with closest time in case we have multiple defect maps
-            if (thisMapScore > bestCandidateScore)
-                bestCandidate = map;
+                // Else we check for the closest passive temperature
+                if (hasCooler)
+                {
+                    double diffMap = std::fabs(temperature - map["temperature"].toDouble());
+                    double diffBest = std::fabs(temperature - best["temperature"].toDouble());
+                    // Prefer temperatures closest to target
+                    if (diffMap < diffBest)
+                        thisMapScore++;
+                    else if (diffBest < diffMap)
+                        bestCandidateScore++;
+                }
+
+                // Duration has a higher score priority over temperature
+                {
+                    double diffMap = std::fabs(map["duration"].toDouble() - lookupDuration);
+                    double diffBest = std::fabs(best["duration"].toDouble() - lookupDuration);
+                    if (diffMap < diffBest)
+                        thisMapScore += 5;
+                    else if (diffBest < diffMap)
+                        bestCandidateScore += 5;
+                }
+
+                // More recent has a higher score than older.
+                {
+                    const QDateTime mapTime = map["timestamp"].toDateTime();
+                    const QDateTime bestTime = best["timestamp"].toDateTime();
+                    if (mapTime > bestTime)
+                        thisMapScore++;
+                    else if (bestTime > mapTime)
+                        bestCandidateScore++;
+                }
+
+                // Find candidate with closest time in case we have multiple defect maps
+                if (thisMapScore > bestCandidateScore)
+                    bestRow = row;
+            }
+            lookup = m_DarkFrameLookup.insert(key, bestRow);
         }
+
+        if (lookup.value() >= 0)
+            bestCandidate = m_DarkFramesDatabaseList[lookup.value()];
     }
 
     if (bestCandidate.isEmpty())
@@ -320,29 +402,39 @@ bool DarkLibrary::findDarkFrame(ISD::CameraChip *m_TargetChip, double duration,
         return false;
     }
 
-    if (m_CachedDarkFrames.contains(filename))
     {
-        darkData = m_CachedDarkFrames[filename];
-        return true;
-    }
+        QMutexLocker locker(&m_CacheMutex);
+        if (auto cached = m_CachedDarkFrames.object(filename))
+        {
+            darkData = *cached;
+            return true;
+        }
 
-    // Before adding to cache, clear the cache if memory drops too low.
-    auto memoryMB = KSUtils::getAvailableRAM() / 1e6;
-    if (memoryMB < CACHE_MEMORY_LIMIT)
-        m_CachedDarkFrames.clear();
+        // Before adding to cache, clear the cache if memory drops too low.
+        auto memoryMB = KSUtils::getAvailableRAM() / 1e6;
+        if (memoryMB < CACHE_MEMORY_LIMIT)
+            m_CachedDarkFrames.clear();
+    }
 
     // Finally we made it, let's put it in the hash
-    if (cacheDarkFrameFromFile(filename))
-    {
-        darkData = m_CachedDarkFrames[filename];
+    if (cacheDarkFrameFromFile(filename, &darkData))
         return true;
-    }
 
     // Remove bad dark frame
     emit newLog(i18n("Removing bad dark frame file %1", filename));
-    m_CachedDarkFrames.remove(filename);
+    evictMaster(filename);
     QFile::remove(filename);
     KStarsData::Instance()->userdb()->DeleteDarkFrame(filename);
+    {
+        // Forget the row too, so that the next lookup falls back to the next best dark.
+        QMutexLocker locker(&m_CacheMutex);
+        m_DarkFramesDatabaseList.erase(std::remove_if(m_DarkFramesDatabaseList.begin(), m_DarkFramesDatabaseList.end(),
+                                       [&filename](const QVariantMap & oneMap)
+        {
+            return oneMap["filename"].toString() == filename;
+        }), m_DarkFramesDatabaseList.end());
+        rebuildLookupIndex();
+    }
     return false;
 
 }
@@ -352,28 +444,44 @@ bool DarkLibrary::findDarkFrame(ISD::CameraChip *m_TargetChip, double duration,
 ///////////////////////////////////////////////////////////////////////////////////////
 bool DarkLibrary::findDefectMap(ISD::CameraChip *m_TargetChip, double duration, QSharedPointer<DefectMap> &defectMap)
 {
-    QVariantMap bestCandidate;
-    for (auto &map : m_DarkFramesDatabaseList)
+    int binX = 1, binY = 1;
+    m_TargetChip->getBinning(&binX, &binY);
+    const QString bucket = lookupBucket(m_TargetChip->getCCD()->getDeviceName(), static_cast<int>(m_TargetChip->getType()),
+                                        binX, binY);
+
+    const bool hasCooler = m_TargetChip->getCCD()->hasCooler();
+    double temperature = 0;
+    if (hasCooler)
+        m_TargetChip->getCCD()->getTemperature(&temperature);
+    temperature = std::round(temperature * 10) / 10;
+    const double lookupDuration = std::round(duration * 1000) / 1000;
+
+    const QString key = QStringList
     {
-        if (map["defectmap"].toString().isEmpty())
-            continue;
+        bucket, QString::number(lookupDuration), QString::number(hasCooler), QString::number(temperature)
+    }.join('|');
 
-        // First check CCD name matches and check if we are on the correct chip
-        if (map["ccd"].toString() == m_TargetChip->getCCD()->getDeviceName() &&
-                map["chip"].toInt() == static_cast<int>(m_TargetChip->getType()))
+    QVariantMap bestCandidate;
+    {
+        QMutexLocker locker(&m_CacheMutex);
+        auto lookup = m_DefectMapLookup.constFind(key);
+        if (lookup == m_DefectMapLookup.constEnd())
         {
-            int binX, binY;
-            m_TargetChip->getBinning(&binX, &binY);
-
-            // Then check if binning is the same
-            if (map["binX"].toInt() == binX && map["binY"].toInt() == binY)
+            int bestRow = -1;
+            for (int row : m_DarkFramesIndex.value(bucket))
             {
-                if (bestCandidate.isEmpty())
+                const QVariantMap &map = m_DarkFramesDatabaseList[row];
+                if (map["defectmap"].toString().isEmpty())
+                    continue;
+
+                if (bestRow < 0)
                 {
-                    bestCandidate = map;
+                    bestRow = row;
                     continue;
                 }
 
+                const QVariantMap &best = m_DarkFramesDatabaseList[bestRow];
+
                 // We try to find the best frame
                 // Frame closest in exposure duration wins
                 // Frame with temperature closest to stored temperature wins (if temperature is reported)
@@ -381,12 +489,10 @@ bool DarkLibrary::findDefectMap(ISD::CameraChip *m_TargetChip, double duration,
                 uint32_t bestCandidateScore = 0;
 
                 // Else we check for the closest passive temperature
-                if (m_TargetChip->getCCD()->hasCooler())
+                if (hasCooler)
                 {
-                    double temperature = 0;
-                    m_TargetChip->getCCD()->getTemperature(&temperature);
                     double diffMap = std::fabs(temperature - map["temperature"].toDouble());
-                    double diffBest = std::fabs(temperature - bestCandidate["temperature"].toDouble());
+                    double diffBest = std::fabs(temperature - best["temperature"].toDouble());
                     // Prefer temperatures closest to target
                     if (diffMap < diffBest)
                         thisMapScore++;
@@ -395,8 +501,8 @@ bool DarkLibrary::findDefectMap(ISD::CameraChip *m_TargetChip, double duration,
                 }
 
                 // Duration has a higher score priority over temperature
-                double diffMap = std::fabs(map["duration"].toDouble() - duration);
-                double diffBest = std::fabs(bestCandidate["duration"].toDouble() - duration);
+                double diffMap = std::fabs(map["duration"].toDouble() - lookupDuration);
+                double diffBest = std::fabs(best["duration"].toDouble() - lookupDuration);
                 if (diffMap < diffBest)
                     thisMapScore += 2;
                 else if (diffBest < diffMap)
@@ -404,11 +510,14 @@ bool DarkLibrary::findDefectMap(ISD::CameraChip *m_TargetChip, double duration,
 
                 // Find candidate with closest time in case we have multiple defect maps
                 if (thisMapScore > bestCandidateScore)
-                    bestCandidate = map;
+                    bestRow = row;
             }
+            lookup = m_DefectMapLookup.insert(key, bestRow);
         }
-    }
 
+        if (lookup.value() >= 0)
+            bestCandidate = m_DarkFramesDatabaseList[lookup.value()];
+    }
 
     if (bestCandidate.isEmpty())
         return false;
@@ -420,16 +529,18 @@ bool DarkLibrary::findDefectMap(ISD::CameraChip *m_TargetChip, double duration,
     if (darkFilename.isEmpty() || defectFilename.isEmpty())
         return false;
 
-    if (m_CachedDefectMaps.contains(darkFilename))
     {
-        defectMap = m_CachedDefectMaps[darkFilename];
-        return true;
+        QMutexLocker locker(&m_CacheMutex);
+        if (auto cached = m_CachedDefectMaps.object(darkFilename))
+        {
+            defectMap = *cached;
+            return true;
+        }
     }
 
     // Finally we made it, let's put it in the hash
-    if (cacheDefectMapFromFile(darkFilename, defectFilename))
+    if (cacheDefectMapFromFile(darkFilename, defectFilename, &defectMap))
     {
-        defectMap = m_CachedDefectMaps[darkFilename];
         return true;
     }
     else
@@ -443,7 +554,7 @@ bool DarkLibrary::findDefectMap(ISD::CameraChip *m_TargetChip, double duration,
 ///////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////
-bool DarkLibrary::cacheDefectMapFromFile(const QString &key, const QString &filename)
+bool DarkLibrary::cacheDefectMapFromFile(const QString &key, const QString &filename, QSharedPointer<DefectMap> *defectMap)
 {
     QSharedPointer<DefectMap> oneMap;
     oneMap.reset(new DefectMap());
@@ -451,7 +562,14 @@ bool DarkLibrary::cacheDefectMapFromFile(const QString &key, const QString &file
     if (oneMap->load(filename))
     {
         oneMap->filterPixels();
-        m_CachedDefectMaps[key] = oneMap;
+
+        // About the size of a set node for each bad pixel.
+        const qint64 bytes = (oneMap->hotPixels().size() + oneMap->coldPixels().size()) * (sizeof(BadPixel) + 32);
+        QMutexLocker locker(&m_CacheMutex);
+        updateCacheBudget();
+        m_CachedDefectMaps.insert(key, new QSharedPointer<DefectMap>(oneMap), static_cast<int>(bytes / 1024 + 1));
+        if (defectMap)
+            *defectMap = oneMap;
         return true;
     }
 
@@ -462,7 +580,7 @@ bool DarkLibrary::cacheDefectMapFromFile(const QString &key, const QString &file
 ///////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////
-bool DarkLibrary::cacheDarkFrameFromFile(const QString &filename)
+bool DarkLibrary::cacheDarkFrameFromFile(const QString &filename, QSharedPointer<FITSData> *darkData)
 {
     QSharedPointer<FITSData> data;
     data.reset(new FITSData(FITS_CALIBRATE), &QObject::deleteLater);
@@ -471,7 +589,16 @@ bool DarkLibrary::cacheDarkFrameFromFile(const QString &filename)
     rc.waitForFinished();
     if (rc.result())
     {
-        m_CachedDarkFrames[filename] = data;
+        // Charged with the full size of the pixels: FITSData converts masters into memory of its own, except for
+        // uncompressed 8 bit masters, which stay mapped but are read whole by the subtraction anyway.
+        const qint64 bytes = static_cast<qint64>(data->samplesPerChannel()) * data->channels() * data->getBytesPerPixel();
+        QMutexLocker locker(&m_CacheMutex);
+        updateCacheBudget();
+        // A master larger than the whole budget is not kept, QCache drops it on insertion.
+        m_CachedDarkFrames.insert(filename, new QSharedPointer<FITSData>(data),
+                                  static_cast<int>(std::min<qint64>(bytes / 1024 + 1, std::numeric_limits<int>::max())));
+        if (darkData)
+            *darkData = data;
     }
     else
     {
@@ -675,6 +802,7 @@ void DarkLibrary::clearAll()
     for (int i = 0; i < darkFramesModel->rowCount(); ++i)
     {
         QString oneFile = darkFramesModel->record(i).value("filename").toString();
+        evictMaster(oneFile);
         QFile::remove(oneFile);
         QString defectMap = darkFramesModel->record(i).value("defectmap").toString();
         if (defectMap.isEmpty() == false)
@@ -699,6 +827,7 @@ void DarkLibrary::clearRow(int index)
     QSqlRecord record = darkFramesModel->record(index);
     QString filename = record.value("filename").toString();
     QString defectMap = record.value("defectmap").toString();
+    evictMaster(filename);
     QFile::remove(filename);
     if (!defectMap.isEmpty())
         QFile::remove(defectMap);
@@ -845,11 +974,18 @@ void DarkLibrary::loadCurrentMasterDark(const QString &camera, int masterIndex)
 void DarkLibrary::loadCurrentMasterDefectMap()
 {
     // Find if we have an existing map
-    if (m_CachedDefectMaps.contains(m_MasterDarkFrameFilename))
+    QSharedPointer<DefectMap> cachedMap;
     {
-        if (m_CurrentDefectMap != m_CachedDefectMaps.value(m_MasterDarkFrameFilename))
+        QMutexLocker locker(&m_CacheMutex);
+        if (auto cached = m_CachedDefectMaps.object(m_MasterDarkFrameFilename))
+            cachedMap = *cached;
+    }
+
+    if (cachedMap)
+    {
+        if (m_CurrentDefectMap != cachedMap)
         {
-            m_CurrentDefectMap = m_CachedDefectMaps.value(m_MasterDarkFrameFilename);
+            m_CurrentDefectMap = cachedMap;
             m_DarkView->setDefectMap(m_CurrentDefectMap);
             m_CurrentDefectMap->setDarkData(m_CurrentDarkFrame);
         }
@@ -1383,7 +1519,11 @@ template <typename T>  void DarkLibrary::generateMasterFrameInternal(const QShar
     map["filename"]    = path;
     map["timestamp"]   = QDateTime::currentDateTime().toString(Qt::ISODate);
 
-    m_DarkFramesDatabaseList.append(map);
+    {
+        QMutexLocker locker(&m_CacheMutex);
+        m_DarkFramesDatabaseList.append(map);
+        rebuildLookupIndex();
+    }
     m_FileLabel->setText(i18n("Master Dark saved to %1", path));
     KStarsData::Instance()->userdb()->AddDarkFrame(map);
 }
@@ -1440,6 +1580,7 @@ void DarkLibrary::saveDefectMap()
 
         if (newFile)
         {
+            QMutexLocker locker(&m_CacheMutex);
             auto currentMap = std::find_if(m_DarkFramesDatabaseList.begin(),
                                            m_DarkFramesDatabaseList.end(), [&](const QVariantMap & oneMap)
             {
@@ -1451,6 +1592,7 @@ void DarkLibrary::saveDefectMap()
                 (*currentMap)["defectmap"] = filename;
                 (*currentMap)["timestamp"] = QDateTime::currentDateTime().toString(Qt::ISODate);
                 KStarsData::Instance()->userdb()->UpdateDarkFrame(*currentMap);
+                rebuildLookupIndex();
             }
         }
     }
@@ -12,7 +12,10 @@
 #include "defectmap.h"
 #include "ekos/ekos.h"
 
+#include <QCache>
 #include <QDialog>
+#include <QHash>
+#include <QMutex>
 #include <QPointer>
 #include "ui_darklibrary.h"
 
@@ -197,9 +200,10 @@ class DarkLibrary : public QDialog, public Ui::DarkLibrary
         /**
          * @brief cacheDarkFrameFromFile Load dark frame from disk and saves it in the local dark frames cache
          * @param filename path of dark frame to load
+         * @param darkData if not null, set to the loaded frame, even if it is too large to be kept in the cache.
          * @return True if file is successfully loaded, false otherwise.
          */
-        bool cacheDarkFrameFromFile(const QString &filename);
+        bool cacheDarkFrameFromFile(const QString &filename, QSharedPointer<FITSData> *darkData = nullptr);
 
 
         ////////////////////////////////////////////////////////////////////////////////////////////////
@@ -232,9 +236,30 @@ class DarkLibrary : public QDialog, public Ui::DarkLibrary
          * @brief cacheDefectMapFromFile Load defect map from disk and saves it in the local defect maps cache
          * @param key dark file name that is used as the key in the defect map cache
          * @param filename path of dark frame to load
+         * @param defectMap if not null, set to the loaded map, even if it is too large to be kept in the cache.
          * @return True if file is successfully loaded, false otherwise.
          */
-        bool cacheDefectMapFromFile(const QString &key, const QString &filename);
+        bool cacheDefectMapFromFile(const QString &key, const QString &filename, QSharedPointer<DefectMap> *defectMap = nullptr);
+
+        ////////////////////////////////////////////////////////////////////////////////////////////////
+        /// Lookup Index & Cache Functions
+        ////////////////////////////////////////////////////////////////////////////////////////////////
+        /**
+         * @brief rebuildLookupIndex Groups the database rows by camera, chip and binning, and forgets previous lookups.
+         * Must be called with m_CacheMutex held whenever m_DarkFramesDatabaseList changes.
+         */
+        void rebuildLookupIndex();
+        static QString lookupBucket(const QString &camera, int chip, int binX, int binY);
+        /**
+         * @brief updateCacheBudget Sets the cache limits from CACHE_BUDGET_MB and the RAM available now.
+         * Must be called with m_CacheMutex held.
+         */
+        void updateCacheBudget();
+        /**
+         * @brief evictMaster Drops the cached dark and defect map of a master before its files are removed.
+         * Cached masters are file mappings, which would keep the file busy.
+         */
+        void evictMaster(const QString &filename);
 
         ////////////////////////////////////////////////////////////////////
         /// Settings
@@ -279,8 +304,15 @@ class DarkLibrary : public QDialog, public Ui::DarkLibrary
         ////////////////////////////////////////////////////////////////////////////////////////////////
 
         QList<QVariantMap> m_DarkFramesDatabaseList;
-        QMap<QString, QSharedPointer<FITSData>> m_CachedDarkFrames;
-        QMap<QString, QSharedPointer<DefectMap>> m_CachedDefectMaps;
+        // Loaded masters keyed by dark file name, the least recently used are dropped when over budget. Costs are in KiB.
+        QCache<QString, QSharedPointer<FITSData>> m_CachedDarkFrames;
+        QCache<QString, QSharedPointer<DefectMap>> m_CachedDefectMaps;
+        // Rows of m_DarkFramesDatabaseList by lookupBucket().
+        QHash<QString, QVector<int>> m_DarkFramesIndex;
+        // Best row for each set of quantized camera settings, -1 if no row matches.
+        QHash<QString, int> m_DarkFrameLookup, m_DefectMapLookup;
+        // Darks are looked up from the processing threads while the dialog updates the database.
+        QMutex m_CacheMutex;
 
         ISD::Camera *m_Camera {nullptr};
         ISD::CameraChip *m_TargetChip {nullptr};
@@ -313,5 +345,7 @@ class DarkLibrary : public QDialog, public Ui::DarkLibrary
 
         // Do not add to cache if system memory falls below 250MB.
         static constexpr uint16_t CACHE_MEMORY_LIMIT {250};
+        // Keep up to 1GB of master darks in memory, or half of the available RAM if less.
+        static constexpr uint32_t CACHE_BUDGET_MB {1024};
 };
 }
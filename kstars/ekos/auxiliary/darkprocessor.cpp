@@ -8,8 +8,6 @@
 #include "darklibrary.h"
 #include "ekos/auxiliary/opticaltrainsettings.h"
 
-#include <array>
-
 #include "ekos_debug.h"
 
 namespace Ekos
@@ -76,114 +74,55 @@ template <typename T>
 void DarkProcessor::normalizeDefectsInternal(const QSharedPointer<DefectMap> &defectMap,
         const QSharedPointer<FITSData> &lightData, uint16_t offsetX, uint16_t offsetY)
 {
-
     T *lightBuffer = reinterpret_cast<T *>(lightData->getWritableImageBuffer());
     const uint32_t width = lightData->width();
+    const uint32_t height = lightData->height();
 
-    // Account for offset X and Y
-    // e.g. if we send a subframed light frame 100x100 pixels wide
-    // but the source defect map covers 1000x1000 pixels array, then we need to only compensate
-    // for the 100x100 region.
-    for (BadPixelSet::const_iterator onePixel = defectMap->hotThreshold();
-            onePixel != defectMap->hotPixels().cend(); ++onePixel)
-    {
-        const uint16_t x = (*onePixel).x;
-        const uint16_t y = (*onePixel).y;
-
-        if (x <= offsetX || y <= offsetY)
-            continue;
-
-        uint32_t offset = (x - offsetX) + (y - offsetY) * width;
-
-        lightBuffer[offset] = median3x3Filter(x - offsetX, y - offsetY, width, lightBuffer);
-    }
-
-    for (BadPixelSet::const_iterator onePixel = defectMap->coldPixels().cbegin();
-            onePixel != defectMap->coldThreshold(); ++onePixel)
-    {
-        const uint16_t x = (*onePixel).x;
-        const uint16_t y = (*onePixel).y;
-
-        if (x <= offsetX || y <= offsetY)
-            continue;
-
-        uint32_t offset = (x - offsetX) + (y - offsetY) * width;
-
-        lightBuffer[offset] = median3x3Filter(x - offsetX, y - offsetY, width, lightBuffer);
-    }
+    // The defect map keeps the list of pixels to fix for this frame geometry, so it is only built
+    // once for a series of frames.
+    DarkCalibration::correctDefects(lightBuffer, width, *defectMap->defectIndexes(width, height, offsetX, offsetY));
 
     lightData->calculateStats(true);
-
-}
-
-///////////////////////////////////////////////////////////////////////////////////////
-///
-///////////////////////////////////////////////////////////////////////////////////////
-template <typename T>
-T DarkProcessor::median3x3Filter(uint16_t x, uint16_t y, uint32_t width, T *buffer)
-{
-    T *top = buffer + (y - 1) * width + (x - 1);
-    T *mid = buffer + (y - 0) * width + (x - 1);
-    T *bot = buffer + (y + 1) * width + (x - 1);
-
-    std::array<T, 8> elements;
-
-    // Top
-    elements[0] = *(top + 0);
-    elements[1] = *(top + 1);
-    elements[2] = *(top + 2);
-    // Mid
-    elements[3] = *(mid + 0);
-    // Mid+1 is the defective value, so we skip and go for + 2
-    elements[4] = *(mid + 2);
-    // Bottom
-    elements[5] = *(bot + 0);
-    elements[6] = *(bot + 1);
-    elements[7] = *(bot + 2);
-
-    std::sort(elements.begin(), elements.end());
-    auto median = (elements[3] + elements[4]) / 2;
-    return median;
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////
 void DarkProcessor::subtractDarkData(const QSharedPointer<FITSData> &darkData, const QSharedPointer<FITSData> &lightData,
-                                     uint16_t offsetX, uint16_t offsetY)
+                                     uint16_t offsetX, uint16_t offsetY, const DarkCalibration::Scaling &scaling)
 {
     switch (darkData->dataType())
     {
         case TBYTE:
-            subtractInternal<uint8_t>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<uint8_t>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TSHORT:
-            subtractInternal<int16_t>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<int16_t>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TUSHORT:
-            subtractInternal<uint16_t>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<uint16_t>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TLONG:
-            subtractInternal<int32_t>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<int32_t>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TULONG:
-            subtractInternal<uint32_t>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<uint32_t>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TFLOAT:
-            subtractInternal<float>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<float>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TLONGLONG:
-            subtractInternal<int64_t>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<int64_t>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         case TDOUBLE:
-            subtractInternal<double>(darkData, lightData, offsetX, offsetY);
+            subtractInternal<double>(darkData, lightData, offsetX, offsetY, scaling);
             break;
 
         default:
@@ -196,7 +135,7 @@ void DarkProcessor::subtractDarkData(const QSharedPointer<FITSData> &darkData, c
 ///////////////////////////////////////////////////////////////////////////////////////
 template <typename T>
 void DarkProcessor::subtractInternal(const QSharedPointer<FITSData> &darkData, const QSharedPointer<FITSData> &lightData,
-                                     uint16_t offsetX, uint16_t offsetY)
+                                     uint16_t offsetX, uint16_t offsetY, const DarkCalibration::Scaling &scaling)
 {
     const uint32_t width = lightData->width();
     const uint32_t height = lightData->height();
@@ -206,14 +145,7 @@ void DarkProcessor::subtractInternal(const QSharedPointer<FITSData> &darkData, c
     const uint32_t darkoffset = offsetX + offsetY * darkStride;
     T const *darkBuffer  = reinterpret_cast<T const*>(darkData->getImageBuffer()) + darkoffset;
 
-    for (uint32_t y = 0; y < height; y++)
-    {
-        for (uint32_t x = 0; x < width; x++)
-            lightBuffer[x] = (lightBuffer[x] > darkBuffer[x]) ? (lightBuffer[x] - darkBuffer[x]) : 0;
-
-        lightBuffer += width;
-        darkBuffer += darkStride;
-    }
+    DarkCalibration::subtract(lightBuffer, width, height, darkBuffer, darkStride, scaling);
 
     lightData->calculateStats(true);
 }
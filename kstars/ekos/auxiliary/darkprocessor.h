@@ -8,6 +8,7 @@
 
 #include "indi/indicamera.h"
 #include "indi/indidustcap.h"
+#include "darkcalibration.h"
 #include "darkview.h"
 #include "defectmap.h"
 #include "ekos/ekos.h"
@@ -60,9 +61,11 @@ class DarkProcessor : public QObject
         * @param lightData passes list frame data to templerated subtract function.
         * @param offsetX passes offsetX to templerated subtract function.
         * @param offsetY passes offsetY to templerated subtract function.
+        * @param scaling dark scale and bias level, the dark is subtracted as is by default.
         */
         void subtractDarkData(const QSharedPointer<FITSData> &darkData, const QSharedPointer<FITSData> &lightData,
-                              uint16_t offsetX, uint16_t offsetY);
+                              uint16_t offsetX, uint16_t offsetY,
+                              const DarkCalibration::Scaling &scaling = DarkCalibration::Scaling());
 
         /**
         * @brief subtract Subtracts dark pixels from light pixels given the supplied parameters
@@ -70,10 +73,11 @@ class DarkProcessor : public QObject
         * @param lightData Light frame data. The light frame data is modified in this process.
         * @param offsetX Only apply subtraction beyond offsetX in X-axis.
         * @param offsetY Only apply subtraction beyond offsetY in Y-axis.
+        * @param scaling Dark scale and bias level.
         */
         template <typename T>
         void subtractInternal(const QSharedPointer<FITSData> &darkData, const QSharedPointer<FITSData> &lightData,
-                              uint16_t offsetX, uint16_t offsetY);
+                              uint16_t offsetX, uint16_t offsetY, const DarkCalibration::Scaling &scaling);
 
         ////////////////////////////////////////////////////////////////////////////////////////////////
         /// Defect Map Functions
@@ -94,9 +98,6 @@ class DarkProcessor : public QObject
         void normalizeDefectsInternal(const QSharedPointer<DefectMap> &defectMap, const QSharedPointer<FITSData> &lightData,
                                       uint16_t offsetX, uint16_t offsetY);
 
-        template <typename T>
-        T median3x3Filter(uint16_t x, uint16_t y, uint32_t width, T *buffer);
-
     signals:
         void darkFrameCompleted(bool);
         void newLog(const QString &message);
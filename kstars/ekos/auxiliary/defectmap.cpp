@@ -7,6 +7,8 @@
 #include "defectmap.h"
 #include <QJsonDocument>
 
+#include <algorithm>
+
 //////////////////////////////////////////////////////////////////////////////
 ///
 //////////////////////////////////////////////////////////////////////////////
@@ -74,6 +76,7 @@ bool DefectMap::load(const QString &filename)
     }
 
     m_ColdPixelsCount = m_ColdPixels.size();
+    clearDefectIndexes();
     return true;
 }
 
@@ -264,6 +267,7 @@ void DefectMap::filterPixels()
     else
         m_ColdPixelsCount = std::distance(m_ColdPixels.cbegin(), m_ColdPixelsThreshold);
 
+    clearDefectIndexes();
     emit pixelsUpdated(m_HotPixelsCount, m_ColdPixelsCount);
 }
 
@@ -273,6 +277,7 @@ void DefectMap::filterPixels()
 void DefectMap::setHotEnabled(bool enabled)
 {
     m_HotEnabled = enabled;
+    clearDefectIndexes();
     emit pixelsUpdated(m_HotEnabled ? m_HotPixelsCount : 0, m_ColdPixelsCount);
 }
 
@@ -282,5 +287,53 @@ void DefectMap::setHotEnabled(bool enabled)
 void DefectMap::setColdEnabled(bool enabled)
 {
     m_ColdEnabled = enabled;
+    clearDefectIndexes();
     emit pixelsUpdated(m_HotPixelsCount, m_ColdEnabled ? m_ColdPixelsCount : 0);
 }
+
+//////////////////////////////////////////////////////////////////////////////
+///
+//////////////////////////////////////////////////////////////////////////////
+std::shared_ptr<const std::vector<uint32_t>> DefectMap::defectIndexes(uint32_t width, uint32_t height, uint16_t offsetX,
+        uint16_t offsetY) const
+{
+    QMutexLocker locker(&m_DefectIndexesMutex);
+
+    const std::vector<uint32_t> geometry {width, height, offsetX, offsetY};
+    if (m_DefectIndexes && geometry == m_DefectIndexesGeometry)
+        return m_DefectIndexes;
+
+    // A new list is built, as the previous one may still be in use by a frame being corrected.
+    auto indexes = std::make_shared<std::vector<uint32_t>>();
+    indexes->reserve((m_HotEnabled ? m_HotPixelsCount : 0) + (m_ColdEnabled ? m_ColdPixelsCount : 0));
+    auto add = [&](const BadPixel & onePixel)
+    {
+        // Account for offset X and Y
+        // e.g. if we send a subframed light frame 100x100 pixels wide
+        // but the source defect map covers 1000x1000 pixels array, then we need to only compensate
+        // for the 100x100 region.
+        const int64_t x = static_cast<int64_t>(onePixel.x) - offsetX;
+        const int64_t y = static_cast<int64_t>(onePixel.y) - offsetY;
+        if (x < 1 || y < 1 || x + 1 >= width || y + 1 >= height)
+            return;
+        indexes->push_back(static_cast<uint32_t>(x + y * width));
+    };
+    std::for_each(hotThreshold(), m_HotPixels.cend(), add);
+    std::for_each(m_ColdPixels.cbegin(), coldThreshold(), add);
+
+    std::sort(indexes->begin(), indexes->end());
+    indexes->erase(std::unique(indexes->begin(), indexes->end()), indexes->end());
+    m_DefectIndexes = std::move(indexes);
+    m_DefectIndexesGeometry = geometry;
+    return m_DefectIndexes;
+}
+
+//////////////////////////////////////////////////////////////////////////////
+///
+//////////////////////////////////////////////////////////////////////////////
+void DefectMap::clearDefectIndexes()
+{
+    QMutexLocker locker(&m_DefectIndexesMutex);
+    m_DefectIndexes.reset();
+    m_DefectIndexesGeometry.clear();
+}
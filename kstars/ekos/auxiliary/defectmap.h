@@ -6,9 +6,12 @@
 
 #pragma once
 
+#include <memory>
 #include <set>
+#include <vector>
 #include <QJsonObject>
 #include <QJsonArray>
+#include <QMutex>
 
 #include "fitsviewer/fitsdata.h"
 
@@ -90,6 +93,17 @@ class DefectMap : public QObject
             return m_ColdPixelsCount;
         }
 
+        /**
+         * @brief defectIndexes Returns the enabled hot and cold pixels as sample indexes in a light frame.
+         * Only pixels with all their 8 neighbors in the frame are listed. The list is built once and kept
+         * until the pixels, their thresholds or the light frame geometry change.
+         * @param width, height light frame dimensions.
+         * @param offsetX, offsetY position of the light frame on the sensor, for subframes.
+         * @return indexes in increasing order, shared with the cache rather than copied for each frame.
+         */
+        std::shared_ptr<const std::vector<uint32_t>> defectIndexes(uint32_t width, uint32_t height, uint16_t offsetX,
+                uint16_t offsetY) const;
+
         void filterPixels();
     signals:
         //        void hotPixelsUpdated(const BadPixelSet::const_iterator &start, const BadPixelSet::const_iterator &end);
@@ -102,6 +116,7 @@ class DefectMap : public QObject
         double calculateSigma(uint8_t aggressiveness);
         template <typename T>
         void initBadPixelsInternal(double hotPixelThreshold, double coldPixelThreshold);
+        void clearDefectIndexes();
 
         BadPixelSet m_ColdPixels, m_HotPixels;
         BadPixelSet::const_iterator m_ColdPixelsThreshold, m_HotPixelsThreshold;
@@ -114,5 +129,10 @@ class DefectMap : public QObject
 
         QSharedPointer<FITSData> m_DarkData;
 
+        // Cache of defectIndexes(), for the frame geometry it was built for.
+        mutable QMutex m_DefectIndexesMutex;
+        mutable std::shared_ptr<const std::vector<uint32_t>> m_DefectIndexes;
+        mutable std::vector<uint32_t> m_DefectIndexesGeometry;
+
 };
 
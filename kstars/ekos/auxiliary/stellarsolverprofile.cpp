@@ -7,8 +7,15 @@
 
 #include "stellarsolverprofile.h"
 
+#include "kspaths.h"
+
 #include <stellarsolver.h>
 #include <KLocalizedString>
+#include <QDateTime>
+#include <QDir>
+#include <QFileInfo>
+#include <QHash>
+#include <QMutex>
 
 namespace Ekos
 {
@@ -298,4 +305,72 @@ QList<Parameters> getDefaultHFROptionsProfiles()
     return profileList;
 }
 
+namespace
+{
+// Saved profiles of one group, with the state of their file when they were read.
+struct CachedProfiles
+{
+    QDateTime lastModified;
+    qint64 size { -1 };
+    QList<Parameters> profiles;
+};
+
+QString savedProfilesFile(ProfileGroup group)
+{
+    switch (group)
+    {
+        case AlignProfiles:
+            return "SavedAlignProfiles.ini";
+        case FocusProfiles:
+            return "SavedFocusProfiles.ini";
+        case GuideProfiles:
+            return "SavedGuideProfiles.ini";
+        case HFRProfiles:
+            return "SavedHFRProfiles.ini";
+    }
+    return QString();
+}
+
+QList<Parameters> getDefaultOptionsProfiles(ProfileGroup group)
+{
+    switch (group)
+    {
+        case AlignProfiles:
+            return getDefaultAlignOptionsProfiles();
+        case FocusProfiles:
+            return getDefaultFocusOptionsProfiles();
+        case GuideProfiles:
+            return getDefaultGuideOptionsProfiles();
+        case HFRProfiles:
+            return getDefaultHFROptionsProfiles();
+    }
+    return QList<Parameters>();
+}
+}
+
+QList<Parameters> getOptionsProfiles(ProfileGroup group)
+{
+    static QMutex mutex;
+    static QHash<int, CachedProfiles> cache;
+
+    // The profile editors rewrite the whole file when saving, so comparing its modification
+    // time and size is enough to know whether the cached profiles are still current.
+    const QFileInfo info(QDir(KSPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath(savedProfilesFile(group)));
+    const bool exists = info.exists();
+    const QDateTime lastModified = exists ? info.lastModified() : QDateTime();
+    const qint64 size = exists ? info.size() : -1;
+
+    QMutexLocker locker(&mutex);
+    auto cached = cache.find(group);
+    if (cached != cache.end() && cached->lastModified == lastModified && cached->size == size)
+        return cached->profiles;
+
+    CachedProfiles profiles;
+    profiles.lastModified = lastModified;
+    profiles.size = size;
+    profiles.profiles = exists ? StellarSolver::loadSavedOptionsProfiles(info.filePath()) : getDefaultOptionsProfiles(group);
+    cache[group] = profiles;
+    return profiles.profiles;
+}
+
 }
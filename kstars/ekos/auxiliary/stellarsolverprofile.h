@@ -48,4 +48,11 @@ QList<SSolver::Parameters> getDefaultAlignOptionsProfiles();
 QList<SSolver::Parameters> getDefaultHFROptionsProfiles();
 SSolver::Parameters getFocusOptionsProfileDefault();
 SSolver::Parameters getFocusOptionsProfileDefaultDonut();
+
+/**
+ * @brief getOptionsProfiles Returns the profiles saved for the group, or its default profiles if none were saved.
+ * The saved profiles are cached, and only read again from disk when their file changes.
+ * @note Thread safe, meant for callers that need the profiles for every frame (guiding, focusing).
+ */
+QList<SSolver::Parameters> getOptionsProfiles(ProfileGroup group);
 }
@@ -187,6 +187,7 @@ enum COMMANDS
 
     // Storage Options
     SET_BLOBS,
+    SET_IMAGE_PROFILE,
 
     // DSLRs
     DSLR_GET_INFO,
@@ -412,6 +413,7 @@ static QMap<COMMANDS, QString> const commands =
     {OPTION_GET, "option_get"},
 
     {SET_BLOBS, "set_blobs"},
+    {SET_IMAGE_PROFILE, "set_image_profile"},
 
     {DSLR_GET_INFO, "dslr_get_info"},
     {DSLR_SET_INFO, "dslr_set_info"},
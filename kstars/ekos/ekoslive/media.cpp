@@ -90,6 +90,9 @@ void Media::onDisconnected()
 
     qCInfo(KSTARS_EKOS) << "Disconnected from Message Websocket server at" << node->url().toDisplayString();
 
+    // Clients send their image profile again when they connect.
+    m_ImageProfiles.remove(node);
+
     if (isConnected() == false)
     {
         m_sendBlobs = true;
@@ -124,6 +127,18 @@ void Media::onTextReceived(const QString &message)
         extension = payload["ext"].toString();
     else if (command == commands[SET_BLOBS])
         m_sendBlobs = msgObj["payload"].toBool();
+    // Smaller or lower quality images for clients on slow links
+    else if (command == commands[SET_IMAGE_PROFILE])
+    {
+        auto node = qobject_cast<Node*>(sender());
+        if (node)
+        {
+            ImageProfile profile;
+            profile.width = qBound(0, payload["width"].toInt(0), static_cast<int>(HB_IMAGE_WIDTH));
+            profile.quality = qBound(0, payload["quality"].toInt(0), 100);
+            m_ImageProfiles[node] = profile;
+        }
+    }
     // Get a list of object based on criteria
     else if (command == commands[ASTRO_GET_OBJECTS_IMAGE])
     {
@@ -287,10 +302,10 @@ void Media::sendData(const QSharedPointer<FITSData> &data, const QString &uuid)
     if (Options::ekosLiveImageTransfer() == false || m_sendBlobs == false || isConnected() == false)
         return;
 
+    const Targets imageTargets = targets(uuid);
     StretchParams params;
-    QImage image;
-    stretch(data, image, params);
-    upload(data, image, params, uuid);
+    QImage image = render(data, maxWidth(imageTargets), params);
+    upload(data, image, params, uuid, imageTargets);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -304,9 +319,9 @@ void Media::sendFile(const QString &filename, const QString &uuid)
     QSharedPointer<FITSData> data(new FITSData());
     data->loadFromFile(filename);
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    QtConcurrent::run(&Media::dispatch, this, data, uuid);
+    QtConcurrent::run(&Media::dispatch, this, data, uuid, targets(uuid));
 #else
-    QtConcurrent::run(this, &Media::dispatch, data, uuid);
+    QtConcurrent::run(this, &Media::dispatch, data, uuid, targets(uuid));
 #endif
 }
 
@@ -324,33 +339,32 @@ void Media::sendView(const QSharedPointer<FITSView> &view, const QString &uuid)
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////////
-void Media::dispatch(const QSharedPointer<FITSData> &data, const QString &uuid)
+void Media::dispatch(const QSharedPointer<FITSData> &data, const QString &uuid, const Targets &targets)
 {
-    QSharedPointer<FITSView> previewImage(new FITSView());
-    previewImage->loadData(data);
-    upload(previewImage, uuid);
+    StretchParams params;
+    QImage image = render(data, maxWidth(targets), params);
+    upload(data, image, params, uuid, targets);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////////
-void Media::stretch(const QSharedPointer<FITSData> &data, QImage &image, StretchParams &params) const
+QImage Media::render(const QSharedPointer<FITSData> &data, int width, StretchParams &params)
 {
-    double min = 0, max = 0;
-    data->getMinMax(&min, &max);
-    auto width = data->width();
-    auto height = data->height();
-    auto channels = data->channels();
-    auto dataType = data->dataType();
-
-    if (min == max)
-    {
-        image.fill(Qt::white);
-    }
+    const int dataWidth = data->width();
+    const int dataHeight = data->height();
+    const int channels = data->channels();
+
+    // Whole sampling steps keep the image at least as wide as the widest client, it is only
+    // scaled down from there.
+    const int sampling = (width > 0) ? std::max(1, dataWidth / width) : 1;
+    const int imageWidth = (dataWidth + sampling - 1) / sampling;
+    const int imageHeight = (dataHeight + sampling - 1) / sampling;
 
+    QImage image;
     if (channels == 1)
     {
-        image = QImage(width, height, QImage::Format_Indexed8);
+        image = QImage(imageWidth, imageHeight, QImage::Format_Indexed8);
 
         image.setColorCount(256);
         for (int i = 0; i < 256; i++)
@@ -358,15 +372,99 @@ void Media::stretch(const QSharedPointer<FITSData> &data, QImage &image, Stretch
     }
     else
     {
-        image = QImage(width, height, QImage::Format_RGB32);
+        image = QImage(imageWidth, imageHeight, QImage::Format_RGB32);
     }
 
-    Stretch stretch(width, height, channels, dataType);
+    Stretch stretch(dataWidth, dataHeight, channels, data->dataType());
 
-    // Compute new auto-stretch params.
-    params = stretch.computeParams(data->getImageBuffer());
+    // Compute new auto-stretch params, reusing the median and MAD from the image statistics.
+    double median[3], mad[3];
+    data->getMedianAndMAD(median, mad);
+    params = stretch.computeParams(data->getImageBuffer(), median, mad);
     stretch.setParams(params);
-    stretch.run(data->getImageBuffer(), &image, 1);
+    stretch.run(data->getImageBuffer(), &image, sampling);
+    return image;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////////
+ImageProfile Media::imageProfile(Node *node, const QString &uuid) const
+{
+    // For low bandwidth images, and module frames such as dark frames +D
+    const bool fastImage = (!Options::ekosLiveHighBandwidth() || uuid.startsWith('+'));
+
+    ImageProfile profile;
+    profile.width = fastImage ? HB_IMAGE_WIDTH / 2 : HB_IMAGE_WIDTH;
+    profile.quality = HB_IMAGE_QUALITY;
+    profile.fast = fastImage;
+
+    // Clients may only ask for less than the defaults.
+    const ImageProfile requested = m_ImageProfiles.value(node);
+    if (requested.width > 0)
+        profile.width = std::min(profile.width, requested.width);
+    if (requested.quality > 0)
+        profile.quality = std::min(profile.quality, requested.quality);
+
+    return profile;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////////
+Media::Targets Media::targets(const QString &uuid) const
+{
+    Targets imageTargets;
+    for (auto &nodeManager : m_NodeManagers)
+    {
+        auto node = nodeManager->media();
+        if (!node->isConnected())
+            continue;
+
+        const ImageProfile profile = imageProfile(node, uuid);
+        auto target = std::find_if(imageTargets.begin(), imageTargets.end(), [&profile](const Target & oneTarget)
+        {
+            return oneTarget.profile == profile;
+        });
+        if (target == imageTargets.end())
+            imageTargets.append({profile, {node}});
+        else
+            target->nodes.append(node);
+    }
+    return imageTargets;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////////
+uint16_t Media::maxWidth(const Targets &targets)
+{
+    uint16_t width = 0;
+    for (const auto &target : targets)
+        width = std::max(width, target.profile.width);
+    return width;
+}
+
+///////////////////////////////////////////////////////////////////////////////////////////
+///
+///////////////////////////////////////////////////////////////////////////////////////////
+void Media::send(const QImage &image, const QByteArray &meta, const Targets &targets)
+{
+    for (const auto &target : targets)
+    {
+        // Encoded once for all the clients with the same profile
+        const QByteArray data = m_Encoder.encode(image, meta, target.profile);
+
+        // Sockets are only used from the GUI thread.
+        QMetaObject::invokeMethod(this, [data, nodes = target.nodes]()
+        {
+            for (auto &node : nodes)
+            {
+                if (node)
+                    node->sendBinaryMessage(data);
+            }
+        }, Qt::QueuedConnection);
+    }
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -374,11 +472,11 @@ void Media::stretch(const QSharedPointer<FITSData> &data, QImage &image, Stretch
 ///////////////////////////////////////////////////////////////////////////////////////////
 void Media::upload(const QSharedPointer<FITSView> &view, const QString &uuid)
 {
-    const QString ext = "jpg";
-    QByteArray jpegData;
-    QBuffer buffer(&jpegData);
-    buffer.open(QIODevice::WriteOnly);
+    const Targets imageTargets = targets(uuid);
+    if (imageTargets.isEmpty())
+        return;
 
+    const QString ext = "jpg";
     const QSharedPointer<FITSData> imageData = view->imageData();
     QString resolution = QString("%1x%2").arg(imageData->width()).arg(imageData->height());
     QString sizeBytes = KFormat().formatByteSize(imageData->size());
@@ -429,34 +527,27 @@ void Media::upload(const QSharedPointer<FITSView> &view, const QString &uuid)
     // the rest to the image data.
     QByteArray meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);
     meta = meta.leftJustified(METADATA_PACKET, 0);
-    buffer.write(meta);
-
-    auto fastImage = (!Options::ekosLiveHighBandwidth() || uuid[0] == '+');
-    auto scaleWidth = fastImage ? HB_IMAGE_WIDTH / 2 : HB_IMAGE_WIDTH;
 
-    // For low bandwidth images
-    // Except for dark frames +D
-    QPixmap scaledImage = view->getDisplayPixmap().width() > scaleWidth ?
-                          view->getDisplayPixmap().scaledToWidth(scaleWidth, fastImage ? Qt::FastTransformation : Qt::SmoothTransformation) :
-                          view->getDisplayPixmap();
-    scaledImage.save(&buffer, ext.toLatin1().constData(), HB_IMAGE_QUALITY);
-
-    buffer.close();
-
-    emit newImage(jpegData);
+    // Scaled once to the widest client, then to each profile.
+    const QPixmap &pixmap = view->getDisplayPixmap();
+    const uint16_t scaleWidth = maxWidth(imageTargets);
+    const bool fastImage = std::all_of(imageTargets.begin(), imageTargets.end(), [](const Target & oneTarget)
+    {
+        return oneTarget.profile.fast;
+    });
+    QImage image = pixmap.width() > scaleWidth ?
+                   pixmap.scaledToWidth(scaleWidth, fastImage ? Qt::FastTransformation : Qt::SmoothTransformation).toImage() :
+                   pixmap.toImage();
+    send(image, meta, imageTargets);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
 ///
 ///////////////////////////////////////////////////////////////////////////////////////////
 void Media::upload(const QSharedPointer<FITSData> &data, const QImage &image, const StretchParams &params,
-                   const QString &uuid)
+                   const QString &uuid, const Targets &targets)
 {
     const QString ext = "jpg";
-    QByteArray jpegData;
-    QBuffer buffer(&jpegData);
-    buffer.open(QIODevice::WriteOnly);
-
     QString resolution = QString("%1x%2").arg(data->width()).arg(data->height());
     QString sizeBytes = KFormat().formatByteSize(data->size());
     QVariant xbin(1), ybin(1), exposure(0), focal_length(0), gain(0), pixel_size(0), aperture(0);
@@ -503,21 +594,8 @@ void Media::upload(const QSharedPointer<FITSData> &data, const QImage &image, co
     // the rest to the image data.
     QByteArray meta = QJsonDocument(metadata).toJson(QJsonDocument::Compact);
     meta = meta.leftJustified(METADATA_PACKET, 0);
-    buffer.write(meta);
-
-    auto fastImage = (!Options::ekosLiveHighBandwidth() || uuid[0] == '+');
-    auto scaleWidth = fastImage ? HB_IMAGE_WIDTH / 2 : HB_IMAGE_WIDTH;
 
-    // For low bandwidth images
-    // Except for dark frames +D
-    QImage scaledImage = image.width() > scaleWidth ?
-                         image.scaledToWidth(scaleWidth, fastImage ? Qt::FastTransformation : Qt::SmoothTransformation) :
-                         image;
-    scaledImage.save(&buffer, ext.toLatin1().constData(), HB_IMAGE_QUALITY);
-
-    buffer.close();
-
-    emit newImage(jpegData);
+    send(image, meta, targets);
 }
 
 ///////////////////////////////////////////////////////////////////////////////////////////
@@ -12,6 +12,7 @@
 #include <memory>
 
 #include "ekos/manager.h"
+#include "mediaencoder.h"
 #include "nodemanager.h"
 
 class FITSView;
@@ -77,11 +78,32 @@ class Media : public QObject
         void uploadImage(const QByteArray &image);
 
     private:
-        void dispatch(const QSharedPointer<FITSData> &data, const QString &uuid);
+        // Clients getting the same image
+        struct Target
+        {
+            ImageProfile profile;
+            QVector<QPointer<Node>> nodes;
+        };
+        using Targets = QVector<Target>;
+
+        ImageProfile imageProfile(Node *node, const QString &uuid) const;
+        Targets targets(const QString &uuid) const;
+        static uint16_t maxWidth(const Targets &targets);
+
+        void dispatch(const QSharedPointer<FITSData> &data, const QString &uuid, const Targets &targets);
         void upload(const QSharedPointer<FITSView> &view, const QString &uuid);
 
-        void upload(const QSharedPointer<FITSData> &data, const QImage &image, const StretchParams &params, const QString &uuid);
-        void stretch(const QSharedPointer<FITSData> &data, QImage &image, StretchParams &params) const;
+        void upload(const QSharedPointer<FITSData> &data, const QImage &image, const StretchParams &params, const QString &uuid,
+                    const Targets &targets);
+        void send(const QImage &image, const QByteArray &meta, const Targets &targets);
+
+        /**
+         * @brief render Stretches the image data straight into a display image about width pixels wide.
+         * The data is sampled down by the stretch, the image is never built at full resolution.
+         * @param width target width, the image is at least as wide unless the data is narrower.
+         * @param params auto stretch parameters computed for the data.
+         */
+        static QImage render(const QSharedPointer<FITSData> &data, int width, StretchParams &params);
 
         Ekos::Manager * m_Manager { nullptr };
         QVector<QSharedPointer<NodeManager>> m_NodeManagers;
@@ -91,6 +113,10 @@ class Media : public QObject
 
         bool m_sendBlobs { true};
 
+        // Image size and quality requested by the clients, 0 for the defaults.
+        QHash<Node *, ImageProfile> m_ImageProfiles;
+        MediaEncoder m_Encoder;
+
         // Image width for high-bandwidth setting
         static const uint16_t HB_IMAGE_WIDTH = 1920;
         // Video width for high-bandwidth setting
@@ -0,0 +1,39 @@
+/*  Media Encoder
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "mediaencoder.h"
+
+namespace EkosLive
+{
+
+MediaEncoder::MediaEncoder()
+{
+    // Reserved capacity is kept when the buffer is truncated.
+    m_Data.reserve(INITIAL_CAPACITY);
+    m_Buffer.setBuffer(&m_Data);
+    m_Writer.setDevice(&m_Buffer);
+    m_Writer.setFormat("jpg");
+}
+
+QByteArray MediaEncoder::encode(const QImage &image, const QByteArray &meta, const ImageProfile &profile)
+{
+    const QImage scaledImage = image.width() > profile.width ?
+                               image.scaledToWidth(profile.width, profile.fast ? Qt::FastTransformation : Qt::SmoothTransformation) :
+                               image;
+
+    QMutexLocker locker(&m_Mutex);
+
+    m_Data.truncate(0);
+    m_Buffer.open(QIODevice::WriteOnly);
+    m_Buffer.write(meta);
+    m_Writer.setQuality(profile.quality);
+    m_Writer.write(scaledImage);
+    m_Buffer.close();
+
+    // The buffer is reused, the caller gets its own copy.
+    return QByteArray(m_Data.constData(), m_Data.size());
+}
+
+}
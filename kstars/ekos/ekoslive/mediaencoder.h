@@ -0,0 +1,61 @@
+/*  Media Encoder
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QBuffer>
+#include <QByteArray>
+#include <QImage>
+#include <QImageWriter>
+#include <QMutex>
+
+namespace EkosLive
+{
+
+/** Width and JPEG quality of the images sent to a client. */
+struct ImageProfile
+{
+    uint16_t width { 0 };
+    uint8_t quality { 0 };
+    /** Fast scaling, for module frames and low bandwidth. */
+    bool fast { false };
+
+    bool operator==(const ImageProfile &other) const
+    {
+        return width == other.width && quality == other.quality && fast == other.fast;
+    }
+};
+
+/**
+ * @brief Encodes the frames sent to the EkosLive clients.
+ *
+ * A frame is scaled and encoded once per distinct profile, and the same bytes go to every client
+ * using that profile. The writer and its output buffer are kept from one frame to the next, so the
+ * buffer does not grow again for every frame. Frames may be encoded from several threads.
+ */
+class MediaEncoder
+{
+    public:
+        MediaEncoder();
+
+        /**
+         * @brief encode Scales the image down to the width of the profile and encodes it as JPEG.
+         * @param image frame, not scaled up when narrower than the profile
+         * @param meta metadata packet written before the image
+         * @return metadata followed by the JPEG data
+         */
+        QByteArray encode(const QImage &image, const QByteArray &meta, const ImageProfile &profile);
+
+    private:
+        /** About one high bandwidth frame. */
+        static constexpr int INITIAL_CAPACITY = 1024 * 1024;
+
+        QMutex m_Mutex;
+        QByteArray m_Data;
+        QBuffer m_Buffer;
+        QImageWriter m_Writer;
+};
+
+}
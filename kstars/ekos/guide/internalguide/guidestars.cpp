@@ -12,6 +12,8 @@
 #include "fitsviewer/fitssepdetector.h"
 #include "Options.h"
 
+#include <algorithm>
+#include <cmath>
 #include <math.h>
 #include <stellarsolver.h>
 #include "ekos/auxiliary/stellarsolverprofileeditor.h"
@@ -33,6 +35,10 @@
 // margin below (e.g. if a guide star was selected that was near the max guide-star hfr, the later
 // the hfr increased a little, we still want to be able to find it.
 constexpr double HFR_MARGIN = 2.0;
+
+// When guiding, stars are extracted in windows at least this many pixels on each side of
+// where they are expected.
+constexpr int MIN_REGION_HALF_SIZE = 32;
 /*
  Start with a set of reference (x,y) positions from stars, where one is designated a guide star.
  Given these and a set of new input stars, determine a mapping of new stars to the references.
@@ -117,6 +123,27 @@ void GuideStars::setupStarCorrespondence(const QList<Edge> &neighbors, int guide
     }
     else
         starCorrespondence.reset();
+    m_LastGuideStarValid = false;
+}
+
+QList<QRect> GuideStars::expectedStarRegions(double maxStarAssociationDistance, double maxHFR) const
+{
+    QList<QRect> regions;
+    const int guideIndex = starCorrespondence.guideStar();
+    if (!m_LastGuideStarValid || guideIndex < 0)
+        return regions;
+
+    // Room for the star to move, and for its wings and enough sky around it to estimate the background.
+    const int halfSize = std::max(MIN_REGION_HALF_SIZE, static_cast<int>(std::ceil(maxStarAssociationDistance + 3 * maxHFR)));
+    const Edge guideReference = starCorrespondence.reference(guideIndex);
+    for (int i = 0; i < starCorrespondence.size(); ++i)
+    {
+        const Edge reference = starCorrespondence.reference(i);
+        const int x = static_cast<int>(m_LastGuideStar.x() + reference.x - guideReference.x);
+        const int y = static_cast<int>(m_LastGuideStar.y() + reference.y - guideReference.y);
+        regions.append(QRect(x - halfSize, y - halfSize, 2 * halfSize + 1, 2 * halfSize + 1));
+    }
+    return regions;
 }
 
 // Calls SEP to generate a set of star detections and score them,
@@ -321,11 +348,6 @@ GuiderUtils::Vector GuideStars::findGuideStar(const QSharedPointer<FITSData> &im
     const double maxHFR = Options::guideMaxHFR() + HFR_MARGIN;
     if (starCorrespondence.size() > 0)
     {
-
-        findTopStars(imageData, STARS_TO_SEARCH, &detectedStars, maxHFR);
-        if (detectedStars.empty())
-            return GuiderUtils::Vector(-1, -1, -1);
-
         // Allow it to guide even if the main guide star isn't detected (as long as enough reference stars are).
         starCorrespondence.setAllowMissingGuideStar(allowMissingGuideStar);
 
@@ -338,44 +360,72 @@ GuiderUtils::Vector GuideStars::findGuideStar(const QSharedPointer<FITSData> &im
         if (starCorrespondence.size() > 25) minFraction =  0.33;
         else if (starCorrespondence.size() > 15) minFraction =  0.4;
 
-        Edge foundStar = starCorrespondence.find(detectedStars, maxStarAssociationDistance, &starMap, true, minFraction);
+        // Only look around the reference stars, from where the guide star was in the last frame.
+        // The whole frame is searched if the guide star was lost, or isn't found that way, e.g. after a dither.
+        QList<QRect> regions;
+        if (!firstFrame)
+            regions = expectedStarRegions(maxStarAssociationDistance, maxHFR);
 
-        // Is there a correspondence to the guide star
-        // Should we also weight distance to the tracking box?
-        for (int i = 0; i < detectedStars.size(); ++i)
+        for (bool fullFrame = regions.isEmpty();; fullFrame = true)
         {
-            if (getStarMap(i) == starCorrespondence.guideStar())
+            findTopStars(imageData, STARS_TO_SEARCH, &detectedStars, maxHFR, nullptr, nullptr, nullptr,
+                         fullFrame ? nullptr : &regions);
+            if (detectedStars.empty())
             {
-                auto &star = detectedStars[i];
-                double SNR = skyBackground.SNR(star.sum, star.numPixels);
-                guideStarSNR = SNR;
-                guideStarMass = star.sum;
-                unreliableDectionCounter = 0;
-                qCDebug(KSTARS_EKOS_GUIDE) << QString("StarCorrespondence found star %1 at %2 %3 SNR %4")
-                                           .arg(i).arg(star.x, 0, 'f', 1).arg(star.y, 0, 'f', 1).arg(SNR, 0, 'f', 1);
+                if (!fullFrame)
+                    continue;
+                m_LastGuideStarValid = false;
+                return GuiderUtils::Vector(-1, -1, -1);
+            }
+
+            Edge foundStar = starCorrespondence.find(detectedStars, maxStarAssociationDistance, &starMap, true, minFraction);
 
+            // Is there a correspondence to the guide star
+            // Should we also weight distance to the tracking box?
+            for (int i = 0; i < detectedStars.size(); ++i)
+            {
+                if (getStarMap(i) == starCorrespondence.guideStar())
+                {
+                    auto &star = detectedStars[i];
+                    double SNR = skyBackground.SNR(star.sum, star.numPixels);
+                    guideStarSNR = SNR;
+                    guideStarMass = star.sum;
+                    unreliableDectionCounter = 0;
+                    m_LastGuideStar = QPointF(star.x, star.y);
+                    m_LastGuideStarValid = true;
+                    qCDebug(KSTARS_EKOS_GUIDE) << QString("StarCorrespondence found star %1 at %2 %3 SNR %4")
+                                               .arg(i).arg(star.x, 0, 'f', 1).arg(star.y, 0, 'f', 1).arg(SNR, 0, 'f', 1);
+
+                    if (guideView != nullptr)
+                        plotStars(guideView, trackingBox);
+                    qCDebug(KSTARS_EKOS_GUIDE) << QString("StarCorrespondence. findGuideStar took %1s").arg(timer.elapsed() / 1000.0, 0, 'f',
+                                               3);
+                    return GuiderUtils::Vector(star.x, star.y, 0);
+                }
+            }
+            // None of the stars matched the guide star, but it's possible star correspondence
+            // invented a guide star position.
+            if (foundStar.x >= 0 && foundStar.y >= 0)
+            {
+                guideStarSNR = skyBackground.SNR(foundStar.sum, foundStar.numPixels);
+                guideStarMass = foundStar.sum;
+                unreliableDectionCounter = 0;  // debating this
+                m_LastGuideStar = QPointF(foundStar.x, foundStar.y);
+                m_LastGuideStarValid = true;
+                qCDebug(KSTARS_EKOS_GUIDE) << "StarCorrespondence invented at" << foundStar.x << foundStar.y << "SNR" << guideStarSNR;
                 if (guideView != nullptr)
                     plotStars(guideView, trackingBox);
-                qCDebug(KSTARS_EKOS_GUIDE) << QString("StarCorrespondence. findGuideStar took %1s").arg(timer.elapsed() / 1000.0, 0, 'f',
-                                           3);
-                return GuiderUtils::Vector(star.x, star.y, 0);
+                qCDebug(KSTARS_EKOS_GUIDE) << QString("StarCorrespondence. findGuideStar/invent took %1s").arg(timer.elapsed() / 1000.0, 0,
+                                           'f', 3);
+                return GuiderUtils::Vector(foundStar.x, foundStar.y, 0);
             }
-        }
-        // None of the stars matched the guide star, but it's possible star correspondence
-        // invented a guide star position.
-        if (foundStar.x >= 0 && foundStar.y >= 0)
-        {
-            guideStarSNR = skyBackground.SNR(foundStar.sum, foundStar.numPixels);
-            guideStarMass = foundStar.sum;
-            unreliableDectionCounter = 0;  // debating this
-            qCDebug(KSTARS_EKOS_GUIDE) << "StarCorrespondence invented at" << foundStar.x << foundStar.y << "SNR" << guideStarSNR;
-            if (guideView != nullptr)
-                plotStars(guideView, trackingBox);
-            qCDebug(KSTARS_EKOS_GUIDE) << QString("StarCorrespondence. findGuideStar/invent took %1s").arg(timer.elapsed() / 1000.0, 0,
-                                       'f', 3);
-            return GuiderUtils::Vector(foundStar.x, foundStar.y, 0);
+
+            if (fullFrame)
+                break;
+            qCDebug(KSTARS_EKOS_GUIDE) << "StarCorrespondence: guide star not found around the reference stars, searching the frame.";
         }
     }
+    m_LastGuideStarValid = false;
 
     qCDebug(KSTARS_EKOS_GUIDE) << "StarCorrespondence not used. It failed to find the guide star.";
 
@@ -454,7 +504,8 @@ SSolver::Parameters GuideStars::getStarExtractionParameters(int num)
 }
 
 // This is the interface to star detection.
-int GuideStars::findAllSEPStars(const QSharedPointer<FITSData> &imageData, QList<Edge *> *sepStars, int num)
+int GuideStars::findAllSEPStars(const QSharedPointer<FITSData> &imageData, QList<Edge *> *sepStars, int num,
+                                const QList<QRect> *regions)
 {
     if (imageData == nullptr)
         return 0;
@@ -462,6 +513,13 @@ int GuideStars::findAllSEPStars(const QSharedPointer<FITSData> &imageData, QList
     QVariantMap settings;
     settings["optionsProfileIndex"] = Options::guideOptionsProfile();
     settings["optionsProfileGroup"] = static_cast<int>(Ekos::GuideProfiles);
+    if (regions != nullptr)
+    {
+        QVariantList regionList;
+        for (const QRect &region : *regions)
+            regionList.append(region);
+        settings["regions"] = regionList;
+    }
     imageData->setSourceExtractorSettings(settings);
     imageData->findStars(ALGORITHM_SEP).waitForFinished();
     skyBackground = imageData->getSkyBackground();
@@ -504,7 +562,8 @@ double GuideStars::findMinDistance(int index, const QList<Edge*> &stars)
 // If the region-of-interest rectange is not null, it only returns scores in that area.
 void GuideStars::findTopStars(const QSharedPointer<FITSData> &imageData, int num, QList<Edge> *stars,
                               const double maxHFR, const QRect *roi,
-                              QList<double> *outputScores, QList<double> *minDistances)
+                              QList<double> *outputScores, QList<double> *minDistances,
+                              const QList<QRect> *regions)
 {
     QElapsedTimer timer2;
     timer2.start();
@@ -525,7 +584,7 @@ void GuideStars::findTopStars(const QSharedPointer<FITSData> &imageData, int num
     QElapsedTimer timer;
     timer.restart();
     QList<Edge*> sepStars;
-    int count = findAllSEPStars(imageData, &sepStars, num * 2);
+    int count = findAllSEPStars(imageData, &sepStars, num * 2, regions);
     if (count == 0)
         return;
 
@@ -8,6 +8,8 @@
 
 #include <QObject>
 #include <QList>
+#include <QPointF>
+#include <QRect>
 #include <QVector3D>
 
 #include "starcorrespondence.h"
@@ -102,6 +104,7 @@ class GuideStars
         void reset()
         {
             starCorrespondence.reset();
+            m_LastGuideStarValid = false;
         }
 
         // Used to initialize the StarCorrespondence object, which ultimately finds
@@ -122,9 +125,16 @@ private:
                           const double maxHFR,
                           const QRect *roi = nullptr,
                           QList<double> *outputScores = nullptr,
-                          QList<double> *minDistances = nullptr);
+                          QList<double> *minDistances = nullptr,
+                          const QList<QRect> *regions = nullptr);
         // The interface to the SEP star detection algoritms.
-        int findAllSEPStars(const QSharedPointer<FITSData> &imageData, QList<Edge*> *sepStars, int num);
+        // If regions is not null, only these windows of the image are searched.
+        int findAllSEPStars(const QSharedPointer<FITSData> &imageData, QList<Edge*> *sepStars, int num,
+                            const QList<QRect> *regions = nullptr);
+
+        // Windows around the positions where the reference stars are expected in the next frame,
+        // given where the guide star was last found. Empty if it was not found in the last frame.
+        QList<QRect> expectedStarRegions(double maxStarAssociationDistance, double maxHFR) const;
 
         // Convert from input image coordinates to output RA and DEC coordinates.
         GuiderUtils::Vector point2arcsec(const GuiderUtils::Vector &p) const;
@@ -187,5 +197,9 @@ private:
 
         int m_NumStarsDetected { 0 };
 
+        // Where findGuideStar() last found the guide star, for expectedStarRegions().
+        QPointF m_LastGuideStar;
+        bool m_LastGuideStarValid { false };
+
         friend class TestGuideStars;
 };
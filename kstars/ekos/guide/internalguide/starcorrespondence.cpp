@@ -10,54 +10,18 @@
 #include "ekos_guide_debug.h"
 #include "Options.h"
 
-// Finds the star in sortedStars that's closest to x,y and within maxDistance pixels.
-// Returns the index of the closest star in  sortedStars, or -1 if none satisfies the criteria.
-// sortedStars must be sorted by x, from lower x to higher x.
+// Finds the star in starPositions that's closest to x,y and within maxDistance pixels.
+// Returns the index of the closest star, or -1 if none satisfies the criteria.
 // Fills distance to the pixel distance to the closest star.
-int StarCorrespondence::findClosestStar(double x, double y, const QList<Edge> sortedStars,
+int StarCorrespondence::findClosestStar(double x, double y, const StarPositionIndex &starPositions,
                                         double maxDistance, double *distance) const
 {
     if (x < -maxDistance || y < -maxDistance ||
             x > imageWidth + maxDistance || y > imageWidth + maxDistance)
         return -1;
 
-    const int size = sortedStars.size();
-    int startPoint = 0;
-
-    // Efficiency improvement to quickly find the start point.
-    // Increments by size/10 to find a better start point.
-    const int coarseIncrement = size / 10;
-    if (coarseIncrement > 1)
-    {
-        for (int i = 0; i < size; i += coarseIncrement)
-        {
-            if (sortedStars[i].x < x - maxDistance)
-                startPoint = i;
-            else
-                break;
-        }
-    }
-
-    // Iterate through the stars starting with the star with lowest x where x >= x - maxDistance
-    // through the star with greatest x where x <= x + maxDistance.  Find the closest star to x,y.
-    int bestIndex = -1;
-    double bestSquaredDistance = maxDistance * maxDistance;
-    for (int i = startPoint; i < size; ++i)
-    {
-        auto &star = sortedStars[i];
-        if (star.x < x - maxDistance) continue;
-        if (star.x > x + maxDistance) break;
-        const double xDiff = star.x - x;
-        const double yDiff = star.y - y;
-        const double squaredDistance = xDiff * xDiff + yDiff * yDiff;
-        if (squaredDistance <= bestSquaredDistance)
-        {
-            bestIndex = i;
-            bestSquaredDistance = squaredDistance;
-        }
-    }
-    if (distance != nullptr) *distance = sqrt(bestSquaredDistance);
-    return bestIndex;
+    // Only the grid cells around x,y are searched, instead of all the stars.
+    return starPositions.findClosest(x, y, maxDistance, distance);
 }
 
 namespace
@@ -134,7 +98,8 @@ void StarCorrespondence::reset()
     initialized = false;
 }
 
-int StarCorrespondence::findInternal(const QList<Edge> &stars, double maxDistance, QVector<int> *starMap,
+int StarCorrespondence::findInternal(const QList<Edge> &stars, const StarPositionIndex &starPositions, double maxDistance,
+                                     QVector<int> *starMap,
                                      int guideStarIndex, const QVector<Offsets> &offsets,
                                      int *numFound, int *numNotFound, double minFraction) const
 {
@@ -183,7 +148,7 @@ int StarCorrespondence::findInternal(const QList<Edge> &stars, double maxDistanc
             const auto &offset = offsets[offsetIndex];
             double distance;
             const int closestIndex = findClosestStar(starX + offset.x, starY + offset.y,
-                                     stars, maxDistance, &distance);
+                                     starPositions, maxDistance, &distance);
             if (closestIndex < 0)
             {
                 // This reference star position had no corresponding input star.
@@ -327,11 +292,12 @@ Edge StarCorrespondence::find(const QList<Edge> &stars, double maxDistance,
     if (!initialized)  return foundStar;
     int numFound = 0, numNotFound = 0;
 
-    // findClosestStar needs an input with stars sorted by their x.
+    // Sort the stars by their x, and index their positions for findClosestStar.
     // Do this outside of the loops.
     QList<Edge> sortedStars;
     QVector<int> sortedToOriginal;
     sortByX(stars, &sortedStars, &sortedToOriginal);
+    const StarPositionIndex starPositions(sortedStars, maxDistance);
 
     const bool alwaysInvent = Options::alwaysInventGuideStar() &&
                               stars.size() >= minFraction * guideStarOffsets.size();
@@ -343,7 +309,7 @@ Edge StarCorrespondence::find(const QList<Edge> &stars, double maxDistance,
 
     QVector<int> sortedStarMap;
     int bestStarIndex =
-        alwaysInvent ? -1 : findInternal(sortedStars, maxDistance, &sortedStarMap, guideStarIndex,
+        alwaysInvent ? -1 : findInternal(sortedStars, starPositions, maxDistance, &sortedStarMap, guideStarIndex,
                                          guideStarOffsets, &numFound, &numNotFound, minFraction);
 
     if (!alwaysInvent && bestStarIndex > -1)
@@ -391,7 +357,7 @@ Edge StarCorrespondence::find(const QList<Edge> &stars, double maxDistance,
             QVector<Offsets> gStarOffsets;
             makeOffsets(guideStarOffsets, &gStarOffsets, gStarIndex);
             QVector<int> newStarMap;
-            int detectedStarIndex = findInternal(sortedStars, maxDistance, &newStarMap,
+            int detectedStarIndex = findInternal(sortedStars, starPositions, maxDistance, &newStarMap,
                                                  gStarIndex, gStarOffsets,
                                                  &numFound, &numNotFound, minFraction);
             if (detectedStarIndex >= 0 && numFound > bestNumFound)
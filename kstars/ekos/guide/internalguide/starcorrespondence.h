@@ -12,6 +12,7 @@
 #include <QVector2D>
 
 #include "fitsviewer/fitsdata.h"
+#include "fitsviewer/starpositionindex.h"
 #include "vect.h"
 
 /*
@@ -111,7 +112,8 @@ class StarCorrespondence
         void adaptOffsets(const QList<Edge> &stars, const QVector<int> &starMap, double x, double y);
 
         // Utility used by find. Useful for iterating when the guide star is missing.
-        int findInternal(const QList<Edge> &stars, double maxDistance, QVector<int> *starMap,
+        // starPositions is built over stars, with cells about maxDistance wide.
+        int findInternal(const QList<Edge> &stars, const StarPositionIndex &starPositions, double maxDistance, QVector<int> *starMap,
                          int guideStarIndex, const QVector<Offsets> &offsets,
                          int *numFound, int *numNotFound, double minFraction) const;
 
@@ -127,9 +129,8 @@ class StarCorrespondence
         Edge inventStarPosition(const QList<Edge> &stars, const QVector<int> &starMap,
                                 const QVector<Offsets> &offsets, const Offsets &offset) const;
 
-        // Finds the star closest to x,y. Returns the index in sortedStars.
-        // sortedStars should be sorted in x, which allows for a speedup in search.
-        int findClosestStar(double x, double y, const QList<Edge> sortedStars,
+        // Finds the star closest to x,y. Returns the index in the stars starPositions was built from.
+        int findClosestStar(double x, double y, const StarPositionIndex &starPositions,
                             double maxDistance, double *distance) const;
 
         // The offsets of the reference stars relative to the guide star.
@@ -0,0 +1,151 @@
+/*  FITS Bayer
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitsbayer.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+
+// Rows interpolated on each side of a band and then dropped. Even, so the band keeps the bayer
+// pattern of the frame, and wider than the reach of any method including the borders it clears.
+constexpr uint32_t HALO_ROWS = 8;
+
+// Rows per band. Many more bands than threads, the interleaved buffers in flight stay small.
+constexpr uint32_t BAND_ROWS = 128;
+
+struct Band
+{
+    uint32_t start;
+    uint32_t rows;
+    dc1394error_t error;
+};
+
+inline dc1394error_t decode(const uint8_t *bayer, uint8_t *rgb, uint32_t width, uint32_t height,
+                            const BayerParams &params, uint32_t)
+{
+    return dc1394_bayer_decoding_8bit(bayer, rgb, width, height, params.filter, params.method);
+}
+
+inline dc1394error_t decode(const uint16_t *bayer, uint16_t *rgb, uint32_t width, uint32_t height,
+                            const BayerParams &params, uint32_t bits)
+{
+    return dc1394_bayer_decoding_16bit(bayer, rgb, width, height, params.filter, params.method, bits);
+}
+
+template <typename T>
+dc1394error_t debayerBands(const T *bayer, T *planar, uint32_t width, uint32_t height, const BayerParams &params,
+                           uint32_t bits)
+{
+    const size_t planeSize = static_cast<size_t>(width) * height;
+    T * const planes[3] = { planar, planar + planeSize, planar + 2 * planeSize };
+
+    // Rows of the interpolated image, the first one of the frame is skipped with a row offset.
+    uint32_t rows = height;
+    if (params.offsetY == 1)
+    {
+        bayer += width;
+        rows--;
+    }
+
+    // Both go through the image by pairs of rows and would read past an odd last row.
+    const bool downsample = params.method == DC1394_BAYER_METHOD_DOWNSAMPLE;
+    if (downsample || params.method == DC1394_BAYER_METHOD_EDGESENSE)
+        rows &= ~1u;
+
+    // The downsampled image is packed at the start of the planes, row pairs map to packed rows
+    // without any halo. Odd widths don't pack into whole rows and are done in one band.
+    const uint32_t halo = downsample ? 0 : HALO_ROWS;
+    const size_t packedWidth = width / 2;
+
+    std::vector<Band> bands;
+    if (rows < 2 * BAND_ROWS || (downsample && (width % 2)))
+        bands.push_back({0, rows, DC1394_SUCCESS});
+    else
+    {
+        for (uint32_t start = 0; start < rows; start += BAND_ROWS)
+            bands.push_back({start, std::min(BAND_ROWS, rows - start), DC1394_SUCCESS});
+    }
+
+    auto process = [ &, planes](Band & band)
+    {
+        const uint32_t above = std::min(halo, band.start);
+        const uint32_t below = std::min(halo, rows - band.start - band.rows);
+        const uint32_t bandHeight = above + band.rows + below;
+
+        std::vector<T> rgb(static_cast<size_t>(bandHeight) * width * 3);
+        band.error = decode(bayer + static_cast<size_t>(band.start - above) * width, rgb.data(), width, bandHeight,
+                            params, bits);
+        if (band.error != DC1394_SUCCESS)
+            return;
+
+        const T *source = rgb.data();
+        size_t offset = 0, count = 0;
+        if (downsample)
+        {
+            offset = band.start / 2 * packedWidth;
+            count = (bands.size() == 1 ? static_cast<size_t>(width) * band.rows / 4 : band.rows / 2 * packedWidth);
+        }
+        else
+        {
+            source += static_cast<size_t>(above) * width * 3;
+            offset = static_cast<size_t>(band.start) * width;
+            count = static_cast<size_t>(band.rows) * width;
+        }
+
+        T *r = planes[0] + offset;
+        T *g = planes[1] + offset;
+        T *b = planes[2] + offset;
+        for (size_t i = 0; i < count; i++)
+        {
+            r[i] = source[0];
+            g[i] = source[1];
+            b[i] = source[2];
+            source += 3;
+        }
+    };
+
+    // AHD builds its lookup tables on first use without locking, let the first band do that alone.
+    auto first = bands.begin();
+    if (params.method == DC1394_BAYER_METHOD_AHD || bands.size() == 1)
+        process(*first++);
+    if (first != bands.end())
+        QtConcurrent::blockingMap(first, bands.end(), process);
+
+    for (const auto &band : bands)
+    {
+        if (band.error != DC1394_SUCCESS)
+            return band.error;
+    }
+
+    // Clear what no band wrote to: the rows past the interpolated image, or past the packed one.
+    const size_t written = downsample ? static_cast<size_t>(width) * rows / 4 : static_cast<size_t>(width) * rows;
+    for (auto plane : planes)
+        std::fill(plane + std::min(written, planeSize), plane + planeSize, T(0));
+
+    return DC1394_SUCCESS;
+}
+
+}
+
+namespace FITSBayer
+{
+
+dc1394error_t debayer(const uint8_t *bayer, uint8_t *planar, uint32_t width, uint32_t height, const BayerParams &params)
+{
+    return debayerBands(bayer, planar, width, height, params, 8);
+}
+
+dc1394error_t debayer(const uint16_t *bayer, uint16_t *planar, uint32_t width, uint32_t height,
+                      const BayerParams &params, uint32_t bits)
+{
+    return debayerBands(bayer, planar, width, height, params, bits);
+}
+
+}
@@ -0,0 +1,34 @@
+/*  FITS Bayer
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "bayer.h"
+
+#include <stdint.h>
+
+// Parallel debayering into planar channels.
+//
+// The bayered image is split into bands of rows. Each band is debayered with the dc1394 method on
+// its own thread, together with a few halo rows above and below so that the pixels next to the band
+// edges see the same neighbours as in a whole frame pass. The interpolated rows are written straight
+// into the red, green and blue planes, so only a band sized interleaved buffer is needed per thread.
+namespace FITSBayer
+{
+
+/**
+ * @brief debayer Debayers a width x height image into three planes of width x height samples.
+ * @param bayer bayered samples, must not overlap planar
+ * @param planar destination, the red, green then blue planes
+ * @param params method and pattern. offsetX must be 0, with offsetY of 1 the first row is skipped
+ * and the last row of the planes is cleared.
+ * @param bits significant bits of the 16 bit samples
+ * @return DC1394_SUCCESS, or the error of the dc1394 method
+ */
+dc1394error_t debayer(const uint8_t *bayer, uint8_t *planar, uint32_t width, uint32_t height, const BayerParams &params);
+dc1394error_t debayer(const uint16_t *bayer, uint16_t *planar, uint32_t width, uint32_t height,
+                      const BayerParams &params, uint32_t bits = 16);
+
+}
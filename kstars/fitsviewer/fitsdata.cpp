@@ -13,6 +13,9 @@
 #include "fitsgradientdetector.h"
 #include "fitscentroiddetector.h"
 #include "fitssepdetector.h"
+#include "fitsmedian.h"
+#include "fitsparallel.h"
+#include "fitsbayer.h"
 
 #include "fpack.h"
 
@@ -29,6 +32,7 @@
 #include <QImage>
 #include <QtConcurrent>
 #include <QImageReader>
+#include <QtEndian>
 #include <QUrl>
 #include <QNetworkAccessManager>
 
@@ -47,6 +51,8 @@
 
 #include <cfloat>
 #include <cmath>
+#include <cstring>
+#include <functional>
 
 #include <fits_debug.h>
 
@@ -110,6 +116,7 @@ FITSData::FITSData(const QSharedPointer<FITSData> &other)
     this->m_Mode = other->m_Mode;
     this->m_Statistics.channels = other->m_Statistics.channels;
     memcpy(&m_Statistics, &(other->m_Statistics), sizeof(m_Statistics));
+    memcpy(m_MAD, other->m_MAD, sizeof(m_MAD));
     m_ImageBuffer = new uint8_t[m_Statistics.samples_per_channel * m_Statistics.channels * m_Statistics.bytesPerPixel];
     memcpy(m_ImageBuffer, other->m_ImageBuffer,
            m_Statistics.samples_per_channel * m_Statistics.channels * m_Statistics.bytesPerPixel);
@@ -138,9 +145,7 @@ FITSData::~FITSData()
     }
 #endif
 
-    if (starCenters.count() > 0)
-        qDeleteAll(starCenters);
-    starCenters.clear();
+    clearStarCenters();
 
     if (m_SkyObjects.count() > 0)
         qDeleteAll(m_SkyObjects);
@@ -161,8 +166,7 @@ FITSData::~FITSData()
 void FITSData::loadCommon(const QString &inFilename)
 {
     int status = 0;
-    qDeleteAll(starCenters);
-    starCenters.clear();
+    clearStarCenters();
 
     if (fptr != nullptr)
     {
@@ -172,6 +176,7 @@ void FITSData::loadCommon(const QString &inFilename)
         m_PackBuffer = nullptr;
         fptr = nullptr;
     }
+    m_SourceBuffer.clear();
 
     m_Filename = inFilename;
 }
@@ -179,6 +184,8 @@ void FITSData::loadCommon(const QString &inFilename)
 bool FITSData::loadFromBuffer(const QByteArray &buffer)
 {
     loadCommon("");
+    // cfitsio reads memory files in place, so the buffer must outlive the file.
+    m_SourceBuffer = buffer;
     qCDebug(KSTARS_FITS) << "Reading file buffer (" << KFormat().formatByteSize(buffer.size()) << ")";
     return privateLoad(buffer);
 }
@@ -227,6 +234,122 @@ bool FITSData::privateLoad(const QByteArray &buffer)
     return false;
 }
 
+namespace
+{
+// Converts big endian FITS samples to native order, and flips the bits in signFlip,
+// which is how the standard BZERO offsets of unsigned types are applied.
+// Each thread converts its own band of rows, so the file is read once, straight into the image.
+template <typename T>
+void fromBigEndian(const T *source, T *destination, uint32_t count, T signFlip)
+{
+    const bool isNative = signFlip == 0 && (sizeof(T) == 1 || QSysInfo::ByteOrder == QSysInfo::BigEndian);
+    FITSParallel::runPartitioned<bool>(count, [ = ](uint32_t start, uint32_t end)
+    {
+        if (isNative)
+            memcpy(destination + start, source + start, (end - start) * sizeof(T));
+        else
+        {
+            for (uint32_t i = start; i < end; i++)
+                destination[i] = qFromBigEndian(source[i]) ^ signFlip;
+        }
+        return true;
+    });
+}
+}
+
+bool FITSData::mapFITSImage(long nelements)
+{
+    int status = 0, bitpix = 0;
+    double bscale = 1, bzero = 0;
+    LONGLONG headStart = 0, dataStart = 0, dataEnd = 0;
+    char urlType[FLEN_FILENAME] = {0};
+
+    // Offsets in the file are only the offsets cfitsio reports when it reads the file as it is. Other drivers,
+    // such as those of gzip compressed files, report offsets in the data they decompressed into memory.
+    if (fits_url_type(fptr, urlType, &status) || strcmp(urlType, "file://") != 0)
+        return false;
+
+    if (fits_get_img_type(fptr, &bitpix, &status) ||
+            fits_get_hduaddrll(fptr, &headStart, &dataStart, &dataEnd, &status))
+        return false;
+    if (fits_read_key(fptr, TDOUBLE, "BSCALE", &bscale, nullptr, &status) == KEY_NO_EXIST)
+        status = 0;
+    if (fits_read_key(fptr, TDOUBLE, "BZERO", &bzero, nullptr, &status) == KEY_NO_EXIST)
+        status = 0;
+    if (status || bscale != 1 || dataEnd - dataStart < static_cast<LONGLONG>(m_ImageBufferSize) ||
+            dataEnd > QFileInfo(m_Filename).size())
+        return false;
+
+    // Only samples that cfitsio would read without scaling them, or just applying the offset
+    // of unsigned types, can be used as they are stored.
+    const bool isUnscaled = bzero == 0 && bitpix != SHORT_IMG && bitpix != LONG_IMG;
+    const bool isUnsigned = (bitpix == SHORT_IMG && bzero == 32768) || (bitpix == LONG_IMG && bzero == 2147483648.0);
+    if (!isUnscaled && !isUnsigned)
+        return false;
+
+    const bool isNative = !isUnsigned && (m_Statistics.bytesPerPixel == 1 || QSysInfo::ByteOrder == QSysInfo::BigEndian);
+
+    m_MappedFile.setFileName(m_Filename);
+    if (!m_MappedFile.open(QIODevice::ReadOnly))
+        return false;
+
+    // Masters loaded for calibration, which are never rewritten while in use, are kept mapped when their
+    // samples need no conversion. Their pages are only read as they are used, and shared with the page cache.
+    // The mapping is private, so pages changed when processing the image are never written back to the file.
+    if (isNative && m_Mode == FITS_CALIBRATE)
+    {
+        uint8_t *data = m_MappedFile.map(dataStart, m_ImageBufferSize, QFileDevice::MapPrivateOption);
+        if (data == nullptr)
+        {
+            m_MappedFile.close();
+            return false;
+        }
+        m_ImageBuffer = data;
+        m_ImageBufferMapped = true;
+        return true;
+    }
+
+    // Other images are converted from a read only mapping that is released right away, so they never keep
+    // the file busy. The mapping is never written, its pages are not copied.
+    const uint8_t *data = m_MappedFile.map(dataStart, m_ImageBufferSize);
+    if (data == nullptr)
+    {
+        m_MappedFile.close();
+        return false;
+    }
+
+    m_ImageBuffer = new uint8_t[m_ImageBufferSize];
+    if (m_ImageBuffer == nullptr)
+    {
+        m_MappedFile.unmap(const_cast<uint8_t *>(data));
+        m_MappedFile.close();
+        return false;
+    }
+
+    switch (m_Statistics.bytesPerPixel)
+    {
+        case 1:
+            fromBigEndian<uint8_t>(data, m_ImageBuffer, nelements, 0);
+            break;
+        case 2:
+            fromBigEndian<uint16_t>(reinterpret_cast<const uint16_t *>(data), reinterpret_cast<uint16_t *>(m_ImageBuffer),
+                                    nelements, isUnsigned ? 0x8000 : 0);
+            break;
+        case 4:
+            fromBigEndian<uint32_t>(reinterpret_cast<const uint32_t *>(data), reinterpret_cast<uint32_t *>(m_ImageBuffer),
+                                    nelements, isUnsigned ? 0x80000000 : 0);
+            break;
+        case 8:
+            fromBigEndian<uint64_t>(reinterpret_cast<const uint64_t *>(data), reinterpret_cast<uint64_t *>(m_ImageBuffer),
+                                    nelements, 0);
+            break;
+    }
+
+    m_MappedFile.unmap(const_cast<uint8_t *>(data));
+    m_MappedFile.close();
+    return true;
+}
+
 bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
 {
     int status = 0, anynull = 0;
@@ -424,27 +547,33 @@ bool FITSData::loadFITSImage(const QByteArray &buffer, const bool isCompressed)
     if ( (m_Mode != FITS_NORMAL && m_Mode != FITS_CALIBRATE) || !Options::auto3DCube())
         m_Statistics.channels = 1;
 
-    m_ImageBufferSize = m_Statistics.samples_per_channel * m_Statistics.channels * m_Statistics.bytesPerPixel;
-    m_ImageBuffer = new uint8_t[m_ImageBufferSize];
-    if (m_ImageBuffer == nullptr)
-    {
-        qCWarning(KSTARS_FITS) << "FITSData: Not enough memory for image_buffer channel. Requested: "
-                               << m_ImageBufferSize << " bytes.";
-        clearImageBuffers();
-        free(m_PackBuffer);
-        m_PackBuffer = nullptr;
-        return false;
-    }
-
     rotCounter     = 0;
     flipHCounter   = 0;
     flipVCounter   = 0;
     long nelements = m_Statistics.samples_per_channel * m_Statistics.channels;
+    m_ImageBufferSize = m_Statistics.samples_per_channel * m_Statistics.channels * m_Statistics.bytesPerPixel;
 
-    if (fits_read_img(fptr, m_Statistics.dataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, &status))
+    // Uncompressed files on disk are mapped, which saves reading them through the buffers of cfitsio.
+    if (buffer.isEmpty() && !isCompressed && mapFITSImage(nelements))
+        qCDebug(KSTARS_FITS) << "Mapped" << KFormat().formatByteSize(m_ImageBufferSize) << "of pixels from" << m_Filename;
+    else
     {
-        m_LastError = i18n("Error reading image: %1", fitsErrorToString(status));
-        return false;
+        m_ImageBuffer = new uint8_t[m_ImageBufferSize];
+        if (m_ImageBuffer == nullptr)
+        {
+            qCWarning(KSTARS_FITS) << "FITSData: Not enough memory for image_buffer channel. Requested: "
+                                   << m_ImageBufferSize << " bytes.";
+            clearImageBuffers();
+            free(m_PackBuffer);
+            m_PackBuffer = nullptr;
+            return false;
+        }
+
+        if (fits_read_img(fptr, m_Statistics.dataType, 1, nelements, nullptr, m_ImageBuffer, &anynull, &status))
+        {
+            m_LastError = i18n("Error reading image: %1", fitsErrorToString(status));
+            return false;
+        }
     }
 
     parseHeader();
@@ -1184,10 +1313,22 @@ bool FITSData::saveImage(const QString &newFilename)
     return true;
 }
 
-void FITSData::clearImageBuffers()
+void FITSData::releaseImageBuffer()
 {
-    delete[] m_ImageBuffer;
+    if (m_ImageBufferMapped)
+    {
+        m_MappedFile.unmap(m_ImageBuffer);
+        m_MappedFile.close();
+        m_ImageBufferMapped = false;
+    }
+    else
+        delete[] m_ImageBuffer;
     m_ImageBuffer = nullptr;
+}
+
+void FITSData::clearImageBuffers()
+{
+    releaseImageBuffer();
     if(m_ImageRoiBuffer != nullptr )
     {
         delete[] m_ImageRoiBuffer;
@@ -1270,6 +1411,12 @@ void FITSData::setupWCSParams()
 
 void FITSData::calculateStats(bool refresh, bool roi)
 {
+    // The pixels may have changed since the last pass.
+    if (roi)
+        m_ROISweepValid = false;
+    else
+        m_SweepValid = false;
+
     // Calculate min max
     if(roi == false)
     {
@@ -1546,7 +1693,11 @@ void FITSData::calculateMedian(bool refresh, bool roi)
             fits_read_key_dbl(fptr, "MEDIAN3", &m_Statistics.median[2], nullptr, &status);
 
             if (nfound == 1)
+            {
+                // The header doesn't provide the MAD, consumers compute it if needed.
+                std::fill(m_MAD, m_MAD + 3, -1);
                 return;
+            }
         }
 
         m_Statistics.median[RED_CHANNEL] = 0;
@@ -1642,29 +1793,30 @@ template <typename T>
 void FITSData::calculateMedian(bool roi)
 {
     auto * buffer = reinterpret_cast<T *>(roi ? m_ImageRoiBuffer : m_ImageBuffer);
-    const uint32_t maxMedianSize = 500000;
-    uint32_t medianSize = roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel;
-    uint8_t downsample = 1;
-    if (medianSize > maxMedianSize)
-    {
-        downsample = (static_cast<double>(medianSize) / maxMedianSize) + 0.999;
-        medianSize /= downsample;
-    }
-    // Ideally samples would be declared like this...
-    // std::vector<T> samples;
-    // Unfortunately this doesn't compile on Mac - see the comments in robuststatistics.cpp for more details
-    // So for now declare samples like this...
-    std::vector<int32_t> samples;
-    samples.reserve(medianSize);
+    const uint32_t samplesPerChannel = roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel;
+
+    // Exact median and MAD of all the samples, from a histogram of each channel.
+    // The MAD is cached so that the auto-stretch doesn't need another pass over the image.
+    if constexpr (FITSSweep::hasKernel<T>() && FITSSweep::hasHistogram<T>())
+        sweepChannels<T>(roi);
+    const auto * sweep = roi ? m_ROISweep : m_Sweep;
 
     for (uint8_t n = 0; n < m_Statistics.channels; n++)
     {
-        auto *oneChannel = buffer + n * (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel);
-        for (uint32_t upto = 0; upto < (roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel);
-                upto += downsample)
-            samples.push_back(oneChannel[upto]);
-        auto median = Mathematics::RobustStatistics::ComputeLocation(Mathematics::RobustStatistics::LOCATION_MEDIAN, samples);
-        roi ? m_ROIStatistics.median[n] = median : m_Statistics.median[n] = median;
+        // 8 and 16 bit images already have their histogram from the fused pass.
+        const auto result = FITSSweep::hasKernel<T>() && FITSSweep::hasHistogram<T>() ?
+                            FITSMedian::fromHistogram(sweep[n].histogram, sweep[n].histogramOrigin, sweep[n].count) :
+                            FITSMedian::compute(buffer + n * samplesPerChannel, samplesPerChannel);
+        if (roi)
+        {
+            m_ROIStatistics.median[n] = result.median;
+            m_ROIMAD[n] = result.mad;
+        }
+        else
+        {
+            m_Statistics.median[n] = result.median;
+            m_MAD[n] = result.mad;
+        }
     }
 }
 
@@ -1690,9 +1842,39 @@ QPair<T, T> FITSData::getParitionMinMax(uint32_t start, uint32_t stride, bool ro
     return qMakePair(min, max);
 }
 
+template <typename T>
+void FITSData::sweepChannels(bool roi)
+{
+    bool &valid = roi ? m_ROISweepValid : m_SweepValid;
+    if (valid)
+        return;
+
+    auto * buffer = reinterpret_cast<T const *>(roi ? m_ImageRoiBuffer : m_ImageBuffer);
+    const uint32_t samplesPerChannel = roi ? m_ROIStatistics.samples_per_channel : m_Statistics.samples_per_channel;
+    auto * sweep = roi ? m_ROISweep : m_Sweep;
+
+    for (uint8_t n = 0; n < m_Statistics.channels; n++)
+        sweep[n] = FITSSweep::sweep(buffer + n * samplesPerChannel, samplesPerChannel, true);
+    valid = true;
+}
+
 template <typename T>
 void FITSData::calculateMinMax(bool roi)
 {
+    // A single vectorized pass gives the min/max along with the sums and histogram.
+    if constexpr (FITSSweep::hasKernel<T>())
+    {
+        sweepChannels<T>(roi);
+        const auto * sweep = roi ? m_ROISweep : m_Sweep;
+        auto &stats = roi ? m_ROIStatistics : m_Statistics;
+        for (int n = 0; n < m_Statistics.channels; n++)
+        {
+            stats.min[n] = sweep[n].min;
+            stats.max[n] = sweep[n].max;
+        }
+        return;
+    }
+
     T min = std::numeric_limits<T>::max();
     T max = std::numeric_limits<T>::min();
 
@@ -1783,6 +1965,21 @@ SumData getSumAndSquaredSum(uint32_t start, uint32_t stride, uint8_t *buff)
 template <typename T>
 void FITSData::calculateStdDev(bool roi )
 {
+    if constexpr (FITSSweep::hasKernel<T>())
+    {
+        sweepChannels<T>(roi);
+        const auto * sweep = roi ? m_ROISweep : m_Sweep;
+        auto &stats = roi ? m_ROIStatistics : m_Statistics;
+        for (int n = 0; n < m_Statistics.channels; n++)
+        {
+            if (sweep[n].count == 0)
+                continue;
+            stats.mean[n] = sweep[n].mean();
+            stats.stddev[n] = sqrt(sweep[n].variance());
+        }
+        return;
+    }
+
     // Create N threads
     const uint8_t nThreads = 16;
 
@@ -2150,8 +2347,7 @@ QFuture<bool> FITSData::findStars(StarAlgorithm algorithm, const QRect &tracking
         m_StarFindFuture.waitForFinished();
 
     starAlgorithm = algorithm;
-    qDeleteAll(starCenters);
-    starCenters.clear();
+    clearStarCenters();
     starsSearched = true;
 
     switch (algorithm)
@@ -2225,6 +2421,30 @@ QFuture<bool> FITSData::findStars(StarAlgorithm algorithm, const QRect &tracking
     }
 }
 
+void FITSData::clearStarCenters()
+{
+    // Only the edges outside of the store were allocated separately.
+    const std::less<const Edge *> before;
+    const Edge *storeBegin = m_StarStore.data();
+    const Edge *storeEnd = storeBegin + m_StarStore.size();
+    for (auto center : starCenters)
+    {
+        if (before(center, storeBegin) || !before(center, storeEnd))
+            delete center;
+    }
+    starCenters.clear();
+    m_StarStore.clear();
+}
+
+void FITSData::setStarCenters(std::vector<Edge> &&centers)
+{
+    clearStarCenters();
+    m_StarStore = std::move(centers);
+    starCenters.reserve(m_StarStore.size());
+    for (auto &center : m_StarStore)
+        starCenters.append(&center);
+}
+
 int FITSData::filterStars(QSharedPointer<ImageMask> mask)
 {
     if (mask.isNull() == false)
@@ -3957,8 +4177,9 @@ bool FITSData::rotFITS(int rotate, int mirror)
         }
     }
 
-    delete[] m_ImageBuffer;
+    releaseImageBuffer();
     m_ImageBuffer = rotimage;
+    m_SweepValid = false;
 
     return true;
 }
@@ -4248,6 +4469,8 @@ void FITSData::rotWCSFITS(int angle, int mirror)
 
 uint8_t * FITSData::getWritableImageBuffer()
 {
+    // The caller may change the pixels.
+    m_SweepValid = false;
     return m_ImageBuffer;
 }
 
@@ -4258,8 +4481,9 @@ uint8_t const * FITSData::getImageBuffer() const
 
 void FITSData::setImageBuffer(uint8_t * buffer)
 {
-    delete[] m_ImageBuffer;
+    releaseImageBuffer();
     m_ImageBuffer = buffer;
+    m_SweepValid = false;
 }
 
 bool FITSData::checkDebayer()
@@ -4364,6 +4588,8 @@ void FITSData::setBayerParams(BayerParams * param)
 
 bool FITSData::debayer(bool reload)
 {
+    m_SweepValid = false;
+
     if (reload)
     {
         int anynull = 0, status = 0;
@@ -4393,183 +4619,82 @@ bool FITSData::debayer(bool reload)
 
 bool FITSData::debayer_8bit()
 {
-    dc1394error_t error_code;
-
-    uint32_t rgb_size = m_Statistics.samples_per_channel * 3 * m_Statistics.bytesPerPixel;
-    uint8_t * destinationBuffer = nullptr;
-
-    try
-    {
-        destinationBuffer = new uint8_t[rgb_size];
-    }
-    catch (const std::bad_alloc &e)
-    {
-        logOOMError(rgb_size);
-        m_LastError = i18n("Unable to allocate memory for temporary bayer buffer: %1", e.what());
-        return false;
-    }
-
-    auto * bayer_source_buffer      = reinterpret_cast<uint8_t *>(m_ImageBuffer);
-    auto * bayer_destination_buffer = reinterpret_cast<uint8_t *>(destinationBuffer);
-
-    if (bayer_destination_buffer == nullptr)
-    {
-        logOOMError(rgb_size);
-        m_LastError = i18n("Unable to allocate memory for temporary bayer buffer.");
+    if (!debayer<uint8_t>())
         return false;
-    }
-
-    int ds1394_height = m_Statistics.height;
-    auto dc1394_source = bayer_source_buffer;
-
-    if (debayerParams.offsetY == 1)
-    {
-        dc1394_source += m_Statistics.width;
-        ds1394_height--;
-    }
-    // offsetX == 1 is handled in checkDebayer() and should be 0 here.
-
-    error_code = dc1394_bayer_decoding_8bit(dc1394_source, bayer_destination_buffer, m_Statistics.width, ds1394_height,
-                                            debayerParams.filter,
-                                            debayerParams.method);
-
-    if (error_code != DC1394_SUCCESS)
-    {
-        m_LastError = i18n("Debayer failed (%1)", error_code);
-        m_Statistics.channels = 1;
-        delete[] destinationBuffer;
-        return false;
-    }
-
-    if (m_ImageBufferSize != rgb_size)
-    {
-        delete[] m_ImageBuffer;
-        try
-        {
-            m_ImageBuffer = new uint8_t[rgb_size];
-        }
-        catch (const std::bad_alloc &e)
-        {
-            delete[] destinationBuffer;
-            logOOMError(rgb_size);
-            m_LastError = i18n("Unable to allocate memory for temporary bayer buffer: %1", e.what());
-            return false;
-        }
-
-        m_ImageBufferSize = rgb_size;
-    }
-
-    auto bayered_buffer = reinterpret_cast<uint8_t *>(m_ImageBuffer);
-
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-
-    uint8_t * rBuff = bayered_buffer;
-    uint8_t * gBuff = bayered_buffer + (m_Statistics.width * m_Statistics.height);
-    uint8_t * bBuff = bayered_buffer + (m_Statistics.width * m_Statistics.height * 2);
-
-    int imax = m_Statistics.samples_per_channel * 3 - 3;
-    for (int i = 0; i <= imax; i += 3)
-    {
-        *rBuff++ = bayer_destination_buffer[i];
-        *gBuff++ = bayer_destination_buffer[i + 1];
-        *bBuff++ = bayer_destination_buffer[i + 2];
-    }
 
     // TODO Maybe all should be treated the same
     // Doing single channel saves lots of memory though for non-essential
     // frames
     m_Statistics.channels = (m_Mode == FITS_NORMAL || m_Mode == FITS_CALIBRATE) ? 3 : 1;
     m_Statistics.dataType = TBYTE;
-    delete[] destinationBuffer;
     return true;
 }
 
 bool FITSData::debayer_16bit()
 {
-    dc1394error_t error_code;
+    if (!debayer<uint16_t>())
+        return false;
+
+    m_Statistics.channels = (m_Mode == FITS_NORMAL || m_Mode == FITS_CALIBRATE) ? 3 : 1;
+    m_Statistics.dataType = TUSHORT;
+    return true;
+}
+
+template <typename T>
+bool FITSData::debayer()
+{
+    const uint32_t channel_size = m_Statistics.samples_per_channel * m_Statistics.bytesPerPixel;
+    const uint32_t rgb_size = channel_size * 3;
+
+    // The planes are written while the bayered data is read, they can't share memory.
+    uint8_t *bayerBuffer = m_ImageBuffer;
+    uint8_t *planarBuffer = m_ImageBuffer;
+    uint8_t *allocated = nullptr;
+    const bool reallocate = m_ImageBufferSize != rgb_size || m_ImageBufferMapped;
+    const uint32_t allocated_size = reallocate ? rgb_size : channel_size;
 
-    uint32_t rgb_size = m_Statistics.samples_per_channel * 3 * m_Statistics.bytesPerPixel;
-    uint8_t *destinationBuffer = nullptr;
     try
     {
-        destinationBuffer = new uint8_t[rgb_size];
+        allocated = new uint8_t[allocated_size];
     }
     catch (const std::bad_alloc &e)
     {
-        logOOMError(rgb_size);
+        logOOMError(allocated_size);
         m_LastError = i18n("Unable to allocate memory for temporary bayer buffer: %1", e.what());
         return false;
     }
 
-    auto * bayer_source_buffer      = reinterpret_cast<uint16_t *>(m_ImageBuffer);
-    auto * bayer_destination_buffer = reinterpret_cast<uint16_t *>(destinationBuffer);
-
-    if (bayer_destination_buffer == nullptr)
+    if (reallocate)
+        planarBuffer = allocated;
+    else
     {
-        logOOMError(rgb_size);
-        m_LastError = i18n("Unable to allocate memory for temporary bayer buffer.");
-        return false;
+        // Debayering again an image already read into a 3 channel buffer, copy out the bayered channel.
+        memcpy(allocated, m_ImageBuffer, channel_size);
+        bayerBuffer = allocated;
     }
 
-    int ds1394_height = m_Statistics.height;
-    auto dc1394_source = bayer_source_buffer;
-
-    if (debayerParams.offsetY == 1)
-    {
-        dc1394_source += m_Statistics.width;
-        ds1394_height--;
-    }
     // offsetX == 1 is handled in checkDebayer() and should be 0 here.
-
-    error_code = dc1394_bayer_decoding_16bit(dc1394_source, bayer_destination_buffer, m_Statistics.width, ds1394_height,
-                 debayerParams.filter,
-                 debayerParams.method, 16);
+    dc1394error_t error_code = FITSBayer::debayer(reinterpret_cast<const T *>(bayerBuffer),
+                               reinterpret_cast<T *>(planarBuffer), m_Statistics.width, m_Statistics.height,
+                               debayerParams);
 
     if (error_code != DC1394_SUCCESS)
     {
-        m_LastError = i18n("Debayer failed (%1)");
+        m_LastError = i18n("Debayer failed (%1)", error_code);
         m_Statistics.channels = 1;
-        delete[] destinationBuffer;
+        delete[] allocated;
         return false;
     }
 
-    if (m_ImageBufferSize != rgb_size)
+    if (reallocate)
     {
-        delete[] m_ImageBuffer;
-        try
-        {
-            m_ImageBuffer = new uint8_t[rgb_size];
-        }
-        catch (const std::bad_alloc &e)
-        {
-            logOOMError(rgb_size);
-            delete[] destinationBuffer;
-            m_LastError = i18n("Unable to allocate memory for temporary bayer buffer: %1", e.what());
-            return false;
-        }
-
+        releaseImageBuffer();
+        m_ImageBuffer = planarBuffer;
         m_ImageBufferSize = rgb_size;
     }
+    else
+        delete[] allocated;
 
-    auto bayered_buffer = reinterpret_cast<uint16_t *>(m_ImageBuffer);
-
-    // Data in R1G1B1, we need to copy them into 3 layers for FITS
-
-    uint16_t * rBuff = bayered_buffer;
-    uint16_t * gBuff = bayered_buffer + (m_Statistics.width * m_Statistics.height);
-    uint16_t * bBuff = bayered_buffer + (m_Statistics.width * m_Statistics.height * 2);
-
-    int imax = m_Statistics.samples_per_channel * 3 - 3;
-    for (int i = 0; i <= imax; i += 3)
-    {
-        *rBuff++ = bayer_destination_buffer[i];
-        *gBuff++ = bayer_destination_buffer[i + 1];
-        *bBuff++ = bayer_destination_buffer[i + 2];
-    }
-
-    m_Statistics.channels = (m_Mode == FITS_NORMAL || m_Mode == FITS_CALIBRATE) ? 3 : 1;
-    m_Statistics.dataType = TUSHORT;
-    delete[] destinationBuffer;
     return true;
 }
 
@@ -4949,6 +5074,9 @@ void FITSData::saveStatistics(FITSImage::Statistic &other)
 void FITSData::restoreStatistics(FITSImage::Statistic &other)
 {
     m_Statistics = other;
+    // The MAD and the fused pass results aren't part of the saved statistics.
+    std::fill(m_MAD, m_MAD + 3, -1);
+    m_SweepValid = false;
 
     emit dataChanged();
 }
@@ -5089,6 +5217,24 @@ template <typename T> void FITSData::constructHistogramInternal()
     {
         futures.append(QtConcurrent::run([ = ]()
         {
+            // The full resolution histogram of the last pass over the image only needs each value binned once,
+            // and counts every sample rather than a subsample.
+            if constexpr (FITSSweep::hasKernel<T>() && FITSSweep::hasHistogram<T>())
+            {
+                if (m_SweepValid)
+                {
+                    const auto &values = m_Sweep[n].histogram;
+                    for (uint32_t v = 0; v < values.size(); v++)
+                    {
+                        if (values[v] == 0)
+                            continue;
+                        int32_t id = histogramBinInternal<T>(static_cast<T>(v + m_Sweep[n].histogramOrigin), n);
+                        m_HistogramFrequency[n][id] += values[v];
+                    }
+                    return;
+                }
+            }
+
             uint32_t offset = n * samples;
 
             for (uint32_t i = 0; i < samples; i += sampleBy)
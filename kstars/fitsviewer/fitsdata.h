@@ -23,6 +23,7 @@
 #include "skybackground.h"
 #include "fitscommon.h"
 #include "fitsstardetector.h"
+#include "fitssweep.h"
 #include "auxiliary/imagemask.h"
 
 #ifdef WIN32
@@ -32,6 +33,7 @@
 
 #include <fitsio.h>
 
+#include <QFile>
 #include <QFuture>
 #include <QObject>
 #include <QRect>
@@ -214,6 +216,7 @@ class FITSData : public QObject
         void setMedian(double val, uint8_t channel = 0)
         {
             m_Statistics.median[channel] = val;
+            m_MAD[channel] = -1;
         }
         // for single channel, just return the median for channel zero
         // for color, return the average
@@ -222,6 +225,21 @@ class FITSData : public QObject
         {
             return roi ? m_ROIStatistics.median[channel] :  m_Statistics.median[channel];
         }
+        // Median absolute deviation, computed along with the median.
+        // Negative if unknown, e.g. when the median was read from the FITS header.
+        double getMAD(uint8_t channel = 0, bool roi = false) const
+        {
+            return roi ? m_ROIMAD[channel] : m_MAD[channel];
+        }
+        // Fills the per-channel median and MAD arrays, e.g. for Stretch::computeParams().
+        void getMedianAndMAD(double median[3], double mad[3], bool roi = false) const
+        {
+            for (int channel = 0; channel < 3; channel++)
+            {
+                median[channel] = getMedian(channel, roi);
+                mad[channel] = getMAD(channel, roi);
+            }
+        }
 
         int getBytesPerPixel() const
         {
@@ -300,9 +318,14 @@ class FITSData : public QObject
 
         void setStarCenters(const QList<Edge*> &centers)
         {
-            qDeleteAll(starCenters);
+            clearStarCenters();
             starCenters = centers;
         }
+        /**
+         * @brief setStarCenters Sets the detected stars from a contiguous store, which is kept by
+         * FITSData. getStarCenters() then points into that store instead of separately allocated edges.
+         */
+        void setStarCenters(std::vector<Edge> &&centers);
         QFuture<bool> findStars(StarAlgorithm algorithm = ALGORITHM_CENTROID, const QRect &trackingBox = QRect());
 
         void setSkyBackground(const SkyBackground &bg)
@@ -704,6 +727,14 @@ class FITSData : public QObject
         bool loadCanonicalImage(const QByteArray &buffer);
         // Load FITS images.
         bool loadFITSImage(const QByteArray &buffer, const bool isCompressed = false);
+        // Read the pixels of an uncompressed FITS file through a mapping instead of cfitsio, converting them in parallel.
+        // 8 bit masters loaded for calibration are used straight from the mapping. Returns false if the file can't be
+        // mapped, in which case the pixels must be read through cfitsio.
+        bool mapFITSImage(long nelements);
+        // Free the image buffer, unmapping it if it was mapped.
+        void releaseImageBuffer();
+        // Free the detected stars, except those held by m_StarStore.
+        void clearStarCenters();
         // Load XISF images.
         bool loadXISFImage(const QByteArray &buffer);
         // Save XISF images.
@@ -760,6 +791,10 @@ class FITSData : public QObject
         template <typename T>
         QPair<T, T> getParitionMinMax(uint32_t start, uint32_t stride, bool roi);
 
+        // Runs the fused pass over each channel (see FITSSweep) unless its results are current.
+        template <typename T>
+        void sweepChannels(bool roi = false);
+
         /* Calculate the Gaussian blur matrix and apply it to the image using the convolution filter */
         QVector<double> createGaussianKernel(int size, double sigma);
         template <typename T>
@@ -834,10 +869,16 @@ class FITSData : public QObject
 
         /// Pointer to CFITSIO FITS file struct
         fitsfile *fptr { nullptr };
+        /// Buffer the image was loaded from, which a memory FITS file keeps reading
+        QByteArray m_SourceBuffer;
         /// Generic data image buffer
         uint8_t *m_ImageBuffer { nullptr };
         /// Above buffer size in bytes
         uint32_t m_ImageBufferSize { 0 };
+        /// File holding the image buffer when it is mapped rather than allocated
+        QFile m_MappedFile;
+        /// Is the image buffer mapped from m_MappedFile?
+        bool m_ImageBufferMapped { false };
         /// Image Buffer if Selection is to be done
         uint8_t *m_ImageRoiBuffer { nullptr };
         /// Above buffer size in bytes
@@ -881,6 +922,8 @@ class FITSData : public QObject
         WCSState m_WCSState { Idle };
         /// All the stars we detected, if any.
         QList<Edge *> starCenters;
+        /// Contiguous storage of the detected stars, for detectors that provide them at once.
+        std::vector<Edge> m_StarStore;
         QList<Edge *> localStarCenters;
         /// The biggest fattest star in the image.
         Edge m_SelectedHFRStar;
@@ -895,6 +938,16 @@ class FITSData : public QObject
         int m_FITSBITPIX {USHORT_IMG};
         FITSImage::Statistic m_Statistics;
         FITSImage::Statistic m_ROIStatistics;
+        // Median absolute deviations, kept alongside the statistics since
+        // FITSImage::Statistic is shared with StellarSolver.
+        double m_MAD[3] { -1, -1, -1 };
+        double m_ROIMAD[3] { -1, -1, -1 };
+        // Results of the fused pass over each channel of the image and of the ROI, shared by the min/max,
+        // median, standard deviation and histogram calculations. Valid until the pixels change.
+        FITSSweep::Result m_Sweep[3];
+        FITSSweep::Result m_ROISweep[3];
+        bool m_SweepValid { false };
+        bool m_ROISweepValid { false };
 
         // A list of header records
         QList<Record> m_HeaderRecords;
@@ -271,8 +271,10 @@ void FITSHistogramView::createNonLinearHistogram()
     }
 
     Stretch stretch(width, height, m_ImageData->channels(), m_ImageData->dataType());
-    // Compute new auto-stretch params.
-    StretchParams stretchParams = stretch.computeParams(m_ImageData->getImageBuffer());
+    // Compute new auto-stretch params, reusing the median and MAD from the image statistics.
+    double median[3], mad[3];
+    m_ImageData->getMedianAndMAD(median, mad);
+    StretchParams stretchParams = stretch.computeParams(m_ImageData->getImageBuffer(), median, mad);
 
     stretch.setParams(stretchParams);
     stretch.run(m_ImageData->getImageBuffer(), &rawImage);
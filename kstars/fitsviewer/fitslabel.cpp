@@ -26,6 +26,8 @@
 #include "indi/indimount.h"
 #endif
 
+#include <QPainter>
+#include <QPaintEvent>
 #include <QScrollBar>
 #include <QToolTip>
 
@@ -112,6 +114,19 @@ void FITSLabel::leaveEvent(QEvent *e)
     emit mouseOverPixel(-1, -1);
 }
 
+void FITSLabel::paintEvent(QPaintEvent *e)
+{
+    if (!view->isTiledImage())
+    {
+        QLabel::paintEvent(e);
+        return;
+    }
+
+    // Very large images are painted tile by tile, only where exposed.
+    QPainter painter(this);
+    view->drawTiledFrame(&painter, e->rect());
+}
+
 /**
 I added some things to the top of this method to allow panning and Scope slewing to function.
 If you are in the dragMouse mode and the mousebutton is pressed, The method checks the difference
@@ -0,0 +1,310 @@
+/*  FITS Median
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitsmedian.h"
+#include "fitsparallel.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <type_traits>
+#include <vector>
+
+namespace FITSMedian
+{
+
+namespace
+{
+
+// Number of bins used when a type can't be binned with one bin per value.
+constexpr uint32_t numQuantizedBins = 64 * 1024;
+
+// Maximum number of histogram refinement levels used to select a quantized value.
+constexpr int maxRefinementLevels = 4;
+
+// NaN and infinite samples (only possible for floating point types) are ignored.
+template <typename T>
+inline bool isValid(T value)
+{
+    if constexpr (std::is_floating_point<T>::value)
+        return std::isfinite(value);
+    else
+        return true;
+}
+
+// Adds the per-thread histograms into the first one.
+uint32_t mergeHistograms(std::vector<std::vector<uint32_t>> &partials)
+{
+    auto &merged = partials[0];
+    for (size_t p = 1; p < partials.size(); p++)
+        for (size_t i = 0; i < merged.size(); i++)
+            merged[i] += partials[p][i];
+
+    uint32_t total = 0;
+    for (const auto bin : merged)
+        total += bin;
+    return total;
+}
+
+// Returns the bin holding the sample of the given (0-based, sorted order) rank,
+// and sets below to the number of samples held by the lower bins.
+uint32_t binOfRank(const std::vector<uint32_t> &bins, uint32_t rank, uint32_t *below)
+{
+    uint32_t cumulative = 0;
+    for (uint32_t i = 0; i < bins.size(); i++)
+    {
+        if (cumulative + bins[i] > rank)
+        {
+            *below = cumulative;
+            return i;
+        }
+        cumulative += bins[i];
+    }
+    *below = cumulative;
+    return bins.size() - 1;
+}
+
+// Median of the deviations from the given median, for a histogram where bin i holds
+// the samples of value origin + i. Walks outwards from the median, always taking the
+// side with the smallest deviation, so the deviations are visited in sorted order.
+double madFromExactHistogram(const std::vector<uint32_t> &bins, uint32_t count, double origin, double median)
+{
+    const uint32_t rank1 = (count - 1) / 2;
+    const uint32_t rank2 = count / 2;
+    const int64_t numBins = bins.size();
+
+    int64_t left = std::floor(median - origin);
+    int64_t right = left + 1;
+    uint32_t seen = 0;
+    double deviation1 = -1;
+
+    while (left >= 0 || right < numBins)
+    {
+        const double leftDeviation = left >= 0 ? median - (origin + left) : std::numeric_limits<double>::max();
+        const double rightDeviation = right < numBins ? (origin + right) - median : std::numeric_limits<double>::max();
+        const bool takeLeft = leftDeviation <= rightDeviation;
+        const double deviation = takeLeft ? leftDeviation : rightDeviation;
+        const uint32_t binCount = takeLeft ? bins[left--] : bins[right++];
+
+        if (binCount == 0)
+            continue;
+        seen += binCount;
+        if (deviation1 < 0 && seen > rank1)
+            deviation1 = deviation;
+        if (seen > rank2)
+            return (deviation1 + deviation) / 2;
+    }
+    return 0;
+}
+
+// Exact median and MAD for 8 and 16 bit types, from a single histogram sweep.
+template <typename T>
+Result computeExact(T const *buffer, uint32_t count)
+{
+    constexpr int64_t lowest = std::numeric_limits<T>::lowest();
+    constexpr uint32_t numBins = 1u << (8 * sizeof(T));
+
+    auto partials = FITSParallel::runPartitioned<std::vector<uint32_t>>(count, [buffer](uint32_t start, uint32_t end)
+    {
+        std::vector<uint32_t> bins(numBins, 0);
+        for (uint32_t i = start; i < end; i++)
+            bins[static_cast<int64_t>(buffer[i]) - lowest]++;
+        return bins;
+    });
+    const uint32_t total = mergeHistograms(partials);
+    return fromHistogram(partials[0], lowest, total);
+}
+
+// Selects the average of the values of ranks rank1 and rank2 (equal, or consecutive) of
+// transform(sample), considering only the samples whose transformed value lies within [low, high].
+// Each level histograms that range and keeps the extremes of every bin. When both ranks land in
+// the same bin, the range is narrowed to that bin's extremes and the process repeats; since the
+// bins are monotonic in value, this keeps exactly the samples of that bin. The result is exact
+// unless the refinement levels run out, in which case it is interpolated within the last bin.
+template <typename T, typename F>
+double selectMiddle(T const *buffer, uint32_t count, const F &transform, double low, double high,
+                    uint32_t rank1, uint32_t rank2, bool integral)
+{
+    struct Partial
+    {
+        std::vector<uint32_t> bins;
+        std::vector<double> minimums;
+        std::vector<double> maximums;
+    };
+
+    for (int level = 0; ; level++)
+    {
+        const bool exact = integral && (high - low + 1) <= numQuantizedBins;
+        const uint32_t numBins = exact ? static_cast<uint32_t>(high - low + 1) : numQuantizedBins;
+        const double width = exact ? 1.0 : (high - low) / numBins;
+
+        auto partials = FITSParallel::runPartitioned<Partial>(count, [ =, &transform](uint32_t start, uint32_t end)
+        {
+            Partial partial;
+            partial.bins.resize(numBins, 0);
+            partial.minimums.resize(numBins, std::numeric_limits<double>::max());
+            partial.maximums.resize(numBins, std::numeric_limits<double>::lowest());
+            for (uint32_t i = start; i < end; i++)
+            {
+                if (!isValid(buffer[i]))
+                    continue;
+                const double value = transform(buffer[i]);
+                if (value < low || value > high)
+                    continue;
+                const uint32_t bin = width > 0 ? std::min<uint32_t>((value - low) / width, numBins - 1) : 0;
+                partial.bins[bin]++;
+                partial.minimums[bin] = std::min(partial.minimums[bin], value);
+                partial.maximums[bin] = std::max(partial.maximums[bin], value);
+            }
+            return partial;
+        });
+
+        std::vector<std::vector<uint32_t>> histograms;
+        auto &minimums = partials[0].minimums;
+        auto &maximums = partials[0].maximums;
+        for (size_t p = 0; p < partials.size(); p++)
+        {
+            histograms.push_back(std::move(partials[p].bins));
+            for (size_t i = 0; p > 0 && i < numBins; i++)
+            {
+                minimums[i] = std::min(minimums[i], partials[p].minimums[i]);
+                maximums[i] = std::max(maximums[i], partials[p].maximums[i]);
+            }
+        }
+        mergeHistograms(histograms);
+        const auto &bins = histograms[0];
+
+        uint32_t below1 = 0, below2 = 0;
+        const uint32_t bin1 = binOfRank(bins, rank1, &below1);
+        const uint32_t bin2 = binOfRank(bins, rank2, &below2);
+
+        // The ranks are consecutive, so the first is the largest sample of its bin
+        // and the second the smallest of the next non-empty bin.
+        if (bin1 != bin2)
+            return (maximums[bin1] + minimums[bin2]) / 2;
+
+        if (exact || minimums[bin1] >= maximums[bin1])
+            return minimums[bin1];
+
+        if (level + 1 < maxRefinementLevels)
+        {
+            rank1 -= below1;
+            rank2 -= below1;
+            low = minimums[bin1];
+            high = maximums[bin1];
+            continue;
+        }
+
+        const double span = maximums[bin1] - minimums[bin1];
+        auto interpolate = [&](uint32_t rank)
+        {
+            const double value = minimums[bin1] + span * (rank - below1 + 0.5) / bins[bin1];
+            return integral ? std::round(value) : value;
+        };
+        return (interpolate(rank1) + interpolate(rank2)) / 2;
+    }
+}
+
+// Median and MAD for 32/64 bit integers and floating point types.
+template <typename T>
+Result computeQuantized(T const *buffer, uint32_t count)
+{
+    constexpr bool integral = std::is_integral<T>::value;
+
+    struct Extrema
+    {
+        double minimum { std::numeric_limits<double>::max() };
+        double maximum { std::numeric_limits<double>::lowest() };
+        uint32_t valid { 0 };
+    };
+
+    auto partials = FITSParallel::runPartitioned<Extrema>(count, [buffer](uint32_t start, uint32_t end)
+    {
+        Extrema extrema;
+        for (uint32_t i = start; i < end; i++)
+        {
+            if (!isValid(buffer[i]))
+                continue;
+            const double value = buffer[i];
+            extrema.minimum = std::min(extrema.minimum, value);
+            extrema.maximum = std::max(extrema.maximum, value);
+            extrema.valid++;
+        }
+        return extrema;
+    });
+
+    Extrema extrema;
+    for (const auto &partial : partials)
+    {
+        extrema.minimum = std::min(extrema.minimum, partial.minimum);
+        extrema.maximum = std::max(extrema.maximum, partial.maximum);
+        extrema.valid += partial.valid;
+    }
+
+    Result result;
+    if (extrema.valid == 0)
+        return result;
+
+    const uint32_t rank1 = (extrema.valid - 1) / 2;
+    const uint32_t rank2 = extrema.valid / 2;
+
+    auto identity = [](T value)
+    {
+        return static_cast<double>(value);
+    };
+    result.median = selectMiddle(buffer, count, identity, extrema.minimum, extrema.maximum, rank1, rank2, integral);
+
+    const double median = result.median;
+    auto deviation = [median](T value)
+    {
+        return std::fabs(static_cast<double>(value) - median);
+    };
+    // Deviations from a half-integer median are not integers.
+    const bool integralDeviations = integral && median == std::floor(median);
+    const double maxDeviation = std::max(median - extrema.minimum, extrema.maximum - median);
+    result.mad = selectMiddle(buffer, count, deviation, 0.0, maxDeviation, rank1, rank2, integralDeviations);
+    return result;
+}
+
+}  // namespace
+
+Result fromHistogram(const std::vector<uint32_t> &bins, int64_t origin, uint32_t count)
+{
+    Result result;
+    if (count == 0)
+        return result;
+
+    uint32_t below = 0;
+    const double low = origin + binOfRank(bins, (count - 1) / 2, &below);
+    const double high = origin + binOfRank(bins, count / 2, &below);
+
+    result.median = (low + high) / 2;
+    result.mad = madFromExactHistogram(bins, count, origin, result.median);
+    return result;
+}
+
+template <typename T>
+Result compute(T const *buffer, uint32_t count)
+{
+    if (buffer == nullptr || count == 0)
+        return Result();
+
+    if constexpr (std::is_integral<T>::value && sizeof(T) <= 2)
+        return computeExact(buffer, count);
+    else
+        return computeQuantized(buffer, count);
+}
+
+template Result compute(uint8_t const *buffer, uint32_t count);
+template Result compute(int16_t const *buffer, uint32_t count);
+template Result compute(uint16_t const *buffer, uint32_t count);
+template Result compute(int32_t const *buffer, uint32_t count);
+template Result compute(uint32_t const *buffer, uint32_t count);
+template Result compute(long const *buffer, uint32_t count);
+template Result compute(long long const *buffer, uint32_t count);
+template Result compute(float const *buffer, uint32_t count);
+template Result compute(double const *buffer, uint32_t count);
+
+}
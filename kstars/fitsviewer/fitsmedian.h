@@ -0,0 +1,61 @@
+/*  FITS Median
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <vector>
+
+// Histogram-based median and median absolute deviation (MAD) of an image channel.
+//
+// The image is swept once (or a few times for wide types) by several threads, each building
+// its own histogram, which are then merged. Median and MAD are both read from the merged
+// histograms, so no copy of the samples and no sort is needed.
+//
+// uint8, int16 and uint16 channels use one bin per possible value and the results are exact.
+//
+// Wider integer types and floating point types are re-binned instead. Each sweep histograms
+// the values within the current range into 64K bins, keeping the smallest and largest value
+// of every bin, then narrows the range to the bin holding the middle ranks. The median is
+// selected this way among the samples, then the MAD among their deviations from the median.
+// The selection stops with the exact value when:
+// - the middle ranks fall in different bins, as the largest value of one and the smallest of the next;
+// - the bin holds a single distinct value;
+// - for integers, the range fits one bin per value.
+// Otherwise, after 4 sweeps, the value is interpolated within the last bin. That bin is at
+// most 1/65536^4 of the initial range wide: the range of the samples for the median, and of
+// the deviations for the MAD. The results for 32 bit integers are therefore always exact.
+// For 64 bit integers they are exact up to the 53 bit precision of double, except that the
+// MAD around a half-integer median may be off by less than one. For floating point types the
+// error is at most the width of that last bin.
+//
+// The median follows the usual convention: for an even number of samples it is the average
+// of the two middle samples. The MAD is not scaled (multiply by 1.4826 for a sigma estimate).
+namespace FITSMedian
+{
+
+struct Result
+{
+    double median { 0 };
+    double mad { 0 };
+};
+
+/**
+ * @brief compute Returns the median and MAD of the given samples.
+ * @param buffer pointer to the first sample of the channel.
+ * @param count number of samples in the channel.
+ * @note Uses multiple threads, blocks until done.
+ */
+template <typename T>
+Result compute(T const *buffer, uint32_t count);
+
+/**
+ * @brief fromHistogram Returns the median and MAD of samples already counted in a histogram
+ * with one bin per value, where bin i holds the samples of value origin + i.
+ * @param count total number of samples in the histogram.
+ */
+Result fromHistogram(const std::vector<uint32_t> &bins, int64_t origin, uint32_t count);
+
+}
@@ -0,0 +1,57 @@
+/*  FITS Parallel
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QtConcurrent>
+#include <QThread>
+
+#include <algorithm>
+#include <stdint.h>
+#include <vector>
+
+namespace FITSParallel
+{
+
+// Below this many samples it isn't worth spreading the work over threads.
+constexpr uint32_t minSamplesPerThread = 64 * 1024;
+
+/**
+ * @brief runPartitioned Splits [0, count) into one partition per thread, runs job(start, end)
+ * on each of them, and returns the per-partition results in order.
+ * @note Blocks until done. Small counts are processed on the calling thread.
+ */
+template <typename R, typename F>
+std::vector<R> runPartitioned(uint32_t count, const F &job)
+{
+    const uint32_t nThreads = std::max(1u, std::min<uint32_t>(QThread::idealThreadCount(),
+                                       count / minSamplesPerThread));
+    const uint32_t stride = count / nThreads;
+
+    std::vector<R> results;
+    results.reserve(nThreads);
+
+    if (nThreads == 1)
+    {
+        results.push_back(job(0, count));
+        return results;
+    }
+
+    QList<QFuture<R>> futures;
+    for (uint32_t i = 0; i < nThreads; i++)
+    {
+        const uint32_t start = i * stride;
+        const uint32_t end = (i == nThreads - 1) ? count : start + stride;
+        futures.append(QtConcurrent::run([ =, &job]()
+        {
+            return job(start, end);
+        }));
+    }
+    for (auto &future : futures)
+        results.push_back(future.result());
+    return results;
+}
+
+}
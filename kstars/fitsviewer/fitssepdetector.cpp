@@ -14,15 +14,16 @@
 #include "fitssepdetector.h"
 #include "fitsdata.h"
 #include "Options.h"
-#include "kspaths.h"
 
+#include <algorithm>
 #include <memory>
+#include <vector>
 #include <math.h>
 #include <QPointer>
 #include <QtConcurrent>
 
 #ifdef HAVE_STELLARSOLVER
-#include "ekos/auxiliary/stellarsolverprofileeditor.h"
+#include "ekos/auxiliary/stellarsolverprofile.h"
 #include <stellarsolver.h>
 #else
 #include <cstring>
@@ -68,7 +69,6 @@ bool FITSSEPDetector::findSourcesAndBackground(QRect const &boundary)
     Q_UNUSED(boundary)
     return false;
 #else
-    QList<Edge*> starCenters;
     SkyBackground skyBG;
     int maxStarsCount = getValue("maxStarsCount", 100000).toInt();
 
@@ -76,46 +76,9 @@ bool FITSSEPDetector::findSourcesAndBackground(QRect const &boundary)
     Ekos::ProfileGroup group = static_cast<Ekos::ProfileGroup>(getValue("optionsProfileGroup", 1).toInt());
     QScopedPointer<StellarSolver, QScopedPointerDeleteLater> solver(new StellarSolver(m_ImageData->getStatistics(),
             m_ImageData->getImageBuffer()));
-    QString filename = "";
     QPointer<FITSData> image(m_ImageData);
-    switch(group)
-    {
-        case Ekos::AlignProfiles:
-            //So it should not be here if it is Align.
-            break;
-        case Ekos::GuideProfiles:
-            filename = "SavedGuideProfiles.ini";
-            break;
-        case Ekos::FocusProfiles:
-            filename = "SavedFocusProfiles.ini";
-            break;
-        case Ekos::HFRProfiles:
-            filename = "SavedHFRProfiles.ini";
-            break;
-    }
-
-    QString savedOptionsProfiles = QDir(KSPaths::writableLocation(QStandardPaths::AppLocalDataLocation)).filePath(filename);
-    QList<SSolver::Parameters> optionsList;
-    if(QFile(savedOptionsProfiles).exists())
-        optionsList = StellarSolver::loadSavedOptionsProfiles(savedOptionsProfiles);
-    else
-    {
-        switch(group)
-        {
-            case Ekos::AlignProfiles:
-                optionsList = Ekos::getDefaultAlignOptionsProfiles();
-                break;
-            case Ekos::GuideProfiles:
-                optionsList = Ekos::getDefaultGuideOptionsProfiles();
-                break;
-            case Ekos::FocusProfiles:
-                optionsList = Ekos::getDefaultFocusOptionsProfiles();
-                break;
-            case Ekos::HFRProfiles:
-                optionsList = Ekos::getDefaultHFROptionsProfiles();
-                break;
-        }
-    }
+    // Cached, so that guiding and focusing don't parse the profiles file for every frame.
+    const QList<SSolver::Parameters> optionsList = Ekos::getOptionsProfiles(group);
     if (optionsProfileIndex >= 0 && optionsList.count() > optionsProfileIndex)
     {
         auto params = optionsList[optionsProfileIndex];
@@ -136,23 +99,62 @@ bool FITSSEPDetector::findSourcesAndBackground(QRect const &boundary)
     solver->setLogLevel(SSolver::LOG_NONE);
     solver->setSSLogLevel(SSolver::LOG_OFF);
 
-    if (boundary.isValid())
-        solver->extract(runHFR, boundary);
+    const QVariantList regionList = getValue("regions", QVariantList()).toList();
+    if (!regionList.isEmpty())
+    {
+        QList<QRect> windows;
+        for (const auto &region : regionList)
+            windows.append(region.toRect());
+        const QRect frame(0, 0, m_ImageData->width(), m_ImageData->height());
+        const QVector<QRect> regions = mergeRegions(windows, boundary.isValid() ? (boundary & frame) : frame);
+
+        // The same solver extracts each region, only the pixels of the regions are converted.
+        // The background of the regions is pooled, weighted by their areas, and so are the pixels it
+        // was estimated from.
+        double area = 0, sum = 0, sumSquares = 0;
+        int starsDetected = 0, skyPixels = 0;
+        for (const QRect &region : regions)
+        {
+            solver->extract(runHFR, region);
+            stars.append(solver->getStarList());
+
+            const auto bg = solver->getBackground();
+            const double regionArea = static_cast<double>(region.width()) * region.height();
+            area += regionArea;
+            sum += regionArea * bg.global;
+            sumSquares += regionArea * (bg.globalrms * bg.globalrms + bg.global * bg.global);
+            starsDetected += bg.num_stars_detected;
+            skyPixels += bg.bw * bg.bh;
+        }
+
+        if (stars.empty() || image.isNull())
+            return false;
+
+        skyBG.mean = sum / area;
+        skyBG.sigma = sqrt(std::max(0.0, sumSquares / area - skyBG.mean * skyBG.mean));
+        skyBG.numPixelsInSkyEstimate = skyPixels;
+        skyBG.setStarsDetected(starsDetected);
+    }
     else
-        solver->extract(runHFR);
+    {
+        if (boundary.isValid())
+            solver->extract(runHFR, boundary);
+        else
+            solver->extract(runHFR);
 
-    stars = solver->getStarList();
+        stars = solver->getStarList();
 
-    // If m_ImageData goes out of scope, also return.
-    if (stars.empty() || image.isNull())
-        return false;
+        // If m_ImageData goes out of scope, also return.
+        if (stars.empty() || image.isNull())
+            return false;
 
-    auto bg = solver->getBackground();
+        auto bg = solver->getBackground();
 
-    skyBG.mean = bg.global;
-    skyBG.sigma = bg.globalrms;
-    skyBG.numPixelsInSkyEstimate = bg.bw * bg.bh;
-    skyBG.setStarsDetected(bg.num_stars_detected);
+        skyBG.mean = bg.global;
+        skyBG.sigma = bg.globalrms;
+        skyBG.numPixelsInSkyEstimate = bg.bw * bg.bh;
+        skyBG.setStarsDetected(bg.num_stars_detected);
+    }
     m_ImageData->setSkyBackground(skyBG);
 
     //There is more information that can be obtained by the Stellarsolver->
@@ -168,31 +170,55 @@ bool FITSSEPDetector::findSourcesAndBackground(QRect const &boundary)
 
     // Take only the first maxNumCenters stars
     int starCount = qMin(maxStarsCount, stars.count());
-    starCenters.reserve(starCount);
+    std::vector<Edge> starCenters(starCount);
     for (int i = 0; i < starCount; i++)
     {
-        Edge *oneEdge = new Edge();
-        oneEdge->x = stars[i].x;
-        oneEdge->y = stars[i].y;
-        oneEdge->val = stars[i].peak;
-        oneEdge->sum = stars[i].flux;
-        oneEdge->HFR = stars[i].HFR;
-        oneEdge->width = stars[i].a;
-        oneEdge->numPixels = stars[i].numPixels;
+        Edge &oneEdge = starCenters[i];
+        oneEdge.x = stars[i].x;
+        oneEdge.y = stars[i].y;
+        oneEdge.val = stars[i].peak;
+        oneEdge.sum = stars[i].flux;
+        oneEdge.HFR = stars[i].HFR;
+        oneEdge.width = stars[i].a;
+        oneEdge.numPixels = stars[i].numPixels;
         if (stars[i].a > 0)
             // See page 63 to find the ellipticity equation for SEP.
             // http://astroa.physics.metu.edu.tr/MANUALS/sextractor/Guide2source_extractor.pdf
-            oneEdge->ellipticity = 1 - stars[i].b / stars[i].a;
+            oneEdge.ellipticity = 1 - stars[i].b / stars[i].a;
         else
-            oneEdge->ellipticity = 0;
-
-        starCenters.append(oneEdge);
+            oneEdge.ellipticity = 0;
     }
-    m_ImageData->setStarCenters(starCenters);
+    m_ImageData->setStarCenters(std::move(starCenters));
     return true;
 #endif
 }
 
+QVector<QRect> FITSSEPDetector::mergeRegions(const QList<QRect> &regions, const QRect &frame)
+{
+    QVector<QRect> merged;
+    for (const QRect &region : regions)
+    {
+        QRect window = region & frame;
+        if (window.isEmpty())
+            continue;
+
+        // Once grown, the window may reach regions it did not overlap before, so start over.
+        for (int i = 0; i < merged.size();)
+        {
+            if (merged[i].intersects(window))
+            {
+                window |= merged[i];
+                merged.remove(i);
+                i = 0;
+            }
+            else
+                i++;
+        }
+        merged.append(window);
+    }
+    return merged;
+}
+
 template <typename T>
 void FITSSEPDetector::getFloatBuffer(float * buffer, int x, int y, int w, int h, FITSData const *data) const
 {
@@ -13,6 +13,9 @@
 #include "fitsstardetector.h"
 #include "skybackground.h"
 
+#include <QRect>
+#include <QVector>
+
 class FITSSEPDetector : public FITSStarDetector
 {
         Q_OBJECT
@@ -26,9 +29,17 @@ class FITSSEPDetector : public FITSStarDetector
         QFuture<bool> findSources(QRect const &boundary = QRect()) override;
 
         /** @brief Find sources in the parent FITS data file as well as background sky information.
+         * If the "regions" setting holds a list of QRect, only these windows of the frame are
+         * extracted, e.g. around the stars followed while guiding, and the sky background is
+         * estimated from their pixels only.
          */
         bool findSourcesAndBackground(QRect const &boundary = QRect());
 
+        /** @brief Clips the regions to the frame and merges those that overlap, so that no source is extracted twice.
+         * @return disjoint regions, empty if none of them is in the frame.
+         */
+        static QVector<QRect> mergeRegions(const QList<QRect> &regions, const QRect &frame);
+
     protected:
         /** @internal Consolidate a float data buffer from FITS data.
          * @param buffer is the destination float block.
@@ -0,0 +1,703 @@
+/*  FITS Sweep
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitssweep.h"
+#include "fitsparallel.h"
+
+#include <algorithm>
+#include <cfloat>
+#include <limits>
+
+#if defined(__x86_64__) || defined(_M_X64) || (defined(__i386__) && defined(__SSE2__))
+#define FITSSWEEP_SSE2
+#include <emmintrin.h>
+// AVX2 kernels are compiled with function level target attributes and only used if the CPU has AVX2.
+#if defined(__GNUC__) || defined(__clang__)
+#define FITSSWEEP_AVX2
+#define FITSSWEEP_TARGET_AVX2 __attribute__((target("avx2")))
+#include <immintrin.h>
+#endif
+#elif defined(__aarch64__) || defined(_M_ARM64)
+#define FITSSWEEP_NEON
+#include <arm_neon.h>
+#endif
+
+namespace FITSSweep
+{
+
+namespace
+{
+
+// Integer kernels work on unsigned samples. Signed samples are mapped to unsigned ones by
+// flipping their sign bit, which is the same as subtracting the lowest value of the type,
+// so the samples are also the histogram bin indexes.
+struct IntegerPartial
+{
+    uint32_t min { std::numeric_limits<uint32_t>::max() };
+    uint32_t max { 0 };
+    uint64_t sum { 0 };
+    uint64_t squaredSum { 0 };
+};
+
+// As with the previous scalar code, NaN samples never become the min or max, but do propagate to the sums.
+struct FloatPartial
+{
+    float min { FLT_MAX };
+    float max { -FLT_MAX };
+    double sum { 0 };
+    double squaredSum { 0 };
+};
+
+Kernel detectKernel()
+{
+#if defined(FITSSWEEP_AVX2)
+    if (__builtin_cpu_supports("avx2"))
+        return KERNEL_AVX2;
+#endif
+#if defined(FITSSWEEP_SSE2)
+    return KERNEL_SSE2;
+#elif defined(FITSSWEEP_NEON)
+    return KERNEL_NEON;
+#else
+    return KERNEL_SCALAR;
+#endif
+}
+
+bool isSupported(Kernel requested)
+{
+    switch (requested)
+    {
+        case KERNEL_SCALAR:
+            return true;
+        case KERNEL_SSE2:
+            return kernel() == KERNEL_SSE2 || kernel() == KERNEL_AVX2;
+        default:
+            return kernel() == requested;
+    }
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// Scalar kernels, also used for the samples left over by the vectorized ones.
+////////////////////////////////////////////////////////////////////////////////////////
+
+template <typename U, bool withHistogram>
+void sweepIntegerScalar(U const *buffer, uint32_t count, U flip, IntegerPartial &partial, uint32_t *histogram)
+{
+    uint32_t minimum = partial.min, maximum = partial.max;
+    uint64_t sum = 0, squaredSum = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const uint32_t sample = static_cast<U>(buffer[i] ^ flip);
+        minimum = std::min(minimum, sample);
+        maximum = std::max(maximum, sample);
+        sum += sample;
+        squaredSum += static_cast<uint64_t>(sample) * sample;
+        if (withHistogram)
+            histogram[sample]++;
+    }
+    partial.min = minimum;
+    partial.max = maximum;
+    partial.sum += sum;
+    partial.squaredSum += squaredSum;
+}
+
+void sweepFloatScalar(float const *buffer, uint32_t count, FloatPartial &partial)
+{
+    float minimum = partial.min, maximum = partial.max;
+    double sum = 0, squaredSum = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        const float sample = buffer[i];
+        minimum = sample < minimum ? sample : minimum;
+        maximum = sample > maximum ? sample : maximum;
+        sum += sample;
+        squaredSum += static_cast<double>(sample) * sample;
+    }
+    partial.min = minimum;
+    partial.max = maximum;
+    partial.sum += sum;
+    partial.squaredSum += squaredSum;
+}
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// SSE2 kernels.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(FITSSWEEP_SSE2)
+
+template <bool withHistogram>
+void sweep8SSE2(uint8_t const *buffer, uint32_t count, IntegerPartial &partial, uint32_t *histogram)
+{
+    const __m128i zero = _mm_setzero_si128();
+    __m128i minimum = _mm_set1_epi8(static_cast<char>(0xFF));
+    __m128i maximum = zero;
+    __m128i sum = zero, squaredSum = zero;
+
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m128i samples = _mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + i));
+        minimum = _mm_min_epu8(minimum, samples);
+        maximum = _mm_max_epu8(maximum, samples);
+        sum = _mm_add_epi64(sum, _mm_sad_epu8(samples, zero));
+
+        const __m128i low = _mm_unpacklo_epi8(samples, zero);
+        const __m128i high = _mm_unpackhi_epi8(samples, zero);
+        const __m128i squares = _mm_add_epi32(_mm_madd_epi16(low, low), _mm_madd_epi16(high, high));
+        squaredSum = _mm_add_epi64(squaredSum, _mm_add_epi64(_mm_unpacklo_epi32(squares, zero),
+                                   _mm_unpackhi_epi32(squares, zero)));
+
+        if (withHistogram)
+            for (int k = 0; k < 16; k++)
+                histogram[buffer[i + k]]++;
+    }
+
+    alignas(16) uint8_t minimums[16], maximums[16];
+    alignas(16) uint64_t sums[2], squaredSums[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(minimums), minimum);
+    _mm_store_si128(reinterpret_cast<__m128i *>(maximums), maximum);
+    _mm_store_si128(reinterpret_cast<__m128i *>(sums), sum);
+    _mm_store_si128(reinterpret_cast<__m128i *>(squaredSums), squaredSum);
+    for (int k = 0; k < 16 && i > 0; k++)
+    {
+        partial.min = std::min<uint32_t>(partial.min, minimums[k]);
+        partial.max = std::max<uint32_t>(partial.max, maximums[k]);
+    }
+    partial.sum += sums[0] + sums[1];
+    partial.squaredSum += squaredSums[0] + squaredSums[1];
+
+    sweepIntegerScalar<uint8_t, withHistogram>(buffer + i, count - i, 0, partial, histogram);
+}
+
+template <bool withHistogram>
+void sweep16SSE2(uint16_t const *buffer, uint32_t count, uint16_t flip, IntegerPartial &partial, uint32_t *histogram)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i flipVector = _mm_set1_epi16(static_cast<short>(flip));
+    // SSE2 only has signed 16 bit min/max, so the samples are compared with their sign bit flipped.
+    const __m128i signBit = _mm_set1_epi16(static_cast<short>(0x8000));
+    __m128i minimum = _mm_set1_epi16(0x7FFF);
+    __m128i maximum = signBit;
+    __m128i sum = zero, squaredSum = zero;
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m128i samples = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i *>(buffer + i)), flipVector);
+        const __m128i signedSamples = _mm_xor_si128(samples, signBit);
+        minimum = _mm_min_epi16(minimum, signedSamples);
+        maximum = _mm_max_epi16(maximum, signedSamples);
+
+        const __m128i low = _mm_unpacklo_epi16(samples, zero);
+        const __m128i high = _mm_unpackhi_epi16(samples, zero);
+        const __m128i pairs = _mm_add_epi32(low, high);
+        sum = _mm_add_epi64(sum, _mm_add_epi64(_mm_unpacklo_epi32(pairs, zero), _mm_unpackhi_epi32(pairs, zero)));
+
+        // _mm_mul_epu32 multiplies the even 32 bit lanes into 64 bit products.
+        const __m128i lowOdd = _mm_srli_epi64(low, 32);
+        const __m128i highOdd = _mm_srli_epi64(high, 32);
+        squaredSum = _mm_add_epi64(squaredSum, _mm_add_epi64(_mm_mul_epu32(low, low), _mm_mul_epu32(lowOdd, lowOdd)));
+        squaredSum = _mm_add_epi64(squaredSum, _mm_add_epi64(_mm_mul_epu32(high, high), _mm_mul_epu32(highOdd, highOdd)));
+
+        if (withHistogram)
+            for (int k = 0; k < 8; k++)
+                histogram[static_cast<uint16_t>(buffer[i + k] ^ flip)]++;
+    }
+
+    alignas(16) uint16_t minimums[8], maximums[8];
+    alignas(16) uint64_t sums[2], squaredSums[2];
+    _mm_store_si128(reinterpret_cast<__m128i *>(minimums), _mm_xor_si128(minimum, signBit));
+    _mm_store_si128(reinterpret_cast<__m128i *>(maximums), _mm_xor_si128(maximum, signBit));
+    _mm_store_si128(reinterpret_cast<__m128i *>(sums), sum);
+    _mm_store_si128(reinterpret_cast<__m128i *>(squaredSums), squaredSum);
+    for (int k = 0; k < 8 && i > 0; k++)
+    {
+        partial.min = std::min<uint32_t>(partial.min, minimums[k]);
+        partial.max = std::max<uint32_t>(partial.max, maximums[k]);
+    }
+    partial.sum += sums[0] + sums[1];
+    partial.squaredSum += squaredSums[0] + squaredSums[1];
+
+    sweepIntegerScalar<uint16_t, withHistogram>(buffer + i, count - i, flip, partial, histogram);
+}
+
+void sweepFloatSSE2(float const *buffer, uint32_t count, FloatPartial &partial)
+{
+    __m128 minimum = _mm_set1_ps(FLT_MAX);
+    __m128 maximum = _mm_set1_ps(-FLT_MAX);
+    __m128d sum = _mm_setzero_pd(), squaredSum = _mm_setzero_pd();
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const __m128 samples = _mm_loadu_ps(buffer + i);
+        // minps/maxps return the second operand when the first is NaN.
+        minimum = _mm_min_ps(samples, minimum);
+        maximum = _mm_max_ps(samples, maximum);
+
+        const __m128d low = _mm_cvtps_pd(samples);
+        const __m128d high = _mm_cvtps_pd(_mm_movehl_ps(samples, samples));
+        sum = _mm_add_pd(sum, _mm_add_pd(low, high));
+        squaredSum = _mm_add_pd(squaredSum, _mm_add_pd(_mm_mul_pd(low, low), _mm_mul_pd(high, high)));
+    }
+
+    alignas(16) float minimums[4], maximums[4];
+    alignas(16) double sums[2], squaredSums[2];
+    _mm_store_ps(minimums, minimum);
+    _mm_store_ps(maximums, maximum);
+    _mm_store_pd(sums, sum);
+    _mm_store_pd(squaredSums, squaredSum);
+    for (int k = 0; k < 4; k++)
+    {
+        partial.min = std::min(partial.min, minimums[k]);
+        partial.max = std::max(partial.max, maximums[k]);
+    }
+    partial.sum += sums[0] + sums[1];
+    partial.squaredSum += squaredSums[0] + squaredSums[1];
+
+    sweepFloatScalar(buffer + i, count - i, partial);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// AVX2 kernels.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(FITSSWEEP_AVX2)
+
+template <bool withHistogram>
+FITSSWEEP_TARGET_AVX2
+void sweep8AVX2(uint8_t const *buffer, uint32_t count, IntegerPartial &partial, uint32_t *histogram)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    __m256i minimum = _mm256_set1_epi8(static_cast<char>(0xFF));
+    __m256i maximum = zero;
+    __m256i sum = zero, squaredSum = zero;
+
+    uint32_t i = 0;
+    for (; i + 32 <= count; i += 32)
+    {
+        const __m256i samples = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(buffer + i));
+        minimum = _mm256_min_epu8(minimum, samples);
+        maximum = _mm256_max_epu8(maximum, samples);
+        sum = _mm256_add_epi64(sum, _mm256_sad_epu8(samples, zero));
+
+        const __m256i low = _mm256_cvtepu8_epi16(_mm256_castsi256_si128(samples));
+        const __m256i high = _mm256_cvtepu8_epi16(_mm256_extracti128_si256(samples, 1));
+        const __m256i squares = _mm256_add_epi32(_mm256_madd_epi16(low, low), _mm256_madd_epi16(high, high));
+        squaredSum = _mm256_add_epi64(squaredSum, _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(squares)),
+                                      _mm256_cvtepu32_epi64(_mm256_extracti128_si256(squares, 1))));
+
+        if (withHistogram)
+            for (int k = 0; k < 32; k++)
+                histogram[buffer[i + k]]++;
+    }
+
+    alignas(32) uint8_t minimums[32], maximums[32];
+    alignas(32) uint64_t sums[4], squaredSums[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(minimums), minimum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(maximums), maximum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(sums), sum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(squaredSums), squaredSum);
+    for (int k = 0; k < 32 && i > 0; k++)
+    {
+        partial.min = std::min<uint32_t>(partial.min, minimums[k]);
+        partial.max = std::max<uint32_t>(partial.max, maximums[k]);
+    }
+    partial.sum += sums[0] + sums[1] + sums[2] + sums[3];
+    partial.squaredSum += squaredSums[0] + squaredSums[1] + squaredSums[2] + squaredSums[3];
+
+    sweepIntegerScalar<uint8_t, withHistogram>(buffer + i, count - i, 0, partial, histogram);
+}
+
+template <bool withHistogram>
+FITSSWEEP_TARGET_AVX2
+void sweep16AVX2(uint16_t const *buffer, uint32_t count, uint16_t flip, IntegerPartial &partial, uint32_t *histogram)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i flipVector = _mm256_set1_epi16(static_cast<short>(flip));
+    __m256i minimum = _mm256_set1_epi16(static_cast<short>(0xFFFF));
+    __m256i maximum = zero;
+    __m256i sum = zero, squaredSum = zero;
+
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const __m256i samples = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i *>(buffer + i)),
+                                flipVector);
+        minimum = _mm256_min_epu16(minimum, samples);
+        maximum = _mm256_max_epu16(maximum, samples);
+
+        const __m256i low = _mm256_cvtepu16_epi32(_mm256_castsi256_si128(samples));
+        const __m256i high = _mm256_cvtepu16_epi32(_mm256_extracti128_si256(samples, 1));
+        const __m256i pairs = _mm256_add_epi32(low, high);
+        sum = _mm256_add_epi64(sum, _mm256_add_epi64(_mm256_cvtepu32_epi64(_mm256_castsi256_si128(pairs)),
+                               _mm256_cvtepu32_epi64(_mm256_extracti128_si256(pairs, 1))));
+
+        // _mm256_mul_epu32 multiplies the even 32 bit lanes into 64 bit products.
+        const __m256i lowOdd = _mm256_srli_epi64(low, 32);
+        const __m256i highOdd = _mm256_srli_epi64(high, 32);
+        squaredSum = _mm256_add_epi64(squaredSum, _mm256_add_epi64(_mm256_mul_epu32(low, low),
+                                      _mm256_mul_epu32(lowOdd, lowOdd)));
+        squaredSum = _mm256_add_epi64(squaredSum, _mm256_add_epi64(_mm256_mul_epu32(high, high),
+                                      _mm256_mul_epu32(highOdd, highOdd)));
+
+        if (withHistogram)
+            for (int k = 0; k < 16; k++)
+                histogram[static_cast<uint16_t>(buffer[i + k] ^ flip)]++;
+    }
+
+    alignas(32) uint16_t minimums[16], maximums[16];
+    alignas(32) uint64_t sums[4], squaredSums[4];
+    _mm256_store_si256(reinterpret_cast<__m256i *>(minimums), minimum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(maximums), maximum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(sums), sum);
+    _mm256_store_si256(reinterpret_cast<__m256i *>(squaredSums), squaredSum);
+    for (int k = 0; k < 16 && i > 0; k++)
+    {
+        partial.min = std::min<uint32_t>(partial.min, minimums[k]);
+        partial.max = std::max<uint32_t>(partial.max, maximums[k]);
+    }
+    partial.sum += sums[0] + sums[1] + sums[2] + sums[3];
+    partial.squaredSum += squaredSums[0] + squaredSums[1] + squaredSums[2] + squaredSums[3];
+
+    sweepIntegerScalar<uint16_t, withHistogram>(buffer + i, count - i, flip, partial, histogram);
+}
+
+FITSSWEEP_TARGET_AVX2
+void sweepFloatAVX2(float const *buffer, uint32_t count, FloatPartial &partial)
+{
+    __m256 minimum = _mm256_set1_ps(FLT_MAX);
+    __m256 maximum = _mm256_set1_ps(-FLT_MAX);
+    __m256d sum = _mm256_setzero_pd(), squaredSum = _mm256_setzero_pd();
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const __m256 samples = _mm256_loadu_ps(buffer + i);
+        // vminps/vmaxps return the second operand when the first is NaN.
+        minimum = _mm256_min_ps(samples, minimum);
+        maximum = _mm256_max_ps(samples, maximum);
+
+        const __m256d low = _mm256_cvtps_pd(_mm256_castps256_ps128(samples));
+        const __m256d high = _mm256_cvtps_pd(_mm256_extractf128_ps(samples, 1));
+        sum = _mm256_add_pd(sum, _mm256_add_pd(low, high));
+        squaredSum = _mm256_add_pd(squaredSum, _mm256_add_pd(_mm256_mul_pd(low, low), _mm256_mul_pd(high, high)));
+    }
+
+    alignas(32) float minimums[8], maximums[8];
+    alignas(32) double sums[4], squaredSums[4];
+    _mm256_store_ps(minimums, minimum);
+    _mm256_store_ps(maximums, maximum);
+    _mm256_store_pd(sums, sum);
+    _mm256_store_pd(squaredSums, squaredSum);
+    for (int k = 0; k < 8; k++)
+    {
+        partial.min = std::min(partial.min, minimums[k]);
+        partial.max = std::max(partial.max, maximums[k]);
+    }
+    partial.sum += sums[0] + sums[1] + sums[2] + sums[3];
+    partial.squaredSum += squaredSums[0] + squaredSums[1] + squaredSums[2] + squaredSums[3];
+
+    sweepFloatScalar(buffer + i, count - i, partial);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// NEON kernels.
+////////////////////////////////////////////////////////////////////////////////////////
+
+#if defined(FITSSWEEP_NEON)
+
+template <bool withHistogram>
+void sweep8NEON(uint8_t const *buffer, uint32_t count, IntegerPartial &partial, uint32_t *histogram)
+{
+    uint8x16_t minimum = vdupq_n_u8(0xFF);
+    uint8x16_t maximum = vdupq_n_u8(0);
+    uint64x2_t sum = vdupq_n_u64(0), squaredSum = vdupq_n_u64(0);
+
+    uint32_t i = 0;
+    for (; i + 16 <= count; i += 16)
+    {
+        const uint8x16_t samples = vld1q_u8(buffer + i);
+        minimum = vminq_u8(minimum, samples);
+        maximum = vmaxq_u8(maximum, samples);
+        sum = vpadalq_u32(sum, vpaddlq_u16(vpaddlq_u8(samples)));
+
+        const uint8x8_t low = vget_low_u8(samples);
+        const uint8x8_t high = vget_high_u8(samples);
+        squaredSum = vpadalq_u32(squaredSum, vpaddlq_u16(vmull_u8(low, low)));
+        squaredSum = vpadalq_u32(squaredSum, vpaddlq_u16(vmull_u8(high, high)));
+
+        if (withHistogram)
+            for (int k = 0; k < 16; k++)
+                histogram[buffer[i + k]]++;
+    }
+
+    if (i > 0)
+    {
+        partial.min = std::min<uint32_t>(partial.min, vminvq_u8(minimum));
+        partial.max = std::max<uint32_t>(partial.max, vmaxvq_u8(maximum));
+    }
+    partial.sum += vaddvq_u64(sum);
+    partial.squaredSum += vaddvq_u64(squaredSum);
+
+    sweepIntegerScalar<uint8_t, withHistogram>(buffer + i, count - i, 0, partial, histogram);
+}
+
+template <bool withHistogram>
+void sweep16NEON(uint16_t const *buffer, uint32_t count, uint16_t flip, IntegerPartial &partial, uint32_t *histogram)
+{
+    const uint16x8_t flipVector = vdupq_n_u16(flip);
+    uint16x8_t minimum = vdupq_n_u16(0xFFFF);
+    uint16x8_t maximum = vdupq_n_u16(0);
+    uint64x2_t sum = vdupq_n_u64(0), squaredSum = vdupq_n_u64(0);
+
+    uint32_t i = 0;
+    for (; i + 8 <= count; i += 8)
+    {
+        const uint16x8_t samples = veorq_u16(vld1q_u16(buffer + i), flipVector);
+        minimum = vminq_u16(minimum, samples);
+        maximum = vmaxq_u16(maximum, samples);
+        sum = vpadalq_u32(sum, vpaddlq_u16(samples));
+
+        const uint16x4_t low = vget_low_u16(samples);
+        const uint16x4_t high = vget_high_u16(samples);
+        squaredSum = vpadalq_u32(squaredSum, vmull_u16(low, low));
+        squaredSum = vpadalq_u32(squaredSum, vmull_u16(high, high));
+
+        if (withHistogram)
+            for (int k = 0; k < 8; k++)
+                histogram[static_cast<uint16_t>(buffer[i + k] ^ flip)]++;
+    }
+
+    if (i > 0)
+    {
+        partial.min = std::min<uint32_t>(partial.min, vminvq_u16(minimum));
+        partial.max = std::max<uint32_t>(partial.max, vmaxvq_u16(maximum));
+    }
+    partial.sum += vaddvq_u64(sum);
+    partial.squaredSum += vaddvq_u64(squaredSum);
+
+    sweepIntegerScalar<uint16_t, withHistogram>(buffer + i, count - i, flip, partial, histogram);
+}
+
+void sweepFloatNEON(float const *buffer, uint32_t count, FloatPartial &partial)
+{
+    float32x4_t minimum = vdupq_n_f32(FLT_MAX);
+    float32x4_t maximum = vdupq_n_f32(-FLT_MAX);
+    float64x2_t sum = vdupq_n_f64(0), squaredSum = vdupq_n_f64(0);
+
+    uint32_t i = 0;
+    for (; i + 4 <= count; i += 4)
+    {
+        const float32x4_t samples = vld1q_f32(buffer + i);
+        // The "number" variants ignore NaN samples.
+        minimum = vminnmq_f32(minimum, samples);
+        maximum = vmaxnmq_f32(maximum, samples);
+
+        const float64x2_t low = vcvt_f64_f32(vget_low_f32(samples));
+        const float64x2_t high = vcvt_high_f64_f32(samples);
+        sum = vaddq_f64(sum, vaddq_f64(low, high));
+        squaredSum = vfmaq_f64(squaredSum, low, low);
+        squaredSum = vfmaq_f64(squaredSum, high, high);
+    }
+
+    partial.min = std::min(partial.min, vminvq_f32(minimum));
+    partial.max = std::max(partial.max, vmaxvq_f32(maximum));
+    partial.sum += vaddvq_f64(sum);
+    partial.squaredSum += vaddvq_f64(squaredSum);
+
+    sweepFloatScalar(buffer + i, count - i, partial);
+}
+
+#endif
+
+////////////////////////////////////////////////////////////////////////////////////////
+/// Dispatch.
+////////////////////////////////////////////////////////////////////////////////////////
+
+template <bool withHistogram>
+void sweepInteger(Kernel kernel, uint8_t const *buffer, uint32_t count, uint8_t, IntegerPartial &partial,
+                  uint32_t *histogram)
+{
+    switch (kernel)
+    {
+#if defined(FITSSWEEP_AVX2)
+        case KERNEL_AVX2:
+            return sweep8AVX2<withHistogram>(buffer, count, partial, histogram);
+#endif
+#if defined(FITSSWEEP_SSE2)
+        case KERNEL_SSE2:
+            return sweep8SSE2<withHistogram>(buffer, count, partial, histogram);
+#endif
+#if defined(FITSSWEEP_NEON)
+        case KERNEL_NEON:
+            return sweep8NEON<withHistogram>(buffer, count, partial, histogram);
+#endif
+        default:
+            return sweepIntegerScalar<uint8_t, withHistogram>(buffer, count, 0, partial, histogram);
+    }
+}
+
+template <bool withHistogram>
+void sweepInteger(Kernel kernel, uint16_t const *buffer, uint32_t count, uint16_t flip, IntegerPartial &partial,
+                  uint32_t *histogram)
+{
+    switch (kernel)
+    {
+#if defined(FITSSWEEP_AVX2)
+        case KERNEL_AVX2:
+            return sweep16AVX2<withHistogram>(buffer, count, flip, partial, histogram);
+#endif
+#if defined(FITSSWEEP_SSE2)
+        case KERNEL_SSE2:
+            return sweep16SSE2<withHistogram>(buffer, count, flip, partial, histogram);
+#endif
+#if defined(FITSSWEEP_NEON)
+        case KERNEL_NEON:
+            return sweep16NEON<withHistogram>(buffer, count, flip, partial, histogram);
+#endif
+        default:
+            return sweepIntegerScalar<uint16_t, withHistogram>(buffer, count, flip, partial, histogram);
+    }
+}
+
+void sweepFloat(Kernel kernel, float const *buffer, uint32_t count, FloatPartial &partial)
+{
+    switch (kernel)
+    {
+#if defined(FITSSWEEP_AVX2)
+        case KERNEL_AVX2:
+            return sweepFloatAVX2(buffer, count, partial);
+#endif
+#if defined(FITSSWEEP_SSE2)
+        case KERNEL_SSE2:
+            return sweepFloatSSE2(buffer, count, partial);
+#endif
+#if defined(FITSSWEEP_NEON)
+        case KERNEL_NEON:
+            return sweepFloatNEON(buffer, count, partial);
+#endif
+        default:
+            return sweepFloatScalar(buffer, count, partial);
+    }
+}
+
+template <typename T>
+Result sweepIntegers(T const *buffer, uint32_t count, bool withHistogram, Kernel kernel)
+{
+    using U = typename std::make_unsigned<T>::type;
+    constexpr uint32_t numBins = 1u << (8 * sizeof(T));
+    // Flipping the sign bit maps signed samples to value - lowest.
+    constexpr U flip = std::is_signed<T>::value ? static_cast<U>(numBins / 2) : 0;
+    constexpr double offset = std::is_signed<T>::value ? numBins / 2 : 0;
+
+    struct Partial
+    {
+        IntegerPartial stats;
+        std::vector<uint32_t> histogram;
+    };
+
+    auto samples = reinterpret_cast<U const *>(buffer);
+    auto partials = FITSParallel::runPartitioned<Partial>(count, [ = ](uint32_t start, uint32_t end)
+    {
+        Partial partial;
+        if (withHistogram)
+        {
+            partial.histogram.resize(numBins, 0);
+            sweepInteger<true>(kernel, samples + start, end - start, flip, partial.stats, partial.histogram.data());
+        }
+        else
+            sweepInteger<false>(kernel, samples + start, end - start, flip, partial.stats, nullptr);
+        return partial;
+    });
+
+    IntegerPartial merged;
+    for (const auto &partial : partials)
+    {
+        merged.min = std::min(merged.min, partial.stats.min);
+        merged.max = std::max(merged.max, partial.stats.max);
+        merged.sum += partial.stats.sum;
+        merged.squaredSum += partial.stats.squaredSum;
+    }
+
+    Result result;
+    result.count = count;
+    result.min = merged.min - offset;
+    result.max = merged.max - offset;
+    // Shift the sums back from the unsigned samples: sum((u - offset)^2) = sum(u^2) - 2 offset sum(u) + n offset^2
+    result.sum = static_cast<double>(merged.sum) - offset * count;
+    result.squaredSum = static_cast<double>(merged.squaredSum) - 2 * offset * merged.sum + offset * offset * count;
+
+    if (withHistogram)
+    {
+        result.histogramOrigin = std::numeric_limits<T>::lowest();
+        result.histogram = std::move(partials[0].histogram);
+        for (size_t p = 1; p < partials.size(); p++)
+            for (uint32_t i = 0; i < numBins; i++)
+                result.histogram[i] += partials[p].histogram[i];
+    }
+    return result;
+}
+
+Result sweepFloats(float const *buffer, uint32_t count, Kernel kernel)
+{
+    auto partials = FITSParallel::runPartitioned<FloatPartial>(count, [ = ](uint32_t start, uint32_t end)
+    {
+        FloatPartial partial;
+        sweepFloat(kernel, buffer + start, end - start, partial);
+        return partial;
+    });
+
+    FloatPartial merged;
+    for (const auto &partial : partials)
+    {
+        merged.min = std::min(merged.min, partial.min);
+        merged.max = std::max(merged.max, partial.max);
+        merged.sum += partial.sum;
+        merged.squaredSum += partial.squaredSum;
+    }
+
+    Result result;
+    result.count = count;
+    result.min = merged.min;
+    result.max = merged.max;
+    result.sum = merged.sum;
+    result.squaredSum = merged.squaredSum;
+    return result;
+}
+
+}  // namespace
+
+Kernel kernel()
+{
+    static const Kernel selected = detectKernel();
+    return selected;
+}
+
+template <typename T>
+Result sweep(T const *buffer, uint32_t count, bool withHistogram, Kernel forceKernel)
+{
+    static_assert(hasKernel<T>(), "No sweep kernel for this type");
+
+    if (buffer == nullptr || count == 0)
+        return Result();
+
+    const Kernel selected = isSupported(forceKernel) ? forceKernel : kernel();
+    if constexpr (std::is_floating_point<T>::value)
+        return sweepFloats(buffer, count, selected);
+    else
+        return sweepIntegers(buffer, count, withHistogram, selected);
+}
+
+template Result sweep(uint8_t const *buffer, uint32_t count, bool withHistogram, Kernel forceKernel);
+template Result sweep(int16_t const *buffer, uint32_t count, bool withHistogram, Kernel forceKernel);
+template Result sweep(uint16_t const *buffer, uint32_t count, bool withHistogram, Kernel forceKernel);
+template Result sweep(float const *buffer, uint32_t count, bool withHistogram, Kernel forceKernel);
+
+}
@@ -0,0 +1,80 @@
+/*  FITS Sweep
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <stdint.h>
+#include <type_traits>
+#include <vector>
+
+// Fused, vectorized pass over an image channel.
+//
+// A single sweep over the samples yields the minimum, maximum, sum and sum of squares and, for
+// 8 and 16 bit integer types, a full resolution histogram (one bin per possible value) from which
+// the median, MAD and the display histogram can be derived without touching the image again.
+//
+// The kernels are vectorized with SSE2 or AVX2 on x86 and NEON on ARM64, with a scalar fallback.
+// The best kernel supported by the CPU is chosen at runtime. Partitions of the channel are swept
+// by several threads and the results merged.
+namespace FITSSweep
+{
+
+typedef enum { KERNEL_SCALAR, KERNEL_SSE2, KERNEL_AVX2, KERNEL_NEON } Kernel;
+
+struct Result
+{
+    double min { 0 };
+    double max { 0 };
+    double sum { 0 };
+    double squaredSum { 0 };
+    uint32_t count { 0 };
+    // One bin per value, bin i holds the samples of value histogramOrigin + i.
+    // Only filled for types with a histogram (see hasHistogram()).
+    std::vector<uint32_t> histogram;
+    int64_t histogramOrigin { 0 };
+
+    double mean() const
+    {
+        return count > 0 ? sum / count : 0;
+    }
+    double variance() const
+    {
+        return count > 0 ? squaredSum / count - mean() * mean() : 0;
+    }
+};
+
+// Types with a vectorized kernel.
+template <typename T>
+constexpr bool hasKernel()
+{
+    return std::is_same<T, uint8_t>::value || std::is_same<T, int16_t>::value ||
+           std::is_same<T, uint16_t>::value || std::is_same<T, float>::value;
+}
+
+// Types for which the sweep also builds the full resolution histogram.
+template <typename T>
+constexpr bool hasHistogram()
+{
+    return std::is_integral<T>::value && sizeof(T) <= 2;
+}
+
+/**
+ * @brief kernel Returns the kernel selected for this CPU.
+ */
+Kernel kernel();
+
+/**
+ * @brief sweep Runs the fused pass over the samples.
+ * @param buffer pointer to the first sample of the channel.
+ * @param count number of samples in the channel.
+ * @param withHistogram whether to build the histogram, ignored if the type has none.
+ * @param forceKernel kernel to use instead of the selected one, mainly for testing. Ignored if
+ * not supported by the CPU.
+ * @note Only available for types where hasKernel() is true. Uses multiple threads, blocks until done.
+ */
+template <typename T>
+Result sweep(T const *buffer, uint32_t count, bool withHistogram, Kernel forceKernel = kernel());
+
+}
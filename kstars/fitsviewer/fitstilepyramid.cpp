@@ -0,0 +1,259 @@
+/*  FITS Tile Pyramid
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "fitstilepyramid.h"
+
+#include <QPainter>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+FITSTilePyramid::FITSTilePyramid(QObject *parent) : QObject(parent)
+{
+    m_Cache.setMaxCost(CACHE_SIZE);
+    // Leave a core for the GUI thread.
+    m_Pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+FITSTilePyramid::~FITSTilePyramid()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_Queue.clear();
+    }
+    m_Pool.waitForDone();
+}
+
+void FITSTilePyramid::setImage(const QImage &image)
+{
+    m_Cache.clear();
+    m_Size = image.size();
+
+    m_MaxLevel = 0;
+    while ((TILE_SIZE << m_MaxLevel) < std::max(m_Size.width(), m_Size.height()))
+        m_MaxLevel++;
+
+    QMutexLocker locker(&m_Mutex);
+    // Tiles being built from the previous image are dropped when they come back.
+    m_Generation++;
+    m_Image = image;
+    m_Queue.clear();
+    m_Building.clear();
+}
+
+void FITSTilePyramid::clear()
+{
+    setImage(QImage());
+}
+
+int FITSTilePyramid::levelForScale(double scale) const
+{
+    // The finest level that is not magnified, or level 0 when zoomed in.
+    if (scale >= 1)
+        return 0;
+    return std::min(m_MaxLevel, static_cast<int>(std::floor(std::log2(1 / scale))));
+}
+
+QRect FITSTilePyramid::sourceRect(const Key &key) const
+{
+    const int span = TILE_SIZE << key.level;
+    return QRect(key.x * span, key.y * span, span, span) & QRect(QPoint(0, 0), m_Size);
+}
+
+void FITSTilePyramid::draw(QPainter *painter, const QRect &exposed, double scale)
+{
+    if (m_Size.isEmpty() || scale <= 0)
+        return;
+
+    const int level = levelForScale(scale);
+    const int span = TILE_SIZE << level;
+
+    // Exposed area in image pixels, and the tiles over it.
+    QRectF area = QRectF(exposed.x() / scale, exposed.y() / scale, exposed.width() / scale, exposed.height() / scale)
+                  & QRectF(QPointF(0, 0), m_Size);
+    if (area.isEmpty())
+        return;
+
+    const int left = static_cast<int>(area.left()) / span;
+    const int top = static_cast<int>(area.top()) / span;
+    const int right = static_cast<int>(std::ceil(area.right())) / span;
+    const int bottom = static_cast<int>(std::ceil(area.bottom())) / span;
+
+    painter->save();
+    painter->setRenderHint(QPainter::SmoothPixmapTransform, scale < 1);
+
+    QList<Key> missing;
+    for (int y = top; y <= bottom; y++)
+    {
+        for (int x = left; x <= right; x++)
+        {
+            Key key { level, x, y };
+            QRect source = sourceRect(key);
+            if (source.isEmpty())
+                continue;
+
+            QRectF target(source.x() * scale, source.y() * scale, source.width() * scale, source.height() * scale);
+            if (QImage *tile = m_Cache.object(key))
+                painter->drawImage(target, *tile);
+            else
+            {
+                missing.append(key);
+                drawCoarser(painter, key, target);
+            }
+        }
+    }
+
+    painter->restore();
+
+    if (!missing.isEmpty())
+        request(missing);
+}
+
+bool FITSTilePyramid::drawCoarser(QPainter *painter, const Key &key, const QRectF &target)
+{
+    const QRect source = sourceRect(key);
+
+    for (int level = key.level + 1; level <= m_MaxLevel; level++)
+    {
+        const int shift = level - key.level;
+        Key coarser { level, key.x >> shift, key.y >> shift };
+        QImage *tile = m_Cache.object(coarser);
+        if (tile == nullptr)
+            continue;
+
+        // Part of the coarser tile covering the missing one, in its pixels.
+        const QRect coarserSource = sourceRect(coarser);
+        const double reduction = 1 << level;
+        QRectF part((source.x() - coarserSource.x()) / reduction, (source.y() - coarserSource.y()) / reduction,
+                    source.width() / reduction, source.height() / reduction);
+        painter->drawImage(target, *tile, part);
+        return true;
+    }
+
+    return false;
+}
+
+void FITSTilePyramid::request(const QList<Key> &keys)
+{
+    QMutexLocker locker(&m_Mutex);
+
+    // Only what is exposed now is worth building, tiles scrolled away are forgotten.
+    m_Queue.clear();
+    for (const auto &key : keys)
+    {
+        if (!m_Building.contains(key))
+            m_Queue.append(key);
+    }
+
+    while (m_Workers < m_Pool.maxThreadCount() && m_Workers < m_Queue.size())
+    {
+        m_Workers++;
+        QtConcurrent::run(&m_Pool, [this]()
+        {
+            work();
+        });
+    }
+}
+
+void FITSTilePyramid::work()
+{
+    for (;;)
+    {
+        Key key;
+        QImage image;
+        uint32_t generation;
+        {
+            QMutexLocker locker(&m_Mutex);
+            if (m_Queue.isEmpty())
+            {
+                m_Workers--;
+                return;
+            }
+
+            key = m_Queue.takeFirst();
+            m_Building.insert(key);
+            image = m_Image;
+            generation = m_Generation;
+        }
+
+        QImage tile = buildTile(image, key);
+
+        // The cache is only used from the GUI thread.
+        QMetaObject::invokeMethod(this, [this, key, tile, generation]()
+        {
+            finish(key, tile, generation);
+        }, Qt::QueuedConnection);
+    }
+}
+
+void FITSTilePyramid::finish(const Key &key, const QImage &tile, uint32_t generation)
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        if (generation != m_Generation)
+            return;
+        m_Building.remove(key);
+    }
+
+    if (tile.isNull())
+        return;
+
+    m_Cache.insert(key, new QImage(tile), std::max<int>(1, tile.sizeInBytes() / 1024));
+    emit tileReady();
+}
+
+QImage FITSTilePyramid::buildTile(const QImage &image, const Key &key)
+{
+    const int step = 1 << key.level;
+    const int span = TILE_SIZE * step;
+    const int left = key.x * span;
+    const int top = key.y * span;
+    if (left >= image.width() || top >= image.height())
+        return QImage();
+
+    const int width = (std::min(span, image.width() - left) + step - 1) / step;
+    const int height = (std::min(span, image.height() - top) + step - 1) / step;
+    QImage tile(width, height, QImage::Format_RGB32);
+
+    // Up to 4x4 samples of each block are averaged, so a tile costs the same at every level.
+    const int samples = std::min(step, 4);
+    const int stride = step / samples;
+    const bool indexed = image.format() == QImage::Format_Indexed8;
+    const QVector<QRgb> colors = image.colorTable();
+
+    for (int y = 0; y < height; y++)
+    {
+        QRgb *out = reinterpret_cast<QRgb *>(tile.scanLine(y));
+        for (int x = 0; x < width; x++)
+        {
+            int red = 0, green = 0, blue = 0, count = 0;
+            for (int sy = 0; sy < samples; sy++)
+            {
+                const int row = top + y * step + sy * stride;
+                if (row >= image.height())
+                    break;
+                const uchar *line = image.constScanLine(row);
+
+                for (int sx = 0; sx < samples; sx++)
+                {
+                    const int column = left + x * step + sx * stride;
+                    if (column >= image.width())
+                        break;
+
+                    const QRgb pixel = indexed ? colors.value(line[column]) : reinterpret_cast<const QRgb *>(line)[column];
+                    red += qRed(pixel);
+                    green += qGreen(pixel);
+                    blue += qBlue(pixel);
+                    count++;
+                }
+            }
+
+            out[x] = count > 0 ? qRgb(red / count, green / count, blue / count) : qRgb(0, 0, 0);
+        }
+    }
+
+    return tile;
+}
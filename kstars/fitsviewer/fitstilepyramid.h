@@ -0,0 +1,97 @@
+/*  FITS Tile Pyramid
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QCache>
+#include <QImage>
+#include <QList>
+#include <QMutex>
+#include <QObject>
+#include <QSet>
+#include <QSize>
+#include <QThreadPool>
+
+class QPainter;
+
+/**
+ * @brief Tiles of the display image at power of two reductions, for drawing very large images.
+ *
+ * Level 0 tiles are TILE_SIZE pixels of the display image, level n tiles cover 2^n times as many
+ * in each direction. Only the tiles of the exposed area are built, on worker threads, and the
+ * last used ones are kept. While a tile is built a coarser one, if cached, is drawn instead.
+ */
+class FITSTilePyramid : public QObject
+{
+        Q_OBJECT
+
+    public:
+        static constexpr int TILE_SIZE = 256;
+
+        explicit FITSTilePyramid(QObject *parent = nullptr);
+        ~FITSTilePyramid() override;
+
+        /**
+         * @brief setImage Replaces the display image, dropping all the tiles built from the previous one.
+         */
+        void setImage(const QImage &image);
+        void clear();
+
+        /**
+         * @brief draw Draws the tiles of the exposed area.
+         * @param painter painter of the widget showing the image
+         * @param exposed area to draw, in widget coordinates
+         * @param scale widget pixels per display image pixel
+         */
+        void draw(QPainter *painter, const QRect &exposed, double scale);
+
+    signals:
+        /** A requested tile was built, the area should be drawn again. */
+        void tileReady();
+
+    private:
+        struct Key
+        {
+            int level;
+            int x;
+            int y;
+
+            bool operator==(const Key &other) const
+            {
+                return level == other.level && x == other.x && y == other.y;
+            }
+
+            friend uint qHash(const Key &key, uint seed = 0)
+            {
+                return ::qHash((static_cast<quint64>(key.level) << 48) | (static_cast<quint64>(key.y) << 24) | key.x, seed);
+            }
+        };
+
+        int levelForScale(double scale) const;
+        QRect sourceRect(const Key &key) const;
+        bool drawCoarser(QPainter *painter, const Key &key, const QRectF &target);
+        void request(const QList<Key> &keys);
+        void work();
+        void finish(const Key &key, const QImage &tile, uint32_t generation);
+        static QImage buildTile(const QImage &image, const Key &key);
+
+        /** Tiles in KiB, about 500 tiles. */
+        static constexpr int CACHE_SIZE = 128 * 1024;
+
+        // Only used from the GUI thread
+        QCache<Key, QImage> m_Cache;
+        QSize m_Size;
+        int m_MaxLevel { 0 };
+
+        // Shared with the workers
+
+        mutable QMutex m_Mutex;
+        QImage m_Image;
+        uint32_t m_Generation { 0 };
+        QList<Key> m_Queue;
+        QSet<Key> m_Building;
+        int m_Workers { 0 };
+        QThreadPool m_Pool;
+};
@@ -100,8 +100,10 @@ void FITSView::doStretch(QImage *outputImage)
         tempParams = StretchParams();  // Keeping it linear
     else if (autoStretch)
     {
-        // Compute new auto-stretch params.
-        stretchParams = stretch.computeParams(m_ImageData->getImageBuffer());
+        // Compute new auto-stretch params, reusing the median and MAD from the image statistics.
+        double median[3], mad[3];
+        m_ImageData->getMedianAndMAD(median, mad);
+        stretchParams = stretch.computeParams(m_ImageData->getImageBuffer(), median, mad);
         emit newStretch(stretchParams);
         tempParams = stretchParams;
     }
@@ -229,6 +231,11 @@ FITSView::FITSView(QWidget * parent, FITSMode fitsMode, FITSScale filterType) :
     connect(this, &FITSView::setRubberBand, m_ImageFrame, &FITSLabel::setRubberBand);
     connect(this, &FITSView::showRubberBand, m_ImageFrame, &FITSLabel::showRubberBand);
     connect(this, &FITSView::zoomRubberBand, m_ImageFrame, &FITSLabel::zoomRubberBand);
+    connect(&m_TilePyramid, &FITSTilePyramid::tileReady, this, [this]()
+    {
+        if (m_ImageFrame)
+            m_ImageFrame->update();
+    });
 
     connect(Options::self(), &Options::HIPSOpacityChanged, this, [this]()
     {
@@ -417,6 +424,7 @@ void FITSView::clearData()
     setWidget(noImageLabel);
 
     m_ImageData.clear();
+    m_TilePyramid.clear();
 }
 
 bool FITSView::loadData(const QSharedPointer<FITSData> &data)
@@ -735,6 +743,8 @@ bool FITSView::rescale(FITSZoom type)
     initDisplayImage();
     m_ImageFrame->setScaledContents(true);
     doStretch(&rawImage);
+    // Shares the pixels, initDisplayImage() allocates a new image for the next stretch.
+    m_TilePyramid.setImage(rawImage);
     setWidget(m_ImageFrame);
 
     // This is needed by fitstab, even if the zoom doesn't change, to change the stretch UI.
@@ -853,6 +863,16 @@ bool FITSView::isLargeImage()
     return rawImage.width() * rawImage.height() >= largeImageNumPixels;
 }
 
+// isTiledImage() returns whether the image is too large for a pixmap of its size, in which case the frame
+// paints the visible tiles of the image and the overlays itself. Only the FITS viewer opens such images,
+// and mosaic masks rearrange the image in the pixmap.
+bool FITSView::isTiledImage()
+{
+    constexpr qint64 tiledImageNumPixels = 16 * 1000 * 1000;
+    return mode == FITS_NORMAL && static_cast<qint64>(rawImage.width()) * rawImage.height() >= tiledImageNumPixels
+           && dynamic_cast<ImageMosaicMask *>(m_ImageMask.get()) == nullptr;
+}
+
 // getScale() is related to the image and overlay rendering strategy used.
 // If we're using a pixmap appropriate for a large image, where we draw and render on a pixmap that's the image size
 // and we let the QLabel deal with scaling and zooming, then the scale is 1.0.
@@ -894,7 +914,9 @@ void FITSView::updateFrame(bool now)
         // and whether we need to therefore conserve memory. The small-image strategy explicitly scales up
         // the image, and writes overlays on the scaled pixmap. The large-image strategy uses a pixmap that's
         // the size of the image itself, never scaling that up.
-        if (isLargeImage())
+        if (isTiledImage())
+            updateFrameTiledImage();
+        else if (isLargeImage())
             updateFrameLargeImage();
         else
             updateFrameSmallImage();
@@ -941,10 +963,10 @@ bool FITSView::initDisplayPixmap(QImage &image, float scale)
     return true;
 }
 
-void FITSView::updateFrameLargeImage()
+bool FITSView::renderLargeImage()
 {
     if (!initDisplayPixmap(rawImage, 1.0 / m_PreviewSampling))
-        return;
+        return false;
     QPainter painter(&displayPixmap);
     // Possibly scale the fonts as we're drawing on the full image, not just the visible part of the scroll window.
     QFont font = painter.font();
@@ -953,10 +975,53 @@ void FITSView::updateFrameLargeImage()
 
     drawStarRingFilter(&painter, 1.0 / m_PreviewSampling, dynamic_cast<ImageRingMask *>(m_ImageMask.get()));
     drawOverlay(&painter, 1.0 / m_PreviewSampling);
+    return true;
+}
+
+void FITSView::updateFrameLargeImage()
+{
+    if (!renderLargeImage())
+        return;
     m_ImageFrame->setPixmap(displayPixmap);
     m_ImageFrame->resize(((m_PreviewSampling * currentZoom) / 100.0) * displayPixmap.size());
 }
 
+void FITSView::updateFrameTiledImage()
+{
+    // No full size pixmap, getDisplayPixmap() renders it again if anyone asks for it.
+    displayPixmap = QPixmap();
+    m_ImageFrame->clear();
+
+    m_ImageFrame->resize(((m_PreviewSampling * currentZoom) / 100.0) * rawImage.size());
+    m_ImageFrame->update();
+}
+
+// Paints the exposed part of a tiled image and its overlays, as updateFrameLargeImage() would have
+// rendered them on a full size pixmap scaled by the frame.
+void FITSView::drawTiledFrame(QPainter *painter, const QRect &exposed)
+{
+    const double scale = (m_PreviewSampling * currentZoom) / ZOOM_DEFAULT;
+
+    painter->fillRect(exposed, Qt::black);
+    m_TilePyramid.draw(painter, exposed, scale);
+
+    painter->setClipRect(exposed);
+    painter->scale(scale, scale);
+    QFont font = painter->font();
+    font.setPixelSize(scaleSize(FONT_SIZE));
+    painter->setFont(font);
+
+    drawStarRingFilter(painter, 1.0 / m_PreviewSampling, dynamic_cast<ImageRingMask *>(m_ImageMask.get()));
+    drawOverlay(painter, 1.0 / m_PreviewSampling);
+}
+
+const QPixmap &FITSView::getDisplayPixmap()
+{
+    if (displayPixmap.isNull() && isTiledImage())
+        renderLargeImage();
+    return displayPixmap;
+}
+
 void FITSView::updateFrameSmallImage()
 {
     QImage scaledImage = rawImage.scaled(currentWidth, currentHeight, Qt::KeepAspectRatio, Qt::SmoothTransformation);
@@ -1293,9 +1358,13 @@ void FITSView::drawMagnifyingGlass(QPainter *painter, double scale)
         }
 
         // Finally, draw the magnified image.
-        painter->drawPixmap(QRect(winLeft * scale, winTop * scale, outputDimension, outputDimension),
-                            displayPixmap,
-                            QRect(imgLeft, imgTop, inputDimension / magAmount, inputDimension / magAmount));
+        const QRect magTarget(winLeft * scale, winTop * scale, outputDimension, outputDimension);
+        const QRect magSource(imgLeft, imgTop, inputDimension / magAmount, inputDimension / magAmount);
+        // Tiled images have no pixmap, only the magnified part of the image is converted.
+        if (isTiledImage())
+            painter->drawImage(magTarget, rawImage.copy(magSource));
+        else
+            painter->drawPixmap(magTarget, displayPixmap, magSource);
         // Draw a white border.
         painter->setPen(QPen(Qt::white, scaleSize(1)));
         painter->drawRect(winLeft * scale, winTop * scale, outputDimension, outputDimension);
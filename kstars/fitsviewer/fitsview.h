@@ -12,6 +12,7 @@
 
 #include <config-kstars.h>
 #include "stretch.h"
+#include "fitstilepyramid.h"
 
 #ifdef HAVE_DATAVISUALIZATION
 #include "starprofileviewer.h"
@@ -96,10 +97,7 @@ class FITSView : public QScrollArea
         {
             return rawImage;
         }
-        const QPixmap &getDisplayPixmap() const
-        {
-            return displayPixmap;
-        }
+        const QPixmap &getDisplayPixmap();
 
         // Tracking square
         void setTrackingBoxEnabled(bool enable);
@@ -382,9 +380,13 @@ class FITSView : public QScrollArea
         void doStretch(QImage *outputImage);
         double scaleSize(double size);
         bool isLargeImage();
+        bool isTiledImage();
         bool initDisplayPixmap(QImage &image, float space);
+        bool renderLargeImage();
         void updateFrameLargeImage();
         void updateFrameSmallImage();
+        void updateFrameTiledImage();
+        void drawTiledFrame(QPainter *painter, const QRect &exposed);
         bool drawHFR(QPainter * painter, const QString &hfr, int x, int y);
 
         QPointer<QLabel> noImageLabel;
@@ -403,6 +405,8 @@ class FITSView : public QScrollArea
         QImage rawImage;
         // Actual pixmap after all the overlays
         QPixmap displayPixmap;
+        // Tiles of rawImage, for images painted directly by the frame
+        FITSTilePyramid m_TilePyramid;
 
         bool firstLoad { true };
         bool markStars { false };
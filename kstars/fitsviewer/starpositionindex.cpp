@@ -0,0 +1,174 @@
+/*  Star Position Index
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "starpositionindex.h"
+
+#include "fitsstardetector.h"
+
+#include <algorithm>
+#include <cmath>
+
+StarPositionIndex::StarPositionIndex(const QList<Edge> &stars, double cellSize)
+{
+    build(stars, cellSize);
+}
+
+void StarPositionIndex::build(const QList<Edge> &stars, double cellSize)
+{
+    build(stars.size(), [&stars](int i)
+    {
+        return std::make_pair(stars[i].x, stars[i].y);
+    }, cellSize);
+}
+
+void StarPositionIndex::build(const QList<Edge *> &stars, double cellSize)
+{
+    build(stars.size(), [&stars](int i)
+    {
+        return std::make_pair(stars[i]->x, stars[i]->y);
+    }, cellSize);
+}
+
+template <typename Position>
+void StarPositionIndex::build(int count, Position position, double cellSize)
+{
+    m_Columns = m_Rows = 0;
+    m_CellStart.clear();
+    m_Indexes.clear();
+    m_X.clear();
+    m_Y.clear();
+
+    float minX = 0, minY = 0, maxX = 0, maxY = 0;
+    bool first = true;
+    for (int i = 0; i < count; i++)
+    {
+        const auto p = position(i);
+        if (!std::isfinite(p.first) || !std::isfinite(p.second))
+            continue;
+        minX = first ? p.first : std::min(minX, p.first);
+        maxX = first ? p.first : std::max(maxX, p.first);
+        minY = first ? p.second : std::min(minY, p.second);
+        maxY = first ? p.second : std::max(maxY, p.second);
+        first = false;
+    }
+    if (first)
+        return;
+
+    // A small radius over a wide field would make mostly empty cells, keep it to a few per star.
+    const double maxCells = 4.0 * count + 16;
+    m_CellSize = cellSize > 0 ? cellSize : 1;
+    while ((std::floor((maxX - minX) / m_CellSize) + 1) * (std::floor((maxY - minY) / m_CellSize) + 1) > maxCells)
+        m_CellSize *= 2;
+
+    m_MinX = minX;
+    m_MinY = minY;
+    m_Columns = static_cast<int>((maxX - minX) / m_CellSize) + 1;
+    m_Rows = static_cast<int>((maxY - minY) / m_CellSize) + 1;
+
+    // Counting sort of the stars by cell, stars of a cell stay in index order.
+    std::vector<int> cells(count, -1);
+    m_CellStart.assign(m_Columns * m_Rows + 1, 0);
+    for (int i = 0; i < count; i++)
+    {
+        const auto p = position(i);
+        if (!std::isfinite(p.first) || !std::isfinite(p.second))
+            continue;
+        const int column = std::min(m_Columns - 1, static_cast<int>((p.first - m_MinX) / m_CellSize));
+        const int row = std::min(m_Rows - 1, static_cast<int>((p.second - m_MinY) / m_CellSize));
+        cells[i] = row * m_Columns + column;
+        m_CellStart[cells[i] + 1]++;
+    }
+    for (size_t c = 1; c < m_CellStart.size(); c++)
+        m_CellStart[c] += m_CellStart[c - 1];
+
+    const int indexed = m_CellStart.back();
+    m_Indexes.resize(indexed);
+    m_X.resize(indexed);
+    m_Y.resize(indexed);
+    std::vector<int> next(m_CellStart.begin(), m_CellStart.end() - 1);
+    for (int i = 0; i < count; i++)
+    {
+        if (cells[i] < 0)
+            continue;
+        const int slot = next[cells[i]]++;
+        const auto p = position(i);
+        m_Indexes[slot] = i;
+        m_X[slot] = p.first;
+        m_Y[slot] = p.second;
+    }
+}
+
+bool StarPositionIndex::cellRange(double x, double y, double radius, int *left, int *top, int *right, int *bottom) const
+{
+    if (m_Columns == 0 || !(radius >= 0))
+        return false;
+
+    const double l = std::floor((x - radius - m_MinX) / m_CellSize);
+    const double r = std::floor((x + radius - m_MinX) / m_CellSize);
+    const double t = std::floor((y - radius - m_MinY) / m_CellSize);
+    const double b = std::floor((y + radius - m_MinY) / m_CellSize);
+    if (r < 0 || b < 0 || l >= m_Columns || t >= m_Rows)
+        return false;
+
+    *left = static_cast<int>(std::max(0.0, l));
+    *top = static_cast<int>(std::max(0.0, t));
+    *right = static_cast<int>(std::min<double>(m_Columns - 1, r));
+    *bottom = static_cast<int>(std::min<double>(m_Rows - 1, b));
+    return true;
+}
+
+int StarPositionIndex::findClosest(double x, double y, double maxDistance, double *distance) const
+{
+    int bestIndex = -1;
+    double bestSquaredDistance = maxDistance * maxDistance;
+
+    int left, top, right, bottom;
+    if (cellRange(x, y, maxDistance, &left, &top, &right, &bottom))
+    {
+        for (int row = top; row <= bottom; row++)
+        {
+            const int rowStart = row * m_Columns;
+            for (int k = m_CellStart[rowStart + left]; k < m_CellStart[rowStart + right + 1]; k++)
+            {
+                const double xDiff = m_X[k] - x;
+                const double yDiff = m_Y[k] - y;
+                const double squaredDistance = xDiff * xDiff + yDiff * yDiff;
+                if (squaredDistance < bestSquaredDistance ||
+                        (squaredDistance == bestSquaredDistance && m_Indexes[k] > bestIndex))
+                {
+                    bestIndex = m_Indexes[k];
+                    bestSquaredDistance = squaredDistance;
+                }
+            }
+        }
+    }
+
+    if (distance != nullptr)
+        *distance = std::sqrt(bestSquaredDistance);
+    return bestIndex;
+}
+
+QVector<int> StarPositionIndex::findWithin(double x, double y, double radius) const
+{
+    QVector<int> found;
+    int left, top, right, bottom;
+    if (!cellRange(x, y, radius, &left, &top, &right, &bottom))
+        return found;
+
+    const double squaredRadius = radius * radius;
+    for (int row = top; row <= bottom; row++)
+    {
+        const int rowStart = row * m_Columns;
+        for (int k = m_CellStart[rowStart + left]; k < m_CellStart[rowStart + right + 1]; k++)
+        {
+            const double xDiff = m_X[k] - x;
+            const double yDiff = m_Y[k] - y;
+            if (xDiff * xDiff + yDiff * yDiff <= squaredRadius)
+                found.append(m_Indexes[k]);
+        }
+    }
+    std::sort(found.begin(), found.end());
+    return found;
+}
@@ -0,0 +1,72 @@
+/*  Star Position Index
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include <QList>
+#include <QVector>
+
+#include <vector>
+
+class Edge;
+
+/**
+ * @brief A uniform grid over star positions, for finding the stars near a point.
+ *
+ * The index is built once per frame and can then be queried any number of times, each query only
+ * looks at the few cells around the point instead of the whole star list. The cells should be about
+ * the size of the search radius. Stars are referred to by their index in the list the grid was built from.
+ */
+class StarPositionIndex
+{
+    public:
+        StarPositionIndex() = default;
+        StarPositionIndex(const QList<Edge> &stars, double cellSize);
+
+        /**
+         * @brief build Indexes the star positions, replacing any previous stars.
+         * @param cellSize side of the grid cells in pixels, enlarged if there would be many more cells than stars.
+         */
+        void build(const QList<Edge> &stars, double cellSize);
+        void build(const QList<Edge *> &stars, double cellSize);
+
+        int size() const
+        {
+            return static_cast<int>(m_Indexes.size());
+        }
+
+        /**
+         * @brief findClosest Finds the star closest to x,y within maxDistance pixels.
+         * Of stars at the same distance, the one with the highest index is returned.
+         * @param distance set to the distance to the star found, or to maxDistance.
+         * @return the index of the star, -1 if there is none within maxDistance.
+         */
+        int findClosest(double x, double y, double maxDistance, double *distance = nullptr) const;
+
+        /**
+         * @brief findWithin Finds all the stars within radius pixels of x,y.
+         * @return the indexes of the stars, in increasing order.
+         */
+        QVector<int> findWithin(double x, double y, double radius) const;
+
+    private:
+        template <typename Position>
+        void build(int count, Position position, double cellSize);
+
+        // Range of cells covering [x - radius, x + radius], false if it is outside the grid.
+        bool cellRange(double x, double y, double radius, int *left, int *top, int *right, int *bottom) const;
+
+        double m_CellSize { 1 };
+        double m_MinX { 0 };
+        double m_MinY { 0 };
+        int m_Columns { 0 };
+        int m_Rows { 0 };
+
+        // Stars of cell c are at [m_CellStart[c], m_CellStart[c + 1]) in the arrays below.
+        std::vector<int> m_CellStart;
+        std::vector<int> m_Indexes;
+        std::vector<float> m_X;
+        std::vector<float> m_Y;
+};
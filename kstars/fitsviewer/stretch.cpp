@@ -4,24 +4,19 @@
 */
 
 #include "stretch.h"
+#include "fitsmedian.h"
 
 #include <fitsio.h>
 #include <math.h>
+#include <limits>
+#include <type_traits>
+#include <vector>
 #include <QtConcurrent>
+#include <QThread>
 
 namespace
 {
 
-// Returns the median value of the vector.
-// The vector is modified in an undefined way.
-template <typename T>
-T median(std::vector<T> &values)
-{
-    const int middle = values.size() / 2;
-    std::nth_element(values.begin(), values.begin() + middle, values.end());
-    return values[middle];
-}
-
 // Returns the rough max of the buffer.
 template <typename T>
 T sampledMax(T const *values, int size, int sampleBy)
@@ -33,181 +28,207 @@ T sampledMax(T const *values, int size, int sampleBy)
     return  maxVal;
 }
 
-// Returns the median of the sample values.
-// The values are not modified.
+// The midtones transfer function of one channel, with its constants computed once.
+// Based on the spec in section 8.5.6
+// https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
+// The extension parameters are not used.
+template <typename T>
+struct ChannelStretch
+{
+    // We're outputting uint8, so the max output is 255.
+    static constexpr int maxOutput = 255;
+
+    ChannelStretch(const StretchParams1Channel &params, float maxInput)
+    {
+        midtones = params.midtones;
+        // highlights - shadows, protecting for divide-by-0, in a 0->1.0 scale.
+        const float hsRangeFactor = params.highlights == params.shadows ? 1.0f : 1.0f / (params.highlights - params.shadows);
+        // Shadow and highlight values translated to the ADU scale.
+        nativeShadows = params.shadows * maxInput;
+        nativeHighlights = params.highlights * maxInput;
+        // Constants based on above needed for the stretch calculations.
+        k1 = (midtones - 1) * hsRangeFactor * maxOutput / maxInput;
+        k2 = ((2 * midtones) - 1) * hsRangeFactor / maxInput;
+    }
+
+    uint8_t operator()(T input) const
+    {
+        if constexpr (std::is_floating_point<T>::value)
+        {
+            // Branch-free so that the compiler can vectorize the row loops.
+            const T inputFloored = (input - nativeShadows);
+            const float stretched = (inputFloored * k1) / (inputFloored * k2 - midtones);
+            const float clipped = input < nativeShadows ? 0.0f : (input >= nativeHighlights ? maxOutput : stretched);
+            return clipped;
+        }
+        else
+        {
+            if (input < nativeShadows) return 0;
+            else if (input >= nativeHighlights) return maxOutput;
+            const T inputFloored = (input - nativeShadows);
+            return (inputFloored * k1) / (inputFloored * k2 - midtones);
+        }
+    }
+
+    T nativeShadows, nativeHighlights;
+    float midtones, k1, k2;
+};
+
+// 8 and 16 bit samples are stretched through a lookup table holding the output of every possible input value.
+template <typename T>
+constexpr bool hasLookupTable()
+{
+    return std::is_integral<T>::value && sizeof(T) <= 2;
+}
+
 template <typename T>
-T median(T const *values, int size, int sampleBy)
+constexpr uint32_t lookupTableSize()
 {
-    const int downsampled_size = size / sampleBy;
-    std::vector<T> samples(downsampled_size);
-    for (int index = 0, i = 0; i < downsampled_size; ++i, index += sampleBy)
-        samples[i] = values[index];
-    return median(samples);
+    return 1u << (8 * sizeof(T));
+}
+
+// Stores the stretch of every possible input value in table, which can then be indexed by the
+// input value (that is, table points to the entry of value 0, even for signed types).
+template <typename T>
+uint8_t const *buildLookupTable(const ChannelStretch<T> &stretch, std::vector<uint8_t> &storage)
+{
+    constexpr int64_t lowest = std::numeric_limits<T>::lowest();
+    storage.resize(lookupTableSize<T>());
+    for (uint32_t i = 0; i < storage.size(); i++)
+        storage[i] = stretch(static_cast<T>(i + lowest));
+    return storage.data() - lowest;
+}
+
+// The table is worth building only if there are more output pixels than entries.
+template <typename T>
+bool useLookupTable(int outputWidth, int outputHeight)
+{
+    if constexpr (hasLookupTable<T>())
+        return static_cast<uint64_t>(outputWidth) * outputHeight >= lookupTableSize<T>();
+    else
+        return false;
+}
+
+// Runs job(start, end) over bands of rows, one band per thread. Blocks until done.
+template <typename F>
+void runOnRowBands(int numRows, const F &job)
+{
+    const int nThreads = std::max(1, std::min(QThread::idealThreadCount(), numRows));
+    const int rowsPerBand = (numRows + nThreads - 1) / nThreads;
+
+    QVector<QFuture<void>> futures;
+    for (int start = 0; start < numRows; start += rowsPerBand)
+    {
+        const int end = std::min(numRows, start + rowsPerBand);
+        futures.append(QtConcurrent::run([ =, &job]()
+        {
+            job(start, end);
+        }));
+    }
+    for(QFuture<void> future : futures)
+        future.waitForFinished();
 }
 
 // This stretches one channel given the input parameters.
-// Based on the spec in section 8.5.6
-// https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
 // Uses multiple threads, blocks until done.
-// The extension parameters are not used.
 // Sampling is applied to the output (that is, with sampling=2, we compute every other output
 // sample both in width and height, so the output would have about 4X fewer pixels.
 template <typename T>
-void stretchOneChannel(T *input_buffer, QImage *output_image,
+void stretchOneChannel(T const *input_buffer, QImage *output_image,
                        const StretchParams &stretch_params,
                        int input_range, int image_height, int image_width, int sampling)
 {
-    QVector<QFuture<void>> futures;
-
-    // We're outputting uint8, so the max output is 255.
-    constexpr int maxOutput = 255;
-
     // Maximum possible input value (e.g. 1024*64 - 1 for a 16 bit unsigned int).
     const float maxInput = input_range > 1 ? input_range - 1 : input_range;
+    const ChannelStretch<T> stretch(stretch_params.grey_red, maxInput);
 
-    const float midtones   = stretch_params.grey_red.midtones;
-    const float highlights = stretch_params.grey_red.highlights;
-    const float shadows    = stretch_params.grey_red.shadows;
+    const int outputHeight = (image_height + sampling - 1) / sampling;
+    const int outputWidth = (image_width + sampling - 1) / sampling;
 
-    // Precomputed expressions moved out of the loop.
-    // highlights - shadows, protecting for divide-by-0, in a 0->1.0 scale.
-    const float hsRangeFactor = highlights == shadows ? 1.0f : 1.0f / (highlights - shadows);
-    // Shadow and highlight values translated to the ADU scale.
-    const T nativeShadows = shadows * maxInput;
-    const T nativeHighlights = highlights * maxInput;
-    // Constants based on above needed for the stretch calculations.
-    const float k1 = (midtones - 1) * hsRangeFactor * maxOutput / maxInput;
-    const float k2 = ((2 * midtones) - 1) * hsRangeFactor / maxInput;
+    std::vector<uint8_t> storage;
+    const uint8_t *table = useLookupTable<T>(outputWidth, outputHeight) ? buildLookupTable(stretch, storage) : nullptr;
 
     // Increment the input index by the sampling, the output index increments by 1.
-    for (int j = 0, jout = 0; j < image_height; j += sampling, jout++)
+    runOnRowBands(outputHeight, [ & ](int start, int end)
     {
-        futures.append(QtConcurrent::run([ = ]()
+        for (int jout = start; jout < end; jout++)
         {
-            T * inputLine  = input_buffer + j * image_width;
+            T const * inputLine  = input_buffer + static_cast<size_t>(jout) * sampling * image_width;
             auto * scanLine = output_image->scanLine(jout);
 
-            for (int i = 0, iout = 0; i < image_width; i += sampling, iout++)
+            if constexpr (hasLookupTable<T>())
             {
-                const T input = inputLine[i];
-                if (input < nativeShadows) scanLine[iout] = 0;
-                else if (input >= nativeHighlights) scanLine[iout] = maxOutput;
-                else
+                if (table)
                 {
-                    const T inputFloored = (input - nativeShadows);
-                    scanLine[iout] = (inputFloored * k1) / (inputFloored * k2 - midtones);
+                    for (int i = 0, iout = 0; i < image_width; i += sampling, iout++)
+                        scanLine[iout] = table[inputLine[i]];
+                    continue;
                 }
             }
-        }));
-    }
-    for(QFuture<void> future : futures)
-        future.waitForFinished();
+            for (int i = 0, iout = 0; i < image_width; i += sampling, iout++)
+                scanLine[iout] = stretch(inputLine[i]);
+        }
+    });
 }
 
 // This is like the above 1-channel stretch, but extended for 3 channels.
-// This could have been more modular, but the three channels are combined
-// into a single qRgb value at the end, so it seems the simplest thing is to
-// replicate the code. It is assume the colors are not interleaved--the red image
+// The three channels are combined into a single qRgb value at the end.
+// It is assume the colors are not interleaved--the red image
 // is stored fully, then the green, then the blue.
 // Sampling is applied to the output (that is, with sampling=2, we compute every other output
 // sample both in width and height, so the output would have about 4X fewer pixels.
 template <typename T>
-void stretchThreeChannels(T *inputBuffer, QImage *outputImage,
+void stretchThreeChannels(T const *inputBuffer, QImage *outputImage,
                           const StretchParams &stretchParams,
                           int inputRange, int imageHeight, int imageWidth, int sampling)
 {
-    QVector<QFuture<void>> futures;
-
-    // We're outputting uint8, so the max output is 255.
-    constexpr int maxOutput = 255;
-
     // Maximum possible input value (e.g. 1024*64 - 1 for a 16 bit unsigned int).
     const float maxInput = inputRange > 1 ? inputRange - 1 : inputRange;
+    const ChannelStretch<T> stretchR(stretchParams.grey_red, maxInput);
+    const ChannelStretch<T> stretchG(stretchParams.green, maxInput);
+    const ChannelStretch<T> stretchB(stretchParams.blue, maxInput);
+
+    const int outputHeight = (imageHeight + sampling - 1) / sampling;
+    const int outputWidth = (imageWidth + sampling - 1) / sampling;
+    const size_t size = static_cast<size_t>(imageWidth) * imageHeight;
+
+    std::vector<uint8_t> storageR, storageG, storageB;
+    const uint8_t *tableR = nullptr, *tableG = nullptr, *tableB = nullptr;
+    if (useLookupTable<T>(outputWidth, outputHeight))
+    {
+        tableR = buildLookupTable(stretchR, storageR);
+        tableG = buildLookupTable(stretchG, storageG);
+        tableB = buildLookupTable(stretchB, storageB);
+    }
 
-    const float midtonesR   = stretchParams.grey_red.midtones;
-    const float highlightsR = stretchParams.grey_red.highlights;
-    const float shadowsR    = stretchParams.grey_red.shadows;
-    const float midtonesG   = stretchParams.green.midtones;
-    const float highlightsG = stretchParams.green.highlights;
-    const float shadowsG    = stretchParams.green.shadows;
-    const float midtonesB   = stretchParams.blue.midtones;
-    const float highlightsB = stretchParams.blue.highlights;
-    const float shadowsB    = stretchParams.blue.shadows;
-
-    // Precomputed expressions moved out of the loop.
-    // highlights - shadows, protecting for divide-by-0, in a 0->1.0 scale.
-    const float hsRangeFactorR = highlightsR == shadowsR ? 1.0f : 1.0f / (highlightsR - shadowsR);
-    const float hsRangeFactorG = highlightsG == shadowsG ? 1.0f : 1.0f / (highlightsG - shadowsG);
-    const float hsRangeFactorB = highlightsB == shadowsB ? 1.0f : 1.0f / (highlightsB - shadowsB);
-    // Shadow and highlight values translated to the ADU scale.
-    const T nativeShadowsR = shadowsR * maxInput;
-    const T nativeShadowsG = shadowsG * maxInput;
-    const T nativeShadowsB = shadowsB * maxInput;
-    const T nativeHighlightsR = highlightsR * maxInput;
-    const T nativeHighlightsG = highlightsG * maxInput;
-    const T nativeHighlightsB = highlightsB * maxInput;
-    // Constants based on above needed for the stretch calculations.
-    const float k1R = (midtonesR - 1) * hsRangeFactorR * maxOutput / maxInput;
-    const float k1G = (midtonesG - 1) * hsRangeFactorG * maxOutput / maxInput;
-    const float k1B = (midtonesB - 1) * hsRangeFactorB * maxOutput / maxInput;
-    const float k2R = ((2 * midtonesR) - 1) * hsRangeFactorR / maxInput;
-    const float k2G = ((2 * midtonesG) - 1) * hsRangeFactorG / maxInput;
-    const float k2B = ((2 * midtonesB) - 1) * hsRangeFactorB / maxInput;
-
-    const int size = imageWidth * imageHeight;
-
-    for (int j = 0, jout = 0; j < imageHeight; j += sampling, jout++)
+    runOnRowBands(outputHeight, [ & ](int start, int end)
     {
-        futures.append(QtConcurrent::run([ = ]()
+        for (int jout = start; jout < end; jout++)
         {
             // R, G, B input images are stored one after another.
-            T * inputLineR  = inputBuffer + j * imageWidth;
-            T * inputLineG  = inputLineR + size;
-            T * inputLineB  = inputLineG + size;
+            T const * inputLineR  = inputBuffer + static_cast<size_t>(jout) * sampling * imageWidth;
+            T const * inputLineG  = inputLineR + size;
+            T const * inputLineB  = inputLineG + size;
 
             auto * scanLine = reinterpret_cast<QRgb*>(outputImage->scanLine(jout));
 
-            for (int i = 0, iout = 0; i < imageWidth; i += sampling, iout++)
+            if constexpr (hasLookupTable<T>())
             {
-                const T inputR = inputLineR[i];
-                const T inputG = inputLineG[i];
-                const T inputB = inputLineB[i];
-
-                uint8_t red, green, blue;
-
-                if (inputR < nativeShadowsR) red = 0;
-                else if (inputR >= nativeHighlightsR) red = maxOutput;
-                else
-                {
-                    const T inputFloored = (inputR - nativeShadowsR);
-                    red = (inputFloored * k1R) / (inputFloored * k2R - midtonesR);
-                }
-
-                if (inputG < nativeShadowsG) green = 0;
-                else if (inputG >= nativeHighlightsG) green = maxOutput;
-                else
-                {
-                    const T inputFloored = (inputG - nativeShadowsG);
-                    green = (inputFloored * k1G) / (inputFloored * k2G - midtonesG);
-                }
-
-                if (inputB < nativeShadowsB) blue = 0;
-                else if (inputB >= nativeHighlightsB) blue = maxOutput;
-                else
+                if (tableR)
                 {
-                    const T inputFloored = (inputB - nativeShadowsB);
-                    blue = (inputFloored * k1B) / (inputFloored * k2B - midtonesB);
+                    for (int i = 0, iout = 0; i < imageWidth; i += sampling, iout++)
+                        scanLine[iout] = qRgb(tableR[inputLineR[i]], tableG[inputLineG[i]], tableB[inputLineB[i]]);
+                    continue;
                 }
-                scanLine[iout] = qRgb(red, green, blue);
             }
-        }));
-    }
-    for(QFuture<void> future : futures)
-        future.waitForFinished();
+            for (int i = 0, iout = 0; i < imageWidth; i += sampling, iout++)
+                scanLine[iout] = qRgb(stretchR(inputLineR[i]), stretchG(inputLineG[i]), stretchB(inputLineB[i]));
+        }
+    });
 }
 
 template <typename T>
-void stretchChannels(T *input_buffer, QImage *output_image,
+void stretchChannels(T const *input_buffer, QImage *output_image,
                      const StretchParams &stretch_params,
                      int input_range, int image_height, int image_width, int num_channels, int sampling)
 {
@@ -220,28 +241,10 @@ void stretchChannels(T *input_buffer, QImage *output_image,
 }
 
 // See section 8.5.7 in above link  https://pixinsight.com/doc/docs/XISF-1.0-spec/XISF-1.0-spec.html
-template <typename T>
-void computeParamsOneChannel(T const *buffer, StretchParams1Channel *params,
-                             int inputRange, int height, int width)
+// Computes the parameters from the channel's median and median deviation (in ADU).
+void computeParamsFromMedian(double medianSample, double medDev, StretchParams1Channel *params, int inputRange)
 {
-    // Find the median sample.
-    constexpr int maxSamples = 500000;
-    const int sampleBy = width * height < maxSamples ? 1 : width * height / maxSamples;
-
-    T medianSample = median(buffer, width * height, sampleBy);
-    // Find the Median deviation: 1.4826 * median of abs(sample[i] - median).
-    const int numSamples = width * height / sampleBy;
-    std::vector<T> deviations(numSamples);
-    for (int index = 0, i = 0; i < numSamples; ++i, index += sampleBy)
-    {
-        if (medianSample > buffer[index])
-            deviations[i] = medianSample - buffer[index];
-        else
-            deviations[i] = buffer[index] - medianSample;
-    }
-
     // Shift everything to 0 -> 1.0.
-    const float medDev = median(deviations);
     const float normalizedMedian = medianSample / static_cast<float>(inputRange);
     const float MADN = 1.4826 * medDev / static_cast<float>(inputRange);
 
@@ -279,6 +282,15 @@ void computeParamsOneChannel(T const *buffer, StretchParams1Channel *params,
     params->highlights_expansion = 1.0;
 }
 
+template <typename T>
+void computeParamsOneChannel(T const *buffer, StretchParams1Channel *params,
+                             int inputRange, int height, int width)
+{
+    // Find the median and the median deviation over all the samples.
+    const auto stats = FITSMedian::compute(buffer, width * height);
+    computeParamsFromMedian(stats.median, stats.mad, params, inputRange);
+}
+
 // Need to know the possible range of input values.
 // Using the type of the sample and guessing.
 // Perhaps we should examine the contents for the file
@@ -439,3 +451,21 @@ StretchParams Stretch::computeParams(uint8_t const *input)
     }
     return result;
 }
+
+StretchParams Stretch::computeParams(uint8_t const *input, const double median[3], const double mad[3])
+{
+    // If a channel's MAD isn't known, compute everything from the buffer.
+    for (int channel = 0; channel < image_channels; ++channel)
+        if (mad[channel] < 0)
+            return computeParams(input);
+
+    recalculateInputRange(input);
+    StretchParams result;
+    for (int channel = 0; channel < image_channels; ++channel)
+    {
+        StretchParams1Channel *params = channel == 0 ? &result.grey_red :
+                                        (channel == 1 ? &result.green : &result.blue);
+        computeParamsFromMedian(median[channel], mad[channel], params, input_range);
+    }
+    return result;
+}
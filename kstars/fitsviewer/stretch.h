@@ -68,6 +68,16 @@ class Stretch
          */
         StretchParams computeParams(const uint8_t *input);
 
+        /**
+         * @brief computeParams Same as above, but uses per-channel medians and median absolute
+         * deviations already computed for the image (e.g. by FITSData::getMedianAndMAD()),
+         * so that the pixels don't need to be scanned again.
+         * @param median the median of each channel.
+         * @param mad the median absolute deviation of each channel. Channels with a negative
+         * MAD (unknown) are computed from the input buffer.
+         */
+        StretchParams computeParams(const uint8_t *input, const double median[3], const double mad[3]);
+
         /**
          * @brief run run the stretch algorithm according to the params given
          * placing the output in output_image.
@@ -437,6 +437,16 @@ int HEALPix::getPix(int level, double ra, double dec)
     return ang2pix_nest_z_phi(nside, sin(polar[0]), polar[1]);
 }
 
+QVector3D HEALPix::getPixCenter(int level, int pix)
+{
+    int ix, iy, fn;
+    int nside = 1 << level;
+
+    nest2xyf(nside, pix, &ix, &iy, &fn);
+
+    return toVec3((ix + 0.5) / nside, (iy + 0.5) / nside, fn);
+}
+
 void HEALPix::getPixChilds(int pix, int *childs)
 {
     childs[0] = pix * 4 + 0;
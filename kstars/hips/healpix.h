@@ -39,6 +39,8 @@ public:
     void neighbours(int nside, qint32 ipix, int *result);
     int  getPix(int level, double ra, double dec);
     void getPixChilds(int pix, int *childs);
+    /** @return the unit vector to the center of the pixel, in the frame of the HiPS survey. */
+    QVector3D getPixCenter(int level, int pix);
 
 private:
     void nest2xyf(int nside, int pix, int *ix, int *iy, int *face_num);
@@ -9,6 +9,7 @@
 #ifndef HIPS_H
 #define HIPS_H
 
+#include <QHash>
 #include <QString>
 #include <QImage>
 #include <QDebug>
@@ -47,4 +48,14 @@ typedef struct
 
 Q_DECLARE_METATYPE(pixCacheKey_t)
 
+inline uint qHash(const pixCacheKey_t &key, uint seed)
+{
+  return qHash(QString("%1_%2_%3").arg(key.level).arg(key.pix).arg(key.uid), seed);
+}
+
+inline bool operator==(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
+{
+  return (k1.uid == k2.uid) && (k1.level == k2.level) && (k1.pix == k2.pix);
+}
+
 #endif // HIPS_H
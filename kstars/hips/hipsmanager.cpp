@@ -26,17 +26,6 @@
 static QNetworkDiskCache *g_discCache = nullptr;
 static UrlFileDownload *g_download = nullptr;
 
-static int qHash(const pixCacheKey_t &key, uint seed)
-{
-    return qHash(QString("%1_%2_%3").arg(key.level).arg(key.pix).arg(key.uid), seed);
-}
-
-
-inline bool operator==(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
-{
-    return (k1.uid == k2.uid) && (k1.level == k2.level) && (k1.pix == k2.pix);
-}
-
 HIPSManager * HIPSManager::_HIPSManager = nullptr;
 
 HIPSManager *HIPSManager::Instance()
@@ -79,8 +68,17 @@ HIPSManager::HIPSManager() : QObject(KStars::Instance())
     value = Options::hIPSMemoryCache() * 1024 * 1024;
     m_cache.setMaxCost(Options::hIPSMemoryCache() * 1024 * 1024);
 
+    connect(&m_decoder, &HIPSTileDecoder::decoded, this, &HIPSManager::slotTileDecoded);
+    connect(&m_decoder, &HIPSTileDecoder::failed, this, &HIPSManager::slotTileFailed);
+    connect(&m_decoder, &HIPSTileDecoder::missed, this, &HIPSManager::slotTileMissed);
+    updateDecodedCache();
+}
 
-
+void HIPSManager::updateDecodedCache()
+{
+    m_decoder.setDiskCacheDirectory(Options::hIPSDecodedCache() ?
+                                    QDir(KSPaths::writableLocation(QStandardPaths::CacheLocation)).filePath("hips-decoded") :
+                                    QString(), static_cast<qint64>(Options::hIPSDecodedCacheSize()) * 1024 * 1024);
 }
 
 void HIPSManager::showSettings()
@@ -112,6 +110,8 @@ void HIPSManager::showSettings()
 
 void HIPSManager::slotApply()
 {
+    updateDecodedCache();
+
     if (Options::hIPSUseOfflineSource())
     {
         QDir hipsDirectory(Options::hIPSOfflinePath());
@@ -222,13 +222,26 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
         return cacheImage;
     }
 
+    m_downloadMap.insert(key);
+
+    if (m_decoder.hasDiskCache())
+        m_decoder.load(key);
+    else
+        g_download->begin(getTileURL(key), key);
+
+    return nullptr;
+}
+
+QUrl HIPSManager::getTileURL(const pixCacheKey_t &key) const
+{
     QString path;
 
-    if (!allsky)
+    // Level 0 only holds the all sky image, see getPix()
+    if (key.level != 0)
     {
-        int dir = (pix / 10000) * 10000;
+        int dir = (key.pix / 10000) * 10000;
 
-        path = "/Norder" + QString::number(level) + "/Dir" + QString::number(dir) + "/Npix" + QString::number(pix) +
+        path = "/Norder" + QString::number(key.level) + "/Dir" + QString::number(dir) + "/Npix" + QString::number(key.pix) +
                '.' + m_currentFormat;
     }
     else
@@ -238,10 +251,12 @@ QImage *HIPSManager::getPix(bool allsky, int level, int pix, bool &freeImage)
 
     QUrl downloadURL(m_currentURL);
     downloadURL.setPath(downloadURL.path() + path);
-    g_download->begin(downloadURL, key);
-    m_downloadMap.insert(key);
+    return downloadURL;
+}
 
-    return nullptr;
+void HIPSManager::setViewCenter(int level, int pix)
+{
+    m_decoder.setViewCenter(level, pix);
 }
 
 
@@ -337,33 +352,21 @@ bool HIPSManager::parseProperties(hipsParams_t *param, const QString &filename,
 void HIPSManager::cancelAll()
 {
     g_download->abortAll();
+    m_decoder.cancelAll();
 }
 
 void HIPSManager::clearDiscCache()
 {
     g_discCache->clear();
+    m_decoder.clearDiskCache();
 }
 
 void HIPSManager::slotDone(QNetworkReply::NetworkError error, QByteArray &data, pixCacheKey_t &key)
 {
     if (error == QNetworkReply::NoError)
     {
-        m_downloadMap.remove(key);
-
-        auto *item = new pixCacheItem_t;
-
-        item->image = new QImage();
-        if (item->image->loadFromData(data))
-        {
-            addToMemoryCache(key, item);
-
-            //SkyMap::Instance()->forceUpdate();
-        }
-        else
-        {
-            delete item;
-            qCWarning(KSTARS) << "no image. Data size: " << data.length();
-        }
+        // The tile stays in the download map until it is decoded
+        m_decoder.decode(key, data);
     }
     else
     {
@@ -387,6 +390,36 @@ void HIPSManager::removeTimer(pixCacheKey_t &key)
     emit sigRepaint();
 }
 
+void HIPSManager::slotTileDecoded(const pixCacheKey_t &key, const QImage &image)
+{
+    m_downloadMap.remove(key);
+
+    auto *item = new pixCacheItem_t;
+    item->image = new QImage(image);
+
+    pixCacheKey_t cacheKey = key;
+    addToMemoryCache(cacheKey, item);
+
+    emit sigRepaint();
+}
+
+void HIPSManager::slotTileFailed(const pixCacheKey_t &key)
+{
+    m_downloadMap.remove(key);
+}
+
+void HIPSManager::slotTileMissed(const pixCacheKey_t &key)
+{
+    // Tiles of a previous source are not worth downloading anymore
+    if (key.uid != m_uid)
+    {
+        m_downloadMap.remove(key);
+        return;
+    }
+
+    g_download->begin(getTileURL(key), key);
+}
+
 PixCache *HIPSManager::getCache()
 {
     return &m_cache;
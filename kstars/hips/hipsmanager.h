@@ -9,6 +9,7 @@
 #pragma once
 
 #include "hips.h"
+#include "hipstiledecoder.h"
 #include "opships.h"
 #include "pixcache.h"
 #include "urlfiledownload.h"
@@ -58,6 +59,12 @@ class HIPSManager : public QObject
         void cancelAll();
         void clearDiscCache();
 
+        /**
+         * @brief setViewCenter Tells which tiles are rendered at the center of the view, so that
+         * they are decoded first.
+         */
+        void setViewCenter(int level, int pix);
+
         // Getters
         const QMap<QString, QString> &getCurrentSource() const
         {
@@ -108,6 +115,9 @@ class HIPSManager : public QObject
         void slotDone(QNetworkReply::NetworkError error, QByteArray &data, pixCacheKey_t &key);
         void slotApply();
         void removeTimer(pixCacheKey_t &key);
+        void slotTileDecoded(const pixCacheKey_t &key, const QImage &image);
+        void slotTileFailed(const pixCacheKey_t &key);
+        void slotTileMissed(const pixCacheKey_t &key);
 
     private:
         HIPSManager();
@@ -116,7 +126,12 @@ class HIPSManager : public QObject
 
         // Cache
         PixCache m_cache;
+        // Tiles being downloaded or decoded
         QSet <pixCacheKey_t> m_downloadMap;
+        HIPSTileDecoder m_decoder;
+
+        QUrl getTileURL(const pixCacheKey_t &key) const;
+        void updateDecodedCache();
 
         void addToMemoryCache(pixCacheKey_t &key, pixCacheItem_t *item);
         pixCacheItem_t *getCacheItem(pixCacheKey_t &key);
@@ -74,6 +74,7 @@ bool HIPSRenderer::render(uint16_t w, uint16_t h, QImage *hipsImage, const Proje
     }
 
     int centerPix = m_HEALpix->getPix(level, ra, de);
+    HIPSManager::Instance()->setViewCenter(level, centerPix);
 
     SkyPoint cornerSkyCoords[4];
     QPointF tileLine[2];
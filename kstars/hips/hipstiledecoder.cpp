@@ -0,0 +1,366 @@
+/*  HiPS Tile Decoder
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "hipstiledecoder.h"
+
+#include "kstars_debug.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QDirIterator>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <vector>
+
+namespace
+{
+// Header of the decoded tiles kept on disk, followed by the scan lines of the image as in memory.
+struct RawTileHeader
+{
+    quint32 magic;
+    quint32 version;
+    qint32 width;
+    qint32 height;
+    qint32 bytesPerLine;
+    qint32 format;
+    qint32 reserved[2];
+};
+
+constexpr quint32 RAW_TILE_MAGIC   = 0x4b535454; // "KSTT"
+constexpr quint32 RAW_TILE_VERSION = 1;
+}
+
+HIPSTileDecoder::HIPSTileDecoder()
+{
+    // Leave a core for the GUI thread.
+    m_pool.setMaxThreadCount(std::max(1, QThread::idealThreadCount() - 1));
+}
+
+HIPSTileDecoder::~HIPSTileDecoder()
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        m_pending.clear();
+    }
+    m_pool.waitForDone();
+}
+
+void HIPSTileDecoder::decode(const pixCacheKey_t &key, const QByteArray &data)
+{
+    enqueue({DECODE_TILE, key, data, m_HEALpix.getPixCenter(key.level, key.pix)});
+}
+
+void HIPSTileDecoder::load(const pixCacheKey_t &key)
+{
+    enqueue({LOAD_TILE, key, QByteArray(), m_HEALpix.getPixCenter(key.level, key.pix)});
+}
+
+void HIPSTileDecoder::setViewCenter(int level, int pix)
+{
+    QVector3D center = m_HEALpix.getPixCenter(level, pix);
+
+    QMutexLocker locker(&m_mutex);
+    m_viewLevel = level;
+    m_viewCenter = center;
+}
+
+void HIPSTileDecoder::setDiskCacheDirectory(const QString &path, qint64 maxSize)
+{
+    QMutexLocker locker(&m_mutex);
+    if (path != m_diskCacheDirectory)
+        m_diskCacheSize = -1;
+    m_diskCacheDirectory = path;
+    m_diskCacheMaxSize = maxSize;
+}
+
+bool HIPSTileDecoder::hasDiskCache() const
+{
+    QMutexLocker locker(&m_mutex);
+    return !m_diskCacheDirectory.isEmpty();
+}
+
+void HIPSTileDecoder::clearDiskCache()
+{
+    QString directory;
+    {
+        QMutexLocker locker(&m_mutex);
+        directory = m_diskCacheDirectory;
+        m_diskCacheSize = -1;
+    }
+
+    if (!directory.isEmpty())
+        QDir(directory).removeRecursively();
+}
+
+void HIPSTileDecoder::cancelAll()
+{
+    std::vector<pixCacheKey_t> dropped;
+    {
+        QMutexLocker locker(&m_mutex);
+        for (auto &job : m_pending)
+            dropped.push_back(job.key);
+        m_pending.clear();
+    }
+
+    for (auto &key : dropped)
+        emit failed(key);
+}
+
+void HIPSTileDecoder::enqueue(Job &&job)
+{
+    bool drop = false;
+    bool keep = true;
+    pixCacheKey_t droppedKey = job.key;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (m_pending.contains(job.key))
+            return;
+
+        // When the queue is full, the tile farthest from the view goes, which may be the new one.
+        if (m_pending.size() >= MAX_PENDING)
+        {
+            drop = true;
+            auto last = findFirst(false);
+            if (priority(*last) < priority(job))
+            {
+                droppedKey = last->key;
+                m_pending.erase(last);
+            }
+            else
+                keep = false;
+        }
+
+        if (keep)
+        {
+            pixCacheKey_t key = job.key;
+            m_pending.insert(key, std::move(job));
+
+            if (m_workers < m_pool.maxThreadCount())
+            {
+                m_workers++;
+                QtConcurrent::run(&m_pool, [this]()
+                {
+                    work();
+                });
+            }
+        }
+    }
+
+    if (drop)
+        emit failed(droppedKey);
+}
+
+QHash<pixCacheKey_t, HIPSTileDecoder::Job>::iterator HIPSTileDecoder::findFirst(bool highest)
+{
+    auto first = m_pending.begin();
+    double firstPriority = priority(*first);
+
+    for (auto it = std::next(first); it != m_pending.end(); ++it)
+    {
+        double value = priority(*it);
+        if (highest ? value > firstPriority : value < firstPriority)
+        {
+            first = it;
+            firstPriority = value;
+        }
+    }
+
+    return first;
+}
+
+double HIPSTileDecoder::priority(const Job &job) const
+{
+    // The all sky image is the background of every level.
+    if (job.key.level == 0)
+        return 4;
+
+    // Cosine of the angle to the view center, the level being rendered first.
+    double proximity = QVector3D::dotProduct(job.center, m_viewCenter);
+    return job.key.level == m_viewLevel ? 2 + proximity : proximity;
+}
+
+void HIPSTileDecoder::work()
+{
+    for (;;)
+    {
+        Job job;
+        QString directory;
+        {
+            QMutexLocker locker(&m_mutex);
+
+            if (m_pending.isEmpty())
+            {
+                m_workers--;
+                return;
+            }
+
+            auto next = findFirst(true);
+            job = std::move(*next);
+            m_pending.erase(next);
+            directory = m_diskCacheDirectory;
+        }
+
+        QImage image;
+
+        if (job.type == LOAD_TILE)
+        {
+            if (!directory.isEmpty())
+                image = loadTile(directory, job.key);
+        }
+        else if (image.loadFromData(job.data))
+        {
+            if (!directory.isEmpty())
+                saveTile(directory, job.key, image);
+        }
+        else
+            qCWarning(KSTARS) << "no image. Data size: " << job.data.length();
+
+        // Deliver to the GUI thread, dropped if the decoder is gone by then.
+        pixCacheKey_t key = job.key;
+        bool notCached = job.type == LOAD_TILE && image.isNull();
+        QMetaObject::invokeMethod(this, [this, key, image, notCached]()
+        {
+            if (!image.isNull())
+                emit decoded(key, image);
+            else if (notCached)
+                emit missed(key);
+            else
+                emit failed(key);
+        }, Qt::QueuedConnection);
+    }
+}
+
+QString HIPSTileDecoder::tilePath(const QString &directory, const pixCacheKey_t &key) const
+{
+    return QString("%1/%2/Norder%3/Npix%4.raw").arg(directory).arg(key.uid).arg(key.level).arg(key.pix);
+}
+
+QImage HIPSTileDecoder::loadTile(const QString &directory, const pixCacheKey_t &key) const
+{
+    // The tile is read rather than mapped, a mapping would hold a file descriptor for as long as the
+    // memory cache keeps the image.
+    QFile file(tilePath(directory, key));
+    if (!file.open(QIODevice::ReadOnly))
+        return QImage();
+
+    RawTileHeader header;
+    QImage image;
+    bool valid = file.read(reinterpret_cast<char *>(&header), sizeof(header)) == sizeof(header) &&
+                 header.magic == RAW_TILE_MAGIC && header.version == RAW_TILE_VERSION && header.width > 0 &&
+                 header.height > 0 && header.format > QImage::Format_Invalid && header.format < QImage::NImageFormats &&
+                 file.size() == static_cast<qint64>(sizeof(header)) + static_cast<qint64>(header.bytesPerLine) * header.height;
+    if (valid)
+    {
+        image = QImage(header.width, header.height, static_cast<QImage::Format>(header.format));
+        valid = !image.isNull() && image.bytesPerLine() == header.bytesPerLine &&
+                file.read(reinterpret_cast<char *>(image.bits()), image.sizeInBytes()) == image.sizeInBytes();
+    }
+
+    if (!valid)
+    {
+        qCWarning(KSTARS) << "Invalid decoded HiPS tile" << file.fileName();
+        file.close();
+        file.remove();
+        return QImage();
+    }
+
+    // Loading a tile counts as a use when pruning the least recently used ones.
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    return image;
+}
+
+void HIPSTileDecoder::saveTile(const QString &directory, const pixCacheKey_t &key, const QImage &image)
+{
+    // Paletted images would need their color table, they are rare enough to always be decoded.
+    if (image.colorCount() > 0)
+        return;
+
+    QString path = tilePath(directory, key);
+    if (!QDir().mkpath(QFileInfo(path).absolutePath()))
+        return;
+
+    RawTileHeader header {RAW_TILE_MAGIC, RAW_TILE_VERSION, image.width(), image.height(),
+                          static_cast<qint32>(image.bytesPerLine()), image.format(), {0, 0}};
+
+    QSaveFile file(path);
+    if (!file.open(QIODevice::WriteOnly))
+        return;
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    file.write(reinterpret_cast<const char *>(image.constBits()), image.sizeInBytes());
+    if (!file.commit())
+    {
+        qCWarning(KSTARS) << "Could not save decoded HiPS tile" << path << file.errorString();
+        return;
+    }
+
+    // One worker at a time counts the tiles on disk the first time, and prunes them when over the limit.
+    bool prune = false;
+    {
+        QMutexLocker locker(&m_mutex);
+        if (m_diskCacheSize >= 0)
+            m_diskCacheSize += static_cast<qint64>(sizeof(header)) + image.sizeInBytes();
+        prune = !m_pruning && (m_diskCacheSize < 0 || m_diskCacheSize > m_diskCacheMaxSize);
+        if (prune)
+            m_pruning = true;
+    }
+
+    if (prune)
+        pruneDiskCache(directory);
+}
+
+void HIPSTileDecoder::pruneDiskCache(const QString &directory)
+{
+    struct Tile
+    {
+        QString path;
+        qint64 size;
+        QDateTime lastUsed;
+    };
+
+    std::vector<Tile> tiles;
+    qint64 total = 0;
+    QDirIterator it(directory, QStringList() << "*.raw", QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext())
+    {
+        it.next();
+        const QFileInfo info = it.fileInfo();
+        tiles.push_back({info.filePath(), info.size(), info.lastModified()});
+        total += info.size();
+    }
+
+    qint64 maxSize;
+    {
+        QMutexLocker locker(&m_mutex);
+        maxSize = m_diskCacheMaxSize;
+    }
+
+    // Like the download cache, go down to 90% of the limit so that pruning does not run for every tile.
+    if (total > maxSize)
+    {
+        std::sort(tiles.begin(), tiles.end(), [](const Tile & a, const Tile & b)
+        {
+            return a.lastUsed < b.lastUsed;
+        });
+
+        const qint64 target = maxSize * 9 / 10;
+        for (auto tile = tiles.cbegin(); tile != tiles.cend() && total > target; ++tile)
+        {
+            if (QFile::remove(tile->path))
+                total -= tile->size;
+        }
+    }
+
+    // Tiles saved while counting may be missed, the estimate is corrected by the next pruning.
+    QMutexLocker locker(&m_mutex);
+    m_diskCacheSize = total;
+    m_pruning = false;
+}
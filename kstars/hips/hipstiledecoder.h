@@ -0,0 +1,117 @@
+/*  HiPS Tile Decoder
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "healpix.h"
+#include "hips.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QObject>
+#include <QThreadPool>
+#include <QVector3D>
+
+/**
+ * @brief Decodes HiPS tiles on a pool of worker threads.
+ *
+ * The HIPSManager hands over the raw tiles it receives and gets the decoded images back on the
+ * GUI thread. Pending tiles are keyed by pixCacheKey_t; the queue is bounded and when it is full
+ * the tile farthest from the view is dropped. The tiles of the level being rendered, nearest to
+ * the view center, are decoded first.
+ *
+ * Optionally the decoded images are also kept on disk in a raw format that is read back as it is,
+ * so that tiles seen before are loaded without decoding them again. The least recently used tiles
+ * are removed when they take more than the size given with the directory.
+ */
+class HIPSTileDecoder : public QObject
+{
+        Q_OBJECT
+
+    public:
+        HIPSTileDecoder();
+        ~HIPSTileDecoder() override;
+
+        /**
+         * @brief decode Queues the encoded tile @p data for decoding. Emits decoded() or failed().
+         */
+        void decode(const pixCacheKey_t &key, const QByteArray &data);
+
+        /**
+         * @brief load Queues the lookup of the tile in the decoded tile cache.
+         * Emits decoded() or missed().
+         * @note Only valid when the decoded tile cache is enabled.
+         */
+        void load(const pixCacheKey_t &key);
+
+        /**
+         * @brief setViewCenter Sets the level being rendered and the pixel at the center of the view,
+         * used to order the pending tiles.
+         */
+        void setViewCenter(int level, int pix);
+
+        /**
+         * @brief setDiskCacheDirectory Sets where to keep the decoded tiles, empty to disable.
+         * @param maxSize size in bytes above which the least recently used tiles are removed.
+         */
+        void setDiskCacheDirectory(const QString &path, qint64 maxSize);
+        bool hasDiskCache() const;
+
+        /**
+         * @brief clearDiskCache Removes all the decoded tiles from the disk.
+         */
+        void clearDiskCache();
+
+        /**
+         * @brief cancelAll Drops the pending tiles. Tiles being decoded are still delivered.
+         */
+        void cancelAll();
+
+        /** Maximum number of tiles waiting to be decoded. */
+        static constexpr int MAX_PENDING = 128;
+
+    signals:
+        void decoded(const pixCacheKey_t &key, const QImage &image);
+        /** The tile could not be decoded, or was dropped from the queue. */
+        void failed(const pixCacheKey_t &key);
+        /** The tile is not in the decoded tile cache and must be downloaded. */
+        void missed(const pixCacheKey_t &key);
+
+    private:
+        typedef enum { DECODE_TILE, LOAD_TILE } JobType;
+
+        struct Job
+        {
+            JobType type;
+            pixCacheKey_t key;
+            QByteArray data;
+            QVector3D center;
+        };
+
+        void enqueue(Job &&job);
+        void work();
+        /** Both must be called with m_mutex held. */
+        QHash<pixCacheKey_t, Job>::iterator findFirst(bool highest);
+        double priority(const Job &job) const;
+
+        QString tilePath(const QString &directory, const pixCacheKey_t &key) const;
+        QImage loadTile(const QString &directory, const pixCacheKey_t &key) const;
+        void saveTile(const QString &directory, const pixCacheKey_t &key, const QImage &image);
+        void pruneDiskCache(const QString &directory);
+
+        HEALPix m_HEALpix;
+        QThreadPool m_pool;
+
+        mutable QMutex m_mutex;
+        QHash<pixCacheKey_t, Job> m_pending;
+        int m_workers { 0 };
+        int m_viewLevel { 0 };
+        QVector3D m_viewCenter;
+        QString m_diskCacheDirectory;
+        qint64 m_diskCacheMaxSize { 0 };
+        /** Estimated size of the decoded tiles on disk, negative until they are counted. */
+        qint64 m_diskCacheSize { -1 };
+        bool m_pruning { false };
+};
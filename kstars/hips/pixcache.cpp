@@ -6,11 +6,6 @@
 
 #include "pixcache.h"
 
-static int qHash(const pixCacheKey_t &key, uint seed)
-{
-  return qHash(QString("%1_%2_%3").arg(key.level).arg(key.pix).arg(key.uid), seed);
-}
-
 inline bool operator<(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
 {
   if (k1.uid != k2.uid)
@@ -26,11 +21,6 @@ inline bool operator<(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
   return k1.pix < k2.pix;
 }
 
-inline bool operator==(const pixCacheKey_t &k1, const pixCacheKey_t &k2)
-{
-  return (k1.uid == k2.uid) && (k1.level == k2.level) && (k1.pix == k2.pix);
-}
-
 void PixCache::add(pixCacheKey_t &key, pixCacheItem_t *item, int cost)
 {
   Q_ASSERT(cost < m_cache.maxCost());
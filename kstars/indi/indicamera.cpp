@@ -19,17 +19,24 @@
 #ifdef HAVE_CFITSIO
 #include "fitsviewer/fitsdata.h"
 #endif
+#ifdef HAVE_STELLARSOLVER
+#include "ekos/auxiliary/stellarsolverprofile.h"
+#endif
 
 #include <knotification.h>
 #include "auxiliary/ksmessagebox.h"
 #include "ksnotification.h"
 #include <QImageReader>
+#include <QMetaMethod>
 #include <QFileInfo>
 #include <QStatusBar>
 #include <QtConcurrent>
 
 #include <basedevice.h>
 
+#include <algorithm>
+#include <atomic>
+
 const QStringList RAWFormats = { "cr2", "cr3", "crw", "nef", "raf", "dng", "arw", "orf" };
 
 const QString getFITSModeStringString(FITSMode mode)
@@ -40,6 +47,37 @@ const QString getFITSModeStringString(FITSMode mode)
 namespace ISD
 {
 
+struct Camera::IngestFrame
+{
+    INDI::Property prop;
+    QString element;
+    QString format;
+    BlobType type { BLOB_OTHER };
+    CameraChip *chip { nullptr };
+    // The BLOB as received, of which the first imageSize bytes hold the image
+    QByteArray buffer;
+    qint64 imageSize { 0 };
+    QSharedPointer<FITSData> imageData;
+    bool load { false };
+    bool loaded { false };
+    bool preview { false };
+    bool starsSearched { false };
+    std::atomic<bool> dropped { false };
+    // Frames wait in the queue without being parsed while the pipeline is full
+    bool started { false };
+    // Set by the parser before it posts the delivery, when the parse future may not be finished yet
+    std::atomic<bool> parsed { false };
+    // Both are finished when their stage is skipped
+    QFuture<void> parse;
+    QFuture<bool> stars;
+    std::unique_ptr<QFutureWatcher<bool>> starsWatcher;
+    // Stage timing, in milliseconds since reception
+    QElapsedTimer timer;
+    qint64 receiveTime { 0 };
+    qint64 queueTime { 0 };
+    qint64 parseTime { 0 };
+};
+
 Camera::Camera(GenericDevice *parent) : ConcreteDevice(parent)
 {
     primaryChip.reset(new CameraChip(this, CameraChip::PRIMARY_CCD));
@@ -55,10 +93,10 @@ Camera::~Camera()
 {
     if (m_ImageViewerWindow)
         m_ImageViewerWindow->close();
+    // The frames still being parsed are dropped, their deliveries never run.
+    m_IngestPool.waitForDone();
     if (fileWriteThread.isRunning())
         fileWriteThread.waitForFinished();
-    if (fileWriteBuffer != nullptr)
-        delete [] fileWriteBuffer;
 }
 
 void Camera::setBLOBManager(const char *device, INDI::Property prop)
@@ -560,36 +598,6 @@ void Camera::processStream(INDI::Property prop)
     emit showVideoFrame(prop, streamW, streamH);
 }
 
-void ISD::Camera::updateFileBuffer(INDI::Property prop, bool is_fits)
-{
-    if (is_fits)
-    {
-        // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
-        if (fileWriteThread.isRunning())
-        {
-            fileWriteThread.waitForFinished();
-        }
-    }
-
-    // Will write blob data in a separate thread, and can't depend on the blob
-    // memory, so copy it first.
-
-    auto bp = prop.getBLOB()->at(0);
-    // Check buffer size.
-    if (fileWriteBufferSize != bp->getBlobLen())
-    {
-        if (fileWriteBuffer != nullptr)
-            delete [] fileWriteBuffer;
-        fileWriteBufferSize = bp->getBlobLen();
-        fileWriteBuffer = new char[fileWriteBufferSize];
-    }
-
-    // Copy memory, and write file on a separate thread.
-    // Probably too late to return an error if the file couldn't write.
-    memcpy(fileWriteBuffer, bp->getBlob(), bp->getBlobLen());
-}
-
 bool Camera::saveCurrentImage(QString &filename)
 {
     // TODO: Not yet threading the writes for non-fits files.
@@ -597,7 +605,7 @@ bool Camera::saveCurrentImage(QString &filename)
     if (BType == BLOB_FITS)
     {
         // Check if the last write is still ongoing, and if so wait.
-        // It is using the fileWriteBuffer.
+        // Writes are kept in order.
         if (fileWriteThread.isRunning())
         {
             fileWriteThread.waitForFinished();
@@ -605,14 +613,12 @@ bool Camera::saveCurrentImage(QString &filename)
 
         // Wait until the file is written before overwritting the filename.
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-        fileWriteThread = QtConcurrent::run(&ISD::Camera::WriteImageFileInternal, this, filename, fileWriteBuffer,
-                                            fileWriteBufferSize);
+        fileWriteThread = QtConcurrent::run(&ISD::Camera::WriteImageFileInternal, this, filename, fileWriteBuffer);
 #else
-        fileWriteThread = QtConcurrent::run(this, &ISD::Camera::WriteImageFileInternal, filename, fileWriteBuffer,
-                                            fileWriteBufferSize);
+        fileWriteThread = QtConcurrent::run(this, &ISD::Camera::WriteImageFileInternal, filename, fileWriteBuffer);
 #endif
     }
-    else if (!WriteImageFileInternal(filename, static_cast<char*>(fileWriteBuffer), fileWriteBufferSize))
+    else if (!WriteImageFileInternal(filename, fileWriteBuffer))
         return false;
 
     return true;
@@ -625,7 +631,7 @@ bool Camera::processBLOB(INDI::Property prop)
     if (bvp->getPermission() == IP_WO || bvp->at(0)->getSize() == 0)
         return false;
 
-    BType = BLOB_OTHER;
+    BlobType blobType = BLOB_OTHER;
 
     auto bp = bvp->at(0);
 
@@ -646,15 +652,15 @@ bool Camera::processBLOB(INDI::Property prop)
 
     // If it's not FITS or an image, don't process it.
     if ((QImageReader::supportedImageFormats().contains(shortFormat.toLatin1())))
-        BType = BLOB_IMAGE;
+        blobType = BLOB_IMAGE;
     else if (format.contains("fits"))
-        BType = BLOB_FITS;
+        blobType = BLOB_FITS;
     else if (format.contains("xisf"))
-        BType = BLOB_XISF;
+        blobType = BLOB_XISF;
     else if (RAWFormats.contains(shortFormat))
-        BType = BLOB_RAW;
+        blobType = BLOB_RAW;
 
-    if (BType == BLOB_OTHER)
+    if (blobType == BLOB_OTHER)
         return false;
 
     CameraChip *targetChip = nullptr;
@@ -668,12 +674,6 @@ bool Camera::processBLOB(INDI::Property prop)
                              bp->getSize();
     }
 
-    // Create temporary name if ANY of the following conditions are met:
-    // 1. file is preview or batch mode is not enabled
-    // 2. file type is not FITS_NORMAL (focus, guide..etc)
-    // create the file buffer only, saving the image file must be triggered from outside.
-    updateFileBuffer(prop, BType == BLOB_FITS);
-
     // Don't spam, just one notification per 3 seconds
     if (QDateTime::currentDateTime().secsTo(m_LastNotificationTS) <= -3)
     {
@@ -681,34 +681,187 @@ bool Camera::processBLOB(INDI::Property prop)
         m_LastNotificationTS = QDateTime::currentDateTime();
     }
 
-    QByteArray buffer = QByteArray::fromRawData(reinterpret_cast<char *>(bp->getBlob()), bp->getSize());
-    QSharedPointer<FITSData> imageData;
-    imageData.reset(new FITSData(targetChip->getCaptureMode()), &QObject::deleteLater);
-    imageData->setExtension(shortFormat);
+    // Receive stage: the BLOB memory is reused by the INDI client, so it is copied once here.
+    // The copy is then shared by the parser and the file writer.
+    auto frame = std::make_shared<IngestFrame>();
+    frame->timer.start();
+    frame->prop = prop;
+    frame->type = blobType;
+    frame->chip = targetChip;
+    frame->element = bp->getName();
+    frame->format = format;
+    frame->buffer = QByteArray(static_cast<const char *>(bp->getBlob()), bp->getBlobLen());
+    frame->imageSize = qMin<qint64>(frame->buffer.size(), bp->getSize());
+    frame->imageData.reset(new FITSData(targetChip->getCaptureMode()), &QObject::deleteLater);
+    frame->imageData->setExtension(shortFormat);
+    // Previews can be replaced by a newer one when the pipeline is full
+    frame->preview = targetChip->getCaptureMode() == FITS_NORMAL && !targetChip->isBatchMode();
 
     // JM 2024.12.25: Only load from buffer if we need the imageData.
     // When neither FITS Viewer nor Summary view is used, and when the type is FITS_NORMAL in batch mode, then we save to disk directly
     // so that we do not incur delays in loading from buffer that may delay the sequence unnecessairly.
-    if ((Options::useFITSViewer() || Options::useSummaryPreview() || targetChip->getCaptureMode() != FITS_NORMAL
-            || !targetChip->isBatchMode()) &&
-            !imageData->loadFromBuffer(buffer))
+    frame->load = Options::useFITSViewer() || Options::useSummaryPreview() || targetChip->getCaptureMode() != FITS_NORMAL
+                  || !targetChip->isBatchMode();
+    frame->receiveTime = frame->timer.elapsed();
+
+    // Backpressure: a full pipeline drops a preview of the same chip. Other frames wait in the queue and are
+    // parsed as the frames ahead of them are delivered, so that the reception of BLOBs never blocks.
+    if (frame->preview && m_IngestQueue.size() >= Options::imageIngestQueueSize())
+        dropPreviewFrame(targetChip);
+
+    m_IngestQueue.push_back(frame);
+    startFrames();
+    deliverFrames();
+
+    return true;
+}
+
+void Camera::startFrames()
+{
+    m_IngestPool.setMaxThreadCount(Options::imageIngestThreads());
+
+    uint32_t inFlight = std::count_if(m_IngestQueue.begin(), m_IngestQueue.end(), [](const auto & frame)
+    {
+        return frame->started;
+    });
+
+    for (auto &frame : m_IngestQueue)
+    {
+        if (frame->started)
+            continue;
+        if (inFlight >= Options::imageIngestQueueSize())
+        {
+            qCDebug(KSTARS_INDI) << "Image ingestion is full," << m_IngestQueue.size() - inFlight << "images waiting";
+            return;
+        }
+
+        frame->started = true;
+        inFlight++;
+
+        // Parse and convert stage
+        if (frame->load)
+        {
+            frame->parse = QtConcurrent::run(&m_IngestPool, [this, frame]()
+            {
+                parseFrame(frame);
+            });
+        }
+        else
+            frame->parsed = true;
+    }
+}
+
+void Camera::parseFrame(const std::shared_ptr<IngestFrame> &frame)
+{
+    frame->queueTime = frame->timer.elapsed();
+
+    if (!frame->dropped)
+    {
+        // Only the part of the BLOB holding the image is parsed. The image data keeps a reference to the
+        // buffer, which is only copied when the BLOB holds more than the image.
+        frame->loaded = frame->imageData->loadFromBuffer(frame->imageSize == frame->buffer.size() ?
+                        frame->buffer : frame->buffer.left(frame->imageSize));
+    }
+
+    frame->parseTime = frame->timer.elapsed();
+    // The task is still running when the delivery below is processed, so its future can't tell it is done.
+    frame->parsed = true;
+
+    QMetaObject::invokeMethod(this, [this]()
+    {
+        deliverFrames();
+    }, Qt::QueuedConnection);
+}
+
+bool Camera::dropPreviewFrame(CameraChip *chip)
+{
+    auto preview = std::find_if(m_IngestQueue.begin(), m_IngestQueue.end(), [chip](const auto & frame)
+    {
+        return frame->preview && frame->chip == chip;
+    });
+
+    if (preview == m_IngestQueue.end())
+        return false;
+
+    // A frame still being parsed finishes in the background, and is released there.
+    qCDebug(KSTARS_INDI) << "Dropping preview image received" << (*preview)->timer.elapsed() << "ms ago";
+    (*preview)->dropped = true;
+    m_IngestQueue.erase(preview);
+    return true;
+}
+
+void Camera::deliverFrames()
+{
+    while (!m_IngestQueue.empty())
+    {
+        auto frame = m_IngestQueue.front();
+
+        if (!frame->parsed)
+            return;
+
+        // Stats and star detection stage. Capture detects the stars of the light frames of
+        // sequences when they are received, which is done here instead, off the GUI thread.
+        QVariant frameType;
+        if (!frame->starsSearched && frame->loaded && frame->chip->getCaptureMode() == FITS_NORMAL &&
+                frame->chip->isBatchMode() && Options::autoHFR() &&
+                frame->imageData->getRecordValue("FRAME", frameType) && frameType.toString() == "Light")
+        {
+#ifdef HAVE_STELLARSOLVER
+            // Don't use the StellarSolver defaults (which allow very small stars).
+            // Use the HFR profile--which the user can modify.
+            QVariantMap extractionSettings;
+            extractionSettings["optionsProfileIndex"] = Options::hFROptionsProfile();
+            extractionSettings["optionsProfileGroup"] = static_cast<int>(Ekos::HFRProfiles);
+            frame->imageData->setSourceExtractorSettings(extractionSettings);
+#endif
+            frame->starsSearched = true;
+            frame->stars = frame->imageData->findStars(ALGORITHM_SEP);
+            frame->starsWatcher.reset(new QFutureWatcher<bool>());
+            connect(frame->starsWatcher.get(), &QFutureWatcher<bool>::finished, this, [this]()
+            {
+                deliverFrames();
+            });
+            frame->starsWatcher->setFuture(frame->stars);
+        }
+
+        if (!frame->stars.isFinished())
+            return;
+
+        m_IngestQueue.pop_front();
+        finishFrame(frame);
+
+        // A slot is free for the next waiting frame
+        startFrames();
+    }
+}
+
+void Camera::finishFrame(const std::shared_ptr<IngestFrame> &frame)
+{
+    if (frame->load && !frame->loaded)
     {
         emit error(ERROR_LOAD);
-        return true;
+        return;
     }
 
     // Add metadata
-    imageData->setProperty("device", getDeviceName());
-    imageData->setProperty("blobVector", prop.getName());
-    imageData->setProperty("blobElement", bp->getName());
-    imageData->setProperty("chip", targetChip->getType());
+    frame->imageData->setProperty("device", getDeviceName());
+    frame->imageData->setProperty("blobVector", frame->prop.getName());
+    frame->imageData->setProperty("blobElement", frame->element);
+    frame->imageData->setProperty("chip", frame->chip->getType());
 
-    // Retain a copy
-    targetChip->setImageData(imageData);
-    emit propertyUpdated(prop);
-    emit newImage(imageData, QString(bp->getFormat()).toLower());
+    // Display and save stage: saveCurrentImage() writes the buffer of the frame being delivered.
+    BType = frame->type;
+    fileWriteBuffer = frame->buffer;
 
-    return true;
+    qCDebug(KSTARS_INDI) << "Image ingested in" << frame->timer.elapsed() << "ms. Receive:" << frame->receiveTime
+                         << "ms Queued:" << (frame->load ? frame->queueTime - frame->receiveTime : 0)
+                         << "ms Parse:" << (frame->load ? frame->parseTime - frame->queueTime : 0)
+                         << "ms Stars:" << (frame->starsSearched ? frame->timer.elapsed() - frame->parseTime : 0) << "ms";
+
+    // Retain a copy
+    frame->chip->setImageData(frame->imageData);
+    emit propertyUpdated(frame->prop);
+    emit newImage(frame->imageData, frame->format);
 }
 
 void Camera::StreamWindowHidden()
@@ -1227,6 +1380,11 @@ bool Camera::isStreamingEnabled()
     return (HasVideoStream && m_isStreamEnabled);
 }
 
+bool Camera::isVideoFrameRequired() const
+{
+    return isSignalConnected(QMetaMethod::fromSignal(&Camera::newVideoFrame));
+}
+
 bool Camera::setSERNameDirectory(const QString &filename, const QString &directory)
 {
     auto tvp = getText("RECORD_FILE");
@@ -1595,8 +1753,11 @@ bool Camera::setScopeInfo(double focalLength, double aperture)
 }
 
 // Internal function to write an image blob to disk.
-bool Camera::WriteImageFileInternal(const QString &filename, char *buffer, const size_t size)
+bool Camera::WriteImageFileInternal(const QString &filename, const QByteArray &buffer)
 {
+    const char *data = buffer.constData();
+    const size_t size = buffer.size();
+
     QFile file(filename);
     if (!file.open(QIODevice::WriteOnly))
     {
@@ -1609,7 +1770,7 @@ bool Camera::WriteImageFileInternal(const QString &filename, char *buffer, const
     bool ok = true;
     for (size_t nr = 0; nr < size; nr += n)
     {
-        n = out.writeRawData(buffer + nr, size - nr);
+        n = out.writeRawData(data + nr, size - nr);
         if (n < 0)
         {
             ok = false;
@@ -16,8 +16,10 @@
 
 #include <QStringList>
 #include <QPointer>
+#include <QThreadPool>
 #include <QtConcurrent>
 
+#include <deque>
 #include <memory>
 
 class FITSView;
@@ -196,6 +198,8 @@ class Camera : public ConcreteDevice
         bool resetStreamingFrame();
         bool setStreamingFrame(int x, int y, int w, int h);
         bool isStreamingEnabled();
+        /** Whether full resolution video frames are consumed, i.e. newVideoFrame() has receivers. */
+        bool isVideoFrameRequired() const;
         bool setStreamExposure(double duration);
         bool getStreamExposure(double *duration);
         bool setStreamLimits(uint16_t maxBufferSize, uint16_t maxPreviewFPS);
@@ -274,7 +278,17 @@ class Camera : public ConcreteDevice
 
     private:
         void processStream(INDI::Property prop);
-        bool WriteImageFileInternal(const QString &filename, char *buffer, const size_t size);
+        bool WriteImageFileInternal(const QString &filename, const QByteArray &buffer);
+
+        // Image ingest pipeline. The BLOBs are received on the GUI thread, parsed on m_IngestPool,
+        // searched for stars when Capture would, and delivered back on the GUI thread in the order
+        // they were received. The frames share the buffer copied on reception.
+        struct IngestFrame;
+        void parseFrame(const std::shared_ptr<IngestFrame> &frame);
+        void startFrames();
+        void deliverFrames();
+        void finishFrame(const std::shared_ptr<IngestFrame> &frame);
+        bool dropPreviewFrame(CameraChip *chip);
 
         bool HasGuideHead { false };
         bool HasCooler { false };
@@ -325,10 +339,12 @@ class Camera : public ConcreteDevice
         QMap<QString, double> m_ExposurePresets;
         QPair<double, double> m_ExposurePresetsMinMax;
 
+        // The frames being ingested, oldest first
+        std::deque<std::shared_ptr<IngestFrame>> m_IngestQueue;
+        QThreadPool m_IngestPool;
+
         // Used when writing the image fits file to disk in a separate thread.
-        void updateFileBuffer(INDI::Property prop, bool is_fits);
-        char *fileWriteBuffer { nullptr };
-        int fileWriteBufferSize { 0 };
+        QByteArray fileWriteBuffer;
         QString fileWriteFilename;
         QFuture<void> fileWriteThread;
 };
@@ -124,6 +124,11 @@ StreamWG::StreamWG(ISD::Camera *ccd) : QDialog(KStars::Instance())
 
     connect(videoFrame, &VideoWG::newSelection, this, &StreamWG::setStreamingFrame);
     connect(videoFrame, &VideoWG::imageChanged, this, &StreamWG::imageChanged);
+    connect(videoFrame, &VideoWG::frameRateChanged, this, [this](double processed, double dropped)
+    {
+        processedFPS->setText(QString::number(processed, 'f', 1));
+        droppedFPS->setText(QString::number(dropped, 'f', 1));
+    });
 
     resize(Options::streamWindowWidth(), Options::streamWindowHeight());
 
@@ -305,6 +310,8 @@ void StreamWG::enableStream(bool enable)
         processStream = false;
         //instFPS->setText("--");
         avgFPS->setText("--");
+        processedFPS->setText("--");
+        droppedFPS->setText("--");
         hide();
     }
 }
@@ -397,6 +404,9 @@ void StreamWG::newFrame(INDI::Property prop)
 {
     auto bp = prop.getBLOB()->at(0);
 
+    // Frames are only kept at full resolution when they are forwarded, e.g. to EkosLive.
+    videoFrame->setFullFrameRequired(m_Camera->isVideoFrameRequired());
+
     bool rc = (m_DebayerActive
                && !strcmp(bp->getFormat(), ".stream")) ? videoFrame->newBayerFrame(bp, m_DebayerParams) : videoFrame->newFrame(bp);
 
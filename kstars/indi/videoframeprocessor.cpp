@@ -0,0 +1,349 @@
+/*  Video Frame Processor
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "videoframeprocessor.h"
+
+#include "kstars_debug.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cstring>
+
+VideoFramePool::Buffer VideoFramePool::acquire(size_t size)
+{
+    std::unique_ptr<std::vector<uint8_t>> buffer;
+    {
+        QMutexLocker locker(&m_Mutex);
+        // Input and output frames differ in size, prefer a buffer that does not need to grow.
+        auto free = std::find_if(m_Free.begin(), m_Free.end(), [size](const auto & oneBuffer)
+        {
+            return oneBuffer->capacity() >= size;
+        });
+        if (free == m_Free.end() && !m_Free.empty())
+            free = m_Free.begin();
+        if (free != m_Free.end())
+        {
+            buffer = std::move(*free);
+            m_Free.erase(free);
+        }
+    }
+
+    if (!buffer)
+        buffer.reset(new std::vector<uint8_t>());
+    buffer->resize(size);
+
+    auto pool = shared_from_this();
+    return Buffer(buffer.release(), [pool](std::vector<uint8_t> *oneBuffer)
+    {
+        pool->release(oneBuffer);
+    });
+}
+
+QImage VideoFramePool::wrap(const Buffer &buffer, int width, int height, int bytesPerLine, QImage::Format format)
+{
+    // The image holds a reference to the buffer until its last copy is gone.
+    return QImage(buffer->data(), width, height, bytesPerLine, format, [](void *info)
+    {
+        delete static_cast<Buffer *>(info);
+    }, new Buffer(buffer));
+}
+
+void VideoFramePool::release(std::vector<uint8_t> *buffer)
+{
+    QMutexLocker locker(&m_Mutex);
+    if (m_Free.size() < MAX_FREE)
+        m_Free.emplace_back(buffer);
+    else
+        delete buffer;
+}
+
+VideoFrameProcessor::VideoFrameProcessor(QObject *parent) : QObject(parent),
+    m_FramePool(std::make_shared<VideoFramePool>())
+{
+    // One worker, frames are processed in order and the latest one wins.
+    m_ThreadPool.setMaxThreadCount(1);
+}
+
+VideoFrameProcessor::~VideoFrameProcessor()
+{
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_Stopping = true;
+        m_Pending.reset();
+    }
+    m_ThreadPool.waitForDone();
+}
+
+void VideoFrameProcessor::submit(const void *data, size_t size, const Request &request)
+{
+    // The BLOB is reused by the INDI client, the worker gets its own copy.
+    auto job = std::make_unique<Job>();
+    job->request = request;
+    job->size = size;
+    job->data = m_FramePool->acquire(size);
+    memcpy(job->data->data(), data, size);
+
+    bool start = false;
+    {
+        QMutexLocker locker(&m_Mutex);
+        if (m_Pending)
+            m_Dropped++;
+        m_Pending = std::move(job);
+        start = !m_Busy;
+        m_Busy = true;
+    }
+
+    if (start)
+    {
+        QtConcurrent::run(&m_ThreadPool, [this]()
+        {
+            work();
+        });
+    }
+
+    updateRate();
+}
+
+void VideoFrameProcessor::work()
+{
+    for (;;)
+    {
+        std::unique_ptr<Job> job;
+        {
+            QMutexLocker locker(&m_Mutex);
+            if (!m_Pending || m_Stopping)
+            {
+                m_Busy = false;
+                return;
+            }
+            job = std::move(m_Pending);
+        }
+
+        auto result = std::make_unique<Result>();
+        bool ok = process(*job, *result);
+        job.reset();
+
+        if (!ok)
+        {
+            qCWarning(KSTARS) << "Failed to load video frame.";
+            continue;
+        }
+
+        bool post = false;
+        {
+            QMutexLocker locker(&m_Mutex);
+            // The GUI did not get to display the previous frame.
+            if (m_Ready)
+                m_Dropped++;
+            m_Ready = std::move(result);
+            post = !m_DeliveryPosted;
+            m_DeliveryPosted = true;
+        }
+
+        if (post)
+        {
+            QMetaObject::invokeMethod(this, [this]()
+            {
+                deliver();
+            }, Qt::QueuedConnection);
+        }
+    }
+}
+
+void VideoFrameProcessor::deliver()
+{
+    std::unique_ptr<Result> result;
+    {
+        QMutexLocker locker(&m_Mutex);
+        m_DeliveryPosted = false;
+        result = std::move(m_Ready);
+        if (result)
+            m_Processed++;
+    }
+
+    if (result)
+        emit frameReady(result->display, result->frame, result->frameSize);
+
+    updateRate();
+}
+
+void VideoFrameProcessor::updateRate()
+{
+    if (!m_RateTimer.isValid())
+    {
+        m_RateTimer.start();
+        return;
+    }
+
+    qint64 elapsed = m_RateTimer.elapsed();
+    if (elapsed < 1000)
+        return;
+
+    uint32_t processed, dropped;
+    {
+        QMutexLocker locker(&m_Mutex);
+        processed = m_Processed;
+        dropped = m_Dropped;
+        m_Processed = m_Dropped = 0;
+    }
+
+    m_RateTimer.restart();
+    emit rateChanged(processed * 1000.0 / elapsed, dropped * 1000.0 / elapsed);
+}
+
+bool VideoFrameProcessor::process(const Job &job, Result &result)
+{
+    const Request &request = job.request;
+    QSize frameSize(request.width, request.height);
+    QSize displaySize = request.displaySize.isEmpty() ? frameSize : request.displaySize;
+    QImage frame;
+
+    switch (request.type)
+    {
+        case FRAME_ENCODED:
+            if (!frame.loadFromData(job.data->data(), static_cast<int>(job.size)))
+                return false;
+            frameSize = frame.size();
+            break;
+
+        case FRAME_MONO:
+            frame = VideoFramePool::wrap(job.data, request.width, request.height, request.width, QImage::Format_Grayscale8);
+            break;
+
+        case FRAME_RGB:
+            frame = VideoFramePool::wrap(job.data, request.width, request.height, request.width * 3,
+                                         QImage::Format_RGB888);
+            break;
+
+        case FRAME_BAYER:
+        {
+            // Fused debayer and downscale when the display has at most one pixel per bayer cell.
+            QSize scaledSize = frameSize.scaled(displaySize, Qt::KeepAspectRatio);
+            if (!request.fullFrame && scaledSize.width() <= request.width / 2 && scaledSize.height() <= request.height / 2)
+            {
+                result.display = debayerScaled(job, scaledSize);
+                result.frame.reset(new QImage(result.display));
+                result.frameSize = frameSize;
+                return !result.display.isNull();
+            }
+
+            const uint8_t *source = job.data->data();
+            int height = request.height;
+            if (request.bayer.offsetY == 1)
+            {
+                source += request.width;
+                height--;
+            }
+            if (request.bayer.offsetX == 1)
+                source++;
+
+            auto buffer = m_FramePool->acquire(request.width * request.height * 3);
+            dc1394error_t error_code = dc1394_bayer_decoding_8bit(source, buffer->data(), request.width, height,
+                                       request.bayer.filter, request.bayer.method);
+            if (error_code != DC1394_SUCCESS)
+            {
+                qCCritical(KSTARS) << "Debayer failed" << error_code;
+                return false;
+            }
+
+            frame = VideoFramePool::wrap(buffer, request.width, request.height, request.width * 3, QImage::Format_RGB888);
+            break;
+        }
+    }
+
+    if (frame.isNull())
+        return false;
+
+    result.display = frame.scaled(displaySize, Qt::KeepAspectRatio);
+    result.frame.reset(new QImage(request.fullFrame ? frame : result.display));
+    result.frameSize = frameSize;
+    return true;
+}
+
+QImage VideoFrameProcessor::debayerScaled(const Job &job, const QSize &size)
+{
+    const Request &request = job.request;
+    const int stride = request.width;
+    const uint8_t *source = job.data->data();
+    int width = request.width;
+    int height = request.height;
+
+    // Same offsets as the full resolution debayering
+    if (request.bayer.offsetY == 1)
+    {
+        source += stride;
+        height--;
+    }
+    if (request.bayer.offsetX == 1)
+    {
+        source++;
+        width--;
+    }
+
+    const int cellsX = width / 2;
+    const int cellsY = height / 2;
+    if (cellsX <= 0 || cellsY <= 0 || size.isEmpty())
+        return QImage();
+
+    // Position of the red and blue samples in the 2x2 cell, as dy * 2 + dx. The greens are averaged.
+    int red = 0, blue = 3;
+    switch (request.bayer.filter)
+    {
+        case DC1394_COLOR_FILTER_RGGB:
+            red = 0;
+            blue = 3;
+            break;
+        case DC1394_COLOR_FILTER_GBRG:
+            red = 2;
+            blue = 1;
+            break;
+        case DC1394_COLOR_FILTER_GRBG:
+            red = 1;
+            blue = 2;
+            break;
+        case DC1394_COLOR_FILTER_BGGR:
+            red = 3;
+            blue = 0;
+            break;
+    }
+
+    int offsets[4] = { 0, 1, stride, stride + 1 };
+    int greens[2], g = 0;
+    for (int k = 0; k < 4; k++)
+    {
+        if (k != red && k != blue)
+            greens[g++] = offsets[k];
+    }
+    const int redOffset = offsets[red];
+    const int blueOffset = offsets[blue];
+
+    // Each output pixel takes the bayer cell under it, without going through the full resolution.
+    const int outWidth = size.width();
+    const int outHeight = size.height();
+    const int bytesPerLine = (outWidth * 3 + 3) & ~3;
+    auto buffer = m_FramePool->acquire(static_cast<size_t>(bytesPerLine) * outHeight);
+
+    std::vector<int> columns(outWidth);
+    for (int x = 0; x < outWidth; x++)
+        columns[x] = 2 * static_cast<int>(static_cast<int64_t>(x) * cellsX / outWidth);
+
+    for (int y = 0; y < outHeight; y++)
+    {
+        const uint8_t *row = source + 2 * static_cast<int>(static_cast<int64_t>(y) * cellsY / outHeight) * stride;
+        uint8_t *out = buffer->data() + static_cast<size_t>(y) * bytesPerLine;
+
+        for (int x = 0; x < outWidth; x++)
+        {
+            const uint8_t *cell = row + columns[x];
+            out[0] = cell[redOffset];
+            out[1] = static_cast<uint8_t>((cell[greens[0]] + cell[greens[1]] + 1) >> 1);
+            out[2] = cell[blueOffset];
+            out += 3;
+        }
+    }
+
+    return VideoFramePool::wrap(buffer, outWidth, outHeight, bytesPerLine, QImage::Format_RGB888);
+}
@@ -0,0 +1,130 @@
+/*  Video Frame Processor
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "fitsviewer/bayer.h"
+
+#include <QElapsedTimer>
+#include <QImage>
+#include <QMutex>
+#include <QObject>
+#include <QSharedPointer>
+#include <QSize>
+#include <QThreadPool>
+
+#include <memory>
+#include <vector>
+
+/**
+ * @brief Buffers recycled between video frames, which all have the same size while streaming.
+ *
+ * A buffer goes back to the pool when the last reference to it is released, including the
+ * QImages wrapped around it with wrap().
+ */
+class VideoFramePool : public std::enable_shared_from_this<VideoFramePool>
+{
+    public:
+        typedef std::shared_ptr<std::vector<uint8_t>> Buffer;
+
+        Buffer acquire(size_t size);
+        static QImage wrap(const Buffer &buffer, int width, int height, int bytesPerLine, QImage::Format format);
+
+    private:
+        void release(std::vector<uint8_t> *buffer);
+
+        /** Buffers kept for reuse, enough for the frames in flight between the stages. */
+        static constexpr size_t MAX_FREE = 8;
+
+        QMutex m_Mutex;
+        std::vector<std::unique_ptr<std::vector<uint8_t>>> m_Free;
+};
+
+/**
+ * @brief Decodes and debayers the frames of a video stream on a worker thread.
+ *
+ * Frames are copied into pooled buffers on submission. Only the latest frame waits for the
+ * worker, and only the latest processed frame is delivered: frames replaced before they are
+ * processed or displayed are counted as dropped.
+ *
+ * Unless the full resolution frame is requested, bayered frames are debayered and downscaled to
+ * the display size in a single pass.
+ */
+class VideoFrameProcessor : public QObject
+{
+        Q_OBJECT
+
+    public:
+        typedef enum
+        {
+            FRAME_ENCODED,  /** Image format supported by QImageReader */
+            FRAME_MONO,     /** 8 bit monochrome */
+            FRAME_RGB,      /** 8 bit interleaved RGB */
+            FRAME_BAYER     /** 8 bit bayered */
+        } FrameType;
+
+        struct Request
+        {
+            FrameType type { FRAME_MONO };
+            uint16_t width { 0 };
+            uint16_t height { 0 };
+            BayerParams bayer;
+            QSize displaySize;
+            bool fullFrame { true };
+        };
+
+        explicit VideoFrameProcessor(QObject *parent = nullptr);
+        ~VideoFrameProcessor() override;
+
+        /**
+         * @brief submit Queues a copy of the frame, replacing the one waiting for the worker if any.
+         */
+        void submit(const void *data, size_t size, const Request &request);
+
+    signals:
+        /**
+         * @param display frame scaled to fit the display size
+         * @param frame full resolution frame, or the display frame when it was not requested
+         * @param frameSize size of the full resolution frame
+         */
+        void frameReady(const QImage &display, const QSharedPointer<QImage> &frame, const QSize &frameSize);
+        /** Frames processed and dropped per second, updated every second. */
+        void rateChanged(double processed, double dropped);
+
+    private:
+        struct Job
+        {
+            Request request;
+            VideoFramePool::Buffer data;
+            size_t size { 0 };
+        };
+
+        struct Result
+        {
+            QImage display;
+            QSharedPointer<QImage> frame;
+            QSize frameSize;
+        };
+
+        void work();
+        void deliver();
+        void updateRate();
+        bool process(const Job &job, Result &result);
+        QImage debayerScaled(const Job &job, const QSize &size);
+
+        std::shared_ptr<VideoFramePool> m_FramePool;
+        QThreadPool m_ThreadPool;
+
+        QMutex m_Mutex;
+        std::unique_ptr<Job> m_Pending;
+        std::unique_ptr<Result> m_Ready;
+        bool m_Busy { false };
+        bool m_DeliveryPosted { false };
+        bool m_Stopping { false };
+        uint32_t m_Processed { 0 };
+        uint32_t m_Dropped { 0 };
+
+        QElapsedTimer m_RateTimer;
+};
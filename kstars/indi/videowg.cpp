@@ -23,15 +23,18 @@ VideoWG::VideoWG(QWidget *parent) : QLabel(parent)
 {
     streamImage.reset(new QImage());
 
-    grayTable.resize(256);
-
-    for (int i = 0; i < 256; i++)
-        grayTable[i] = qRgb(i, i, i);
+    m_Processor = new VideoFrameProcessor(this);
+    connect(m_Processor, &VideoFrameProcessor::frameReady, this, &VideoWG::showFrame);
+    connect(m_Processor, &VideoFrameProcessor::rateChanged, this, &VideoWG::frameRateChanged);
 }
 
 bool VideoWG::newBayerFrame(IBLOB *bp, const BayerParams &params)
 {
-    return debayer(bp, params);
+    if (static_cast<uint32_t>(bp->size) < totalBaseCount)
+        return false;
+
+    submitFrame(bp, VideoFrameProcessor::FRAME_BAYER, &params);
+    return true;
 }
 
 bool VideoWG::newFrame(IBLOB *bp)
@@ -39,7 +42,6 @@ bool VideoWG::newFrame(IBLOB *bp)
     if (bp->size <= 0)
         return false;
 
-    bool rc = false;
     QString format(bp->format);
     if (m_RawFormat != format)
     {
@@ -50,31 +52,43 @@ bool VideoWG::newFrame(IBLOB *bp)
     }
 
     if (m_RawFormatSupported)
-        rc = streamImage->loadFromData(static_cast<uchar *>(bp->blob), bp->size);
+        submitFrame(bp, VideoFrameProcessor::FRAME_ENCODED);
     else if (static_cast<uint32_t>(bp->size) == totalBaseCount)
-    {
-        streamImage.reset(new QImage(static_cast<uchar *>(bp->blob), streamW, streamH, QImage::Format_Indexed8));
-        streamImage->setColorTable(grayTable);
-        rc = !streamImage->isNull();
-    }
+        submitFrame(bp, VideoFrameProcessor::FRAME_MONO);
     else if (static_cast<uint32_t>(bp->size) == totalBaseCount * 3)
-    {
-        streamImage.reset(new QImage(static_cast<uchar *>(bp->blob), streamW, streamH, QImage::Format_RGB888));
-        rc = !streamImage->isNull();
-    }
+        submitFrame(bp, VideoFrameProcessor::FRAME_RGB);
+    else
+        return false;
 
-    if (rc)
-    {
-        kPix = QPixmap::fromImage(streamImage->scaled(size(), Qt::KeepAspectRatio));
+    return true;
+}
+
+void VideoWG::submitFrame(IBLOB *bp, VideoFrameProcessor::FrameType type, const BayerParams *params)
+{
+    VideoFrameProcessor::Request request;
+    request.type = type;
+    request.width = streamW;
+    request.height = streamH;
+    if (params)
+        request.bayer = *params;
+    request.displaySize = size();
+    request.fullFrame = m_FullFrameRequired;
+
+    m_Processor->submit(bp->blob, bp->size, request);
+}
 
-        paintOverlay(kPix);
+void VideoWG::showFrame(const QImage &display, const QSharedPointer<QImage> &frame, const QSize &frameSize)
+{
+    streamImage = frame;
+    m_FrameSize = frameSize;
 
-        setPixmap(kPix);
-    }
+    kPix = QPixmap::fromImage(display);
 
-    emit imageChanged(streamImage);
+    paintOverlay(kPix);
+
+    setPixmap(kPix);
 
-    return rc;
+    emit imageChanged(streamImage);
 }
 
 bool VideoWG::save(const QString &filename, const char *format)
@@ -89,6 +103,11 @@ void VideoWG::setSize(uint16_t w, uint16_t h)
     totalBaseCount = w * h;
 }
 
+void VideoWG::setFullFrameRequired(bool required)
+{
+    m_FullFrameRequired = required;
+}
+
 //void VideoWG::resizeEvent(QResizeEvent *ev)
 //{
 //    setPixmap(QPixmap::fromImage(streamImage->scaled(ev->size(), Qt::KeepAspectRatio)));
@@ -125,8 +144,8 @@ void VideoWG::mouseReleaseEvent(QMouseEvent *event)
 
     QRect finalSelection;
 
-    double scaleX = static_cast<double>(streamImage->width()) / kPix.width();
-    double scaleY = static_cast<double>(streamImage->height()) / kPix.height();
+    double scaleX = static_cast<double>(m_FrameSize.width()) / kPix.width();
+    double scaleY = static_cast<double>(m_FrameSize.height()) / kPix.height();
 
     finalSelection.setX((rawSelection.x() - pixmapX) * scaleX);
     finalSelection.setY((rawSelection.y() - pixmapY) * scaleY);
@@ -138,57 +157,6 @@ void VideoWG::mouseReleaseEvent(QMouseEvent *event)
     // and QRect::contains().
 }
 
-bool VideoWG::debayer(const IBLOB *bp, const BayerParams &params)
-{
-    uint32_t rgb_size = streamW * streamH * 3;
-    auto * destinationBuffer = new uint8_t[rgb_size];
-
-    if (destinationBuffer == nullptr)
-    {
-        qCCritical(KSTARS) << "Unable to allocate memory for temporary bayer buffer.";
-        return false;
-    }
-
-    int ds1394_height = streamH;
-
-    uint8_t * dc1394_source = reinterpret_cast<uint8_t*>(bp->blob);
-    if (params.offsetY == 1)
-    {
-        dc1394_source += streamW;
-        ds1394_height--;
-    }
-    if (params.offsetX == 1)
-    {
-        dc1394_source++;
-    }
-    dc1394error_t error_code = dc1394_bayer_decoding_8bit(dc1394_source, destinationBuffer, streamW, ds1394_height,
-                               params.filter, params.method);
-
-    if (error_code != DC1394_SUCCESS)
-    {
-        qCCritical(KSTARS) << "Debayer failed" << error_code;
-        delete[] destinationBuffer;
-        return false;
-    }
-
-    streamImage.reset(new QImage(destinationBuffer, streamW, streamH, QImage::Format_RGB888));
-    bool rc = !streamImage->isNull();
-
-    if (rc)
-    {
-        kPix = QPixmap::fromImage(streamImage->scaled(size(), Qt::KeepAspectRatio));
-
-        paintOverlay(kPix);
-
-        setPixmap(kPix);
-    }
-
-    emit imageChanged(streamImage);
-
-    delete[] destinationBuffer;
-    return rc;
-}
-
 void VideoWG::paintOverlay(QPixmap &imagePix)
 {
     if (!overlayEnabled || m_EnabledOverlayElements.count() == 0) return;
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "fitsviewer/bayer.h"
+#include "videoframeprocessor.h"
 
 #include <indidevapi.h>
 
@@ -40,6 +41,12 @@ class VideoWG : public QLabel
 
         void setSize(uint16_t w, uint16_t h);
 
+        /**
+         * @brief setFullFrameRequired Whether imageChanged() must carry full resolution frames.
+         * Otherwise it carries the frames as displayed, which are cheaper to produce.
+         */
+        void setFullFrameRequired(bool required);
+
     protected:
         //virtual void resizeEvent(QResizeEvent *ev) override;
         void mousePressEvent(QMouseEvent *event) override;
@@ -54,15 +61,20 @@ class VideoWG : public QLabel
     signals:
         void newSelection(QRect);
         void imageChanged(const QSharedPointer<QImage> &frame);
+        /** Frames displayed and dropped per second. */
+        void frameRateChanged(double processed, double dropped);
 
     private:
-        bool debayer(const IBLOB *bp, const BayerParams &params);
+        void submitFrame(IBLOB *bp, VideoFrameProcessor::FrameType type, const BayerParams *params = nullptr);
+        void showFrame(const QImage &display, const QSharedPointer<QImage> &frame, const QSize &frameSize);
 
         uint16_t streamW { 0 };
         uint16_t streamH { 0 };
         uint32_t totalBaseCount { 0 };
-        QVector<QRgb> grayTable;
+        VideoFrameProcessor *m_Processor { nullptr };
+        bool m_FullFrameRequired { true };
         QSharedPointer<QImage> streamImage;
+        QSize m_FrameSize;
         QPixmap kPix;
         QRubberBand *rubberBand { nullptr };
         QPoint origin;
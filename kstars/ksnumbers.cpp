@@ -278,6 +278,40 @@ void KSNumbers::updateValues(long double jd)
     P2(1, 2) = P1(2, 1);
     P2(2, 2) = P1(2, 2);
 
+    // Nutation as a rotation from the mean to the true equator of date,
+    // R1(-obliquity) * R3(-deltaEcLong) * R1(mean obliquity), see the
+    // "Explanatory Supplement to the Astronomical Almanac" (3.222-3).
+    // To first order it gives the same corrections as Meeus (23.1),
+    // which SkyPoint::nutate() uses away from the poles.
+    double sinOb, cosOb;
+    Obliquity.SinCos(sinOb, cosOb);
+    double meanOb = Obliquity.radians() - deltaObliquity * dms::DegToRad;
+    double sinMeanOb = sin(meanOb), cosMeanOb = cos(meanOb);
+    double sinPsi = sin(deltaEcLong * dms::DegToRad), cosPsi = cos(deltaEcLong * dms::DegToRad);
+
+    Eigen::Matrix3d N;
+    N(0, 0) = cosPsi;
+    N(0, 1) = -sinPsi * cosMeanOb;
+    N(0, 2) = -sinPsi * sinMeanOb;
+    N(1, 0) = sinPsi * cosOb;
+    N(1, 1) = cosPsi * cosOb * cosMeanOb + sinOb * sinMeanOb;
+    N(1, 2) = cosPsi * cosOb * sinMeanOb - sinOb * cosMeanOb;
+    N(2, 0) = sinPsi * sinOb;
+    N(2, 1) = cosPsi * sinOb * cosMeanOb - cosOb * sinMeanOb;
+    N(2, 2) = cosPsi * sinOb * sinMeanOb + cosOb * cosMeanOb;
+
+    PN.noalias() = N * p2();
+
+    // Annual aberration, Meeus (23.3) written as a displacement of the
+    // unit vector towards the apex of the Earth's motion.
+    double sinL, cosL, sinP, cosP;
+    L0.SinCos(sinL, cosL);
+    P.SinCos(sinP, cosP);
+    double k = K.radians();
+    Aberration(0) = k * (sinL - e * sinP);
+    Aberration(1) = k * cosOb * (e * cosP - cosL);
+    Aberration(2) = k * sinOb * (e * cosP - cosL);
+
     // Mean longitudes for the planets. radians
     //
 
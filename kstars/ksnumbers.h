@@ -111,6 +111,21 @@ class KSNumbers
     inline const Eigen::Matrix3d &p1b() const { return P1B; }
     inline const Eigen::Matrix3d &p2b() const { return P2B; }
 
+    /**
+     * @return the combined precession and nutation matrix, which rotates a
+     * J2000.0 unit vector to the true equator and equinox of date.
+     * @note Equivalent to SkyPoint::precess() followed by SkyPoint::nutate()
+     */
+    inline const Eigen::Matrix3d &precessionNutation() const { return PN; }
+
+    /**
+     * @return the annual aberration displacement, in radians, to add to a
+     * unit vector referred to the true equator and equinox of date.
+     * @note Equivalent to SkyPoint::aberrate(), to first order in the
+     * constant of aberration.
+     */
+    inline const Eigen::Vector3d &aberration() const { return Aberration; }
+
     /**
      * @short compute constant values that need to be computed only once per instance of the application
      */
@@ -136,6 +151,8 @@ class KSNumbers
     double CX, SX, CY, SY, CZ, SZ;
     double CXB, SXB, CYB, SYB, CZB, SZB;
     Eigen::Matrix3d P1, P2, P1B, P2B;
+    Eigen::Matrix3d PN;
+    Eigen::Vector3d Aberration;
     double deltaObliquity, deltaEcLong;
     double e, T;
     long double days; // JD for which the last update was called
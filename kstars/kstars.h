@@ -490,6 +490,12 @@ class KStars : public KXmlGuiWindow
              */
         Q_SCRIPTABLE QString getSkyMapDimensions();
 
+        /** DBUS interface function.  Get the time spent drawing each part of the Sky Map.
+             * @return a newline-separated list of the parts, with the last and average times in milliseconds.
+             * @note Set the ShowSkyMapProfile option to also show it on the Sky Map.
+             */
+        Q_SCRIPTABLE QString getSkyMapDrawProfile();
+
         /** DBUS interface function.  Return a newline-separated list of objects in the observing wishlist.
              * @note Unfortunately, unnamed objects are troublesome. Hopefully, we don't have them on the observing list.
              */
@@ -1007,6 +1007,12 @@ QString KStars::getSkyMapDimensions()
 {
     return (QString::number(map()->width()) + 'x' + QString::number(map()->height()));
 }
+
+QString KStars::getSkyMapDrawProfile()
+{
+    return KStarsData::Instance()->skyComposite()->drawProfileText();
+}
+
 void KStars::printImage(bool usePrintDialog, bool useChartColors)
 {
     //QPRINTER_FOR_NOW
@@ -54,6 +54,10 @@ OpsImageOverlay::OpsImageOverlay() : QFrame(KStars::Instance())
     {
         Options::setImageOverlayMaxDimension(value);
     });
+    connect(kcfg_ImageOverlayCacheSize, QOverload<int>::of(&QSpinBox::valueChanged), [](int value)
+    {
+        Options::setImageOverlayCacheSize(value);
+    });
     connect(kcfg_ImageOverlayTimeout, QOverload<int>::of(&QSpinBox::valueChanged), [](int value)
     {
         Options::setImageOverlayTimeout(value);
@@ -117,6 +121,7 @@ void OpsImageOverlay::syncOptions()
 {
     kcfg_ShowImageOverlays->setChecked(Options::showImageOverlays());
     kcfg_ImageOverlayMaxDimension->setValue(Options::imageOverlayMaxDimension());
+    kcfg_ImageOverlayCacheSize->setValue(Options::imageOverlayCacheSize());
     kcfg_ImageOverlayTimeout->setValue(Options::imageOverlayTimeout());
     kcfg_ImageOverlayDefaultScale->setValue(Options::imageOverlayDefaultScale());
 }
@@ -25,6 +25,16 @@ double AzimuthalEquidistantProjector::radius() const
     return 1.57079633;
 }
 
+void AzimuthalEquidistantProjector::toScreenBatch(const double *lon, const double *lat, int count, float *x,
+                                                  float *y, uint8_t *visible, bool oRefract) const
+{
+    projectBatch(lon, lat, count, x, y, visible, oRefract, [](double c)
+    {
+        double crad = acos(c);
+        return ((crad != 0) ? crad / sin(crad) : 1);
+    });
+}
+
 double AzimuthalEquidistantProjector::projectionK(double x) const
 {
     double crad = acos(x);
@@ -60,6 +60,46 @@ Eigen::Vector2f EquirectangularProjector::toScreenVec(const SkyPoint *o, bool oR
     return p;
 }
 
+void EquirectangularProjector::toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                                             uint8_t *visible, bool oRefract) const
+{
+    oRefract &= m_vp.useRefraction;
+
+    const double sgn = m_vp.mirror ? -1. : 1.;
+    const double xx  = m_vp.zoomFactor * sgn * m_vp.rotationAngle.cos();
+    const double xy  = m_vp.zoomFactor * m_vp.rotationAngle.sin();
+    const double yx  = m_vp.zoomFactor * sgn * m_vp.rotationAngle.sin();
+    const double yy  = m_vp.zoomFactor * m_vp.rotationAngle.cos();
+    const double x0  = m_vp.width / 2;
+    const double y0  = m_vp.height / 2;
+
+    double lon0, lat0, dir;
+    if (m_vp.useAltAz)
+    {
+        lon0 = m_vp.focus->az().radians();
+        lat0 = SkyPoint::refract(m_vp.focus->alt(), oRefract).radians();
+        dir  = -1.;
+    }
+    else
+    {
+        lon0 = m_vp.focus->ra().radians();
+        lat0 = m_vp.focus->dec().radians();
+        dir  = 1.;
+    }
+    const bool refract = m_vp.useAltAz && oRefract;
+
+    for (int i = 0; i < count; ++i)
+    {
+        double Y  = refract ? SkyPoint::refract(lat[i] / dms::DegToRad) * dms::DegToRad : lat[i];
+        double px = KSUtils::reduceAngle(dir * (lon[i] - lon0), -dms::PI, dms::PI);
+        double py = Y - lat0;
+
+        x[i] = x0 - (px * xx - py * xy);
+        y[i] = y0 - (px * yx + py * yy);
+        visible[i] = x[i] > 0 && x[i] < m_vp.width;
+    }
+}
+
 SkyPoint EquirectangularProjector::fromScreen(const QPointF &p, KStarsData* data, bool onlyAltAz) const
 {
     SkyPoint result;
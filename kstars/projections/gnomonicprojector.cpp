@@ -21,6 +21,15 @@ double GnomonicProjector::radius() const
     return 2 * M_PI;
 }
 
+void GnomonicProjector::toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                                      uint8_t *visible, bool oRefract) const
+{
+    projectBatch(lon, lat, count, x, y, visible, oRefract, [](double c)
+    {
+        return 1.0 / c;
+    });
+}
+
 double GnomonicProjector::projectionK(double x) const
 {
     return 1.0 / x;
@@ -20,6 +20,8 @@ class GnomonicProjector : public Projector
   public:
     explicit GnomonicProjector(const ViewParams &p);
     Projection type() const override;
+    void toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                       uint8_t *visible, bool oRefract = true) const override;
     double radius() const override;
     double projectionK(double x) const override;
     double projectionL(double x) const override;
@@ -21,6 +21,15 @@ double LambertProjector::radius() const
     return 1.41421356;
 }
 
+void LambertProjector::toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                                     uint8_t *visible, bool oRefract) const
+{
+    projectBatch(lon, lat, count, x, y, visible, oRefract, [](double c)
+    {
+        return sqrt(2.0 / (1.0 + c));
+    });
+}
+
 double LambertProjector::projectionK(double x) const
 {
     return sqrt(2.0 / (1.0 + x));
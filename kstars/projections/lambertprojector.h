@@ -21,6 +21,8 @@ class LambertProjector : public Projector
     explicit LambertProjector(const ViewParams &p);
     ~LambertProjector() override = default;
     Projection type() const override;
+    void toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                       uint8_t *visible, bool oRefract = true) const override;
     double radius() const override;
     double projectionK(double x) const override;
     double projectionL(double x) const override;
@@ -21,6 +21,15 @@ double OrthographicProjector::radius() const
     return 1.0;
 }
 
+void OrthographicProjector::toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                                          uint8_t *visible, bool oRefract) const
+{
+    projectBatch(lon, lat, count, x, y, visible, oRefract, [](double)
+    {
+        return 1.0;
+    });
+}
+
 double OrthographicProjector::projectionK(double x) const
 {
     Q_UNUSED(x);
@@ -95,6 +95,15 @@ QPointF Projector::toScreen(const SkyPoint *o, bool oRefract, bool *onVisibleHem
     return KSUtils::vecToPoint(toScreenVec(o, oRefract, onVisibleHemisphere));
 }
 
+void Projector::toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                              uint8_t *visible, bool oRefract) const
+{
+    projectBatch(lon, lat, count, x, y, visible, oRefract, [this](double c)
+    {
+        return projectionK(c);
+    });
+}
+
 bool Projector::onScreen(const QPointF &p) const
 {
     return (0 <= p.x() && p.x() <= m_vp.width && 0 <= p.y() && p.y() <= m_vp.height);
@@ -28,6 +28,7 @@
 #include <QPointF>
 
 #include <cstddef>
+#include <cstdint>
 #include <cmath>
 
 class KStarsData;
@@ -127,6 +128,25 @@ class Projector
         virtual Eigen::Vector2f toScreenVec(const SkyPoint *o, bool oRefract = true,
                                             bool *onVisibleHemisphere = nullptr) const;
 
+        /**
+         * Batch version of toScreenVec() for contiguous arrays of coordinates.
+         *
+         * The coordinates are right ascension and declination, or azimuth and unrefracted
+         * altitude when the view is in horizontal coordinates, all in radians. The focus,
+         * rotation and scale of the view are only looked up once, and the projections
+         * override this to inline their projectionK().
+         *
+         * @param lon right ascensions or azimuths of the points
+         * @param lat declinations or altitudes of the points
+         * @param count number of points
+         * @param x, y receive the screen pixel coordinates of the points
+         * @param visible receives 1 for the points on the visible part of the Celestial Sphere,
+         *   0 otherwise. Points with non-finite coordinates are at (0, 0) and not visible.
+         * @param oRefract see toScreenVec()
+         */
+        virtual void toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                                   uint8_t *visible, bool oRefract = true) const;
+
         /**
          * This is exactly the same as toScreenVec but it returns a QPointF.
          * It just calls toScreenVec and converts the result.
@@ -344,6 +364,67 @@ class Projector
             };
         }
 
+        /**
+         * The loop behind toScreenBatch(), the projection-specific code being the
+         * @p projectionK functor so that it is inlined.
+         * @see toScreenVec()
+         */
+        template <typename ProjectionK>
+        void projectBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                          uint8_t *visible, bool oRefract, ProjectionK projectionK) const
+        {
+            oRefract &= m_vp.useRefraction;
+
+            // rst() with the rotation and scale factored out of the loop
+            const double sgn  = m_vp.mirror ? -1. : 1.;
+            const double xx   = m_vp.zoomFactor * sgn * m_vp.rotationAngle.cos();
+            const double xy   = m_vp.zoomFactor * m_vp.rotationAngle.sin();
+            const double yx   = m_vp.zoomFactor * sgn * m_vp.rotationAngle.sin();
+            const double yy   = m_vp.zoomFactor * m_vp.rotationAngle.cos();
+            const double x0   = m_vp.width / 2;
+            const double y0   = m_vp.height / 2;
+            const double cosMax = cosMaxFieldAngle();
+
+            // dX is focus.az - az in horizontal coordinates, and ra - focus.ra otherwise
+            const double lon0 = m_vp.useAltAz ? m_vp.focus->az().radians() : m_vp.focus->ra().radians();
+            const double dir  = m_vp.useAltAz ? -1. : 1.;
+            const bool refract = m_vp.useAltAz && oRefract;
+
+            for (int i = 0; i < count; ++i)
+            {
+                double Y  = refract ? SkyPoint::refract(lat[i] / dms::DegToRad) * dms::DegToRad : lat[i];
+                double dX = dir * (lon[i] - lon0);
+
+                if (!(std::isfinite(Y) && std::isfinite(dX)))
+                {
+                    x[i] = y[i] = 0;
+                    visible[i] = 0;
+                    continue;
+                }
+
+                // No need to reduce dX, it only goes through sin and cos
+                double sindX, cosdX, sinY, cosY;
+#ifdef HAVE_SINCOS
+                sincos(dX, &sindX, &cosdX);
+                sincos(Y, &sinY, &cosY);
+#else
+                sindX = sin(dX);
+                cosdX = cos(dX);
+                sinY  = sin(Y);
+                cosY  = cos(Y);
+#endif
+
+                const double c = m_sinY0 * sinY + m_cosY0 * cosY * cosdX;
+                visible[i] = c > cosMax;
+
+                const double k  = projectionK(c);
+                const double px = k * cosY * sindX;
+                const double py = k * (m_cosY0 * sinY - m_sinY0 * cosY * cosdX);
+                x[i] = x0 - (px * xx - py * xy);
+                y[i] = y0 - (px * yx + py * yy);
+            }
+        }
+
         /**
          * Helper function for drawing ground.
          * @return the point with Alt = 0, az = @p az
@@ -22,6 +22,15 @@ double StereographicProjector::radius() const
     return 2 * M_PI;
 }
 
+void StereographicProjector::toScreenBatch(const double *lon, const double *lat, int count, float *x, float *y,
+                                           uint8_t *visible, bool oRefract) const
+{
+    projectBatch(lon, lat, count, x, y, visible, oRefract, [](double c)
+    {
+        return 2.0 / (1.0 + c);
+    });
+}
+
 double StereographicProjector::projectionK(double x) const
 {
     return 2.0 / (1.0 + x);
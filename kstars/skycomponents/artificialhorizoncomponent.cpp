@@ -15,10 +15,13 @@
 #include "skypainter.h"
 #include "projections/projector.h"
 
+#include <algorithm>
+
 #define UNDEFINED_ALTITUDE -90
 
 ArtificialHorizonEntity::~ArtificialHorizonEntity()
 {
+    m_Horizon = nullptr;
     clearList();
 }
 
@@ -40,6 +43,8 @@ bool ArtificialHorizonEntity::enabled() const
 void ArtificialHorizonEntity::setEnabled(bool Enabled)
 {
     m_Enabled = Enabled;
+    if (m_Horizon != nullptr)
+        m_Horizon->compileConstraints();
 }
 
 bool ArtificialHorizonEntity::ceiling() const
@@ -50,11 +55,15 @@ bool ArtificialHorizonEntity::ceiling() const
 void ArtificialHorizonEntity::setCeiling(bool value)
 {
     m_Ceiling = value;
+    if (m_Horizon != nullptr)
+        m_Horizon->compileConstraints();
 }
 
 void ArtificialHorizonEntity::setList(const std::shared_ptr<LineList> &list)
 {
     m_List = list;
+    if (m_Horizon != nullptr)
+        m_Horizon->compileConstraints();
 }
 
 std::shared_ptr<LineList> ArtificialHorizonEntity::list() const
@@ -65,6 +74,8 @@ std::shared_ptr<LineList> ArtificialHorizonEntity::list() const
 void ArtificialHorizonEntity::clearList()
 {
     m_List.reset();
+    if (m_Horizon != nullptr)
+        m_Horizon->compileConstraints();
 }
 
 namespace
@@ -157,8 +168,9 @@ ArtificialHorizon::~ArtificialHorizon()
 void ArtificialHorizon::load(const QList<ArtificialHorizonEntity *> &list)
 {
     m_HorizonList = list;
-    resetPrecomputeConstraints();
-    checkForCeilings();
+    for (auto &entity : m_HorizonList)
+        entity->m_Horizon = this;
+    compileConstraints();
 }
 
 bool ArtificialHorizonComponent::load()
@@ -673,8 +685,7 @@ void ArtificialHorizon::removeRegion(const QString &regionName, bool lineOnly)
         m_HorizonList.removeOne(regionHorizon);
         delete (regionHorizon);
     }
-    resetPrecomputeConstraints();
-    checkForCeilings();
+    compileConstraints();
 }
 
 void ArtificialHorizonComponent::removeRegion(const QString &regionName, bool lineOnly)
@@ -707,10 +718,10 @@ void ArtificialHorizon::addRegion(const QString &regionName, bool enabled, const
     horizon->setEnabled(enabled);
     horizon->setCeiling(ceiling);
     horizon->setList(list);
+    horizon->m_Horizon = this;
 
     m_HorizonList.append(horizon);
-    resetPrecomputeConstraints();
-    checkForCeilings();
+    compileConstraints();
 }
 
 void ArtificialHorizonComponent::addRegion(const QString &regionName, bool enabled, const std::shared_ptr<LineList> &list,
@@ -755,15 +766,23 @@ const ArtificialHorizonEntity *ArtificialHorizon::getConstraintAbove(double azim
     return entity;
 }
 
-// Estimate the horizon contraint to .1 degrees.
-// This significantly speeds up computation.
-constexpr int PRECOMPUTED_RESOLUTION = 10;
+// The constraints are compiled every .05 degrees in azimuth, and interpolated in between.
+constexpr int CONSTRAINT_RESOLUTION = 20;
+constexpr int CONSTRAINT_BINS = 360 * CONSTRAINT_RESOLUTION;
 
 double ArtificialHorizon::altitudeConstraint(double azimuthDegrees) const
 {
-    if (precomputedConstraints.size() != 360 * PRECOMPUTED_RESOLUTION)
-        precomputeConstraints();
-    return precomputedConstraint(azimuthDegrees);
+    Constraints constraints;
+    constraintsAt(azimuthDegrees, &constraints);
+    // The highest constraint below the zenith, as in altitudeConstraintInternal().
+    double constraint = UNDEFINED_ALTITUDE;
+    for (const auto &c : constraints)
+    {
+        if (c.altitude >= 90.0)
+            break;
+        constraint = c.altitude;
+    }
+    return constraint;
 }
 
 double ArtificialHorizon::altitudeConstraintInternal(double azimuthDegrees) const
@@ -775,33 +794,72 @@ double ArtificialHorizon::altitudeConstraintInternal(double azimuthDegrees) cons
     return horizonBelow->altitudeConstraint(azimuthDegrees, &ignore);
 }
 
-// Quantize the constraints to within .1 degrees (so there are 360*10=3600
-// precomputed values).
-void ArtificialHorizon::precomputeConstraints() const
+void ArtificialHorizon::compileConstraints()
 {
-    precomputedConstraints.clear();
-    precomputedConstraints.fill(0, 360 * PRECOMPUTED_RESOLUTION);
-    for (int i = 0; i < 360 * PRECOMPUTED_RESOLUTION; ++i)
+    checkForCeilings();
+    m_ConstraintOffsets.fill(0, CONSTRAINT_BINS + 1);
+    m_Constraints.clear();
+    if (!altitudeConstraintsExist())
+        return;
+
+    Constraints bin;
+    for (int i = 0; i < CONSTRAINT_BINS; ++i)
     {
-        const double az = i / static_cast<double>(PRECOMPUTED_RESOLUTION);
-        precomputedConstraints[i] = altitudeConstraintInternal(az);
+        const double az = i / static_cast<double>(CONSTRAINT_RESOLUTION);
+        bin.clear();
+        for (const auto &entity : m_HorizonList)
+        {
+            if (!entity->enabled())
+                continue;
+            bool exists = false;
+            const double constraint = entity->altitudeConstraint(az, &exists);
+            if (exists)
+                bin.append({constraint, entity->ceiling()});
+        }
+        // Stable, so that equal altitudes keep the order of the list, as in getConstraintAbove/Below().
+        std::stable_sort(bin.begin(), bin.end(), [](const Constraint & a, const Constraint & b)
+        {
+            return a.altitude < b.altitude;
+        });
+        m_ConstraintOffsets[i] = m_Constraints.size();
+        for (const auto &c : bin)
+            m_Constraints.append(c);
     }
+    m_ConstraintOffsets[CONSTRAINT_BINS] = m_Constraints.size();
 }
 
-void ArtificialHorizon::resetPrecomputeConstraints() const
+void ArtificialHorizon::constraintsAt(double azimuthDegrees, Constraints *constraints) const
 {
-    precomputedConstraints.clear();
-}
+    constraints->clear();
+    if (m_Constraints.isEmpty() || qIsNaN(azimuthDegrees))
+        return;
 
-double ArtificialHorizon::precomputedConstraint(double azimuth) const
-{
-    constexpr int maxval = 360 * PRECOMPUTED_RESOLUTION;
-    int index = azimuth * PRECOMPUTED_RESOLUTION + 0.5;
-    if (index == maxval)
-        index = 0;
-    if (index < 0 || index >= precomputedConstraints.size())
-        return UNDEFINED_ALTITUDE;
-    return precomputedConstraints[index];
+    double position = std::fmod(azimuthDegrees, 360.0) * CONSTRAINT_RESOLUTION;
+    if (position < 0)
+        position += CONSTRAINT_BINS;
+    const int bin1 = std::min(static_cast<int>(position), CONSTRAINT_BINS - 1);
+    const int bin2 = (bin1 + 1) % CONSTRAINT_BINS;
+    const double fraction = std::clamp(position - bin1, 0.0, 1.0);
+
+    const Constraint *c1 = m_Constraints.constData() + m_ConstraintOffsets[bin1];
+    const Constraint *c2 = m_Constraints.constData() + m_ConstraintOffsets[bin2];
+    const int size1 = m_ConstraintOffsets[bin1 + 1] - m_ConstraintOffsets[bin1];
+    const int size2 = m_ConstraintOffsets[bin2 + 1] - m_ConstraintOffsets[bin2];
+
+    // Interpolate if the same kinds of lines constrain both neighbors. Otherwise a line starts or
+    // ends between them, and the nearest one is used.
+    bool sameLines = size1 == size2;
+    for (int i = 0; sameLines && i < size1; ++i)
+        sameLines = c1[i].ceiling == c2[i].ceiling;
+    if (sameLines)
+    {
+        for (int i = 0; i < size1; ++i)
+            constraints->append({c1[i].altitude + fraction * (c2[i].altitude - c1[i].altitude), c1[i].ceiling});
+    }
+    else if (fraction < 0.5)
+        constraints->append(c1, size1);
+    else
+        constraints->append(c2, size2);
 }
 
 const ArtificialHorizonEntity *ArtificialHorizon::getConstraintBelow(double azimuthDegrees, double altitudeDegrees,
@@ -847,10 +905,59 @@ bool ArtificialHorizon::isAltitudeOK(double azimuthDegrees, double altitudeDegre
     return isVisible(azimuthDegrees, altitudeDegrees, reason, margin);
 }
 
+bool ArtificialHorizon::isVisible(double azimuthDegrees, double altitudeDegrees, QString *reason, double *margin) const
+{
+    if (margin)
+        *margin = 90;
+
+    // Same rules as isVisibleInternal(), with the constraints sorted by altitude.
+    Constraints constraints;
+    constraintsAt(azimuthDegrees, &constraints);
+    const Constraint *above = nullptr;
+    const Constraint *below = nullptr;
+    for (const auto &c : constraints)
+    {
+        if (c.altitude > altitudeDegrees)
+        {
+            above = &c;
+            break;
+        }
+        if (c.altitude < altitudeDegrees && (below == nullptr || c.altitude > below->altitude))
+            below = &c;
+    }
+
+    if (above != nullptr && !above->ceiling)
+    {
+        if (reason)
+            *reason = QString("altitude %1 < horizon %2").arg(altitudeDegrees, 0, 'f', 1).arg(above->altitude, 0, 'f', 1);
+        if (margin)
+            *margin = fabs(altitudeDegrees - above->altitude);
+        return false;
+    }
+    if (below != nullptr && below->ceiling)
+    {
+        if (reason)
+            *reason = QString("altitude %1 > ceiling %2").arg(altitudeDegrees, 0, 'f', 1).arg(below->altitude, 0, 'f', 1);
+        if (margin)
+            *margin = fabs(altitudeDegrees - below->altitude);
+        return false;
+    }
+    if (margin)
+    {
+        // we're ok on one or both margins, but how close?
+        if (below && !below->ceiling)
+            *margin = fabs(altitudeDegrees - below->altitude);
+        if (above && above->ceiling)
+            *margin = std::min(*margin, fabs(altitudeDegrees - above->altitude));
+    }
+    return true;
+}
+
 // An altitude is blocked (not visible) if either:
 // - there are constraints above and the closest above constraint is not a ceiling, or
 // - there are constraints below and the closest below constraint is a ceiling.
-bool ArtificialHorizon::isVisible(double azimuthDegrees, double altitudeDegrees, QString *reason, double *margin) const
+bool ArtificialHorizon::isVisibleInternal(double azimuthDegrees, double altitudeDegrees, QString *reason,
+        double *margin) const
 {
     if (margin)
         *margin = 90;
@@ -8,8 +8,12 @@
 
 #include "noprecessindex.h"
 
+#include <QVarLengthArray>
+#include <QVector>
+
 #include <memory>
 
+class ArtificialHorizon;
 class TestArtificialHorizon;
 
 // An ArtificialHorizonEntity is a set of Azimuth & Altitude values defining
@@ -47,6 +51,9 @@ class ArtificialHorizonEntity
         bool m_Enabled { false };
         bool m_Ceiling { false };
         std::shared_ptr<LineList> m_List;
+        // The horizon this entity belongs to, told to recompile its constraints when the entity changes.
+        ArtificialHorizon *m_Horizon { nullptr };
+        friend class ArtificialHorizon;
 };
 
 // ArtificialHorizon can contain several ArtificialHorizonEntities. That is,
@@ -80,7 +87,7 @@ class ArtificialHorizon
 
         // Returns true if the azimuth/altitude point is not blocked by the artificial horzon entities.
         bool isVisible(double azimuthDegrees, double altitudeDegrees, QString *reason = nullptr, double *margin = nullptr) const;
-        // Like isVisible, but uses the cache if there are no ceiling constraints.
+        // Like isVisible, but simply compares with altitudeConstraint() if there are no ceiling constraints.
         bool isAltitudeOK(double azimuthDegrees, double altitudeDegrees, QString *reason, double *margin = nullptr) const;
 
         // returns the (highest) altitude constraint at the given azimuth.
@@ -115,16 +122,30 @@ class ArtificialHorizon
         QList<ArtificialHorizonEntity *> m_HorizonList;
         bool testing { false };
 
-        // Methods and data structure for precomputing altitudeConstraint(azimuth).
-        // This way, we don't traverse the potentially horizon list each time
-        // we query the horizon constraint.
-        void precomputeConstraints() const;
-        void resetPrecomputeConstraints() const;
-        double precomputedConstraint(double azimuth) const;
+        // The enabled entities are compiled into a table of the constraints at each azimuth,
+        // so that the queries don't traverse the horizon lines. The table is rebuilt whenever
+        // a region is added, removed, or an entity changes, and is only read by the queries,
+        // which can then be made from several threads.
+        struct Constraint
+        {
+            double altitude;
+            bool ceiling;
+        };
+        using Constraints = QVarLengthArray<Constraint, 8>;
+        void compileConstraints();
+        // The constraints at the azimuth sorted by altitude, interpolated between the table entries.
+        void constraintsAt(double azimuthDegrees, Constraints *constraints) const;
+        // Same as altitudeConstraint() and isVisible(), but computed from the horizon lines.
         double altitudeConstraintInternal(double azimuthDegrees) const;
-        mutable QVector<double> precomputedConstraints;
+        bool isVisibleInternal(double azimuthDegrees, double altitudeDegrees, QString *reason = nullptr,
+                               double *margin = nullptr) const;
+        // For each azimuth bin, its constraints are m_Constraints[m_ConstraintOffsets[bin]]
+        // up to m_Constraints[m_ConstraintOffsets[bin + 1]].
+        QVector<int> m_ConstraintOffsets;
+        QVector<Constraint> m_Constraints;
         bool noCeilingConstraints { true };
         void checkForCeilings();
+        friend ArtificialHorizonEntity;
         friend TestArtificialHorizon;
 };
 
@@ -19,6 +19,7 @@
 #include "kspaths.h"
 #include "import_skycomp.h"
 
+#include <QCoreApplication>
 #include <QtConcurrent>
 
 #include <cmath>
@@ -26,6 +27,9 @@
 constexpr std::size_t expectedKnownMagObjectsPerTrixel = 500;
 constexpr std::size_t expectedUnknownMagObjectsPerTrixel = 1500;
 
+// Radius of the prefetched ring, relative to the radius of the view.
+constexpr double prefetchRadiusScale = 1.5;
+
 CatalogsComponent::CatalogsComponent(SkyComposite *parent, const QString &db_filename,
                                      bool load_default)
     : SkyComponent(parent)
@@ -33,7 +37,16 @@ CatalogsComponent::CatalogsComponent(SkyComposite *parent, const QString &db_fil
     , m_skyMesh{ SkyMesh::Create(m_db_manager.htmesh_level()) }
     , m_mainCache(m_skyMesh->size(), calculateCacheSize(Options::dSOCachePercentage()))
     , m_unknownMagCache(m_skyMesh->size(), calculateCacheSize(Options::dSOCachePercentage()))
+    , m_prefetcher{ new CatalogsPrefetcher(m_db_manager.db_file_name()) }
 {
+    // Repaint when visible trixels we skipped have been loaded.
+    QObject::connect(m_prefetcher.get(), &CatalogsPrefetcher::resultsReady,
+                     QCoreApplication::instance(), []()
+    {
+        if (SkyMap::Instance())
+            SkyMap::Instance()->forceUpdate();
+    });
+
     if (load_default)
     {
         const auto &default_file = KSPaths::locate(QStandardPaths::AppLocalDataLocation,
@@ -92,6 +105,14 @@ void CatalogsComponent::draw(SkyPainter *skyp)
     auto &proj = *map.projector();
 
     updateSkyMesh(map);
+    takePrefetchedTrixels();
+
+    // Waiting for the database would make slewing stutter, so we draw
+    // what is cached and let the prefetcher load the rest. Otherwise
+    // everything is loaded right away, so a settled (or exported) sky
+    // is always complete.
+    const bool prefetchVisible = map.isSlewing();
+    std::vector<CatalogsPrefetcher::Request> prefetchRequests;
 
     size_t num_trixels{ 0 };
     const auto zoomFactor = Options::zoomFactor();
@@ -157,6 +178,27 @@ void CatalogsComponent::draw(SkyPainter *skyp)
         }
     };
 
+    // Helper lambda to make sure a trixel is cached, returns false if
+    // it is left to the prefetcher instead
+    auto ensureCache = [&](
+                           TrixelCache<ObjectList>::element & cacheElement,
+                           ObjectList (CatalogsDB::DBManager::*fillFunction)(const int),
+                           Trixel trixel, bool unknownMag
+                       ) -> bool
+    {
+        if (cacheElement.is_set())
+            return true;
+
+        if (prefetchVisible)
+        {
+            prefetchRequests.push_back({ trixel, unknownMag, true });
+            return false;
+        }
+
+        fillCache(cacheElement, fillFunction, trixel);
+        return true;
+    };
+
     // Helper lambda to JIT update and draw
     auto drawObjects = [&](std::vector<CatalogObject*> &objects)
     {
@@ -201,7 +243,9 @@ void CatalogsComponent::draw(SkyPainter *skyp)
 
         // Fill the cache for this trixel
         auto &objectsKnownMag = m_mainCache[trixel];
-        fillCache(objectsKnownMag, &CatalogsDB::DBManager::get_objects_in_trixel_no_nulls, trixel);
+        if (!ensureCache(objectsKnownMag, &CatalogsDB::DBManager::get_objects_in_trixel_no_nulls,
+                         trixel, false))
+            continue;
         drawListKnownMag.clear();
 
         // Filter based on magnitude and size
@@ -246,7 +290,9 @@ void CatalogsComponent::draw(SkyPainter *skyp)
 
             // Fill cache
             auto &objectsUnknownMag = m_unknownMagCache[trixel];
-            fillCache(objectsUnknownMag, &CatalogsDB::DBManager::get_objects_in_trixel_null_mag, trixel);
+            if (!ensureCache(objectsUnknownMag, &CatalogsDB::DBManager::get_objects_in_trixel_null_mag,
+                             trixel, true))
+                continue;
 
             // Filter
             QtConcurrent::blockingMap(
@@ -281,16 +327,49 @@ void CatalogsComponent::draw(SkyPainter *skyp)
 
     }
 
+    // Prefetch the ring around the view, after the visible trixels
+    size_t num_ring_trixels{ 0 };
+    updateSkyMesh(map, PREFETCH_BUF, prefetchRadiusScale);
+    MeshIterator ring(m_skyMesh, PREFETCH_BUF);
+    while (ring.hasNext())
+    {
+        Trixel trixel = ring.next();
+        num_ring_trixels++;
+
+        if (!m_mainCache[trixel].is_set())
+            prefetchRequests.push_back({ trixel, false, false });
+        if (showUnknownMagObjects && !m_unknownMagCache[trixel].is_set())
+            prefetchRequests.push_back({ trixel, true, false });
+    }
+    m_prefetcher->request(std::move(prefetchRequests));
+
     // prune only if the to-be-pruned trixels are likely not visible
     // and we are not zooming
-    m_mainCache.prune(num_trixels * 1.2);
-    m_unknownMagCache.prune(num_trixels * 1.2);
+    const size_t keep = std::max(num_trixels, num_ring_trixels) * 1.2;
+    m_mainCache.prune(keep);
+    m_unknownMagCache.prune(keep);
 };
 
-void CatalogsComponent::updateSkyMesh(SkyMap &map, MeshBufNum_t buf)
+void CatalogsComponent::takePrefetchedTrixels()
+{
+    for (auto &result : m_prefetcher->takeResults())
+    {
+        // Failed trixels are loaded (and the error reported) by draw
+        // once the map is not slewing anymore.
+        if (result.failed)
+            continue;
+
+        auto &cache = result.request.unknownMag ? m_unknownMagCache : m_mainCache;
+        auto &element = cache[result.request.trixel];
+        if (!element.is_set())
+            element = std::move(result.objects);
+    }
+}
+
+void CatalogsComponent::updateSkyMesh(SkyMap &map, MeshBufNum_t buf, double scale)
 {
     SkyPoint *focus = map.focus();
-    float radius    = map.projector()->fov();
+    float radius    = map.projector()->fov() * scale;
     if (radius > 180.0 && SkyMap::Instance()->projector()->type() != Projector::Stereographic)
         radius = 180.0;
 
@@ -9,12 +9,14 @@
 
 #include "skycomponent.h"
 #include "catalogsdb.h"
+#include "catalogsprefetcher.h"
 #include "catalogobject.h"
 #include "skymesh.h"
 #include "trixelcache.h"
 #include "Options.h"
 
 #include "polyfills/qstring_hash.h"
+#include <memory>
 #include <unordered_map>
 
 class SkyMesh;
@@ -60,6 +62,10 @@ class CatalogsComponent : public SkyComponent
         /**
          * Draws the objects in the currently visible trixels by
          * dynamically loading them from the database.
+         *
+         * While the map is slewing, visible trixels which are not cached
+         * yet are loaded by the prefetcher and drawn once they arrive.
+         * A ring of trixels around the view is always prefetched.
          */
         void draw(SkyPainter *skyp) override;
 
@@ -110,6 +116,7 @@ class CatalogsComponent : public SkyComponent
          */
         void dropCache()
         {
+            m_prefetcher->clear();
             m_mainCache.clear();
             m_unknownMagCache.clear();
             m_catalog_colors = m_db_manager.get_catalog_colors();
@@ -172,6 +179,11 @@ class CatalogsComponent : public SkyComponent
          */
         std::unordered_map<Trixel, CatalogsDB::CatalogObjectList> m_static_objects;
 
+        /**
+         * Loads trixels into the caches in the background.
+         */
+        std::unique_ptr<CatalogsPrefetcher> m_prefetcher;
+
         /**
          * A cache for catalog colors.
          */
@@ -180,7 +192,12 @@ class CatalogsComponent : public SkyComponent
         //@{
         /** Helpers */
 
-        void updateSkyMesh(SkyMap &map, MeshBufNum_t buf = DRAW_BUF);
+        void updateSkyMesh(SkyMap &map, MeshBufNum_t buf = DRAW_BUF, double scale = 1.0);
+
+        /**
+         * Move the trixels loaded by the prefetcher into the caches.
+         */
+        void takePrefetchedTrixels();
         size_t calculateCacheSize(const unsigned int percentage)
         {
             return m_skyMesh->size() * percentage / 100.f;
@@ -0,0 +1,145 @@
+/*  Catalogs Prefetcher
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "catalogsprefetcher.h"
+#include "kstars_debug.h"
+
+#include <algorithm>
+
+CatalogsPrefetcher::CatalogsPrefetcher(const QString &db_filename)
+    : QObject(nullptr), m_db_filename{ db_filename }, m_thread{ new QThread }
+{
+    // The database connection has to be opened in the thread that uses it.
+    moveToThread(m_thread.get());
+    connect(m_thread.get(), &QThread::started, this, &CatalogsPrefetcher::init);
+    m_thread->start();
+}
+
+CatalogsPrefetcher::~CatalogsPrefetcher()
+{
+    clear();
+    QMetaObject::invokeMethod(this, "cleanup");
+    m_thread->wait();
+}
+
+void CatalogsPrefetcher::init()
+{
+    try
+    {
+        m_db_manager = std::make_unique<CatalogsDB::DBManager>(m_db_filename);
+    }
+    catch (const CatalogsDB::DatabaseError &e)
+    {
+        // The requests will fail and be loaded synchronously instead.
+        qCWarning(KSTARS) << "Could not open the catalogs for prefetching:" << e.what();
+    }
+}
+
+void CatalogsPrefetcher::cleanup()
+{
+    m_db_manager.reset();
+    m_thread->quit();
+}
+
+void CatalogsPrefetcher::request(std::vector<Request> requests)
+{
+    QMutexLocker _{ &m_mutex };
+    m_requests.assign(requests.begin(), requests.end());
+    schedule();
+}
+
+std::vector<CatalogsPrefetcher::Result> CatalogsPrefetcher::takeResults()
+{
+    QMutexLocker _{ &m_mutex };
+    std::vector<Result> results;
+    results.swap(m_results);
+    m_visibleWaiting = false;
+    return results;
+}
+
+void CatalogsPrefetcher::clear()
+{
+    QMutexLocker _{ &m_mutex };
+    m_requests.clear();
+    m_results.clear();
+    m_visibleWaiting = false;
+    m_generation++;
+}
+
+void CatalogsPrefetcher::schedule()
+{
+    if (m_scheduled || m_requests.empty())
+        return;
+
+    // One trixel per event, so that new requests can replace the
+    // pending ones in between.
+    m_scheduled = true;
+    QMetaObject::invokeMethod(this, "processNext", Qt::QueuedConnection);
+}
+
+bool CatalogsPrefetcher::isWaiting(const Request &request) const
+{
+    return std::any_of(m_results.cbegin(), m_results.cend(), [&](const Result & result)
+    {
+        return result.request.trixel == request.trixel &&
+               result.request.unknownMag == request.unknownMag;
+    });
+}
+
+void CatalogsPrefetcher::processNext()
+{
+    Request request;
+    int generation;
+    {
+        QMutexLocker _{ &m_mutex };
+        m_scheduled = false;
+
+        // Skip the trixels that are already waiting to be taken.
+        while (!m_requests.empty() && isWaiting(m_requests.front()))
+            m_requests.pop_front();
+
+        if (m_requests.empty())
+            return;
+
+        request = m_requests.front();
+        m_requests.pop_front();
+        generation = m_generation;
+    }
+
+    Result result{ request, {}, false };
+    if (!m_db_manager)
+        result.failed = true;
+    else
+    {
+        try
+        {
+            result.objects =
+                request.unknownMag ?
+                m_db_manager->get_objects_in_trixel_null_mag(request.trixel) :
+                m_db_manager->get_objects_in_trixel_no_nulls(request.trixel);
+        }
+        catch (const CatalogsDB::DatabaseError &e)
+        {
+            qCWarning(KSTARS) << "Could not prefetch catalog objects in trixel: "
+                              << request.trixel << ", " << e.what();
+            result.failed = true;
+        }
+    }
+
+    bool notify = false;
+    {
+        QMutexLocker _{ &m_mutex };
+        if (generation == m_generation)
+        {
+            notify = request.visible && !m_visibleWaiting;
+            m_visibleWaiting = m_visibleWaiting || request.visible;
+            m_results.push_back(std::move(result));
+        }
+        schedule();
+    }
+
+    if (notify)
+        emit resultsReady();
+}
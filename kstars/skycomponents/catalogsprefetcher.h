@@ -0,0 +1,105 @@
+/*  Catalogs Prefetcher
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "catalogsdb.h"
+#include "skymesh.h"
+
+#include <QMutex>
+#include <QObject>
+#include <QThread>
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+/**
+ * \brief Loads the objects of catalog trixels in the background.
+ *
+ * The prefetcher owns a thread with its own `CatalogsDB::DBManager`
+ * connection. The `CatalogsComponent` hands it the trixels it is
+ * missing, most important first, and picks up the loaded objects on
+ * its next draw. This keeps the SQLite queries for cold trixels out of
+ * the render loop while the sky map is being panned.
+ *
+ * Follows the same active object pattern as `CatalogsDB::AsyncDBManager`.
+ */
+class CatalogsPrefetcher : public QObject
+{
+    Q_OBJECT
+
+  public:
+    struct Request
+    {
+        Trixel trixel;
+        /** Whether to load the objects of unknown instead of known magnitude */
+        bool unknownMag;
+        /** Whether the trixel is visible, so the sky map needs a repaint once loaded */
+        bool visible;
+    };
+
+    struct Result
+    {
+        Request request;
+        CatalogsDB::CatalogObjectVector objects;
+        /** Loading failed, the trixel should be loaded synchronously to report the error */
+        bool failed{ false };
+    };
+
+    /**
+     * Starts the thread and opens the database \p db_filename in it.
+     */
+    explicit CatalogsPrefetcher(const QString &db_filename);
+    ~CatalogsPrefetcher() override;
+
+    /**
+     * Replaces the pending requests by \p requests, which are processed
+     * in order. Trixels which are already loaded but not yet taken are
+     * not loaded again.
+     */
+    void request(std::vector<Request> requests);
+
+    /**
+     * \return the trixels loaded since the last call.
+     */
+    std::vector<Result> takeResults();
+
+    /**
+     * Drops the pending requests and the results not yet taken, for
+     * instance because the catalogs changed.
+     */
+    void clear();
+
+  signals:
+    /**
+     * Emitted when a visible trixel is loaded while none were waiting to
+     * be taken, so a single repaint can pick up a burst of results.
+     */
+    void resultsReady();
+
+  private slots:
+    void init();
+    void processNext();
+    void cleanup();
+
+  private:
+    /** Must be called with `m_mutex` held. */
+    void schedule();
+    /** \return whether the result of \p request is waiting to be taken, with `m_mutex` held. */
+    bool isWaiting(const Request &request) const;
+
+    QString m_db_filename;
+    std::unique_ptr<CatalogsDB::DBManager> m_db_manager;
+    std::unique_ptr<QThread> m_thread;
+
+    QMutex m_mutex;
+    std::deque<Request> m_requests;
+    std::vector<Result> m_results;
+    bool m_scheduled{ false };
+    bool m_visibleWaiting{ false };
+    /** Bumped by `clear`, results of an older generation are dropped. */
+    int m_generation{ 0 };
+};
@@ -22,6 +22,9 @@
 #include <qplatformdefs.h>
 #include <QtConcurrent>
 #include <QElapsedTimer>
+#include <QPair>
+
+#include <vector>
 
 #include <kstars_debug.h>
 
@@ -42,6 +45,8 @@ DeepStarComponent::DeepStarComponent(SkyComposite *parent, QString fileName, flo
 
 DeepStarComponent::~DeepStarComponent()
 {
+    // The read ahead uses the mapped file
+    m_readAhead.waitForFinished();
     if (fileOpened)
         starReader.closeFile();
     fileOpened = false;
@@ -246,8 +251,6 @@ void DeepStarComponent::draw(SkyPainter *skyp)
     StarObject::starsUpdated        = 0;
 #endif
     SkyMap *map       = SkyMap::Instance();
-    KStarsData *data  = KStarsData::Instance();
-    UpdateID updateID = data->updateID();
 
     //FIXME_FOV -- maybe not clamp like that...
     float radius = map->projector()->fov();
@@ -327,6 +330,11 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         region.reset();
     }
 
+    // The stars of a block handed to the painter, reused across blocks
+    std::vector<const SkyPoint *> starLocs;
+    std::vector<float> starMags;
+    std::vector<char> starTypes;
+
     while (region.hasNext())
     {
         ++nTrixels;
@@ -357,16 +365,16 @@ void DeepStarComponent::draw(SkyPainter *skyp)
         //        qDebug() << Q_FUNC_INFO << "Drawing SBL for trixel " << currentRegion << ", SBL has "
         //                 <<  m_starBlockList[ currentRegion ]->getBlockCount() << " blocks";
 
-        // REMARK: The following should never carry state, except for const parameters like updateID and maglim
-        std::function<void(std::shared_ptr<StarBlock>)> mapFunction = [&updateID, &maglim](std::shared_ptr<StarBlock> myBlock)
+        // REMARK: The following should never carry state, except for const parameters like maglim
+        std::function<void(std::shared_ptr<StarBlock>)> mapFunction = [&maglim](std::shared_ptr<StarBlock> myBlock)
         {
-            for (StarObject &star : myBlock->contents())
-            {
-                if (star.updateID != updateID)
-                    star.JITupdate();
-                if (star.mag() > maglim)
-                    break;
-            }
+            // Stars are sorted by magnitude, update up to the first one fainter than the limit
+            int count = 0;
+            while (count < myBlock->getStarCount() && myBlock->star(count++)->mag() <= maglim)
+                ;
+
+            if (count > 0)
+                StarObject::JITupdate(myBlock->star(0), count);
         };
 
         QtConcurrent::blockingMap(m_starBlockList.at(currentRegion)->contents(), mapFunction);
@@ -376,6 +384,9 @@ void DeepStarComponent::draw(SkyPainter *skyp)
             std::shared_ptr<StarBlock> block = m_starBlockList.at(currentRegion)->block(i);
             //            qDebug() << Q_FUNC_INFO << "---> Drawing stars from block " << i << " of trixel " <<
             //                currentRegion << ". SB has " << block->getStarCount() << " stars";
+            starLocs.clear();
+            starMags.clear();
+            starTypes.clear();
             for (int j = 0; j < block->getStarCount(); j++)
             {
                 StarObject *curStar = block->star(j);
@@ -388,15 +399,24 @@ void DeepStarComponent::draw(SkyPainter *skyp)
                 if (mag > maglim)
                     break;
 
-                if (skyp->drawPointSource(curStar, mag, curStar->spchar()))
-                    visibleStarCount++;
+                starLocs.push_back(curStar);
+                starMags.push_back(mag);
+                starTypes.push_back(curStar->spchar());
             }
+
+            // The painter projects the whole block at once
+            visibleStarCount += skyp->drawPointSources(starLocs.data(), starMags.data(), starTypes.data(),
+                                                       static_cast<int>(starLocs.size()));
         }
 
         // DEBUG: Uncomment to identify problems with Star Block Factory / preservation of Magnitude Order in the LRU Cache
         //        verifySBLIntegrity();
         t_drawUnnamed += t.restart();
     }
+
+    if (!staticStars)
+        readAhead(focus, radius, maglim);
+
     m_skyMesh->inDraw(false);
 #ifdef PROFILE_SINCOS
     trig_calls_here += dms::trig_function_calls;
@@ -422,6 +442,52 @@ void DeepStarComponent::draw(SkyPainter *skyp)
 #endif
 }
 
+void DeepStarComponent::readAhead(SkyPoint *focus, float radius, float maglim)
+{
+    // Only one read ahead at a time, the next draw requests whatever is still missing
+    if (!starReader.isMapped() || m_readAhead.isRunning())
+        return;
+
+    // Bound the reads for one request, the catalogs are sorted by magnitude within a trixel
+    // so the remaining records of a trixel may be many more than the current limit requires.
+    constexpr quint32 maxReadAheadBytes = 16 * 1024 * 1024;
+    const quint32 recordSize = starReader.guessRecordSize();
+    quint32 totalBytes = 0;
+    QVector<QPair<quint32, quint32>> spans;
+
+    m_skyMesh->aperture(focus, radius * 1.5 + 1.0, PREFETCH_BUF);
+    MeshIterator ring(m_skyMesh, PREFETCH_BUF);
+    while (ring.hasNext() && totalBytes < maxReadAheadBytes)
+    {
+        Trixel trixel = ring.next();
+        if (trixel >= m_starBlockList.size())
+            continue;
+
+        // Trixels filled to the limit, including the visible ones, need nothing more
+        const auto &sbl         = m_starBlockList.at(trixel);
+        const quint32 nRecords  = starReader.getRecordCount(trixel);
+        if (sbl->getFaintMag() >= maglim || sbl->getStarCount() >= nRecords)
+            continue;
+
+        const quint32 offset = starReader.getOffset(trixel) + sbl->getStarCount() * recordSize;
+        const quint32 size   = qMin<quint32>((nRecords - sbl->getStarCount()) * recordSize, maxReadAheadBytes - totalBytes);
+        spans.append(qMakePair(offset, size));
+        totalBytes += size;
+    }
+
+    if (spans.isEmpty())
+        return;
+
+    // Page the records in from another thread, so that the fillToMag() calls of the
+    // next draws only copy them from memory.
+    const BinFileHelper *reader = &starReader;
+    m_readAhead = QtConcurrent::run([reader, spans]()
+    {
+        for (const auto &span : spans)
+            reader->readAhead(span.first, span.second);
+    });
+}
+
 bool DeepStarComponent::openDataFile()
 {
     if (starReader.getFileHandle())
@@ -461,6 +527,8 @@ bool DeepStarComponent::openDataFile()
         ret = fread(&MSpT, 2, 1, starReader.getFileHandle());
         if (starReader.getByteSwap())
             MSpT = bswap_16(MSpT);
+        if (!staticStars && !starReader.mapFile())
+            qCInfo(KSTARS) << "Could not map " << dataFileName << ", reading it through the file handle.";
         fileOpened = true;
         qCInfo(KSTARS) << "  Sky Mesh Size: " << m_skyMesh->size();
         for (long int i = 0; i < m_skyMesh->size(); i++)
@@ -22,6 +22,8 @@
 #include "skyobjects/deepstardata.h"
 #include "skyobjects/stardata.h"
 
+#include <QFuture>
+
 class SkyLabeler;
 class SkyMesh;
 class StarBlockFactory;
@@ -102,6 +104,11 @@ class DeepStarComponent : public ListComponent
     static StarBlockFactory m_StarBlockFactory;
 
   private:
+    /**
+     * @short Reads ahead the records of the trixels around the view that are not yet filled to maglim.
+     */
+    void readAhead(SkyPoint *focus, float radius, float maglim);
+
     SkyMesh *m_skyMesh { nullptr };
     KSNumbers m_reindexNum;
 
@@ -131,4 +138,6 @@ class DeepStarComponent : public ListComponent
     StarData stardata;
     BinFileHelper starReader;
     QString dataFileName;
+    /// Background read ahead of the mapped catalog
+    QFuture<void> m_readAhead;
 };
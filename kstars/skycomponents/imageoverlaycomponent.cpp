@@ -7,6 +7,7 @@
 #include "imageoverlaycomponent.h"
 
 #include "kstars.h"
+#include "kstarsdata.h"
 #include "Options.h"
 #include "skypainter.h"
 #include "skymap.h"
@@ -23,6 +24,8 @@
 #include <QtConcurrent>
 #include <QRegularExpression>
 
+#include <algorithm>
+
 #include "ekos/auxiliary/solverutils.h"
 #include "ekos/auxiliary/stellarsolverprofile.h"
 
@@ -49,6 +52,30 @@ enum ColumnIndex
 constexpr int UNPROCESSED_INDEX = 0;
 constexpr int OK_INDEX = 4;
 
+// Mipmap levels at most this many pixels wide and high are kept for all the overlays,
+// the larger ones are loaded when drawn and cached within Options::imageOverlayCacheSize().
+constexpr int RESIDENT_DIMENSION = 256;
+// Smallest mipmap level.
+constexpr int MIN_DIMENSION = 8;
+
+// Size of the next mipmap level.
+QSize reducedSize(const QSize &size)
+{
+    return QSize(std::max(1, size.width() / 2), std::max(1, size.height() / 2));
+}
+
+// The next mipmap level, each pixel is the average of 2x2 pixels.
+QImage reduce(const QImage &image)
+{
+    return image.scaled(reducedSize(image.size()), Qt::IgnoreAspectRatio, Qt::SmoothTransformation);
+}
+
+// QPainter draws these formats without converting them first.
+QImage drawable(const QImage &image)
+{
+    return image.convertToFormat(image.hasAlphaChannel() ? QImage::Format_ARGB32_Premultiplied : QImage::Format_RGB32);
+}
+
 // Helper to create the image overlay table.
 // Start the table, displaying the heading and timing information, common to all sessions.
 void setupTable(QTableWidget *table)
@@ -128,6 +155,13 @@ QString toDecString(double dec)
 }
 }  // namespace
 
+QSizeF ImageOverlay::screenSize(double zoom) const
+{
+    const double a = m_Width * m_ArcsecPerPixel / 60.0;  // This is the width of the image in arcmin--not the major axis
+    const double w = a * dms::PI * zoom / 10800.0;
+    return QSizeF(w, m_Width > 0 ? w * m_Height / m_Width : 0.0);
+}
+
 ImageOverlayComponent::ImageOverlayComponent(SkyComposite *parent) : SkyComponent(parent)
 {
     QDir dir = QDir(KSPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + "/imageOverlays");
@@ -285,14 +319,14 @@ void ImageOverlayComponent::statusCellChanged(int row)
             const QComboBox *ewItem = dynamic_cast<QComboBox*>(m_ImageOverlayTable->cellWidget(row, EAST_TO_RIGHT_COL));
             m_Overlays[row].m_EastToTheRight = ewItem->currentIndex();
 
-            if (m_Overlays[row].m_Img.get() == nullptr)
+            if (!m_Overlays[row].loaded())
             {
                 // Load the image.
                 const QString fullFilename = QString("%1/%2").arg(m_Directory).arg(m_Overlays[row].m_Filename);
-                QImage *img = loadImageFile(fullFilename, !m_Overlays[row].m_EastToTheRight);
-                m_Overlays[row].m_Width = img->width();
-                m_Overlays[row].m_Height = img->height();
-                m_Overlays[row].m_Img.reset(img);
+                const QImage img = loadImageFile(fullFilename, !m_Overlays[row].m_EastToTheRight);
+                m_Overlays[row].m_Width = img.width();
+                m_Overlays[row].m_Height = img.height();
+                setImage(m_Overlays[row], img);
             }
             saveToUserDB();
             QString msg = i18n("Stored OK status for %1.", m_Overlays[row].m_Filename);
@@ -309,6 +343,11 @@ ImageOverlayComponent::~ImageOverlayComponent()
         m_LoadImagesFuture.cancel();
         m_LoadImagesFuture.waitForFinished();
     }
+    {
+        QMutexLocker locker(&m_LevelMutex);
+        m_LevelQueue.clear();
+    }
+    m_LoadLevelsFuture.waitForFinished();
 }
 
 void ImageOverlayComponent::selectionChanged()
@@ -325,13 +364,171 @@ bool ImageOverlayComponent::selected()
 void ImageOverlayComponent::draw(SkyPainter *skyp)
 {
 #if !defined(KSTARS_LITE)
-    if (m_Initialized)
-        skyp->drawImageOverlay(&m_Overlays);
+    if (!m_Initialized)
+        return;
+
+    m_LevelCache.setMaxCost(std::max(1, Options::imageOverlayCacheSize()) * 1024);
+    for (auto &overlay : m_Overlays)
+    {
+        if (overlay.m_Status == ImageOverlay::AVAILABLE)
+            updateCoords(overlay);
+    }
+
+    m_MissingLevels.clear();
+    skyp->drawImageOverlay(this);
+    requestLevels(m_MissingLevels);
 #else
     Q_UNUSED(skyp);
 #endif
 }
 
+void ImageOverlayComponent::updateCoords(ImageOverlay &overlay)
+{
+    // Like the stars, the RA/DEC is converted from j2000 to the epoch of the KSNumbers,
+    // and the az/alt are computed again when the sky is updated.
+    KStarsData *data = KStarsData::Instance();
+    const bool moved = !overlay.m_HasCoord || overlay.m_CoordRA != overlay.m_RA || overlay.m_CoordDEC != overlay.m_DEC;
+    if (moved || overlay.m_CoordNumID != data->updateNumID())
+    {
+        overlay.m_Coord = SkyPoint(dms(overlay.m_RA), dms(overlay.m_DEC));
+        overlay.m_Coord.updateCoordsNow(data->updateNum());
+        overlay.m_CoordNumID = data->updateNumID();
+    }
+    if (moved || overlay.m_CoordID != data->updateID())
+    {
+        overlay.m_Coord.EquatorialToHorizontal(data->lst(), data->geo()->lat());
+        overlay.m_CoordID = data->updateID();
+    }
+    overlay.m_HasCoord = true;
+    overlay.m_CoordRA = overlay.m_RA;
+    overlay.m_CoordDEC = overlay.m_DEC;
+}
+
+QImage ImageOverlayComponent::image(const ImageOverlay &overlay, const QSizeF &screenSize)
+{
+    if (!overlay.loaded())
+        return QImage();
+
+    // The smallest level that is not magnified.
+    const int lastLevel = overlay.m_FirstResidentLevel + overlay.m_Levels.size() - 1;
+    int level = 0;
+    QSize size = overlay.m_LoadedSize;
+    while (level < lastLevel && reducedSize(size).width() >= screenSize.width()
+            && reducedSize(size).height() >= screenSize.height())
+    {
+        size = reducedSize(size);
+        level++;
+    }
+
+    if (level >= overlay.m_FirstResidentLevel)
+        return overlay.m_Levels[level - overlay.m_FirstResidentLevel];
+
+    const bool mirror = !overlay.m_EastToTheRight;
+    const LevelKey key { overlay.m_Filename, mirror, level };
+    if (QImage *cached = m_LevelCache.object(key))
+        return *cached;
+
+    // Levels that would not fit in the cache are never loaded.
+    const qint64 kib = static_cast<qint64>(size.width()) * size.height() * 4 / 1024;
+    if (kib <= m_LevelCache.maxCost() && !m_UnreadableLevels.contains(key))
+        m_MissingLevels.append(key);
+
+    // Meanwhile, a finer level if one is cached, else the largest resident one.
+    for (int finer = level - 1; finer >= 0; finer--)
+    {
+        if (QImage *cached = m_LevelCache.object({ overlay.m_Filename, mirror, finer }))
+            return *cached;
+    }
+    return overlay.m_Levels.first();
+}
+
+void ImageOverlayComponent::requestLevels(const QList<LevelKey> &keys)
+{
+    QMutexLocker locker(&m_LevelMutex);
+
+    // Only the levels drawn now are worth loading, overlays panned away are forgotten.
+    m_LevelQueue.clear();
+    for (const auto &key : keys)
+    {
+        if (!m_LevelsLoading.contains(key) && !m_LevelQueue.contains(key))
+            m_LevelQueue.append(key);
+    }
+
+    if (!m_LoadingLevels && !m_LevelQueue.isEmpty())
+    {
+        m_LoadingLevels = true;
+        m_LoadLevelsFuture = QtConcurrent::run([this]()
+        {
+            loadLevels();
+        });
+    }
+}
+
+void ImageOverlayComponent::loadLevels()
+{
+    for (;;)
+    {
+        QList<LevelKey> keys;
+        {
+            QMutexLocker locker(&m_LevelMutex);
+            if (m_LevelQueue.isEmpty())
+            {
+                m_LoadingLevels = false;
+                return;
+            }
+
+            // All the levels queued for a file are reduced from a single read.
+            keys.append(m_LevelQueue.takeFirst());
+            for (int i = 0; i < m_LevelQueue.size();)
+            {
+                if (m_LevelQueue[i].filename == keys.first().filename && m_LevelQueue[i].mirror == keys.first().mirror)
+                    keys.append(m_LevelQueue.takeAt(i));
+                else
+                    i++;
+            }
+            for (const auto &key : keys)
+                m_LevelsLoading.insert(key);
+        }
+
+        std::sort(keys.begin(), keys.end(), [](const LevelKey & a, const LevelKey & b)
+        {
+            return a.level < b.level;
+        });
+
+        const QString fullFilename = QString("%1/%2").arg(m_Directory).arg(keys.first().filename);
+        QImage image = drawable(loadImageFile(fullFilename, keys.first().mirror));
+        int level = 0;
+        for (const auto &key : keys)
+        {
+            for (; level < key.level && !image.isNull(); level++)
+                image = reduce(image);
+
+            // The cache is only used from the GUI thread.
+            QMetaObject::invokeMethod(this, [this, key, image]()
+            {
+                levelLoaded(key, image);
+            }, Qt::QueuedConnection);
+        }
+    }
+}
+
+void ImageOverlayComponent::levelLoaded(const LevelKey &key, const QImage &image)
+{
+    {
+        QMutexLocker locker(&m_LevelMutex);
+        m_LevelsLoading.remove(key);
+    }
+
+    if (image.isNull())
+    {
+        m_UnreadableLevels.insert(key);
+        return;
+    }
+
+    m_LevelCache.insert(key, new QImage(image), std::max<int>(1, image.sizeInBytes() / 1024));
+    SkyMap::Instance()->forceUpdate();
+}
+
 void ImageOverlayComponent::setWidgets(QTableWidget *table, QPlainTextEdit *statusDisplay,
                                        QPushButton *solveButton, QGroupBox *tableGroupBox,
                                        QComboBox *solverProfile)
@@ -462,7 +659,7 @@ void ImageOverlayComponent::loadImageFileLoop()
     while (loadImageFile());
     int num = 0;
     for (const auto &o : m_Overlays)
-        if (o.m_Img.get() != nullptr)
+        if (o.loaded())
             num++;
     emit updateLog(i18n("%1 image files loaded.", num));
     // Restore editing for the table.
@@ -470,18 +667,38 @@ void ImageOverlayComponent::loadImageFileLoop()
     m_Initialized = true;
 }
 
-QImage *ImageOverlayComponent::loadImageFile (const QString &fullFilename, bool mirror)
+QImage ImageOverlayComponent::loadImageFile (const QString &fullFilename, bool mirror)
 {
-    QSharedPointer<QImage> tempImage(new QImage(fullFilename));
-    if (tempImage.get() == nullptr) return nullptr;
-    int scaleWidth = std::min(tempImage->width(), Options::imageOverlayMaxDimension());
-    QImage *processedImg = new QImage;
+    const QImage tempImage(fullFilename);
+    if (tempImage.isNull()) return tempImage;
+    int scaleWidth = std::min(tempImage.width(), Options::imageOverlayMaxDimension());
     if (mirror)
-        *processedImg = tempImage->mirrored(true, false).scaledToWidth(scaleWidth); // It's reflected horizontally.
+        return tempImage.mirrored(true, false).scaledToWidth(scaleWidth); // It's reflected horizontally.
     else
-        *processedImg = tempImage->scaledToWidth(scaleWidth);
+        return tempImage.scaledToWidth(scaleWidth);
+}
+
+// Keeps the small mipmap levels of the image in the overlay. The larger ones are loaded again when needed.
+void ImageOverlayComponent::setImage(ImageOverlay &overlay, const QImage &image)
+{
+    overlay.m_Levels.clear();
+    overlay.m_LoadedSize = image.size();
+    overlay.m_FirstResidentLevel = 0;
+    if (image.isNull())
+        return;
 
-    return processedImg;
+    QImage level = drawable(image);
+    while (std::max(level.width(), level.height()) > RESIDENT_DIMENSION)
+    {
+        level = reduce(level);
+        overlay.m_FirstResidentLevel++;
+    }
+    overlay.m_Levels.append(level);
+    while (std::max(level.width(), level.height()) > MIN_DIMENSION)
+    {
+        level = reduce(level);
+        overlay.m_Levels.append(level);
+    }
 }
 
 bool ImageOverlayComponent::loadImageFile()
@@ -490,12 +707,13 @@ bool ImageOverlayComponent::loadImageFile()
 
     for (auto &o : m_Overlays)
     {
-        if (o.m_Status == o.ImageOverlay::AVAILABLE && o.m_Img.get() == nullptr)
+        if (o.m_Status == o.ImageOverlay::AVAILABLE && !o.loaded())
         {
             QString fullFilename = QString("%1%2%3").arg(m_Directory).arg(QDir::separator()).arg(o.m_Filename);
-            QImage *img = loadImageFile(fullFilename, !o.m_EastToTheRight);
-            o.m_Img.reset(img);
-            updatedSomething = true;
+            const QImage img = loadImageFile(fullFilename, !o.m_EastToTheRight);
+            setImage(o, img);
+            // Files that can't be read are not tried again.
+            updatedSomething = updatedSomething || !img.isNull();
 
             // Note: The original width and height in o.m_Width/m_Height is kept even
             // though the image was rescaled. This is to get the rendering right
@@ -681,7 +899,7 @@ void ImageOverlayComponent::show()
                 emit updateLog(i18n("Can't show %1. Not plate solved.", m_Overlays[row].m_Filename));
                 return;
             }
-            if (m_Overlays[row].m_Img.get() == nullptr)
+            if (!m_Overlays[row].loaded())
             {
                 emit updateLog(i18n("Can't show %1. Image not loaded.", m_Overlays[row].m_Filename));
                 return;
@@ -847,10 +1065,14 @@ void ImageOverlayComponent::solverDone(bool timedOut, bool success, const FITSIm
         QComboBox *statusItem = dynamic_cast<QComboBox*>(m_ImageOverlayTable->cellWidget(solverRow, STATUS_COL));
         statusItem->setCurrentIndex(static_cast<int>(overlay.m_Status));
 
-        // Load the image.
+        // Load the image, the levels cached from the previous solution may be mirrored differently.
         QString fullFilename = QString("%1/%2").arg(m_Directory).arg(m_Overlays[solverRow].m_Filename);
-        QImage *img = loadImageFile(fullFilename, !m_Overlays[solverRow].m_EastToTheRight);
-        m_Overlays[solverRow].m_Img.reset(img);
+        setImage(m_Overlays[solverRow], loadImageFile(fullFilename, !m_Overlays[solverRow].m_EastToTheRight));
+        for (const auto &key : m_LevelCache.keys())
+        {
+            if (key.filename == m_Overlays[solverRow].m_Filename)
+                m_LevelCache.remove(key);
+        }
     }
     saveToUserDB();
 
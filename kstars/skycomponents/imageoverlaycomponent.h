@@ -8,6 +8,9 @@
 
 #include "imageoverlaycomponent.h"
 #include "skycomponent.h"
+#include <QCache>
+#include <QMutex>
+#include <QSet>
 #include <QSharedPointer>
 #include <QImage>
 #include <QObject>
@@ -56,7 +59,30 @@ class ImageOverlay
         bool m_EastToTheRight = true;
         int m_Width = 0;
         int m_Height = 0;
-        QSharedPointer<QImage> m_Img = nullptr;
+
+        /** @return true once the image file was loaded. */
+        bool loaded() const
+        {
+            return !m_Levels.isEmpty();
+        }
+
+        /** @return the size in screen pixels of the whole image at the zoom factor. */
+        QSizeF screenSize(double zoom) const;
+
+        // The loaded image, at most ImageOverlayMaxDimension wide, is reduced by powers of two. Only the
+        // levels that fit RESIDENT_DIMENSION are kept here, from level m_FirstResidentLevel, the larger
+        // ones are loaded on demand and cached by ImageOverlayComponent.
+        QSize m_LoadedSize;
+        int m_FirstResidentLevel = 0;
+        QVector<QImage> m_Levels;
+
+        // Apparent and horizontal coordinates, see ImageOverlayComponent::updateCoords().
+        SkyPoint m_Coord;
+        bool m_HasCoord = false;
+        double m_CoordRA = 0.0;
+        double m_CoordDEC = 0.0;
+        unsigned int m_CoordNumID = 0;
+        unsigned int m_CoordID = 0;
 };
 
 /**
@@ -84,6 +110,13 @@ class ImageOverlayComponent : public QObject, public SkyComponent
         return m_Overlays;
     }
 
+    /**
+     * @brief image The level of the overlay's mipmap to draw it at the given size in screen pixels.
+     * When that level isn't cached it is loaded in the background, and a coarser level is returned meanwhile.
+     * Only called from the GUI thread while drawing.
+     */
+    QImage image(const ImageOverlay &overlay, const QSizeF &screenSize);
+
     public slots:
     void startSolving();
     void abortSolving();
@@ -117,7 +150,34 @@ private:
     void loadAllImageFiles();
     void loadImageFileLoop();
     bool loadImageFile();
-    QImage *loadImageFile (const QString &fullFilename, bool mirror);
+    QImage loadImageFile (const QString &fullFilename, bool mirror);
+    void setImage(ImageOverlay &overlay, const QImage &image);
+    void updateCoords(ImageOverlay &overlay);
+
+    // Mipmap levels larger than the resident ones, loaded in the background.
+    struct LevelKey
+    {
+        QString filename;
+        bool mirror;
+        int level;
+
+        bool operator==(const LevelKey &other) const
+        {
+            return level == other.level && mirror == other.mirror && filename == other.filename;
+        }
+
+        friend uint qHash(const LevelKey &key, uint seed = 0)
+        {
+            return ::qHash(key.filename, seed) ^ ::qHash((key.level << 1) | (key.mirror ? 1 : 0), seed);
+        }
+    };
+    void requestLevels(const QList<LevelKey> &keys);
+    void loadLevels();
+    void levelLoaded(const LevelKey &key, const QImage &image);
+
+    // Levels image() didn't find in the cache during the current draw.
+    QList<LevelKey> m_MissingLevels;
+    QSet<LevelKey> m_UnreadableLevels;
 
 
     QTableWidget *m_ImageOverlayTable;
@@ -136,4 +196,14 @@ private:
     QString m_Directory;
     QTimer m_TryAgainTimer;
     QFuture<void> m_LoadImagesFuture;
+
+    // Only used from the GUI thread, the cost is in KiB.
+    QCache<LevelKey, QImage> m_LevelCache;
+
+    // Shared with the level loader
+    QMutex m_LevelMutex;
+    QList<LevelKey> m_LevelQueue;
+    QSet<LevelKey> m_LevelsLoading;
+    bool m_LoadingLevels = false;
+    QFuture<void> m_LoadLevelsFuture;
 };
@@ -85,9 +85,11 @@ void SatellitesComponent::update(KSNumbers *)
     if (!selected())
         return;
 
+    // The observer and the Sun are computed once for all the satellites.
+    const Satellite::Frame frame = Satellite::currentFrame();
     foreach (SatelliteGroup *group, m_groups)
     {
-        group->updateSatellitesPos();
+        group->updateSatellitesPos(frame);
     }
 }
 
@@ -52,6 +52,7 @@
 #endif
 
 #include <QApplication>
+#include <QElapsedTimer>
 
 #include <kstars_debug.h>
 
@@ -248,6 +249,17 @@ void SkyMapComposite::draw(SkyPainter *skyp)
     SkyMap *map      = SkyMap::Instance();
     KStarsData *data = KStarsData::Instance();
 
+    QElapsedTimer frameTimer;
+    frameTimer.start();
+    qint64 lap = 0;
+    // Attributes the time since the previous call to the named part of the frame.
+    auto profile = [&](const QString & name)
+    {
+        const qint64 now = frameTimer.nsecsElapsed();
+        addDrawTime(name, now - lap);
+        lap = now;
+    };
+
     // We delay one draw cycle before re-indexing
     // we MUST ensure CLines do not get re-indexed while we use DRAW_BUF
     // so we do it here.
@@ -308,18 +320,28 @@ void SkyMapComposite::draw(SkyPainter *skyp)
             }
     }
 
+    // The stars are updated on the thread pool while the components below them are painted.
+    m_Stars->prepare();
+    profile("Setup");
+
     m_MilkyWay->draw(skyp);
+    profile("Milky Way");
 
     // Draw HIPS after milky way but before everything else
     m_HiPS->draw(skyp);
+    profile("HiPS");
 
     if (Options::showImageOverlaysBelowCatalogs())
+    {
         // Draw fits overlay.
         m_ImageOverlay->draw(skyp);
+        profile("Image overlays");
+    }
 
     m_EquatorialCoordinateGrid->draw(skyp);
     m_HorizontalCoordinateGrid->draw(skyp);
     m_LocalMeridianComponent->draw(skyp);
+    profile("Coordinate grids");
 
     //Draw constellation boundary lines only if we draw western constellations
     if (m_Cultures->current() == "Western")
@@ -333,27 +355,36 @@ void SkyMapComposite::draw(SkyPainter *skyp)
     }
 
     m_CLines->draw(skyp);
+    profile("Constellations");
 
     m_Equator->draw(skyp);
 
     m_Ecliptic->draw(skyp);
+    profile("Equator and ecliptic");
 
     m_Catalogs->draw(skyp);
+    profile("Catalogs");
 
     m_Stars->draw(skyp);
+    profile("Stars");
+    addDrawTime("Stars update (thread pool)", m_Stars->prepareTime());
 
     m_SolarSystem->drawTrails(skyp);
     m_SolarSystem->draw(skyp);
+    profile("Solar system");
 
     m_Satellites->draw(skyp);
+    profile("Satellites");
 
     m_Supernovae->draw(skyp);
+    profile("Supernovae");
 
     map->drawObjectLabels(labelObjects());
 
     m_skyLabeler->drawQueuedLabels();
     m_CNames->draw(skyp);
     m_Stars->drawLabels();
+    profile("Labels");
 
     m_ObservingList->pen =
         QPen(QColor(data->colorScheme()->colorNamed("ObsListColor")), 1.);
@@ -365,23 +396,32 @@ void SkyMapComposite::draw(SkyPainter *skyp)
     m_StarHopRouteList->pen =
         QPen(QColor(data->colorScheme()->colorNamed("StarHopRouteColor")), 1.);
     m_StarHopRouteList->draw(skyp);
+    profile("Observing list and flags");
 
     if (!Options::showImageOverlaysBelowCatalogs())
+    {
         // Draw fits overlay before mosaic and terrain/horizon, but after most things.
         m_ImageOverlay->draw(skyp);
+        profile("Image overlays");
+    }
 
 #ifdef HAVE_INDI
     m_Mosaic->draw(skyp);
+    profile("Mosaic");
 #endif
 
     m_ArtificialHorizon->draw(skyp);
 
     m_Horizon->draw(skyp);
+    profile("Horizon");
 
     m_skyMesh->inDraw(false);
 
     // Draw terrain at the end.
     m_Terrain->draw(skyp);
+    profile("Terrain");
+
+    addDrawTime("Frame", frameTimer.nsecsElapsed());
 
     // DEBUG Edit. Keywords: Trixel boundaries. Currently works only in QPainter mode
     // -jbb uncomment these to see trixel outlines:
@@ -406,6 +446,29 @@ void SkyMapComposite::draw(SkyPainter *skyp)
 #endif
 }
 
+void SkyMapComposite::addDrawTime(const QString &name, qint64 nsecs)
+{
+    const double ms = nsecs / 1e6;
+    for (auto &time : m_DrawProfile)
+    {
+        if (time.name == name)
+        {
+            time.last = ms;
+            time.average += 0.1 * (ms - time.average);
+            return;
+        }
+    }
+    m_DrawProfile.append({ name, ms, ms });
+}
+
+QString SkyMapComposite::drawProfileText() const
+{
+    QStringList lines;
+    for (const auto &time : m_DrawProfile)
+        lines << QString("%1: %2 ms (average %3 ms)").arg(time.name).arg(time.last, 0, 'f', 2).arg(time.average, 0, 'f', 2);
+    return lines.join('\n');
+}
+
 //Select nearest object to the given skypoint, but give preference
 //to certain object types.
 //we multiply each object type's smallest angular distance by the
@@ -112,6 +112,28 @@ class SkyMapComposite : public QObject, public SkyComposite
              */
         void draw(SkyPainter *skyp) override;
 
+        /**
+         * @struct DrawTime
+         * Time spent drawing a part of the sky map, the stars are also updated on the thread pool.
+         */
+        struct DrawTime
+        {
+            QString name;
+            /// Last frame [ms]
+            double last { 0 };
+            /// Exponential moving average over the last frames [ms]
+            double average { 0 };
+        };
+
+        /** @return the time spent in each part of draw(), in drawing order, and the whole frame last */
+        const QVector<DrawTime> &drawProfile() const
+        {
+            return m_DrawProfile;
+        }
+
+        /** @return drawProfile() as text, one part per line */
+        QString drawProfileText() const;
+
         /**
              * @return the object nearest a given point in the sky.
              * @param p The point to find an object near
@@ -274,6 +296,7 @@ class SkyMapComposite : public QObject, public SkyComposite
 
     private:
         QHash<int, QStringList> &getObjectNames() override;
+        void addDrawTime(const QString &name, qint64 nsecs);
         QHash<int, QVector<QPair<QString, const SkyObject *>>> &getObjectLists() override;
 
         std::unique_ptr<CultureList> m_Cultures;
@@ -317,4 +340,6 @@ class SkyMapComposite : public QObject, public SkyComposite
         QHash<int, QStringList> m_ObjectNames;
         QHash<int, QVector<QPair<QString, const SkyObject *>>> m_ObjectLists;
         QHash<QString, QString> m_ConstellationNames;
+
+        QVector<DrawTime> m_DrawProfile;
 };
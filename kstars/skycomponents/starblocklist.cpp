@@ -18,6 +18,8 @@
 
 #include <QDebug>
 
+#include <cstring>
+
 StarBlockList::StarBlockList(const Trixel &tr, DeepStarComponent *parent)
 {
     trixel       = tr;
@@ -92,7 +94,11 @@ bool StarBlockList::fillToMag(float maglim)
 
     Q_ASSERT(nBlocks == (unsigned int)blocks.size());
 
-    BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
+    // With a mapped catalog, the records are copied straight from memory instead of read one by one.
+    const bool isStarData = dSReader->guessRecordSize() == 32;
+    const uchar *record   = dSReader->getRecords(readOffset, dSReader->getRecordCount(trixelId) - nStars);
+    if (!record)
+        BinFileHelper::unsigned_KDE_fseek(dataFile, readOffset, SEEK_SET);
 
     /*
     qDebug() << Q_FUNC_INFO << "Reading trixel" << trixel << ", id on disk =" << trixelId << ", currently nStars =" << nStars
@@ -124,9 +130,15 @@ bool StarBlockList::fillToMag(float maglim)
             ++nBlocks;
         }
         // TODO: Make this more general
-        if (dSReader->guessRecordSize() == 32)
+        if (isStarData)
         {
-            ret = fread(&stardata, sizeof(StarData), 1, dataFile);
+            if (record)
+            {
+                memcpy(&stardata, record, sizeof(StarData));
+                record += sizeof(StarData);
+            }
+            else
+                ret = fread(&stardata, sizeof(StarData), 1, dataFile);
             if (dSReader->getByteSwap())
                 DeepStarComponent::byteSwap(&stardata);
             readOffset += sizeof(StarData);
@@ -134,7 +146,13 @@ bool StarBlockList::fillToMag(float maglim)
         }
         else
         {
-            ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
+            if (record)
+            {
+                memcpy(&deepstardata, record, sizeof(DeepStarData));
+                record += sizeof(DeepStarData);
+            }
+            else
+                ret = fread(&deepstardata, sizeof(DeepStarData), 1, dataFile);
             if (dSReader->getByteSwap())
                 DeepStarComponent::byteSwap(&deepstardata);
             readOffset += sizeof(DeepStarData);
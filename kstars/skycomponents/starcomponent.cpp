@@ -43,6 +43,9 @@
 // Qt version calming
 #include <qtskipemptyparts.h>
 
+#include <QElapsedTimer>
+#include <QtConcurrent>
+
 StarComponent *StarComponent::pinstance = nullptr;
 
 StarComponent::StarComponent(SkyComposite *parent)
@@ -79,6 +82,7 @@ StarComponent::StarComponent(SkyComposite *parent)
 
 StarComponent::~StarComponent()
 {
+    m_PrepareFuture.waitForFinished();
     qDeleteAll(*m_starIndex);
     m_starIndex->clear();
     qDeleteAll(m_DeepStarComponents);
@@ -248,9 +252,62 @@ float StarComponent::zoomMagnitudeLimit()
     return 3.5 + 3.7 * (lgz - lgmin) + 2.222 * log10(static_cast<float>(Options::starDensity()));
 }
 
+void StarComponent::prepare()
+{
+#ifndef KSTARS_LITE
+    m_PrepareFuture.waitForFinished();
+    m_PrepareTime = 0;
+
+    if (!selected() || (Options::showHIPS() && !Options::showStarsOverHIPS()))
+        return;
+
+    KStarsData *data  = KStarsData::Instance();
+    UpdateID updateID = data->updateID();
+
+    // Reindexing uses the sky mesh, which the other components use while the stars are updated.
+    reindex(data->updateNum());
+
+    // Same magnitude limit as draw().
+    SkyMap *map   = SkyMap::Instance();
+    double maglim = zoomMagnitudeLimit();
+    if (map->isSlewing() && Options::hideOnSlew() && Options::hideStars() && maglim > Options::magLimitHideStar())
+        maglim = Options::magLimitHideStar();
+
+    QVector<Trixel> trixels;
+    MeshIterator region(m_skyMesh, DRAW_BUF);
+    while (region.hasNext())
+        trixels.append(region.next());
+
+    // Each star is in a single trixel, and JITupdate() only modifies the star.
+    m_PrepareFuture = QtConcurrent::run([this, trixels, maglim, updateID]() mutable
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        QtConcurrent::blockingMap(trixels, [this, maglim, updateID](Trixel trixel)
+        {
+            for (auto &star : *m_starIndex->at(trixel))
+            {
+                if (!star)
+                    continue;
+                if (star->mag() > maglim)
+                    break;
+                if (star->updateID != updateID)
+                    star->JITupdate();
+            }
+        });
+
+        m_PrepareTime = timer.nsecsElapsed();
+    });
+#endif
+}
+
 void StarComponent::draw(SkyPainter *skyp)
 {
 #ifndef KSTARS_LITE
+    // The stars are updated by prepare() when SkyMapComposite draws them.
+    m_PrepareFuture.waitForFinished();
+
     if (!selected())
         return;
 
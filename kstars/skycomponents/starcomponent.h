@@ -12,6 +12,8 @@
 #include "stardata.h"
 #include "skyobjects/starobject.h"
 
+#include <QFuture>
+
 #include <memory>
 
 #ifdef KSTARS_LITE
@@ -71,6 +73,19 @@ class StarComponent : public ListComponent
 
     void draw(SkyPainter *skyp) override;
 
+    /**
+     * @short Starts updating, on the thread pool, the coordinates of the stars that draw() will draw.
+     * Called on the GUI thread once the sky mesh has the draw aperture, so that the update runs while
+     * the components drawn before the stars are painted. draw() waits for it to finish.
+     */
+    void prepare();
+
+    /** @return the time, in nanoseconds, the last prepare() took on the thread pool */
+    qint64 prepareTime() const
+    {
+        return m_PrepareTime;
+    }
+
     /**
      * @short draw all the labels in the prioritized LabelLists and then clear the LabelLists.
      */
@@ -178,6 +193,9 @@ class StarComponent : public ListComponent
 
     StarBlockFactory *m_StarBlockFactory { nullptr };
 
+    QFuture<void> m_PrepareFuture;
+    qint64 m_PrepareTime { 0 };
+
     QVector<HighPMStarList *> m_highPMStars;
     QHash<QString, SkyObject *> m_genName;
     QHash<int, StarObject *> m_HDHash;
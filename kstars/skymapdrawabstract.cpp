@@ -12,6 +12,7 @@
 #include <QPainter>
 #include <QPixmap>
 #include <QPainterPath>
+#include <QFontDatabase>
 
 #include "skymapdrawabstract.h"
 #include "skymap.h"
@@ -103,6 +104,33 @@ void SkyMapDrawAbstract::drawOverlays(QPainter &p, bool drawFov)
         m_SkyMap->updateAngleRuler();
         drawAngleRuler(p);
     }
+
+    if (Options::showSkyMapProfile())
+        drawProfile(p);
+}
+
+void SkyMapDrawAbstract::drawProfile(QPainter &p)
+{
+    const QString text = m_KStarsData->skyComposite()->drawProfileText();
+    if (text.isEmpty())
+        return;
+
+    p.save();
+    p.setFont(QFontDatabase::systemFont(QFontDatabase::FixedFont));
+
+    // Bottom left, where no info box is by default.
+    constexpr int margin = 10, padding = 4;
+    QRect box = p.fontMetrics().boundingRect(QRect(0, 0, p.viewport().width(), p.viewport().height()),
+                Qt::AlignLeft | Qt::AlignTop, text);
+    box.adjust(-padding, -padding, padding, padding);
+    box.moveTo(margin, p.viewport().height() - box.height() - margin);
+
+    QColor background = m_KStarsData->colorScheme()->colorNamed("BoxBGColor");
+    background.setAlpha(192);
+    p.fillRect(box, background);
+    p.setPen(m_KStarsData->colorScheme()->colorNamed("BoxTextColor"));
+    p.drawText(box.adjusted(padding, padding, -padding, -padding), Qt::AlignLeft | Qt::AlignTop, text);
+    p.restore();
 }
 
 void SkyMapDrawAbstract::drawDomeSlits(QPainter &psky)
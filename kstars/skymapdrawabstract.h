@@ -85,6 +85,12 @@ class SkyMapDrawAbstract
             	*/
         void drawZoomBox(QPainter &psky);
 
+        /**
+         * @short Draw the time spent drawing each part of the sky map, see SkyMapComposite::drawProfile().
+         * @param p reference to the QPainter on which to draw (this should be the sky map)
+         */
+        void drawProfile(QPainter &p);
+
         /**Draw a dashed line from the Angular-Ruler start point to the current mouse cursor,
             	*when in Angular-Ruler mode.
             	*@param psky reference to the QPainter on which to draw (this should be the Sky pixmap).
@@ -702,30 +702,127 @@ void Satellite::init()
     }
 }
 
-int Satellite::updatePos()
+Satellite::Frame::Frame(const KStarsDateTime &ut, const GeoLocation *geo)
 {
-    KStarsData *data = KStarsData::Instance();
-    return sgp4((data->clock()->utc().djd() - m_tle_jd) * MINPD);
+    jd  = ut.djd();
+    lst = geo->GSTtoLST(ut.gst());
+    lat = geo->lat();
+
+    // Observer ECI position
+    sinLat   = sin(geo->lat()->radians());
+    cosLat   = cos(geo->lat()->radians());
+    const double thetageo = geo->LMST(jd);
+    sinTheta = sin(thetageo);
+    cosTheta = cos(thetageo);
+    const double c     = 1.0 / sqrt(1.0 + F * (F - 2.0) * sinLat * sinLat);
+    const double sq    = (1.0 - F) * (1.0 - F) * c;
+    const double achcp = (RADIUSEARTHKM * c + MEANALT) * cosLat;
+    obsX = achcp * cosTheta;
+    obsY = achcp * sinTheta;
+    obsZ = (RADIUSEARTHKM * sq + MEANALT) * sinLat;
+    obsW = sqrt(obsX * obsX + obsY * obsY + obsZ * obsZ);
+
+    // Find ECI coordinates of the sun
+    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
+
+    mjd  = jd - 2415020.0;
+    year = 1900.0 + mjd / 365.25;
+    T    = (mjd + deltaET(year) / (MINPD * 60.0)) / 36525.0;
+    M    = DEG2RAD * (Modulus(358.47583 + Modulus(35999.04975 * T, 360.0) - (0.000150 + 0.0000033 * T) * T * T, 360.0));
+    L    = DEG2RAD * (Modulus(279.69668 + Modulus(36000.76892 * T, 360.0) + 0.0003025 * T * T, 360.0));
+    e    = 0.01675104 - (0.0000418 + 0.000000126 * T) * T;
+    C    = DEG2RAD * ((1.919460 - (0.004789 + 0.000014 * T) * T) * sin(M) + (0.020094 - 0.000100 * T) * sin(2 * M) +
+                      0.000293 * sin(3 * M));
+    O    = DEG2RAD * (Modulus(259.18 - 1934.142 * T, 360.0));
+    Lsa  = Modulus(L + C - DEG2RAD * (0.00569 - 0.00479 * sin(O)), TWOPI);
+    nu   = Modulus(M + C, TWOPI);
+    R    = 1.0000002 * (1.0 - e * e) / (1.0 + e * cos(nu));
+    eps  = DEG2RAD * (23.452294 - (0.0130125 + (0.00000164 - 0.000000503 * T) * T) * T + 0.00256 * cos(O));
+    R    = AU * R;
+
+    sunX = R * cos(Lsa);
+    sunY = R * sin(Lsa) * cos(eps);
+    sunZ = R * sin(Lsa) * sin(eps);
+    sunW = R;
+
+    // Same topocentric elevation as the satellites, the parallax of the Sun is negligible.
+    const double top_z = cosLat * cosTheta * sunX + cosLat * sinTheta * sunY + sinLat * sunZ;
+    sunAltitude = arcSin(top_z / sunW) / DEG2RAD;
 }
 
-int Satellite::sgp4(double tsince)
+Satellite::Frame Satellite::Frame::after(double seconds) const
+{
+    Frame frame(*this);
+    frame.jd += seconds / (MINPD * 60.0);
+
+    const double rotation = MFACTOR * seconds;
+    const double sinRotation = sin(rotation), cosRotation = cos(rotation);
+    frame.lst      = dms(lst.Degrees() + rotation / DEG2RAD).reduce();
+    frame.sinTheta = sinTheta * cosRotation + cosTheta * sinRotation;
+    frame.cosTheta = cosTheta * cosRotation - sinTheta * sinRotation;
+    frame.obsX     = obsX * cosRotation - obsY * sinRotation;
+    frame.obsY     = obsY * cosRotation + obsX * sinRotation;
+
+    const double top_z = cosLat * frame.cosTheta * sunX + cosLat * frame.sinTheta * sunY + sinLat * sunZ;
+    frame.sunAltitude  = arcSin(top_z / sunW) / DEG2RAD;
+    return frame;
+}
+
+Satellite::Frame Satellite::currentFrame()
 {
     KStarsData *data = KStarsData::Instance();
+    Frame frame(data->clock()->utc(), data->geo());
+
+    // Use the same Sun as the sky map.
+    KSSun *sun = dynamic_cast<KSSun *>(data->skyComposite()->findByName(i18n("Sun")));
+    if (sun != nullptr)
+        frame.sunAltitude = sun->alt().Degrees();
+    return frame;
+}
+
+int Satellite::updatePos()
+{
+    return updatePos(currentFrame());
+}
+
+int Satellite::updatePos(const Frame &frame)
+{
+    Position position;
+    const int rc = sgp4((frame.jd - m_tle_jd) * MINPD, frame, &position);
+    if (rc != 0)
+        return rc;
+
+    m_velocity    = position.velocity;
+    m_altitude    = position.height;
+    m_range       = position.range;
+    m_is_eclipsed = position.eclipsed;
+    m_is_visible  = position.visible;
+
+    setAz(position.az);
+    setAlt(position.alt);
+    HorizontalToEquatorial(&frame.lst, frame.lat);
+
+    return 0;
+}
 
+int Satellite::position(const Frame &frame, Position *position)
+{
+    return sgp4((frame.jd - m_tle_jd) * MINPD, frame, position);
+}
+
+int Satellite::sgp4(double tsince, const Frame &frame, Position *position)
+{
     int ktr;
     double am, axnl, aynl, betal, cosim, cnod, cos2u, coseo1 = 0, cosi, cosip, cosisq, cossu, cosu, delm, delomg, em,
                                                       ecose, el2, eo1, ep, esine, argpm, argpp, argpdf, pl,
                                                       mrt = 0.0, mvt, rdotl, rl, rvdot, rvdotl, sinim, dndt, sin2u, sineo1 = 0, sini, sinip, sinsu, sinu, snod, su, t2,
                                                       t3, t4, tem5, temp, temp1, temp2, tempa, tempe, templ, u, ux, uy, uz, vx, vy, vz, inclm, mm, nm, nodem, xinc,
                                                       xincp, xl, xlm, mp, xmdf, xmx, xmy, nodedf, xnode, nodep, tc, sat_posx, sat_posy, sat_posz, sat_posw, sat_velx,
-                                                      sat_vely, sat_velz, sinlat, obs_posx, obs_posy, obs_posz, obs_posw, /*obs_velx, obs_vely, obs_velz,*/
-                                                      coslat, thetageo, sintheta, costheta, c, sq, achcp, vkmpersec;
+                                                      sat_vely, sat_velz, vkmpersec;
     //    double emsq;
 
     const double temp4 = 1.5e-12;
 
-    double jul_utc = data->clock()->utc().djd();
-
     vkmpersec = RADIUSEARTHKM * XKE / 60.0;
 
     // Update for secular gravity and atmospheric drag
@@ -1118,7 +1215,7 @@ int Satellite::sgp4(double tsince)
     sat_velx   = (mvt * ux + rvdot * vx) * vkmpersec;
     sat_vely   = (mvt * uy + rvdot * vy) * vkmpersec;
     sat_velz   = (mvt * uz + rvdot * vz) * vkmpersec;
-    m_velocity = sqrt(sat_velx * sat_velx + sat_vely * sat_vely + sat_velz * sat_velz);
+    position->velocity = sqrt(sat_velx * sat_velx + sat_vely * sat_vely + sat_velz * sat_velz);
 
     //     printf("tsince=%.15f\n", tsince);
     //     printf("sat_posx=%.15f\n", sat_posx);
@@ -1134,33 +1231,22 @@ int Satellite::sgp4(double tsince)
         return (6);
     }
 
-    // Observer ECI position and velocity
-    sinlat   = sin(data->geo()->lat()->radians());
-    coslat   = cos(data->geo()->lat()->radians());
-    thetageo = data->geo()->LMST(jul_utc);
-    sintheta = sin(thetageo);
-    costheta = cos(thetageo);
-    c        = 1.0 / sqrt(1.0 + F * (F - 2.0) * sinlat * sinlat);
-    sq       = (1.0 - F) * (1.0 - F) * c;
-    achcp    = (RADIUSEARTHKM * c + MEANALT) * coslat;
-    obs_posx = achcp * costheta;
-    obs_posy = achcp * sintheta;
-    obs_posz = (RADIUSEARTHKM * sq + MEANALT) * sinlat;
-    obs_posw = sqrt(obs_posx * obs_posx + obs_posy * sat_posy + obs_posz * obs_posz);
-    /*obs_velx = -MFACTOR * obs_posy;
-    obs_vely = MFACTOR * obs_posx;
-    obs_velz = 0.;*/
-
-    m_altitude = sat_posw - obs_posw + MEANALT;
+    // Observer ECI position, computed once for all the satellites
+    const double sinlat   = frame.sinLat;
+    const double coslat   = frame.cosLat;
+    const double sintheta = frame.sinTheta;
+    const double costheta = frame.cosTheta;
+    const double obs_posx = frame.obsX;
+    const double obs_posy = frame.obsY;
+    const double obs_posz = frame.obsZ;
+
+    position->height = sat_posw - frame.obsW + MEANALT;
 
     // Az and Dec
     double range_posx = sat_posx - obs_posx;
     double range_posy = sat_posy - obs_posy;
     double range_posz = sat_posz - obs_posz;
-    m_range           = sqrt(range_posx * range_posx + range_posy * range_posy + range_posz * range_posz);
-    //     double range_velx = sat_velx - obs_velx;
-    //     double range_vely = sat_velx - obs_vely;
-    //     double range_velz = sat_velx - obs_velz;
+    position->range   = sqrt(range_posx * range_posx + range_posy * range_posy + range_posz * range_posz);
 
     double top_s = sinlat * costheta * range_posx + sinlat * sintheta * range_posy - coslat * range_posz;
     double top_e = -sintheta * range_posx + costheta * range_posy;
@@ -1171,59 +1257,31 @@ int Satellite::sgp4(double tsince)
         azimuth += M_PI;
     if (azimuth < 0.)
         azimuth += TWOPI;
-    double elevation = arcSin(top_z / m_range);
+    double elevation = arcSin(top_z / position->range);
 
-    //     printf("azimuth=%.15f\n\r", azimuth / DEG2RAD);
-    //     printf("elevation=%.15f\n\r", elevation / DEG2RAD);
-
-    setAz(azimuth / DEG2RAD);
-    setAlt(elevation / DEG2RAD);
-    HorizontalToEquatorial(data->lst(), data->geo()->lat());
+    position->az  = azimuth / DEG2RAD;
+    position->alt = elevation / DEG2RAD;
 
     // is the satellite visible ?
-    // Find ECI coordinates of the sun
-    double mjd, year, T, M, L, e, C, O, Lsa, nu, R, eps;
-
-    mjd  = jul_utc - 2415020.0;
-    year = 1900.0 + mjd / 365.25;
-    T    = (mjd + deltaET(year) / (MINPD * 60.0)) / 36525.0;
-    M    = DEG2RAD * (Modulus(358.47583 + Modulus(35999.04975 * T, 360.0) - (0.000150 + 0.0000033 * T) * T * T, 360.0));
-    L    = DEG2RAD * (Modulus(279.69668 + Modulus(36000.76892 * T, 360.0) + 0.0003025 * T * T, 360.0));
-    e    = 0.01675104 - (0.0000418 + 0.000000126 * T) * T;
-    C    = DEG2RAD * ((1.919460 - (0.004789 + 0.000014 * T) * T) * sin(M) + (0.020094 - 0.000100 * T) * sin(2 * M) +
-                      0.000293 * sin(3 * M));
-    O    = DEG2RAD * (Modulus(259.18 - 1934.142 * T, 360.0));
-    Lsa  = Modulus(L + C - DEG2RAD * (0.00569 - 0.00479 * sin(O)), TWOPI);
-    nu   = Modulus(M + C, TWOPI);
-    R    = 1.0000002 * (1.0 - e * e) / (1.0 + e * cos(nu));
-    eps  = DEG2RAD * (23.452294 - (0.0130125 + (0.00000164 - 0.000000503 * T) * T) * T + 0.00256 * cos(O));
-    R    = AU * R;
-
-    double sun_posx = R * cos(Lsa);
-    double sun_posy = R * sin(Lsa) * cos(eps);
-    double sun_posz = R * sin(Lsa) * sin(eps);
-    double sun_posw = R;
-
     // Calculates satellite's eclipse status and depth
     double sd_sun, sd_earth, delta, depth;
 
     // Determine partial eclipse
     sd_earth       = arcSin(RADIUSEARTHKM / sat_posw);
-    double rho_x   = sun_posx - sat_posx;
-    double rho_y   = sun_posy - sat_posy;
-    double rho_z   = sun_posz - sat_posz;
+    double rho_x   = frame.sunX - sat_posx;
+    double rho_y   = frame.sunY - sat_posy;
+    double rho_z   = frame.sunZ - sat_posz;
     double rho_w   = sqrt(rho_x * rho_x + rho_y * rho_y + rho_z * rho_z);
     sd_sun         = arcSin(SR / rho_w);
     double earth_x = -1.0 * sat_posx;
     double earth_y = -1.0 * sat_posy;
     double earth_z = -1.0 * sat_posz;
     double earth_w = sat_posw;
-    delta      = PIO2 - arcSin((sun_posx * earth_x + sun_posy * earth_y + sun_posz * earth_z) / (sun_posw * earth_w));
-    depth      = sd_earth - sd_sun - delta;
-    KSSun *sun = dynamic_cast<KSSun *>(data->skyComposite()->findByName(i18n("Sun")));
+    delta = PIO2 - arcSin((frame.sunX * earth_x + frame.sunY * earth_y + frame.sunZ * earth_z) / (frame.sunW * earth_w));
+    depth = sd_earth - sd_sun - delta;
 
-    m_is_eclipsed = sd_earth >= sd_sun && depth >= 0;
-    m_is_visible  = !m_is_eclipsed && sun->alt().Degrees() <= -12.0 && elevation >= 0.0;
+    position->eclipsed = sd_earth >= sd_sun && depth >= 0;
+    position->visible  = !position->eclipsed && frame.sunAltitude <= -12.0 && elevation >= 0.0;
 
     return (0);
 }
@@ -10,7 +10,9 @@
 
 #include <QString>
 
+class GeoLocation;
 class KSPopupMenu;
+class KStarsDateTime;
 
 /**
  * @class Satellite
@@ -34,9 +36,76 @@ class Satellite : public SkyObject
         /** @short Destructor */
         virtual ~Satellite() override = default;
 
+        /**
+         * @struct Frame
+         * The observer and the Sun at one time. They are the same for all the satellites, so they
+         * are computed once when many satellites are propagated to the same time.
+         */
+        struct Frame
+        {
+            /**
+             * @short Computes the frame of the observer at geo, at the UT.
+             * The altitude of the Sun is the one of the low precision Sun used for the eclipses.
+             */
+            Frame(const KStarsDateTime &ut, const GeoLocation *geo);
+
+            /**
+             * @return the frame the given number of seconds later, for short intervals (minutes).
+             * Only the rotation of the Earth is accounted for, which is much cheaper than a new frame.
+             */
+            Frame after(double seconds) const;
+
+            /// UT Julian date
+            double jd { 0 };
+            /// Local sidereal time and latitude, to convert the positions to equatorial coordinates
+            CachingDms lst;
+            const CachingDms *lat { nullptr };
+            /// Observer ECI position [km] and local mean sidereal time
+            double sinLat { 0 }, cosLat { 0 }, sinTheta { 0 }, cosTheta { 0 };
+            double obsX { 0 }, obsY { 0 }, obsZ { 0 }, obsW { 0 };
+            /// Sun ECI position [km] and altitude [degrees]
+            double sunX { 0 }, sunY { 0 }, sunZ { 0 }, sunW { 0 };
+            double sunAltitude { 0 };
+        };
+
+        /**
+         * @struct Position
+         * Position of a satellite seen by the observer of a frame.
+         */
+        struct Position
+        {
+            /// Azimuth and altitude [degrees]
+            double az { 0 };
+            double alt { 0 };
+            /// Range from the observer, altitude and velocity, see range(), altitude() and velocity()
+            double range { 0 };
+            double height { 0 };
+            double velocity { 0 };
+            /// See isVisible()
+            bool eclipsed { false };
+            bool visible { false };
+        };
+
+        /** @return the frame of the current KStars time and location, with the Sun of the sky map. */
+        static Frame currentFrame();
+
         /** @short Update satellite position */
         int updatePos();
 
+        /**
+         * @short Update satellite position to the time of the frame.
+         * Only this satellite is modified, so that different satellites can be updated from several threads.
+         */
+        int updatePos(const Frame &frame);
+
+        /**
+         * @brief position Computes the position of the satellite at the time of the frame, without moving the satellite.
+         * @note The deep space resonance integration state of the satellite is updated, a satellite
+         * must not be propagated from several threads at once.
+         * @return 0 on success, otherwise see sgp4ErrorString()
+         */
+        int position(const Frame &frame, Position *position);
+
         /**
          * @return True if the satellite is visible (above horizon, in the sunlight and sun at least 12° under horizon)
          */
@@ -77,10 +146,10 @@ class Satellite : public SkyObject
         void init();
 
         /** @short Compute satellite position */
-        int sgp4(double tsince);
+        int sgp4(double tsince, const Frame &frame, Position *position);
 
         /** @return Arcsine of the argument */
-        double arcSin(double arg);
+        static double arcSin(double arg);
 
         /**
          * Provides the difference between UT (approximately the same as UTC)
@@ -88,10 +157,10 @@ class Satellite : public SkyObject
          * This function is based on a least squares fit of data from 1950
          * to 1991 and will need to be updated periodically.
          */
-        double deltaET(double year);
+        static double deltaET(double year);
 
         /** @return arg1 mod arg2 */
-        double Modulus(double arg1, double arg2);
+        static double Modulus(double arg1, double arg2);
 
         // TLE
         /// Satellite Number
@@ -11,6 +11,15 @@
 #include "skyobjects/satellite.h"
 
 #include <QTextStream>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+namespace
+{
+// Below this, propagating in parallel costs more than it saves.
+constexpr int MIN_PARALLEL_SATELLITES = 64;
+}
 
 SatelliteGroup::SatelliteGroup(const QString& name, const QString& tle_filename, const QUrl& update_url)
 {
@@ -51,19 +60,38 @@ void SatelliteGroup::readTLE()
 
 void SatelliteGroup::updateSatellitesPos()
 {
-    QMutableListIterator<Satellite *> sats(*this);
+    updateSatellitesPos(Satellite::currentFrame());
+}
 
-    while (sats.hasNext())
+void SatelliteGroup::updateSatellitesPos(const Satellite::Frame &frame)
+{
+    struct Update
+    {
+        Satellite *satellite;
+        int rc;
+    };
+    QVector<Update> updates;
+    for (const auto &sat : *this)
     {
-        Satellite *sat = sats.next();
-
         if (sat->selected())
-        {
-            int rc = sat->updatePos();
-            // If position cannot be calculated, remove it from list
-            if (rc != 0)
-                sats.remove();
-        }
+            updates.append({sat, 0});
+    }
+
+    // Each satellite only modifies itself, so they are propagated in parallel.
+    const auto update = [&frame](Update & u)
+    {
+        u.rc = u.satellite->updatePos(frame);
+    };
+    if (updates.size() < MIN_PARALLEL_SATELLITES)
+        std::for_each(updates.begin(), updates.end(), update);
+    else
+        QtConcurrent::blockingMap(updates, update);
+
+    // If position cannot be calculated, remove it from list
+    for (const auto &u : updates)
+    {
+        if (u.rc != 0)
+            removeOne(u.satellite);
     }
 }
 
@@ -6,11 +6,11 @@
 
 #pragma once
 
+#include "satellite.h"
+
 #include <QString>
 #include <QUrl>
 
-class Satellite;
-
 /**
  * @class SatelliteGroup
  * Represents a group of artificial satellites.
@@ -37,6 +37,12 @@ class SatelliteGroup : public QList<Satellite *>
      */
     void updateSatellitesPos();
 
+    /**
+     * Compute the position of the selected satellites of the group at the time of the frame.
+     * The satellites are propagated in parallel.
+     */
+    void updateSatellitesPos(const Satellite::Frame &frame);
+
     /**
      * @return TLE filename
      */
@@ -0,0 +1,237 @@
+/*  Satellite Pass Predictor
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "satellitepasspredictor.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+#include <memory>
+
+namespace
+{
+
+// Satellites per parallel job.
+constexpr int SATELLITES_PER_JOB = 16;
+
+// Precision of the rise, culmination and set times, in seconds.
+constexpr double TIME_PRECISION = 1.0;
+
+// Local maxima of the altitude on the grid that are less than this below the minimum altitude
+// are refined, in case the satellite goes above the minimum altitude between two times of the grid.
+constexpr double GRAZING_MARGIN = 10.0;
+
+}
+
+SatellitePassPredictor::SatellitePassPredictor(const GeoLocation *geo, const KStarsDateTime &startUT,
+        const KStarsDateTime &endUT, int stepSeconds)
+    : m_Geo(geo), m_StartUT(startUT), m_StepSeconds(std::max(1, stepSeconds))
+{
+    // The end is rounded up to a time of the grid.
+    const double seconds = static_cast<double>(endUT.djd() - startUT.djd()) * 86400;
+    const int count = seconds > 0 ? static_cast<int>(std::ceil(seconds / m_StepSeconds)) + 1 : 0;
+    m_Frames.reserve(count);
+    for (int i = 0; i < count; i++)
+        m_Frames.push_back(Satellite::Frame(m_StartUT.addSecs(static_cast<double>(i) * m_StepSeconds), m_Geo));
+}
+
+bool SatellitePassPredictor::position(Satellite *satellite, double seconds, Satellite::Position *position) const
+{
+    const int last = static_cast<int>(m_Frames.size()) - 1;
+    const int i = std::clamp(static_cast<int>(std::lround(seconds / m_StepSeconds)), 0, last);
+    const double offset = seconds - static_cast<double>(i) * m_StepSeconds;
+    if (offset == 0)
+        return satellite->position(m_Frames[i], position) == 0;
+    return satellite->position(m_Frames[i].after(offset), position) == 0;
+}
+
+double SatellitePassPredictor::crossing(Satellite *satellite, double seconds1, double seconds2, bool rising) const
+{
+    // Bisection, the altitude is below the minimum at seconds1 if rising, above otherwise.
+    Satellite::Position p;
+    while (seconds2 - seconds1 > TIME_PRECISION)
+    {
+        const double middle = (seconds1 + seconds2) / 2;
+        if (!position(satellite, middle, &p))
+            break;
+        if ((p.alt >= m_MinAltitude) == rising)
+            seconds2 = middle;
+        else
+            seconds1 = middle;
+    }
+    return (seconds1 + seconds2) / 2;
+}
+
+double SatellitePassPredictor::culmination(Satellite *satellite, double seconds1, double seconds2) const
+{
+    // Golden section search, the altitude has a single maximum around a time of the grid.
+    const auto altitude = [&](double seconds)
+    {
+        Satellite::Position p;
+        return position(satellite, seconds, &p) ? p.alt : -90.0;
+    };
+    constexpr double ratio = 0.6180339887498949;
+    double c = seconds2 - ratio * (seconds2 - seconds1);
+    double d = seconds1 + ratio * (seconds2 - seconds1);
+    double altC = altitude(c), altD = altitude(d);
+    while (seconds2 - seconds1 > TIME_PRECISION)
+    {
+        if (altC > altD)
+        {
+            seconds2 = d;
+            d = c;
+            altD = altC;
+            c = seconds2 - ratio * (seconds2 - seconds1);
+            altC = altitude(c);
+        }
+        else
+        {
+            seconds1 = c;
+            c = d;
+            altC = altD;
+            d = seconds1 + ratio * (seconds2 - seconds1);
+            altD = altitude(d);
+        }
+    }
+    return (seconds1 + seconds2) / 2;
+}
+
+void SatellitePassPredictor::predict(Satellite *satellite, QVector<Pass> *passes) const
+{
+    // Coarse: the positions at all the times of the grid.
+    const int count = static_cast<int>(m_Frames.size());
+    std::vector<Satellite::Position> positions(count);
+    for (int i = 0; i < count; i++)
+    {
+        if (satellite->position(m_Frames[i], &positions[i]) != 0)
+            return;
+    }
+
+    const double endSeconds = static_cast<double>(count - 1) * m_StepSeconds;
+    const auto addPass = [&](const double *riseSeconds, double culminationSeconds, const double *setSeconds, bool visible)
+    {
+        Pass pass;
+        Satellite::Position p;
+        if (riseSeconds != nullptr && position(satellite, *riseSeconds, &p))
+        {
+            pass.rise = m_StartUT.addSecs(*riseSeconds);
+            pass.riseAz = p.az;
+        }
+        if (position(satellite, culminationSeconds, &p))
+        {
+            pass.culmination = m_StartUT.addSecs(culminationSeconds);
+            pass.culminationAz = p.az;
+            pass.culminationAlt = p.alt;
+            visible = visible || p.visible;
+        }
+        if (setSeconds != nullptr && position(satellite, *setSeconds, &p))
+        {
+            pass.set = m_StartUT.addSecs(*setSeconds);
+            pass.setAz = p.az;
+        }
+        pass.visible = visible;
+        passes->append(pass);
+    };
+
+    // Fine: the rise, culmination and set around the times of the grid.
+    int i = 0;
+    while (i < count)
+    {
+        if (positions[i].alt >= m_MinAltitude)
+        {
+            const int first = i;
+            int highest = i;
+            bool visible = false;
+            for (; i < count && positions[i].alt >= m_MinAltitude; i++)
+            {
+                if (positions[i].alt > positions[highest].alt)
+                    highest = i;
+                visible = visible || positions[i].visible;
+            }
+            const int last = i - 1;
+
+            double riseSeconds = 0, setSeconds = endSeconds;
+            if (first > 0)
+                riseSeconds = crossing(satellite, (first - 1.0) * m_StepSeconds, first * static_cast<double>(m_StepSeconds), true);
+            if (last < count - 1)
+                setSeconds = crossing(satellite, last * static_cast<double>(m_StepSeconds), (last + 1.0) * m_StepSeconds, false);
+            const double culminationSeconds = culmination(satellite,
+                                              std::max(riseSeconds, (highest - 1.0) * m_StepSeconds),
+                                              std::min(setSeconds, (highest + 1.0) * m_StepSeconds));
+            addPass(first > 0 ? &riseSeconds : nullptr, culminationSeconds, last < count - 1 ? &setSeconds : nullptr, visible);
+        }
+        else if (i > 0 && i < count - 1 && positions[i].alt > positions[i - 1].alt && positions[i].alt >= positions[i + 1].alt
+                 && positions[i].alt > m_MinAltitude - GRAZING_MARGIN)
+        {
+            // The highest point may be above the minimum altitude between two times of the grid.
+            const double culminationSeconds = culmination(satellite, (i - 1.0) * m_StepSeconds, (i + 1.0) * m_StepSeconds);
+            Satellite::Position p;
+            if (position(satellite, culminationSeconds, &p) && p.alt >= m_MinAltitude)
+            {
+                const double riseSeconds = crossing(satellite, (i - 1.0) * m_StepSeconds, culminationSeconds, true);
+                const double setSeconds = crossing(satellite, culminationSeconds, (i + 1.0) * m_StepSeconds, false);
+                addPass(&riseSeconds, culminationSeconds, &setSeconds, false);
+            }
+            i++;
+        }
+        else
+            i++;
+    }
+}
+
+QVector<SatellitePassPredictor::Pass> SatellitePassPredictor::predict(const QList<Satellite *> &satellites) const
+{
+    struct Job
+    {
+        int begin;
+        int end;
+        QVector<Pass> passes;
+    };
+
+    QVector<Pass> passes;
+    if (satellites.isEmpty() || m_Frames.empty())
+        return passes;
+
+    // New satellites are made from the TLEs, which never change, rather than copied: the state of
+    // the satellites given may be written by the sky map update while the passes are predicted.
+    std::vector<std::unique_ptr<Satellite>> snapshots;
+    snapshots.reserve(satellites.size());
+    for (const auto satellite : satellites)
+    {
+        const QStringList lines = satellite->tle().split('\n');
+        snapshots.emplace_back(lines.size() == 3 ? new Satellite(lines[0], lines[1], lines[2]) : nullptr);
+    }
+
+    std::vector<Job> jobs;
+    for (int begin = 0; begin < satellites.size(); begin += SATELLITES_PER_JOB)
+        jobs.push_back({begin, std::min<int>(satellites.size(), begin + SATELLITES_PER_JOB), {}});
+
+    auto predictJob = [&](Job & job)
+    {
+        for (int i = job.begin; i < job.end; i++)
+        {
+            if (!snapshots[i])
+                continue;
+            const int first = job.passes.size();
+            predict(snapshots[i].get(), &job.passes);
+            for (int j = first; j < job.passes.size(); j++)
+                job.passes[j].satellite = satellites[i];
+        }
+    };
+
+    if (jobs.size() == 1)
+        predictJob(jobs.front());
+    else
+        QtConcurrent::blockingMap(jobs, predictJob);
+
+    for (const auto &job : jobs)
+        passes.append(job.passes);
+    std::stable_sort(passes.begin(), passes.end(), [](const Pass & a, const Pass & b)
+    {
+        return a.culmination < b.culmination;
+    });
+    return passes;
+}
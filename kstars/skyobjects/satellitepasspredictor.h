@@ -0,0 +1,87 @@
+/*  Satellite Pass Predictor
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kstarsdatetime.h"
+#include "satellite.h"
+
+#include <QList>
+#include <QVector>
+
+#include <vector>
+
+class GeoLocation;
+
+/**
+ * @class SatellitePassPredictor
+ * @short Predicts the passes of many satellites over the observer during an interval, typically a night.
+ *
+ * The observer and the Sun are computed once for a grid of times. Each satellite is propagated
+ * to all the times of the grid, then the rise, culmination and set of its passes are refined
+ * between the times of the grid to about a second. Passes culminating between two times of the
+ * grid, with both times below the minimum altitude, are found by refining the local maxima of the
+ * altitude that are close to the minimum altitude.
+ *
+ * The satellites are processed in parallel, on new satellites made from their TLEs, so that the
+ * satellites shown on the sky map are neither read nor modified while they are updated.
+ */
+class SatellitePassPredictor
+{
+    public:
+        struct Pass
+        {
+            /// The satellite given to predict()
+            const Satellite *satellite { nullptr };
+            /// Invalid if the satellite is already above the minimum altitude at the start
+            KStarsDateTime rise;
+            double riseAz { 0 };
+            KStarsDateTime culmination;
+            double culminationAz { 0 };
+            double culminationAlt { 0 };
+            /// Invalid if the satellite is still above the minimum altitude at the end
+            KStarsDateTime set;
+            double setAz { 0 };
+            /// True if the satellite can be seen during the pass, see Satellite::isVisible()
+            bool visible { false };
+        };
+
+        /**
+         * @brief Prepares the grid of times from startUT to endUT, stepSeconds apart.
+         * @param stepSeconds should be shorter than the passes to find, a minute finds all the passes
+         * of low Earth orbit satellites above a few degrees.
+         */
+        SatellitePassPredictor(const GeoLocation *geo, const KStarsDateTime &startUT, const KStarsDateTime &endUT,
+                               int stepSeconds = 60);
+
+        /** @short Only the parts of the passes above this altitude (degrees) are considered, 0 by default. */
+        void setMinAltitude(double minAltitude)
+        {
+            m_MinAltitude = minAltitude;
+        }
+
+        /**
+         * @brief predict Finds the passes of the satellites, using several threads.
+         * @note Only the TLEs of the satellites are read, on the calling thread. The satellites must
+         * outlive the passes, which point to them. Satellites whose position cannot be computed are skipped.
+         * @return the passes, sorted by culmination time
+         */
+        QVector<Pass> predict(const QList<Satellite *> &satellites) const;
+
+    private:
+        /// Position of the satellite the given number of seconds after the start.
+        bool position(Satellite *satellite, double seconds, Satellite::Position *position) const;
+        /// Time in seconds, between seconds1 and seconds2, at which the satellite rises above, or sets below, the minimum altitude.
+        double crossing(Satellite *satellite, double seconds1, double seconds2, bool rising) const;
+        /// Time in seconds, between seconds1 and seconds2, of the highest altitude of the satellite.
+        double culmination(Satellite *satellite, double seconds1, double seconds2) const;
+        void predict(Satellite *satellite, QVector<Pass> *passes) const;
+
+        const GeoLocation *m_Geo { nullptr };
+        KStarsDateTime m_StartUT;
+        int m_StepSeconds { 60 };
+        double m_MinAltitude { 0 };
+        std::vector<Satellite::Frame> m_Frames;
+};
@@ -546,6 +546,180 @@ void StarObject::JITupdate()
     updateID = data->updateID();
 }
 
+void StarObject::JITupdate(StarObject *stars, int count)
+{
+    static KStarsData *data = KStarsData::Instance();
+
+    // Light bending depends on the distance of each star to the Sun,
+    // leave it to the regular path.
+    if (Options::useRelativistic())
+    {
+        for (int i = 0; i < count; ++i)
+        {
+            if (stars[i].updateID != data->updateID())
+                stars[i].JITupdate();
+        }
+        return;
+    }
+
+    JITupdate(stars, count, data->updateNum(), data->lst(), data->geo()->lat(), data->updateID(), data->updateNumID());
+}
+
+void StarObject::JITupdate(StarObject *stars, int count, const KSNumbers *num, const CachingDms *LST,
+                           const CachingDms *lat, quint64 updateID, quint64 updateNumID)
+{
+#ifdef PROFILE_UPDATECOORDS
+    std::clock_t start = std::clock();
+    unsigned int updated = 0;
+#endif
+
+    const long double jd       = num->getJD();
+    const bool alwaysRecompute = Options::alwaysRecomputeCoordinates();
+
+    // Same short circuit of the proper motion as getIndexCoords()
+    const double julianMillenia = num->julianMillenia();
+    const double pmScale        = julianMillenia * (M_PI / (180.0 * 3600.0));
+
+    const Eigen::Matrix3d &PN = num->precessionNutation();
+    const double m00 = PN(0, 0), m01 = PN(0, 1), m02 = PN(0, 2);
+    const double m10 = PN(1, 0), m11 = PN(1, 1), m12 = PN(1, 2);
+    const double m20 = PN(2, 0), m21 = PN(2, 1), m22 = PN(2, 2);
+    const double ax = num->aberration()(0), ay = num->aberration()(1), az = num->aberration()(2);
+
+    double sinLST, cosLST, sinLat, cosLat;
+    LST->SinCos(sinLST, cosLST);
+    lat->SinCos(sinLat, cosLat);
+
+    // Stars are processed in chunks, with their coordinates laid out in
+    // plain arrays so that the loops without trigonometry vectorize.
+    constexpr int chunkSize = 64;
+    StarObject *pending[chunkSize], *moving[chunkSize];
+    double x[chunkSize], y[chunkSize], z[chunkSize];
+    double sinAlt[chunkSize], cosAlt[chunkSize], sinHA[chunkSize], sinDec[chunkSize];
+
+    int i = 0;
+    while (i < count)
+    {
+        // Gather the stars which need an update, and the catalog
+        // positions of those which need to be moved to the apparent place.
+        int n = 0, m = 0;
+        for (; i < count && n < chunkSize; ++i)
+        {
+            StarObject *star = &stars[i];
+            if (star->updateID == updateID)
+                continue;
+
+            pending[n++] = star;
+
+            if (star->updateNumID == updateNumID)
+                continue;
+            star->updateNumID = updateNumID;
+
+            if (!alwaysRecompute && std::abs(star->lastPrecessJD - jd) < 0.00069444)
+                continue;
+
+            double sinRa, cosRa, sinDec0, cosDec0;
+            star->ra0().SinCos(sinRa, cosRa);
+            star->dec0().SinCos(sinDec0, cosDec0);
+
+            double pmms = star->pmMagnitudeSquared();
+            double pmRA = 0, pmDec = 0;
+            if (!std::isnan(pmms) && pmms * julianMillenia * julianMillenia >= .01)
+            {
+                pmRA  = star->pmRA() * pmScale;
+                pmDec = star->pmDec() * pmScale;
+            }
+
+            x[m] = cosDec0 * cosRa - pmRA * sinRa - pmDec * sinDec0 * cosRa;
+            y[m] = cosDec0 * sinRa + pmRA * cosRa - pmDec * sinDec0 * sinRa;
+            z[m] = sinDec0 + pmDec * cosDec0;
+            moving[m++] = star;
+        }
+
+        // Precession, nutation and aberration
+        for (int j = 0; j < m; ++j)
+        {
+            double vx = m00 * x[j] + m01 * y[j] + m02 * z[j];
+            double vy = m10 * x[j] + m11 * y[j] + m12 * z[j];
+            double vz = m20 * x[j] + m21 * y[j] + m22 * z[j];
+
+            // The proper motion is a first order correction, renormalize before and after aberration
+            double r = 1.0 / std::sqrt(vx * vx + vy * vy + vz * vz);
+            vx = vx * r + ax;
+            vy = vy * r + ay;
+            vz = vz * r + az;
+
+            r    = 1.0 / std::sqrt(vx * vx + vy * vy + vz * vz);
+            x[j] = vx * r;
+            y[j] = vy * r;
+            z[j] = vz * r;
+        }
+
+        for (int j = 0; j < m; ++j)
+        {
+            CachingDms ra, dec;
+            ra.setUsing_atan2(y[j], x[j]);
+            ra.reduceToRange(dms::ZERO_TO_2PI);
+            dec.setUsing_asin(z[j]);
+
+            moving[j]->setRA(ra);
+            moving[j]->setDec(dec);
+            moving[j]->lastPrecessJD = jd;
+        }
+
+        // Horizontal coordinates, as in SkyPoint::EquatorialToHorizontal()
+        for (int j = 0; j < n; ++j)
+        {
+            double sinRa, cosRa, cosDec;
+            pending[j]->ra().SinCos(sinRa, cosRa);
+            pending[j]->dec().SinCos(sinDec[j], cosDec);
+
+            // Hour angle LST - RA
+            sinHA[j]    = sinLST * cosRa - cosLST * sinRa;
+            double cosHA = cosLST * cosRa + sinLST * sinRa;
+
+            sinAlt[j] = sinDec[j] * sinLat + cosDec * cosLat * cosHA;
+            cosAlt[j] = std::sqrt(1 - sinAlt[j] * sinAlt[j]);
+        }
+
+        for (int j = 0; j < n; ++j)
+        {
+            double altRad = asin(sinAlt[j]);
+            if (cosAlt[j] == 0.)
+                cosAlt[j] = cos(altRad);
+
+            double arg = (sinDec[j] - sinLat * sinAlt[j]) / (cosLat * cosAlt[j]);
+            double azRad;
+            if (arg <= -1.0)
+                azRad = dms::PI;
+            else if (arg >= 1.0)
+                azRad = 0.0;
+            else
+                azRad = acos(arg);
+
+            if (sinHA[j] > 0.0 && azRad != 0.0)
+                azRad = 2.0 * dms::PI - azRad;
+
+            dms alt, azimuth;
+            alt.setRadians(altRad);
+            azimuth.setRadians(azRad);
+            pending[j]->setAlt(alt);
+            pending[j]->setAz(azimuth);
+            pending[j]->updateID = updateID;
+        }
+
+#ifdef PROFILE_UPDATECOORDS
+        updated += m;
+#endif
+    }
+
+#ifdef PROFILE_UPDATECOORDS
+    std::clock_t stop = std::clock();
+    updateCoordsCpuTime += double(stop - start) / double(CLOCKS_PER_SEC);
+    starsUpdated += updated;
+#endif
+}
+
 QString StarObject::sptype(void) const
 {
     return QString(QByteArray(SpType, 2));
@@ -195,6 +195,25 @@ class StarObject : public SkyObject
     /** @short added for JIT updates from both StarComponent and ConstellationLines */
     void JITupdate();
 
+    /**
+     * @short JITupdate() of @p count consecutive stars at once.
+     *
+     * The catalog positions are gathered into arrays and carried to the
+     * apparent place with the combined precession and nutation matrix and
+     * the aberration vector of KSNumbers, then converted to horizontal
+     * coordinates, in tight loops over the arrays instead of one
+     * SkyPoint::updateCoords() per star. Results agree with JITupdate()
+     * within 50 milliarcseconds, which the tests check over the whole sky.
+     */
+    static void JITupdate(StarObject *stars, int count);
+
+    /**
+     * @short JITupdate() of @p count consecutive stars for the given time and place.
+     * @note Does not apply light bending, see Options::useRelativistic()
+     */
+    static void JITupdate(StarObject *stars, int count, const KSNumbers *num, const CachingDms *LST,
+                          const CachingDms *lat, quint64 updateID, quint64 updateNumID);
+
     /** @short returns the magnitude of the proper motion correction in milliarcsec/year */
     inline double pmMagnitude() const
     {
@@ -29,7 +29,7 @@ class SkyObject;
 class SkyPoint;
 class Supernova;
 class CatalogObject;
-class ImageOverlay;
+class ImageOverlayComponent;
 
 /**
  * @short Draws things on the sky, without regard to backend.
@@ -128,6 +128,17 @@ class SkyPainter
          */
         virtual bool drawPointSource(const SkyPoint *loc, float mag, char sp = 'A') = 0;
 
+        /**
+         * @short Draw a batch of point sources.
+         * The default implementation calls drawPointSource() for each of them.
+         * @param locs the locations of the sources in the sky
+         * @param mags the magnitudes of the sources
+         * @param sps the spectral classes of the sources
+         * @param count the number of sources
+         * @return the number of sources drawn
+         */
+        virtual int drawPointSources(const SkyPoint * const *locs, const float *mags, const char *sps, int count);
+
         /**
         * @short Draw a deep sky object (loaded from the new implementation)
         * @param obj the object to draw
@@ -201,10 +212,11 @@ class SkyPainter
 
         /**
          * @brief drawImageOverlay Draws a user-supplied image onto the skymap
+         * @param imageOverlays the component, which provides the image at the drawn size
          * @param useCache if True, try to re-use last generated image instead of rendering a new image.
          * @return true if it was drawn
          */
-        virtual bool drawImageOverlay(const QList<ImageOverlay> *imageOverlays, bool useCache = false) = 0;
+        virtual bool drawImageOverlay(ImageOverlayComponent *imageOverlays, bool useCache = false) = 0;
 
     private:
         float m_sizeMagLim{ 10.0f };
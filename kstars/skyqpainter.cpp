@@ -733,6 +733,46 @@ bool SkyQPainter::drawPointSource(const SkyPoint * loc, float mag, char sp)
     }
 }
 
+int SkyQPainter::drawPointSources(const SkyPoint * const *locs, const float *mags, const char *sps, int count)
+{
+    m_batchIndex.clear();
+    m_batchLon.clear();
+    m_batchLat.clear();
+
+    // Same as drawPointSource(), with the sources that pass checkVisibility() projected at once
+    const bool useAltAz = m_proj->viewParams().useAltAz;
+    for (int i = 0; i < count; ++i)
+    {
+        const SkyPoint *loc = locs[i];
+        if (!m_proj->checkVisibility(loc))
+            continue;
+
+        m_batchIndex.push_back(i);
+        m_batchLon.push_back(useAltAz ? loc->az().radians() : loc->ra().radians());
+        m_batchLat.push_back(useAltAz ? loc->alt().radians() : loc->dec().radians());
+    }
+
+    const int n = static_cast<int>(m_batchIndex.size());
+    m_batchX.resize(n);
+    m_batchY.resize(n);
+    m_batchVisible.resize(n);
+    m_proj->toScreenBatch(m_batchLon.data(), m_batchLat.data(), n, m_batchX.data(), m_batchY.data(),
+                          m_batchVisible.data());
+
+    int drawn = 0;
+    for (int j = 0; j < n; ++j)
+    {
+        QPointF pos(m_batchX[j], m_batchY[j]);
+        if (m_batchVisible[j] && m_proj->onScreen(pos))
+        {
+            const int i = m_batchIndex[j];
+            drawPointSource(pos, starWidth(mags[i]), sps[i]);
+            drawn++;
+        }
+    }
+    return drawn;
+}
+
 void SkyQPainter::drawPointSource(const QPointF &pos, float size, char sp)
 {
     int isize = qMin(static_cast<int>(size), 14);
@@ -872,7 +912,7 @@ bool SkyQPainter::drawTerrain(bool useCache)
     return rendered;
 }
 
-bool SkyQPainter::drawImageOverlay(const QList<ImageOverlay> *imageOverlays, bool useCache)
+bool SkyQPainter::drawImageOverlay(ImageOverlayComponent *imageOverlays, bool useCache)
 {
     Q_UNUSED(useCache);
     if (!Options::showImageOverlays())
@@ -880,41 +920,35 @@ bool SkyQPainter::drawImageOverlay(const QList<ImageOverlay> *imageOverlays, boo
 
     constexpr int minDisplayDimension = 5;
 
-    // Convert the RA/DEC from j2000 to jNow and add in az/alt computations.
-    auto localTime = KStarsData::Instance()->geo()->UTtoLT(KStarsData::Instance()->clock()->utc());
-
     const ViewParams view = m_proj->viewParams();
     const double vw = view.width, vh = view.height;
     RectangleOverlap overlap(QPointF(vw / 2.0, vh / 2.0), vw, vh);
+    const double zoom = Options::zoomFactor();
 
     // QElapsedTimer drawTimer;
     // drawTimer.restart();
     int numDrawn = 0;
-    for (const ImageOverlay &o : *imageOverlays)
+    const QList<ImageOverlay> overlays = imageOverlays->imageOverlays();
+    for (const ImageOverlay &o : overlays)
     {
-        if (o.m_Status != ImageOverlay::AVAILABLE || o.m_Img.get() == nullptr)
+        if (o.m_Status != ImageOverlay::AVAILABLE || !o.loaded())
             continue;
 
-        double orientation = o.m_Orientation,  ra = o.m_RA, dec = o.m_DEC, scale = o.m_ArcsecPerPixel;
-        const int origWidth = o.m_Width, origHeight = o.m_Height;
+        double orientation = o.m_Orientation;
 
         // Not sure why I have to do this, suspect it's related to the East-to-the-right thing.
         // Note that I have mirrored the image above, so east-to-the-right=false is now east-to-the-right=true
         // BTW, solver gave me -66, but astrometry.net gave me 246.1 East of North
         orientation += 180;
 
-        const dms raDms(ra), decDms(dec);
-        SkyPoint coord(raDms, decDms);
-        coord.apparentCoord(static_cast<long double>(J2000), KStars::Instance()->data()->ut().djd());
-        coord.EquatorialToHorizontal(KStarsData::Instance()->lst(), KStarsData::Instance()->geo()->lat());
+        // The RA/DEC converted from j2000 to jNow, and the az/alt, by ImageOverlayComponent::draw().
+        const SkyPoint &coord = o.m_Coord;
 
         // Find if the object is not visible, or if it is very small.
-        const double a = origWidth * scale / 60.0;  // This is the width of the image in arcmin--not the major axis
-        const double zoom = Options::zoomFactor();
         // W & h are the actual pixel width and height (as doubles) though
         // the projection size might be smaller.
-        const double w    = a * dms::PI * zoom / 10800.0;
-        const double h    = w * origHeight / origWidth;
+        const QSizeF size = o.screenSize(zoom);
+        const double w = size.width(), h = size.height();
         const double maxDimension = std::max(w, h);
         if (maxDimension < minDisplayDimension)
             continue;
@@ -930,6 +964,11 @@ bool SkyQPainter::drawImageOverlay(const QList<ImageOverlay> *imageOverlays, boo
         if (!overlap.intersects(pos, w, h, finalPA))
             continue;
 
+        // The mipmap level closest to the drawn size, rather than the whole image scaled down.
+        const QImage image = imageOverlays->image(o, size);
+        if (image.isNull())
+            continue;
+
         save();
         translate(pos);
         rotate(finalPA);
@@ -937,7 +976,7 @@ bool SkyQPainter::drawImageOverlay(const QList<ImageOverlay> *imageOverlays, boo
         {
             this->scale(-1., 1.);
         }
-        drawImage(QRectF(-0.5 * w, -0.5 * h, w, h), *(o.m_Img.get()));
+        drawImage(QRectF(-0.5 * w, -0.5 * h, w, h), image);
         numDrawn++;
         restore();
     }
@@ -13,13 +13,15 @@
 #include <QColor>
 #include <QMap>
 
+#include <vector>
+
 class Projector;
 class QWidget;
 class QSize;
 class QMessageBox;
 class HIPSRenderer;
 class TerrainRenderer;
-class ImageOverlay;
+class ImageOverlayComponent;
 class KSEarthShadow;
 
 /**
@@ -88,6 +90,7 @@ class SkyQPainter : public SkyPainter, public QPainter
                              LineListLabel *label = nullptr) override;
         void drawSkyPolygon(LineList *list, bool forceClip = true) override;
         bool drawPointSource(const SkyPoint *loc, float mag, char sp = 'A') override;
+        int drawPointSources(const SkyPoint * const *locs, const float *mags, const char *sps, int count) override;
         bool drawCatalogObject(const CatalogObject &obj) override;
         void drawCatalogObjectImage(const QPointF &pos, const CatalogObject &obj,
                                     float positionAngle);
@@ -111,7 +114,7 @@ class SkyQPainter : public SkyPainter, public QPainter
 #endif
         bool drawHips(bool useCache = false) override;
         bool drawTerrain(bool useCache = false) override;
-        bool drawImageOverlay(const QList<ImageOverlay> *imageOverlays, bool useCache = false) override;
+        bool drawImageOverlay(ImageOverlayComponent *imageOverlays, bool useCache = false) override;
         void setSize(int width, int height);
 
     private:
@@ -123,6 +126,11 @@ class SkyQPainter : public SkyPainter, public QPainter
         TerrainRenderer *m_terrainRender{ nullptr };
         QSize m_size;
         QScopedPointer<QImage> m_HiPSImage;
+        // Scratch buffers of drawPointSources(), kept to avoid allocating on every batch
+        std::vector<int> m_batchIndex;
+        std::vector<double> m_batchLon, m_batchLat;
+        std::vector<float> m_batchX, m_batchY;
+        std::vector<uint8_t> m_batchVisible;
         static int starColorMode;
         static QColor m_starColor;
         static QMap<char, QColor> ColorMap;
@@ -14,6 +14,7 @@
 #include "ksnumbers.h"
 #include "simclock.h"
 #include "kssun.h"
+#include "visibilityengine.h"
 #include "dialogs/finddialog.h"
 #include "dialogs/locationdialog.h"
 #include "geolocation.h"
@@ -415,9 +416,10 @@ void AltVsTime::processObject(SkyObject *o, bool forceAdd)
         // time range: 24h
 
         int offset = 3;
-        for (double h = -12.0, i = 0; h <= 12.0; h += 0.25, i++)
+        const QVector<double> altitudes = findAltitudes(o);
+        for (int i = 0; i < altitudes.size(); i++)
         {
-            y[i] = findAltitude(o, h);
+            y[i] = altitudes[i];
             if (y[i] > maxAlt)
                 maxAlt = y[i];
             if (y[i] < minAlt)
@@ -476,6 +478,14 @@ double AltVsTime::findAltitude(SkyPoint *p, double hour)
     return p->alt().Degrees();
 }
 
+QVector<double> AltVsTime::findAltitudes(SkyPoint *p)
+{
+    // 15 minute steps from -12 to +12 hours, see findAltitude()
+    const KStarsDateTime start = getDate().addSecs((24.0 * DayOffset - 12.0) * 3600.0);
+    const VisibilityEngine grid(geo, start, 900, 97);
+    return grid.altitudes(p->ra(), p->dec());
+}
+
 void AltVsTime::slotHighlight(int row)
 {
     if (row < 0)
@@ -938,9 +948,10 @@ void AltVsTime::slotUpdateDateLoc()
             // compute the new graph values:
             // time range: 24h
             int offset = 3;
-            for (double h = -12.0, i = 0; h <= 12.0; h += 0.25, i++)
+            const QVector<double> altitudes = findAltitudes(o);
+            for (int i = 0; i < altitudes.size(); i++)
             {
-                point_altitudeValue = findAltitude(o, h);
+                point_altitudeValue = altitudes[i];
                 altitude_dataSet.push_back(point_altitudeValue);
                 if (point_altitudeValue > maxAlt)
                     maxAlt = point_altitudeValue;
@@ -990,9 +1001,10 @@ void AltVsTime::slotUpdateDateLoc()
             // compute the new graph values:
             // time range: 24h
             int offset = 3;
-            for (double h = -12.0, i = 0; h <= 12.0; h += 0.25, i++)
+            const QVector<double> altitudes = findAltitudes(pList.at(i));
+            for (int i = 0; i < altitudes.size(); i++)
             {
-                point_altitudeValue = findAltitude(pList.at(i), h);
+                point_altitudeValue = altitudes[i];
                 altitude_dataSet.push_back(point_altitudeValue);
                 if (point_altitudeValue > maxAlt)
                     maxAlt = point_altitudeValue;
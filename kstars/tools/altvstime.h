@@ -90,6 +90,14 @@ class AltVsTime : public QDialog
      */
     double findAltitude(SkyPoint *p, double hour);
 
+    /**
+     * @short Determine the altitude of the given skypoint every 15 minutes over the displayed Day,
+     * the same times as findAltitude() for hours -12 to 12, using a VisibilityEngine grid.
+     * @param p the skypoint whose altitude is to be found
+     * @return the 97 altitudes, expressed in degrees
+     */
+    QVector<double> findAltitudes(SkyPoint *p);
+
     /**
      * @short get object name. If star has no name, generate a name based on catalog number.
      * @param o sky object.
@@ -455,6 +455,9 @@ void setupJob(Ekos::SchedulerJob &job, const QString name, double minAltitude, d
                             true, true, true, true);
 }
 
+// Resolution of the imaging times and maximum altitudes shown in the catalog table.
+constexpr int VISIBILITY_STEP_MINUTES = 10;
+
 // Computes the times when the given coordinates can be imaged on the date.
 void getRunTimes(const QDate &date, const GeoLocation &geo, double minAltitude, double minMoonSeparation,
                  double maxMoonAltitude, const dms &ra, const dms &dec, bool useArtificialHorizon, QVector<QDateTime> *jobStartTimes,
@@ -499,25 +502,6 @@ void getRunTimes(const QDate &date, const GeoLocation &geo, double minAltitude,
     }
 }
 
-// Computes the times when the given catalog object can be imaged on the date.
-double getRunHours(const CatalogObject &object, const QDate &date, const GeoLocation &geo, double minAltitude,
-                   double minMoonSeparation, double maxMoonAltitude, bool useArtificialHorizon)
-{
-    QVector<QDateTime> jobStartTimes, jobEndTimes;
-    getRunTimes(date, geo, minAltitude, minMoonSeparation, maxMoonAltitude, object.ra0(), object.dec0(), useArtificialHorizon,
-                &jobStartTimes,
-                &jobEndTimes);
-    if (jobStartTimes.size() == 0 || jobEndTimes.size() == 0)
-        return 0;
-    else
-    {
-        double totalHours = 0.0;
-        for (int i = 0; i < jobStartTimes.size(); ++i)
-            totalHours += jobStartTimes[i].secsTo(jobEndTimes[i]) * 1.0 / 3600.0;
-        return totalHours;
-    }
-}
-
 // Pack is needed to generate the Astrobin search URLs.
 // This implementation was inspired by
 // https://github.com/romixlab/qmsgpack/blob/master/src/private/pack_p.cpp
@@ -738,43 +722,6 @@ double getAltitude(GeoLocation *geo, SkyPoint &p, const QDateTime &time)
     return p.alt().Degrees();
 }
 
-double getMaxAltitude(const KSAlmanac &ksal, const QDate &date, GeoLocation *geo, const SkyObject &object,
-                      double hoursAfterDusk = 0, double hoursBeforeDawn = 0)
-{
-    auto tz = QTimeZone(geo->TZ() * 3600);
-    KStarsDateTime midnight = KStarsDateTime(date.addDays(1), QTime(0, 1));
-    midnight.setTimeZone(tz);
-
-    QDateTime dawn = midnight.addSecs(24 * 3600 * ksal.getDawnAstronomicalTwilight());
-    dawn.setTimeZone(tz);
-    QDateTime dusk = midnight.addSecs(24 * 3600 * ksal.getDuskAstronomicalTwilight());
-    dusk.setTimeZone(tz);
-
-    QDateTime start = dusk.addSecs(hoursAfterDusk * 3600);
-    start.setTimeZone(tz);
-
-    auto end = dawn.addSecs(-hoursBeforeDawn * 3600);
-    end.setTimeZone(tz);
-
-    SkyPoint coords = object;
-    double maxAlt = -90;
-    auto t = start;
-    t.setTimeZone(tz);
-    QDateTime maxTime = t;
-
-    while (t.secsTo(end) > 0)
-    {
-        double alt = getAltitude(geo, coords, t);
-        if (alt > maxAlt)
-        {
-            maxAlt = alt;
-            maxTime = t;
-        }
-        t = t.addSecs(60 * 20);
-    }
-    return maxAlt;
-}
-
 }  // namespace
 
 CatalogFilter::CatalogFilter(QObject* parent) : QSortFilterProxyModel(parent)
@@ -1510,6 +1457,24 @@ KSMoon *ImagingPlanner::getMoon()
     return moon;
 }
 
+VisibilityEngine::Constraints ImagingPlanner::visibilityConstraints()
+{
+    // Same constraints as the scheduler jobs used by getRunTimes().
+    VisibilityEngine::Constraints constraints;
+    constraints.minAltitude = ui->minAltitude->value();
+    constraints.minMoonSeparation = ui->minMoon->value();
+    constraints.maxMoonAltitude = ui->maxMoonAltitude->value();
+    constraints.preDawnMinutes = Options::preDawnTime();
+    if (Options::enableAltitudeLimits())
+    {
+        constraints.minAltitude = std::max(constraints.minAltitude, Options::minimumAltLimit());
+        constraints.maxAltitude = Options::maximumAltLimit();
+    }
+    if (ui->useArtificialHorizon->isChecked() && KStarsData::Instance()->skyComposite()->artificialHorizon() != nullptr)
+        constraints.horizon = &KStarsData::Instance()->skyComposite()->artificialHorizon()->getHorizon();
+    return constraints;
+}
+
 // Setup the moon image.
 void ImagingPlanner::updateMoon()
 {
@@ -1854,12 +1819,14 @@ CatalogObject *ImagingPlanner::addObject(const QString &name)
 
 // Adds the object to the catalog model, assuming a KStars catalog object can be found
 // for that name.
-bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name, int flags)
+bool ImagingPlanner::addCatalogItem(const VisibilityEngine &visibility, const QString &name, int flags)
 {
     CatalogObject *object = addObject(name);
     if (object == nullptr)
         return false;
 
+    const VisibilityEngine::Visibility objectVisibility = visibility.evaluate(*object, visibilityConstraints());
+
     auto getItemWithUserRole = [](const QString & itemText) -> QStandardItem *
     {
         QStandardItem *ret = new QStandardItem(itemText);
@@ -1878,8 +1845,7 @@ bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name,
         }
         else if (i == HOURS_COLUMN)
         {
-            double runHours = getRunHours(*object, getDate(), *getGeo(), ui->minAltitude->value(), ui->minMoon->value(),
-                                          ui->maxMoonAltitude->value(), ui->useArtificialHorizon->isChecked());
+            const double runHours = objectVisibility.runHours;
             auto hoursItem = getItemWithUserRole(QString("%1").arg(runHours, 0, 'f', 1));
             hoursItem->setData(runHours, HOURS_ROLE);
             itemList.append(hoursItem);
@@ -1899,8 +1865,7 @@ bool ImagingPlanner::addCatalogItem(const KSAlmanac &ksal, const QString &name,
         }
         else if (i == ALTITUDE_COLUMN)
         {
-            const auto time = KStarsDateTime(QDateTime(getDate(), QTime(12, 0)));
-            const double altitude = getMaxAltitude(ksal, getDate(), getGeo(), *object, 0, 0);
+            const double altitude = objectVisibility.maxAltitude;
             auto altItem = getItemWithUserRole(QString("%1º").arg(altitude, 0, 'f', 0));
             altItem->setData(altitude, ALTITUDE_ROLE);
             itemList.append(altItem);
@@ -1983,22 +1948,36 @@ void ImagingPlanner::recompute()
     QElapsedTimer timer;
     timer.start();
 
-    auto tz = QTimeZone(getGeo()->TZ() * 3600);
-    KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-    KStarsDateTime ut  = getGeo()->LTtoUT(KStarsDateTime(midnight));
-    KSAlmanac ksal(ut, getGeo());
-
-    for (int i = 0; i < m_CatalogModel->rowCount(); ++i)
+    // All the rows are evaluated at once, over the same grid of times, see VisibilityEngine.
+    const int rows = m_CatalogModel->rowCount();
+    QVector<const CatalogObject *> catalogEntries(rows);
+    QVector<SkyPoint> targets(rows);
+    for (int i = 0; i < rows; ++i)
     {
         const QString &name = m_CatalogModel->item(i, 0)->text();
-        const CatalogObject *catalogEntry = getObject(name);
-        if (catalogEntry == nullptr)
+        catalogEntries[i] = getObject(name);
+        if (catalogEntries[i] == nullptr)
         {
             DPRINTF(stderr, "************* Couldn't find \"%s\"\n", name.toLatin1().data());
             return;
         }
-        double runHours = getRunHours(*catalogEntry, getDate(), *getGeo(), ui->minAltitude->value(),
-                                      ui->minMoon->value(), ui->maxMoonAltitude->value(), ui->useArtificialHorizon->isChecked());
+        targets[i] = *catalogEntries[i];
+    }
+    const VisibilityEngine visibilityEngine = VisibilityEngine::forNight(getGeo(), getDate(), VISIBILITY_STEP_MINUTES,
+            getMoon());
+    const QVector<VisibilityEngine::Visibility> visibility = visibilityEngine.evaluate(targets, visibilityConstraints());
+
+    // Puts the Moon back at midnight for the separations.
+    KSMoon *moon = getMoon();
+    auto tz = QTimeZone(getGeo()->TZ() * 3600);
+    KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
+    midnight.setTimeZone(tz);
+    const KSNumbers midnightNumbers(midnight.djd());
+
+    for (int i = 0; i < rows; ++i)
+    {
+        const CatalogObject *catalogEntry = catalogEntries[i];
+        const double runHours = visibility[i].runHours;
         QString hoursText = QString("%1").arg(runHours, 0, 'f', 1);
         QStandardItem *hItem = new QStandardItem(hoursText);
         hItem->setData(hoursText, Qt::UserRole);
@@ -2007,25 +1986,19 @@ void ImagingPlanner::recompute()
         m_CatalogModel->setItem(i, HOURS_COLUMN, hItem);
 
 
-        const auto time = KStarsDateTime(QDateTime(getDate(), QTime(12, 0)));
-        const double altitude = getMaxAltitude(ksal, getDate(), getGeo(), *catalogEntry, 0, 0);
+        const double altitude = visibility[i].maxAltitude;
         QString altText = QString("%1º").arg(altitude, 0, 'f', 0);
         auto altItem = new QStandardItem(altText);
         altItem->setData(altText, Qt::UserRole);
         altItem->setData(altitude, ALTITUDE_ROLE);
         m_CatalogModel->setItem(i, ALTITUDE_COLUMN, altItem);
 
-        KSMoon *moon = getMoon();
         if (moon)
         {
             SkyPoint o;
             o.setRA0(catalogEntry->ra0());
             o.setDec0(catalogEntry->dec0());
-            auto tz = QTimeZone(getGeo()->TZ() * 3600);
-            KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-            midnight.setTimeZone(tz);
-            KSNumbers numbers(midnight.djd());
-            o.updateCoordsNow(&numbers);
+            o.updateCoordsNow(&midnightNumbers);
 
             double const separation = moon->angularDistanceTo(&o).Degrees();
             QString moonText = QString("%1º").arg(separation, 0, 'f', 0);
@@ -3769,10 +3742,8 @@ void ImagingPlanner::loadCatalogFromFile(QString path, bool reset)
     QStringList objectNames;
     if (inputFile.open(QIODevice::ReadOnly))
     {
-        const auto tz = QTimeZone(getGeo()->TZ() * 3600);
-        const KStarsDateTime midnight = KStarsDateTime(getDate().addDays(1), QTime(0, 1));
-        const KStarsDateTime ut  = getGeo()->LTtoUT(KStarsDateTime(midnight));
-        const KSAlmanac ksal(ut, getGeo());
+        const VisibilityEngine visibility = VisibilityEngine::forNight(getGeo(), getDate(), VISIBILITY_STEP_MINUTES,
+                                            getMoon());
 
         if (reset)
         {
@@ -3885,7 +3856,7 @@ void ImagingPlanner::loadCatalogFromFile(QString path, bool reset)
         for (const auto &name : objectNames)
         {
             setStatus(i18n("%1/%2: Adding %3", ++iteration, objectNames.size(), name));
-            if (addCatalogItem(ksal, name, 0)) num++;
+            if (addCatalogItem(visibility, name, 0)) num++;
             else
             {
                 DPRINTF(stderr, "Couldn't add %s\n", name.toLatin1().data());
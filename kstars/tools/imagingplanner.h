@@ -8,6 +8,7 @@
 
 #include "ui_imagingplanner.h"
 #include "catalogsdb.h"
+#include "visibilityengine.h"
 
 #include <QDialog>
 #include <QDir>
@@ -177,7 +178,8 @@ protected:
     bool getKStarsCatalogObject(const QString &name, CatalogObject *catObject);
     bool internetNameSearch(const QString &name, bool abellPlanetary, int abellNumber, CatalogObject * catObject);
 
-    bool addCatalogItem(const KSAlmanac &ksal, const QString &name, int flags = 0);
+    bool addCatalogItem(const VisibilityEngine &visibility, const QString &name, int flags = 0);
+    VisibilityEngine::Constraints visibilityConstraints();
     QUrl getAstrobinUrl(const QString &target, bool requireAwards, bool requireSomeFilters, double minRadius, double maxRadius);
     void popupAstrobin(const QString &target);
     void plotAltitudeGraph(const QDate &date, const dms &ra, const dms &dec);
@@ -0,0 +1,274 @@
+/*  Visibility Engine
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#include "visibilityengine.h"
+
+#include "artificialhorizoncomponent.h"
+#include "geolocation.h"
+#include "ksalmanac.h"
+#include "ksnumbers.h"
+#include "ksmoon.h"
+#include "skypoint.h"
+
+#include <QtConcurrent>
+
+#include <algorithm>
+#include <cmath>
+
+namespace
+{
+
+// Targets per parallel job, each job has its own scratch buffers.
+constexpr int TARGETS_PER_JOB = 64;
+
+// Number of samples, stepSeconds apart from 0, before the time.
+int samplesBefore(double seconds, int stepSeconds, int sampleCount)
+{
+    if (!(seconds > 0))
+        return 0;
+    return static_cast<int>(std::min<double>(sampleCount, std::ceil(seconds / stepSeconds)));
+}
+
+}
+
+VisibilityEngine::VisibilityEngine(const GeoLocation *geo, const KStarsDateTime &startUT, int stepSeconds,
+                                   int sampleCount)
+    : m_Geo(geo), m_StartUT(startUT), m_StepSeconds(std::max(1, stepSeconds)), m_SampleCount(std::max(0, sampleCount))
+{
+    m_Geo->lat()->SinCos(m_SinLat, m_CosLat);
+
+    m_CosLST.resize(m_SampleCount);
+    m_SinLST.resize(m_SampleCount);
+    for (int i = 0; i < m_SampleCount; i++)
+    {
+        double sinLST, cosLST;
+        m_Geo->GSTtoLST(sampleTime(i).gst()).SinCos(sinLST, cosLST);
+        m_CosLST[i] = cosLST;
+        m_SinLST[i] = sinLST;
+    }
+
+    m_DuskSample = 0;
+    m_DawnSample = m_SampleCount;
+    m_DawnSeconds = static_cast<double>(m_SampleCount) * m_StepSeconds;
+}
+
+VisibilityEngine VisibilityEngine::forNight(const GeoLocation *geo, const QDate &date, int stepMinutes, KSMoon *moon)
+{
+    const KStarsDateTime noonUT = geo->LTtoUT(KStarsDateTime(date, QTime(12, 0)));
+    const int stepSeconds = std::max(1, stepMinutes) * 60;
+    VisibilityEngine engine(geo, noonUT, stepSeconds, 24 * 3600 / stepSeconds);
+
+    // Same dusk and dawn as the Imaging Planner and the Observing List use for the night.
+    const KStarsDateTime midnightUT = geo->LTtoUT(KStarsDateTime(date.addDays(1), QTime(0, 1)));
+    KSAlmanac ksal(midnightUT, geo);
+    engine.setNight(midnightUT.addSecs(24 * 3600 * ksal.getDuskAstronomicalTwilight()),
+                    midnightUT.addSecs(24 * 3600 * ksal.getDawnAstronomicalTwilight()));
+
+    if (moon)
+        engine.setMoon(moon);
+    return engine;
+}
+
+void VisibilityEngine::setNight(const KStarsDateTime &duskUT, const KStarsDateTime &dawnUT)
+{
+    const double duskSeconds = static_cast<double>(duskUT.djd() - m_StartUT.djd()) * 86400;
+    m_DawnSeconds = static_cast<double>(dawnUT.djd() - m_StartUT.djd()) * 86400;
+    m_DuskSample = samplesBefore(duskSeconds, m_StepSeconds, m_SampleCount);
+    m_DawnSample = std::max(m_DuskSample, samplesBefore(m_DawnSeconds, m_StepSeconds, m_SampleCount));
+}
+
+void VisibilityEngine::setMoon(KSMoon *moon)
+{
+    m_MoonSinDec.resize(m_SampleCount);
+    m_MoonCosDecCosRA.resize(m_SampleCount);
+    m_MoonCosDecSinRA.resize(m_SampleCount);
+    m_MoonAltitude.resize(m_SampleCount);
+
+    for (int i = 0; i < m_SampleCount; i++)
+    {
+        const KStarsDateTime ut = sampleTime(i);
+        KSNumbers numbers(ut.djd());
+        CachingDms LST = m_Geo->GSTtoLST(ut.gst());
+        moon->updateCoords(&numbers, true, m_Geo->lat(), &LST, true);
+        moon->EquatorialToHorizontal(&LST, m_Geo->lat());
+
+        double sinRA, cosRA, sinDec, cosDec;
+        moon->ra().SinCos(sinRA, cosRA);
+        moon->dec().SinCos(sinDec, cosDec);
+        m_MoonSinDec[i] = sinDec;
+        m_MoonCosDecCosRA[i] = cosDec * cosRA;
+        m_MoonCosDecSinRA[i] = cosDec * sinRA;
+        m_MoonAltitude[i] = moon->alt().Degrees();
+    }
+    m_HasMoon = true;
+}
+
+QVector<double> VisibilityEngine::altitudes(const dms &ra, const dms &dec) const
+{
+    double sinRA, cosRA, sinDec, cosDec;
+    ra.SinCos(sinRA, cosRA);
+    dec.SinCos(sinDec, cosDec);
+    const double a = sinDec * m_SinLat;
+    const double b = cosDec * m_CosLat * cosRA;
+    const double c = cosDec * m_CosLat * sinRA;
+
+    QVector<double> result(m_SampleCount);
+    for (int i = 0; i < m_SampleCount; i++)
+        result[i] = std::asin(std::clamp(a + b * m_CosLST[i] + c * m_SinLST[i], -1.0, 1.0)) * 180 / M_PI;
+    return result;
+}
+
+VisibilityEngine::Target VisibilityEngine::prepare(const SkyPoint &target) const
+{
+    double sinRA, cosRA, sinDec, cosDec;
+    target.ra().SinCos(sinRA, cosRA);
+    target.dec().SinCos(sinDec, cosDec);
+
+    Target t;
+    t.a = sinDec * m_SinLat;
+    t.b = cosDec * m_CosLat * cosRA;
+    t.c = cosDec * m_CosLat * sinRA;
+    t.sinDec = sinDec;
+    t.cosDec = cosDec;
+    t.sinRA = sinRA;
+    t.cosRA = cosRA;
+    return t;
+}
+
+VisibilityEngine::Visibility VisibilityEngine::evaluate(const Target &target, const Constraints &constraints,
+        std::vector<float> &sinAlt) const
+{
+    const int n = m_SampleCount;
+    sinAlt.resize(n);
+    float * const s = sinAlt.data();
+    const float * const cosLST = m_CosLST.data();
+    const float * const sinLST = m_SinLST.data();
+
+    // cos(LST - RA) expanded, so that the loops below are plain multiply-adds.
+    for (int i = 0; i < n; i++)
+        s[i] = target.a + target.b * cosLST[i] + target.c * sinLST[i];
+
+    Visibility result;
+    if (m_DuskSample < m_DawnSample)
+    {
+        float maxSinAlt = -1;
+        for (int i = m_DuskSample; i < m_DawnSample; i++)
+            maxSinAlt = std::max(maxSinAlt, s[i]);
+        result.maxAltitude = std::asin(std::clamp(maxSinAlt, -1.0f, 1.0f)) * 180 / M_PI;
+    }
+
+    int first = 0, last = n;
+    if (constraints.enforceTwilight)
+    {
+        first = m_DuskSample;
+        last = std::min(m_DawnSample, samplesBefore(m_DawnSeconds - 60 * std::fabs(constraints.preDawnMinutes),
+                        m_StepSeconds, n));
+    }
+    if (first >= last)
+        return result;
+
+    // Altitudes are compared as sines, and separations as cosines.
+    const float minSinAlt = std::sin(std::clamp(constraints.minAltitude, -90.0, 90.0) * M_PI / 180);
+    const float maxSinAlt = constraints.maxAltitude >= 90 ? 2.0f :
+                            std::sin(std::clamp(constraints.maxAltitude, -90.0, 90.0) * M_PI / 180);
+    const bool checkSeparation = m_HasMoon && constraints.minMoonSeparation > 0;
+    const bool checkMoonAltitude = m_HasMoon && constraints.maxMoonAltitude < 90;
+    const float maxCosSeparation = std::cos(std::min(constraints.minMoonSeparation, 180.0) * M_PI / 180);
+    const float maxMoonAltitude = constraints.maxMoonAltitude;
+
+    const float p = target.sinDec, q = target.cosDec * target.cosRA, r = target.cosDec * target.sinRA;
+    const float * const moonSinDec = m_MoonSinDec.data();
+    const float * const moonCosDecCosRA = m_MoonCosDecCosRA.data();
+    const float * const moonCosDecSinRA = m_MoonCosDecSinRA.data();
+    const float * const moonAltitude = m_MoonAltitude.data();
+
+    // Samples that fail a constraint get their sine set below -1.
+    constexpr float REJECTED = -2;
+    for (int i = first; i < last; i++)
+    {
+        bool ok = s[i] >= minSinAlt && s[i] <= maxSinAlt;
+        if (checkSeparation)
+            ok = ok && (p * moonSinDec[i] + q * moonCosDecCosRA[i] + r * moonCosDecSinRA[i]) <= maxCosSeparation;
+        if (checkMoonAltitude)
+            ok = ok && moonAltitude[i] <= maxMoonAltitude;
+        s[i] = ok ? s[i] : REJECTED;
+    }
+
+    int count = 0;
+    for (int i = first; i < last; i++)
+    {
+        if (s[i] == REJECTED)
+            continue;
+
+        if (constraints.horizon != nullptr)
+        {
+            // Same azimuth as SkyPoint::EquatorialToHorizontal().
+            const double sinHA = m_SinLST[i] * target.cosRA - m_CosLST[i] * target.sinRA;
+            const double altitude = std::asin(s[i]);
+            const double cosAlt = std::sqrt(std::max(0.0, 1.0 - static_cast<double>(s[i]) * s[i]));
+            double azimuth = 0;
+            if (cosAlt > 0 && m_CosLat > 0)
+            {
+                const double arg = (target.sinDec - m_SinLat * s[i]) / (m_CosLat * cosAlt);
+                azimuth = arg <= -1 ? M_PI : (arg >= 1 ? 0 : std::acos(arg));
+                if (sinHA > 0 && azimuth != 0)
+                    azimuth = 2 * M_PI - azimuth;
+            }
+            if (!constraints.horizon->isAltitudeOK(azimuth * 180 / M_PI, altitude * 180 / M_PI, nullptr))
+                continue;
+        }
+        count++;
+    }
+
+    result.runHours = count * (m_StepSeconds / 3600.0);
+    return result;
+}
+
+VisibilityEngine::Visibility VisibilityEngine::evaluate(const SkyPoint &target, const Constraints &constraints) const
+{
+    return evaluate(QVector<SkyPoint>() << target, constraints).first();
+}
+
+QVector<VisibilityEngine::Visibility> VisibilityEngine::evaluate(const QVector<SkyPoint> &targets,
+        const Constraints &constraints) const
+{
+    struct Job
+    {
+        int begin;
+        int end;
+        std::vector<float> sinAlt;
+    };
+
+    QVector<Visibility> result(targets.size());
+    if (targets.isEmpty())
+        return result;
+    // Written from several threads, must not detach.
+    Visibility * const visibility = result.data();
+
+    // Catalog coordinates are brought to the middle of the grid, precession during a night is negligible.
+    const KSNumbers numbers(sampleTime(m_SampleCount / 2).djd());
+
+    auto evaluateJob = [&](Job & job)
+    {
+        for (int i = job.begin; i < job.end; i++)
+        {
+            SkyPoint point;
+            point.setRA0(targets[i].ra0());
+            point.setDec0(targets[i].dec0());
+            point.updateCoordsNow(&numbers);
+            visibility[i] = evaluate(prepare(point), constraints, job.sinAlt);
+        }
+    };
+
+    std::vector<Job> jobs;
+    for (int begin = 0; begin < targets.size(); begin += TARGETS_PER_JOB)
+        jobs.push_back({begin, std::min<int>(targets.size(), begin + TARGETS_PER_JOB), {}});
+
+    if (jobs.size() == 1)
+        evaluateJob(jobs.front());
+    else
+        QtConcurrent::blockingMap(jobs, evaluateJob);
+    return result;
+}
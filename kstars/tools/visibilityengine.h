@@ -0,0 +1,134 @@
+/*  Visibility Engine
+
+    SPDX-License-Identifier: GPL-2.0-or-later
+*/
+
+#pragma once
+
+#include "kstarsdatetime.h"
+
+#include <QVector>
+
+#include <vector>
+
+class ArtificialHorizon;
+class dms;
+class GeoLocation;
+class KSMoon;
+class SkyPoint;
+
+/**
+ * @class VisibilityEngine
+ * @short Altitude and imaging time of many targets over a grid of times.
+ *
+ * The local sidereal time, darkness and Moon position are computed once for every time of the grid.
+ * Targets are then evaluated in parallel against all the times at once. Target coordinates are kept
+ * as sines and cosines, so that cos(LST - RA) and the Moon separation become sums of products, and
+ * the inner loops over the times have no trigonometric calls and are vectorized by the compiler.
+ * Azimuths are only computed, for the artificial horizon, at the times that pass the other constraints.
+ *
+ * A night with a 10 minute grid for a few thousand catalog objects is evaluated in a few milliseconds.
+ */
+class VisibilityEngine
+{
+    public:
+        struct Constraints
+        {
+            double minAltitude { 0 };
+            double maxAltitude { 90 };
+            // Disabled when not positive.
+            double minMoonSeparation { 0 };
+            // Disabled when 90 or more.
+            double maxMoonAltitude { 90 };
+            // Only count the times between dusk and dawn less preDawnMinutes.
+            bool enforceTwilight { true };
+            double preDawnMinutes { 0 };
+            // Not used if null. Must not be modified while evaluate() runs.
+            const ArtificialHorizon *horizon { nullptr };
+        };
+
+        struct Visibility
+        {
+            // Time satisfying all the constraints.
+            double runHours { 0 };
+            // Highest altitude between dusk and dawn, -90 if there is no night.
+            double maxAltitude { -90 };
+        };
+
+        /**
+         * @brief Builds a grid of sampleCount times, stepSeconds apart, from startUT.
+         * All the times are considered dark until setNight() is called.
+         */
+        VisibilityEngine(const GeoLocation *geo, const KStarsDateTime &startUT, int stepSeconds, int sampleCount);
+
+        /**
+         * @brief forNight Builds a grid from local noon of date to the next noon, with the night set between
+         * astronomical dusk and dawn.
+         * @param moon if not null, its positions are sampled for the Moon constraints, which is done on the calling thread.
+         */
+        static VisibilityEngine forNight(const GeoLocation *geo, const QDate &date, int stepMinutes, KSMoon *moon = nullptr);
+
+        /**
+         * @brief setNight Marks the times between dusk and dawn as dark.
+         */
+        void setNight(const KStarsDateTime &duskUT, const KStarsDateTime &dawnUT);
+
+        /**
+         * @brief setMoon Samples the Moon at every time of the grid. The Moon is left at the last time.
+         */
+        void setMoon(KSMoon *moon);
+
+        int sampleCount() const
+        {
+            return m_SampleCount;
+        }
+        int stepSeconds() const
+        {
+            return m_StepSeconds;
+        }
+        KStarsDateTime sampleTime(int sample) const
+        {
+            return m_StartUT.addSecs(static_cast<qint64>(sample) * m_StepSeconds);
+        }
+
+        /**
+         * @brief altitudes The altitude in degrees of the given coordinates at each time of the grid.
+         * The coordinates are used as is, like SkyPoint::EquatorialToHorizontal() uses ra() and dec().
+         */
+        QVector<double> altitudes(const dms &ra, const dms &dec) const;
+
+        /**
+         * @brief evaluate Evaluates the constraints for each target at all the times of the grid, using several threads.
+         * @param targets catalog coordinates, ra0() and dec0(), which are brought to the middle of the grid.
+         */
+        QVector<Visibility> evaluate(const QVector<SkyPoint> &targets, const Constraints &constraints) const;
+        Visibility evaluate(const SkyPoint &target, const Constraints &constraints) const;
+
+    private:
+        struct Target
+        {
+            // sin(alt) = a + b * cos(LST) + c * sin(LST)
+            float a, b, c;
+            float sinDec, cosDec, sinRA, cosRA;
+        };
+
+        Target prepare(const SkyPoint &target) const;
+        Visibility evaluate(const Target &target, const Constraints &constraints, std::vector<float> &sinAlt) const;
+
+        const GeoLocation *m_Geo { nullptr };
+        KStarsDateTime m_StartUT;
+        int m_StepSeconds { 0 };
+        int m_SampleCount { 0 };
+        double m_SinLat { 0 };
+        double m_CosLat { 1 };
+
+        // Dark samples are [m_DuskSample, m_DawnSample), early dawn is in seconds from the start of the grid.
+        int m_DuskSample { 0 };
+        int m_DawnSample { 0 };
+        double m_DawnSeconds { 0 };
+
+        // Structure of arrays, one entry per sample.
+        std::vector<float> m_CosLST, m_SinLST;
+        bool m_HasMoon { false };
+        std::vector<float> m_MoonSinDec, m_MoonCosDecCosRA, m_MoonCosDecSinRA, m_MoonAltitude;
+};